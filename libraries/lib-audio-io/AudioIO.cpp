@@ -62,6 +62,7 @@ time warp info and AudioIOListener and whether the playback is looped.
 
 #include "AudioIOExt.h"
 #include "AudioIOListener.h"
+#include "AudioTrace.h"
 
 #include "float_cast.h"
 #include "DeviceManager.h"
@@ -340,6 +341,7 @@ AudioIO::~AudioIO()
    // wxTheApp->Yield();
 
    mFinishAudioThread.store(true, std::memory_order_release);
+   WakeAudioThread();
    mAudioThread.join();
 }
 
@@ -1041,8 +1043,10 @@ int AudioIO::StartStream(const TransportSequences &sequences,
    // so that they will have data in them when the stream starts.  Having the
    // audio thread call SequenceBufferExchange here makes the code more predictable, since
    // SequenceBufferExchange will ALWAYS get called from the Audio thread.
+   mAudioThreadStatistics.Reset(mRate, mPlaybackQueueMinimum);
    mAudioThreadShouldCallSequenceBufferExchangeOnce
       .store(true, std::memory_order_release);
+   WakeAudioThread();
 
    while( mAudioThreadShouldCallSequenceBufferExchangeOnce
       .load(std::memory_order_acquire)) {
@@ -1268,6 +1272,10 @@ bool AudioIO::AllocateBuffers(
             mPlaybackQueueMinimum = mPlaybackSamplesToCopy *
                ((mPlaybackQueueMinimum + mPlaybackSamplesToCopy - 1) / mPlaybackSamplesToCopy);
 
+            // FillPlayBuffers does nothing until a batch fits
+            mPlaybackLowWater = playbackBufferSize -
+               std::min(playbackBufferSize, mPlaybackSamplesToCopy);
+
             if (mPlaybackSequences.empty())
                // Make at least one playback buffer
                mPlaybackBuffers[0] =
@@ -1802,6 +1810,8 @@ void AudioIO::AudioThread(std::atomic<bool> &finish)
 {
    enum class State { eUndefined, eOnce, eLoopRunning, eDoNothing, eMonitoring } lastState = State::eUndefined;
    AudioIO *const gAudioIO = AudioIO::Get();
+   bool signaled = false;
+   AudioTrace::SetThreadName("Audio Thread");
    while (!finish.load(std::memory_order_acquire)) {
       using Clock = std::chrono::steady_clock;
       auto loopPassStart = Clock::now();
@@ -1837,7 +1847,13 @@ void AudioIO::AudioThread(std::atomic<bool> &finish)
          // This is unlike the case with mAudioThreadShouldCallSequenceBufferExchangeOnce where the
          // store really means that the one-time exchange was done.
 
+         const auto playing = gAudioIO->mNumPlaybackChannels > 0;
+         const auto ready = playing ? gAudioIO->GetCommonlyReadyPlayback() : 0;
+         const auto exchangeStart = Clock::now();
          gAudioIO->SequenceBufferExchange();
+         if (playing)
+            gAudioIO->mAudioThreadStatistics.AddPass(
+               Clock::now() - exchangeStart, ready, signaled);
       }
       else
       {
@@ -1860,7 +1876,9 @@ void AudioIO::AudioThread(std::atomic<bool> &finish)
       gAudioIO->mAudioThreadSequenceBufferExchangeLoopActive
          .store(false, std::memory_order_relaxed);
 
-      std::this_thread::sleep_until( loopPassStart + interval );
+      // Sleep no longer than the policy says, but the callback may wake us
+      // sooner, when it has consumed enough for another batch
+      signaled = gAudioIO->WaitForAudioThreadWake(loopPassStart + interval);
    }
 }
 
@@ -1986,6 +2004,8 @@ void AudioIO::FillPlayBuffers()
 bool AudioIO::ProcessPlaybackSlices(
    std::optional<RealtimeEffects::ProcessingScope> &pScope, size_t available)
 {
+   auto stopwatch =
+      AudioTrace::CreateStopwatch(AudioTrace::SectionID::PlaybackSlices);
    auto &policy = mPlaybackSchedule.GetPolicy();
 
    // msmeyer: When playing a very short selection in looped
@@ -2023,6 +2043,8 @@ bool AudioIO::ProcessPlaybackSlices(
                produced = mixer->Process(toProduce);
             //wxASSERT(produced <= toProduce);
             // Copy (non-interleaved) mixer outputs to one or more ring buffers
+            auto putStopwatch =
+               AudioTrace::CreateStopwatch(AudioTrace::SectionID::PlaybackPut);
             const auto nChannels = mPlaybackSequences[iSequence++]->NChannels();
             for (size_t j = 0; j < nChannels; ++j) {
                auto warpedSamples = mixer->GetBuffer(j);
@@ -2123,6 +2145,8 @@ void AudioIO::DrainRecordBuffers()
 {
    if (mRecordingException || mCaptureSequences.empty())
       return;
+   auto stopwatch =
+      AudioTrace::CreateStopwatch(AudioTrace::SectionID::DrainRecordBuffers);
 
    auto delayedHandler = [this] ( AudacityException * pException ) {
       // In the main thread, stop recording
@@ -3106,6 +3130,9 @@ int AudioIoCallback::AudioCallback(
    const PaStreamCallbackTimeInfo *timeInfo,
    const PaStreamCallbackFlags statusFlags, void * WXUNUSED(userData) )
 {
+   auto stopwatch =
+      AudioTrace::CreateStopwatch(AudioTrace::SectionID::AudioCallback);
+
    // Poll sequences for change of state.
    // (User might click mute and solo buttons.)
    mbHasSoloSequences = CountSoloingSequences() > 0 ;
@@ -3196,6 +3223,11 @@ int AudioIoCallback::AudioCallback(
          outputMeterFloats))
       return mCallbackReturn;
 
+   // Don't wait for the Audio thread to poll, if it can refill now
+   if (mNumPlaybackChannels > 0 &&
+       GetCommonlyReadyPlayback() <= mPlaybackLowWater)
+      WakeAudioThread();
+
    // To move the cursor onwards.  (uses mMaxFramesOutput)
    UpdateTimePosition(framesPerBuffer);
 
@@ -3302,6 +3334,7 @@ auto AudioIoCallback::AudioIOExtIterator::operator *() const -> AudioIOExt &
 void AudioIoCallback::StartAudioThread()
 {
    mAudioThreadSequenceBufferExchangeLoopRunning.store(true, std::memory_order_release);
+   WakeAudioThread();
 }
 
 void AudioIoCallback::WaitForAudioThreadStarted()
@@ -3317,6 +3350,7 @@ void AudioIoCallback::WaitForAudioThreadStarted()
 void AudioIoCallback::StopAudioThread()
 {
    mAudioThreadSequenceBufferExchangeLoopRunning.store(false, std::memory_order_release);
+   WakeAudioThread();
 }
 
 void AudioIoCallback::WaitForAudioThreadStopped()
@@ -3333,6 +3367,7 @@ void AudioIoCallback::ProcessOnceAndWait(std::chrono::milliseconds sleepTime)
 {
    mAudioThreadShouldCallSequenceBufferExchangeOnce
       .store(true, std::memory_order_release);
+   WakeAudioThread();
 
    while (mAudioThreadShouldCallSequenceBufferExchangeOnce
       .load(std::memory_order_acquire))
@@ -3344,6 +3379,24 @@ void AudioIoCallback::ProcessOnceAndWait(std::chrono::milliseconds sleepTime)
 
 
 
+void AudioIoCallback::WakeAudioThread()
+{
+   mAudioThreadWake.store(true, std::memory_order_release);
+   // Notify without the mutex, which the callback must not lock.  A wake-up
+   // between the waiter's test and its wait can be missed, but then it waits
+   // only until its deadline, as it always did.
+   mAudioThreadWakeCondition.notify_one();
+}
+
+bool AudioIoCallback::WaitForAudioThreadWake(
+   std::chrono::steady_clock::time_point deadline)
+{
+   std::unique_lock<std::mutex> lock{ mAudioThreadWakeMutex };
+   return mAudioThreadWakeCondition.wait_until(lock, deadline, [this]{
+      return mAudioThreadWake.exchange(false, std::memory_order_acquire);
+   });
+}
+
 bool AudioIO::IsCapturing() const
 {
    // Includes a test of mTime, used in the main thread
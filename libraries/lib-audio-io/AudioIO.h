@@ -15,8 +15,10 @@
 
 #include "AudioIOBase.h" // to inherit
 #include "AudioIOSequences.h"
+#include "AudioThreadStatistics.h" // member variable
 #include "PlaybackSchedule.h" // member variable
 
+#include <condition_variable>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -300,6 +302,9 @@ public:
    size_t              mHardwarePlaybackLatencyFrames {};
    /// Occupancy of the queue we try to maintain, with bigger batches if needed
    size_t              mPlaybackQueueMinimum;
+   /// The callback wakes the Audio thread when no more than this is ready,
+   /// because then there is room for a batch
+   size_t              mPlaybackLowWater{};
 
    double              mMinCaptureSecsToCopy;
    /*! Read by a worker thread but unchanging during playback */
@@ -331,6 +336,22 @@ public:
 
    void ProcessOnceAndWait( std::chrono::milliseconds sleepTime = std::chrono::milliseconds(50) );
 
+   //! Make the Audio thread start its next pass now, if it is waiting
+   /*! Does not block, so the PortAudio callback may call it */
+   void WakeAudioThread();
+   //! Called only in the Audio thread, between passes
+   /*! @return whether woken by WakeAudioThread() before the deadline */
+   bool WaitForAudioThreadWake(std::chrono::steady_clock::time_point deadline);
+
+   std::mutex mAudioThreadWakeMutex;
+   std::condition_variable mAudioThreadWakeCondition;
+   std::atomic<bool> mAudioThreadWake{ false };
+
+   //! Written by the Audio thread, read by any
+   AudioThreadStatistics mAudioThreadStatistics;
+
+   const AudioThreadStatistics &GetAudioThreadStatistics() const
+   { return mAudioThreadStatistics; }
 
 
    std::atomic<bool>   mForceFadeOut{ false };
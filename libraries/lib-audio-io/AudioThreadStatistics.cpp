@@ -0,0 +1,145 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+ Audacity: A Digital Audio Editor
+
+ @file AudioThreadStatistics.cpp
+
+ **********************************************************************/
+
+#include "AudioThreadStatistics.h"
+
+#include <algorithm>
+#include <limits>
+
+#include <wx/sstream.h>
+#include <wx/txtstrm.h>
+
+#include "Internat.h"
+
+Log2Histogram::Log2Histogram() noexcept
+{
+   Reset();
+}
+
+void Log2Histogram::Add(uint64_t value) noexcept
+{
+   size_t bin = 0;
+   while (value && bin < NBins - 1) {
+      value >>= 1;
+      ++bin;
+   }
+   mCounts[bin].fetch_add(1, std::memory_order_relaxed);
+}
+
+void Log2Histogram::Reset() noexcept
+{
+   for (auto &count : mCounts)
+      count.store(0, std::memory_order_relaxed);
+}
+
+auto Log2Histogram::GetCounts() const noexcept -> Counts
+{
+   Counts result;
+   for (size_t ii = 0; ii < NBins; ++ii)
+      result[ii] = mCounts[ii].load(std::memory_order_relaxed);
+   return result;
+}
+
+uint64_t Log2Histogram::BinStart(size_t bin) noexcept
+{
+   return bin == 0 ? 0 : uint64_t{ 1 } << (bin - 1);
+}
+
+AudioThreadStatistics::AudioThreadStatistics() noexcept
+{
+   Reset(0, 0);
+}
+
+void AudioThreadStatistics::Reset(double rate, size_t queueMinimum) noexcept
+{
+   mWorkMicroseconds.Reset();
+   mReadyMilliseconds.Reset();
+   mPasses.store(0, std::memory_order_relaxed);
+   mSignaledPasses.store(0, std::memory_order_relaxed);
+   mNearMisses.store(0, std::memory_order_relaxed);
+   mLeastReady.store(
+      std::numeric_limits<size_t>::max(), std::memory_order_relaxed);
+   mRate.store(rate, std::memory_order_relaxed);
+   mQueueMinimum.store(queueMinimum, std::memory_order_relaxed);
+}
+
+void AudioThreadStatistics::AddPass(
+   Duration work, size_t ready, bool signaled) noexcept
+{
+   using namespace std::chrono;
+   mWorkMicroseconds.Add(duration_cast<microseconds>(work).count());
+   const auto rate = mRate.load(std::memory_order_relaxed);
+   if (rate > 0)
+      mReadyMilliseconds.Add(ready * 1000 / rate);
+   mPasses.fetch_add(1, std::memory_order_relaxed);
+   if (signaled)
+      mSignaledPasses.fetch_add(1, std::memory_order_relaxed);
+   if (ready < mQueueMinimum.load(std::memory_order_relaxed))
+      mNearMisses.fetch_add(1, std::memory_order_relaxed);
+   // Only the audio thread writes this, except in Reset
+   if (ready < mLeastReady.load(std::memory_order_relaxed))
+      mLeastReady.store(ready, std::memory_order_relaxed);
+}
+
+wxString AudioThreadStatistics::Report() const
+{
+   wxStringOutputStream o;
+   wxTextOutputStream s(o, wxEOL_UNIX);
+
+   const auto passes = mPasses.load(std::memory_order_relaxed);
+   const auto rate = mRate.load(std::memory_order_relaxed);
+   const auto toMilliseconds = [rate](size_t samples) {
+      return rate > 0 ? samples * 1000 / rate : 0.0;
+   };
+
+   s << XO("Passes of the audio thread during playback: %llu\n")
+      .Format(static_cast<unsigned long long>(passes));
+   if (passes == 0)
+      return o.GetString();
+
+   s << XO("Woken by the playback callback: %llu\n")
+      .Format(static_cast<unsigned long long>(
+         mSignaledPasses.load(std::memory_order_relaxed)));
+   s << XO("Near misses, with less than %.1f ms queued: %llu\n")
+      .Format(
+         toMilliseconds(mQueueMinimum.load(std::memory_order_relaxed)),
+         static_cast<unsigned long long>(
+            mNearMisses.load(std::memory_order_relaxed)));
+   s << XO("Least queued: %.1f ms\n")
+      .Format(toMilliseconds(mLeastReady.load(std::memory_order_relaxed)));
+
+   const auto printHistogram = [&](
+      const TranslatableString &title, const Log2Histogram &histogram
+   ){
+      s << wxT("==============================\n");
+      s << title << wxT("\n");
+      const auto counts = histogram.GetCounts();
+      for (size_t bin = 0; bin < Log2Histogram::NBins; ++bin) {
+         if (counts[bin] == 0)
+            continue;
+         const auto start = Log2Histogram::BinStart(bin);
+         if (bin == Log2Histogram::NBins - 1)
+            s << wxString::Format(wxT("%llu+"),
+               static_cast<unsigned long long>(start));
+         else
+            s << wxString::Format(wxT("%llu-%llu"),
+               static_cast<unsigned long long>(start),
+               static_cast<unsigned long long>(
+                  Log2Histogram::BinStart(bin + 1) - 1));
+         s << wxString::Format(wxT("\t%llu\n"),
+            static_cast<unsigned long long>(counts[bin]));
+      }
+   };
+   printHistogram(XO("Time to fill the buffers (microseconds):"),
+      mWorkMicroseconds);
+   printHistogram(XO("Queued for playback when the pass began (ms):"),
+      mReadyMilliseconds);
+
+   return o.GetString();
+}
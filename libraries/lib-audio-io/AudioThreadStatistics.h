@@ -0,0 +1,92 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+ Audacity: A Digital Audio Editor
+
+ @file AudioThreadStatistics.h
+ @brief Timings and queue levels of the passes of the audio thread
+
+ **********************************************************************/
+
+#ifndef __AUDACITY_AUDIO_THREAD_STATISTICS__
+#define __AUDACITY_AUDIO_THREAD_STATISTICS__
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include <wx/string.h>
+
+//! Counts of values in bins that double in width
+/*!
+ Bin 0 counts zero; bin k > 0 counts values from 2^(k-1) up to but excluding
+ 2^k; the last bin also counts all greater values.
+
+ One thread may add while others read, without locks.
+ */
+class AUDIO_IO_API Log2Histogram
+{
+public:
+   static constexpr size_t NBins = 24;
+   using Counts = std::array<uint64_t, NBins>;
+
+   Log2Histogram() noexcept;
+
+   void Add(uint64_t value) noexcept;
+   void Reset() noexcept;
+
+   //! A snapshot, which may be inconsistent with concurrent additions by
+   //! one count at most
+   Counts GetCounts() const noexcept;
+
+   //! Least value counted in the bin
+   static uint64_t BinStart(size_t bin) noexcept;
+
+private:
+   std::array<std::atomic<uint64_t>, NBins> mCounts;
+};
+
+//! What the audio thread records of its passes that exchange buffers
+/*!
+ The audio thread adds while the main thread may query, without locks
+ */
+class AUDIO_IO_API AudioThreadStatistics
+{
+public:
+   using Duration = std::chrono::steady_clock::duration;
+
+   AudioThreadStatistics() noexcept;
+
+   //! Forget all passes; call at the start of each stream
+   /*!
+    @param rate of the playback
+    @param queueMinimum passes that begin with fewer samples ready for playback
+    count as near misses
+    */
+   void Reset(double rate, size_t queueMinimum) noexcept;
+
+   //! Record one pass of the audio thread during playback
+   /*!
+    @param work time taken to fill and drain the buffers
+    @param ready samples queued for playback when the pass began
+    @param signaled whether the playback callback woke the thread, rather than
+    a timeout
+    */
+   void AddPass(Duration work, size_t ready, bool signaled) noexcept;
+
+   //! Human readable summary, with histograms
+   wxString Report() const;
+
+private:
+   Log2Histogram mWorkMicroseconds;
+   Log2Histogram mReadyMilliseconds;
+   std::atomic<uint64_t> mPasses;
+   std::atomic<uint64_t> mSignaledPasses;
+   std::atomic<uint64_t> mNearMisses;
+   std::atomic<size_t> mLeastReady;
+   std::atomic<double> mRate;
+   std::atomic<size_t> mQueueMinimum;
+};
+
+#endif
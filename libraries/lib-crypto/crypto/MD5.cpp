@@ -0,0 +1,195 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ * SPDX-FileName: MD5.cpp
+ *
+ * Follows the reference implementation in RFC 1321.
+ */
+
+#include "MD5.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace crypto
+{
+
+namespace
+{
+constexpr uint32_t K[64] = {
+   0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a,
+   0xa8304613, 0xfd469501, 0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be,
+   0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821, 0xf61e2562, 0xc040b340,
+   0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+   0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8,
+   0x676f02d9, 0x8d2a4c8a, 0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c,
+   0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70, 0x289b7ec6, 0xeaa127fa,
+   0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+   0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92,
+   0xffeff47d, 0x85845dd1, 0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1,
+   0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+};
+
+constexpr uint32_t S[64] = {
+   7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+   5, 9,  14, 20, 5, 9,  14, 20, 5, 9,  14, 20, 5, 9,  14, 20,
+   4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+   6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21
+};
+
+#define ROTLEFT(a, b) (((a) << (b)) | ((a) >> (32 - (b))))
+
+void md5_transform(uint32_t state[4], const uint8_t data[64])
+{
+   uint32_t m[16];
+
+   for (int i = 0, j = 0; i < 16; ++i, j += 4)
+      m[i] = (data[j]) | (data[j + 1] << 8) | (data[j + 2] << 16) |
+             (uint32_t(data[j + 3]) << 24);
+
+   uint32_t a = state[0];
+   uint32_t b = state[1];
+   uint32_t c = state[2];
+   uint32_t d = state[3];
+
+   for (int i = 0; i < 64; ++i)
+   {
+      uint32_t f;
+      int g;
+
+      if (i < 16)
+      {
+         f = (b & c) | (~b & d);
+         g = i;
+      }
+      else if (i < 32)
+      {
+         f = (d & b) | (~d & c);
+         g = (5 * i + 1) % 16;
+      }
+      else if (i < 48)
+      {
+         f = b ^ c ^ d;
+         g = (3 * i + 5) % 16;
+      }
+      else
+      {
+         f = c ^ (b | ~d);
+         g = (7 * i) % 16;
+      }
+
+      const auto temp = d;
+      d = c;
+      c = b;
+      b = b + ROTLEFT(a + f + K[i] + m[g], S[i]);
+      a = temp;
+   }
+
+   state[0] += a;
+   state[1] += b;
+   state[2] += c;
+   state[3] += d;
+}
+} // namespace
+
+MD5::MD5()
+{
+   Reset();
+}
+
+void MD5::Update(const void* data, std::size_t size)
+{
+   auto bytes = static_cast<const uint8_t*>(data);
+
+   while (size > 0)
+   {
+      const auto toCopy = std::min<std::size_t>(size, BLOCK_SIZE - mBufferLength);
+      std::memcpy(mBuffer + mBufferLength, bytes, toCopy);
+
+      mBufferLength += toCopy;
+      bytes += toCopy;
+      size -= toCopy;
+
+      if (mBufferLength == BLOCK_SIZE)
+      {
+         md5_transform(mState, mBuffer);
+         mBitLength += BLOCK_SIZE * 8;
+         mBufferLength = 0;
+      }
+   }
+}
+
+void MD5::Update(const char* zString)
+{
+   Update(zString, std::strlen(zString));
+}
+
+MD5::Digest MD5::FinalizeDigest()
+{
+   // `mBufferLength` is always less than MD5::BLOCK_SIZE. See `Update`
+   // method.
+   assert(mBufferLength < MD5::BLOCK_SIZE);
+
+   mBitLength += mBufferLength * 8;
+
+   mBuffer[mBufferLength++] = 0x80;
+
+   if (mBufferLength > 56)
+   {
+      std::memset(mBuffer + mBufferLength, 0, BLOCK_SIZE - mBufferLength);
+      md5_transform(mState, mBuffer);
+      mBufferLength = 0;
+   }
+
+   std::memset(mBuffer + mBufferLength, 0, 56 - mBufferLength);
+
+   // Length in bits, little-endian
+   for (int i = 0; i < 8; ++i)
+      mBuffer[56 + i] = (mBitLength >> (8 * i)) & 0xff;
+
+   md5_transform(mState, mBuffer);
+
+   Digest result;
+
+   for (int i = 0; i < 4; ++i)
+   {
+      result[i * 4 + 0] = (mState[i] >> 0) & 0xff;
+      result[i * 4 + 1] = (mState[i] >> 8) & 0xff;
+      result[i * 4 + 2] = (mState[i] >> 16) & 0xff;
+      result[i * 4 + 3] = (mState[i] >> 24) & 0xff;
+   }
+
+   Reset();
+
+   return result;
+}
+
+std::string MD5::Finalize()
+{
+   const auto result = FinalizeDigest();
+
+   // Convert to hex string
+   constexpr char hexChars[] = "0123456789ABCDEF";
+   std::string resultStr;
+   resultStr.resize(HASH_SIZE * 2);
+
+   for (std::size_t i = 0; i < HASH_SIZE; ++i)
+   {
+      resultStr[i * 2 + 0] = hexChars[(result[i] >> 4) & 0xf];
+      resultStr[i * 2 + 1] = hexChars[result[i] & 0xf];
+   }
+
+   return resultStr;
+}
+
+void MD5::Reset()
+{
+   mBitLength = 0;
+   mBufferLength = 0;
+
+   mState[0] = 0x67452301;
+   mState[1] = 0xefcdab89;
+   mState[2] = 0x98badcfe;
+   mState[3] = 0x10325476;
+}
+} // namespace crypto
@@ -0,0 +1,65 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ * SPDX-FileName: MD5.h
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+#include <string>
+
+namespace crypto
+{
+//! MD5 message digest (RFC 1321)
+/*! Not for security purposes; some file formats, such as FLAC, record the
+ MD5 of their contents */
+class CRYPTO_API MD5 final
+{
+public:
+   static constexpr std::size_t HASH_SIZE = 16;
+   static constexpr std::size_t BLOCK_SIZE = 64;
+
+   using Digest = std::array<uint8_t, HASH_SIZE>;
+
+   MD5();
+
+   MD5(const MD5&) = delete;
+   MD5(MD5&&) = delete;
+   MD5& operator=(const MD5&) = delete;
+   MD5& operator=(MD5&&) = delete;
+
+   void Update(const void* data, std::size_t size);
+   void Update(const char* zString);
+
+   template<typename T>
+   void Update(const T& data)
+   {
+      Update(data.data(), data.size());
+   }
+
+   //! Digest as upper case hexadecimal; resets the state
+   std::string Finalize();
+
+   //! Digest as bytes; resets the state
+   Digest FinalizeDigest();
+
+   void Reset();
+
+private:
+   uint64_t mBitLength;
+   uint32_t mState[4];
+   uint8_t mBuffer[BLOCK_SIZE];
+   uint32_t mBufferLength;
+}; // class MD5
+
+template<typename T>
+std::string md5(const T& data)
+{
+   MD5 hasher;
+   hasher.Update(data);
+   return hasher.Finalize();
+}
+} // namespace crypto
@@ -0,0 +1,83 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SegmentedOverlapAdd.cpp
+
+**********************************************************************/
+#include "SegmentedOverlapAdd.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <cassert>
+
+SegmentedOverlapAdd::SegmentedOverlapAdd(size_t windowSize, size_t M,
+   WindowFilter filter, size_t segmentWindows, size_t nSegments)
+   : mFilter{ move(filter) }
+   , mWindowSize{ windowSize }
+   , mM{ M }
+   , mL{ windowSize - (M - 1) }
+   , mSegmentLen{ std::max<size_t>(segmentWindows, 1) * mL }
+   , mNSegments{ nSegments > 0
+      ? nSegments : SegmentsPerThread * Parallel::DefaultConcurrency() }
+   , mBlockLen{ mNSegments * mSegmentLen }
+   , mBuffer{ mBlockLen }
+   , mOutput{ mBlockLen + M - 1 }
+   , mTails{ mNSegments * (M - 1) }
+   , mCarry{ M - 1, true }
+{
+   assert(M >= 1);
+   assert(2 * (M - 1) < windowSize);
+}
+
+void SegmentedOverlapAdd::FilterSegment(
+   const float *in, size_t n, float *body, float *tail) const
+{
+   ArrayOf<float> window{ mWindowSize };
+   ArrayOf<float> scratch{ mWindowSize };
+   // tail accumulates the overlap of each window into the next
+   std::fill(tail, tail + mM - 1, 0.0f);
+   for (size_t i = 0; i < n; i += mL) {
+      const auto count = std::min(mL, n - i);
+      std::copy(in + i, in + i + count, window.get());
+      std::fill(window.get() + count, window.get() + mWindowSize, 0.0f);
+
+      mFilter(window.get(), scratch.get());
+
+      // Overlap - Add
+      for (size_t j = 0; j < count; ++j)
+         body[i + j] = (j < mM - 1) ? window[j] + tail[j] : window[j];
+      // Only a short last window leaves some of the old overlap
+      for (size_t j = 0; j < mM - 1; ++j)
+         tail[j] = (count + j < mM - 1)
+            ? window[count + j] + tail[count + j]
+            : window[count + j];
+   }
+}
+
+const float *SegmentedOverlapAdd::FilterBlock(size_t len)
+{
+   assert(len <= mBlockLen);
+   const auto nUsed = (len + mSegmentLen - 1) / mSegmentLen;
+   Parallel::For(nUsed, [&](size_t ii){
+      const auto offset = ii * mSegmentLen;
+      FilterSegment(mBuffer.get() + offset,
+         std::min(mSegmentLen, len - offset),
+         mOutput.get() + offset, mTails.get() + ii * (mM - 1));
+   });
+
+   // Add tails of the previous block and of each segment into the starts
+   // of the following ones; the last M - 1 samples carry to the next block
+   std::fill(mOutput.get() + len, mOutput.get() + len + mM - 1, 0.0f);
+   for (size_t j = 0; j < mM - 1; ++j)
+      mOutput[j] += mCarry[j];
+   for (size_t ii = 0; ii < nUsed; ++ii) {
+      const auto end = std::min(len, (ii + 1) * mSegmentLen);
+      const auto tail = mTails.get() + ii * (mM - 1);
+      for (size_t j = 0; j < mM - 1; ++j)
+         mOutput[end + j] += tail[j];
+   }
+   std::copy(mOutput.get() + len, mOutput.get() + len + mM - 1, mCarry.get());
+   return mOutput.get();
+}
@@ -0,0 +1,87 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SegmentedOverlapAdd.h
+  @brief Overlap-add convolution of a stream, in segments filtered in parallel
+
+**********************************************************************/
+#ifndef __AUDACITY_SEGMENTED_OVERLAP_ADD__
+#define __AUDACITY_SEGMENTED_OVERLAP_ADD__
+
+#include "MemoryX.h"
+
+#include <cstddef>
+#include <functional>
+
+//! Convolves a stream with a filter of length M, by overlap-add of windows
+/*!
+ Each block of input is cut into segments of whole numbers of windows, which
+ are filtered independently, on several threads.  The tail of M - 1 samples
+ that each segment leaves is then added into the start of the next, so the
+ result does not depend on the segmentation: it is the same, to the bit, as
+ overlap-add of one window after another.
+
+ M - 1 must be less than half of the window size, so that no more than two
+ windows overlap at any sample.
+ */
+class FFT_API SegmentedOverlapAdd
+{
+public:
+   //! Filters one window in place; the window has windowSize samples, of
+   //! which the last M - 1 at least are zero on entry, and so has the scratch
+   /*! Called on several threads at once */
+   using WindowFilter = std::function<void(float *window, float *scratch)>;
+
+   //! Windows in one segment, the unit of work for one thread
+   static constexpr size_t DefaultSegmentWindows = 8;
+   //! Segments in a block, for each thread
+   static constexpr size_t SegmentsPerThread = 4;
+
+   /*!
+    @param nSegments segments in a block; if 0, SegmentsPerThread for each
+    thread of Parallel::DefaultConcurrency()
+    */
+   SegmentedOverlapAdd(size_t windowSize, size_t M, WindowFilter filter,
+      size_t segmentWindows = DefaultSegmentWindows, size_t nSegments = 0);
+
+   //! Most samples that one call of FilterBlock takes
+   /*! A multiple of the window step, so that windows fall at the same places
+    in the stream whatever the blocks */
+   size_t BlockLen() const { return mBlockLen; }
+   //! Where to put the input for FilterBlock
+   float *Buffer() { return mBuffer.get(); }
+
+   //! Filter len samples from Buffer(), which are not more than BlockLen(),
+   //! or less only for the last block
+   /*! @return len finished samples of output, valid until the next call */
+   const float *FilterBlock(size_t len);
+
+   //! The last M - 1 samples of output, after all input
+   const float *Finish() const { return mCarry.get(); }
+   size_t TailLen() const { return mM - 1; }
+
+private:
+   //! Convolve n samples of in; write the first n results to body, and the
+   //! remaining M - 1 to tail
+   void FilterSegment(const float *in, size_t n, float *body, float *tail) const;
+
+   const WindowFilter mFilter;
+   const size_t mWindowSize;
+   const size_t mM;
+   //! Samples of input in each window
+   const size_t mL;
+   const size_t mSegmentLen;
+   const size_t mNSegments;
+   const size_t mBlockLen;
+
+   ArrayOf<float> mBuffer;
+   ArrayOf<float> mOutput;
+   //! Tails of the segments of one block
+   ArrayOf<float> mTails;
+   //! Tail of the previous block
+   ArrayOf<float> mCarry;
+};
+
+#endif
@@ -0,0 +1,155 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SegmentedOverlapAddTest.cpp
+
+**********************************************************************/
+#include "SegmentedOverlapAdd.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace
+{
+constexpr size_t windowSize = 64;
+
+//! Convolution with a kernel of length M, in the time domain, standing in
+//! for the FFT filter of Equalization
+SegmentedOverlapAdd::WindowFilter
+Convolver(const std::vector<float>& kernel)
+{
+   return [kernel](float* window, float* scratch) {
+      std::copy(window, window + windowSize, scratch);
+      for (size_t n = 0; n < windowSize; ++n)
+      {
+         float sum = 0;
+         for (size_t k = 0; k < kernel.size() && k <= n; ++k)
+            sum += kernel[k] * scratch[n - k];
+         window[n] = sum;
+      }
+   };
+}
+
+//! The serial overlap-add that Equalization did before, one window after
+//! another, with the output of a stream of len + M - 1 samples
+std::vector<float> SinglePass(
+   const SegmentedOverlapAdd::WindowFilter& filter, size_t M,
+   const std::vector<float>& input)
+{
+   const auto L = windowSize - (M - 1);
+   std::vector<float> window1(windowSize), window2(windowSize), scratch(windowSize);
+   auto thisWindow = window1.data(), lastWindow = window2.data();
+   std::vector<float> result(input.size());
+   size_t wcopy = 0;
+   for (size_t i = 0; i < input.size(); i += L)
+   {
+      wcopy = std::min(L, input.size() - i);
+      std::copy(input.begin() + i, input.begin() + i + wcopy, thisWindow);
+      std::fill(thisWindow + wcopy, thisWindow + windowSize, 0.0f);
+      filter(thisWindow, scratch.data());
+      for (size_t j = 0; j < M - 1 && j < wcopy; ++j)
+         result[i + j] = thisWindow[j] + lastWindow[L + j];
+      for (size_t j = M - 1; j < wcopy; ++j)
+         result[i + j] = thisWindow[j];
+      std::swap(thisWindow, lastWindow);
+   }
+   // The tail, which may still overlap the window before the last
+   for (size_t j = 0; j < M - 1; ++j)
+      result.push_back(
+         wcopy + j < M - 1 ? lastWindow[wcopy + j] + thisWindow[L + wcopy + j] :
+                             lastWindow[wcopy + j]);
+   return result;
+}
+
+std::vector<float> Segmented(
+   SegmentedOverlapAdd& overlapAdd, const std::vector<float>& input)
+{
+   std::vector<float> result;
+   for (size_t pos = 0; pos < input.size();)
+   {
+      const auto len = std::min(overlapAdd.BlockLen(), input.size() - pos);
+      std::copy(
+         input.begin() + pos, input.begin() + pos + len, overlapAdd.Buffer());
+      const auto output = overlapAdd.FilterBlock(len);
+      result.insert(result.end(), output, output + len);
+      pos += len;
+   }
+   const auto tail = overlapAdd.Finish();
+   result.insert(result.end(), tail, tail + overlapAdd.TailLen());
+   return result;
+}
+
+std::vector<float> Random(size_t len, std::mt19937& engine)
+{
+   std::uniform_real_distribution<float> distribution { -1.f, 1.f };
+   std::vector<float> result(len);
+   std::generate(
+      result.begin(), result.end(), [&] { return distribution(engine); });
+   return result;
+}
+} // namespace
+
+TEST_CASE("Segmented overlap-add equals the single pass")
+{
+   std::mt19937 engine { 3 };
+   for (const size_t M : { 1, 2, 9, 31 })
+   {
+      const auto filter = Convolver(Random(M, engine));
+      const auto L = windowSize - (M - 1);
+      for (const size_t segmentWindows : { 1, 2, 3 })
+         for (const size_t nSegments : { 1, 2, 5 })
+         {
+            const auto blockLen = segmentWindows * nSegments * L;
+            // Streams of one or more blocks, ending in whole or short
+            // windows, in whole or short segments, and shorter than M
+            for (const size_t len :
+                 { size_t(1), M / 2 + 1, L, L + 1, segmentWindows * L - 1,
+                   blockLen, blockLen + 1, 3 * blockLen - L / 2,
+                   4 * blockLen + 7 })
+            {
+               const auto input = Random(len, engine);
+               SegmentedOverlapAdd overlapAdd {
+                  windowSize, M, filter, segmentWindows, nSegments
+               };
+               REQUIRE(overlapAdd.BlockLen() == blockLen);
+               REQUIRE(
+                  Segmented(overlapAdd, input) ==
+                  SinglePass(filter, M, input));
+            }
+         }
+   }
+}
+
+TEST_CASE("Segmented overlap-add carries tails across segments and blocks")
+{
+   // Impulses at the ends of segments, whose responses belong mostly to the
+   // next segment, or the next block
+   constexpr size_t M = 31, segmentWindows = 2, nSegments = 3;
+   constexpr auto L = windowSize - (M - 1);
+   constexpr auto segmentLen = segmentWindows * L;
+   std::vector<float> kernel(M);
+   for (size_t k = 0; k < M; ++k)
+      kernel[k] = 1.0f / (k + 1);
+   const auto filter = Convolver(kernel);
+   SegmentedOverlapAdd overlapAdd {
+      windowSize, M, filter, segmentWindows, nSegments
+   };
+
+   std::vector<float> input(3 * overlapAdd.BlockLen());
+   for (size_t end = segmentLen; end <= input.size(); end += segmentLen)
+      input[end - 1] = 1;
+   const auto output = Segmented(overlapAdd, input);
+   REQUIRE(output == SinglePass(filter, M, input));
+
+   // Each impulse response is whole, wherever it is cut
+   REQUIRE(output.size() == input.size() + M - 1);
+   for (size_t end = segmentLen; end <= input.size(); end += segmentLen)
+      for (size_t k = 0; k < M; ++k)
+         REQUIRE(output[end - 1 + k] == kernel[k]);
+}
@@ -0,0 +1,107 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file MemoryMappedFile.cpp
+
+**********************************************************************/
+#include "MemoryMappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <limits>
+
+#ifdef _WIN32
+
+MemoryMappedFile::MemoryMappedFile(const FilePath &path)
+{
+   const auto file = CreateFileW(path.wc_str(), GENERIC_READ, FILE_SHARE_READ,
+      nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+   if (file == INVALID_HANDLE_VALUE)
+      return;
+   mFile = file;
+
+   LARGE_INTEGER size;
+   if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0 ||
+       static_cast<unsigned long long>(size.QuadPart) >
+          std::numeric_limits<size_t>::max()) {
+      Close();
+      return;
+   }
+
+   mMapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+   if (!mMapping) {
+      Close();
+      return;
+   }
+
+   mData = static_cast<const unsigned char *>(
+      MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+   if (!mData) {
+      Close();
+      return;
+   }
+   mSize = static_cast<size_t>(size.QuadPart);
+}
+
+void MemoryMappedFile::Close()
+{
+   if (mData)
+      UnmapViewOfFile(mData);
+   if (mMapping)
+      CloseHandle(mMapping);
+   if (mFile)
+      CloseHandle(mFile);
+   mData = nullptr;
+   mSize = 0;
+   mMapping = mFile = nullptr;
+}
+
+#else
+
+MemoryMappedFile::MemoryMappedFile(const FilePath &path)
+{
+   const auto fd = open(path.fn_str(), O_RDONLY);
+   if (fd < 0)
+      return;
+
+   struct stat st;
+   if (fstat(fd, &st) == 0 && st.st_size > 0 &&
+       static_cast<unsigned long long>(st.st_size) <=
+          std::numeric_limits<size_t>::max()) {
+      const auto size = static_cast<size_t>(st.st_size);
+      // The mapping stays valid after the descriptor is closed
+      const auto data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED) {
+#ifdef POSIX_MADV_SEQUENTIAL
+         posix_madvise(data, size, POSIX_MADV_SEQUENTIAL);
+#endif
+         mData = static_cast<const unsigned char *>(data);
+         mSize = size;
+      }
+   }
+   close(fd);
+}
+
+void MemoryMappedFile::Close()
+{
+   if (mData)
+      munmap(const_cast<unsigned char *>(mData), mSize);
+   mData = nullptr;
+   mSize = 0;
+}
+
+#endif
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+   Close();
+}
@@ -0,0 +1,50 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file MemoryMappedFile.h
+  @brief Read-only view of a whole file through the virtual memory system
+
+**********************************************************************/
+#ifndef __AUDACITY_MEMORY_MAPPED_FILE__
+#define __AUDACITY_MEMORY_MAPPED_FILE__
+
+#include "Identifier.h"
+
+#include <cstddef>
+
+//! Maps the contents of an existing file into the address space, read-only
+/*!
+ Mapping can fail for reasons that do not mean the file is unreadable (a file
+ too large for a 32 bit address space, a file system that does not support it),
+ so callers should check `IsOpen()` and fall back to ordinary reads.
+ */
+class FILES_API MemoryMappedFile final
+{
+public:
+   explicit MemoryMappedFile(const FilePath &path);
+   ~MemoryMappedFile();
+
+   MemoryMappedFile(const MemoryMappedFile&) = delete;
+   MemoryMappedFile &operator=(const MemoryMappedFile&) = delete;
+
+   bool IsOpen() const { return mData != nullptr; }
+
+   //! Null if not open
+   const unsigned char *Data() const { return mData; }
+   //! Zero if not open
+   size_t Size() const { return mSize; }
+
+private:
+   void Close();
+
+   const unsigned char *mData{};
+   size_t mSize{};
+#ifdef _WIN32
+   void *mFile{};
+   void *mMapping{};
+#endif
+};
+
+#endif
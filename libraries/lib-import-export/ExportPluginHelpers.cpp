@@ -15,12 +15,13 @@
 #include "Mix.h"
 #include "WaveTrack.h"
 #include "MixAndRender.h"
+#include "PipelinedMixer.h"
 #include "ExportUtils.h"
 #include "ExportPlugin.h"
 #include "StretchingSequence.h"
 
 //Create a mixer by computing the time warp factor
-std::unique_ptr<Mixer> ExportPluginHelpers::CreateMixer(const TrackList &tracks,
+std::unique_ptr<PipelinedMixer> ExportPluginHelpers::CreateMixer(const TrackList &tracks,
          bool selectionOnly,
          double startTime, double stopTime,
          unsigned numOutChannels, size_t outBufferSize, bool outInterleaved,
@@ -34,19 +35,19 @@ std::unique_ptr<Mixer> ExportPluginHelpers::CreateMixer(const TrackList &tracks,
          StretchingSequence::Create(*pTrack, pTrack->GetClipInterfaces()),
          GetEffectStages(*pTrack));
    // MB: the stop time should not be warped, this was a bug.
-   return std::make_unique<Mixer>(move(inputs),
+   return std::make_unique<PipelinedMixer>(std::make_unique<Mixer>(move(inputs),
                   // Throw, to stop exporting, if read fails:
                   true,
                   Mixer::WarpOptions{ tracks.GetOwner() },
                   startTime, stopTime,
                   numOutChannels, outBufferSize, outInterleaved,
                   outRate, outFormat,
-                  true, mixerSpec);
+                  true, mixerSpec));
 }
 
 namespace
 {
-   double EvalExportProgress(Mixer &mixer, double t0, double t1)
+   double EvalExportProgress(const PipelinedMixer &mixer, double t0, double t1)
    {
       const auto duration = t1 - t0;
       if(duration > 0)
@@ -55,7 +56,7 @@ namespace
    }
 }
 
-ExportResult ExportPluginHelpers::UpdateProgress(ExportProcessorDelegate& delegate, Mixer &mixer, double t0, double t1)
+ExportResult ExportPluginHelpers::UpdateProgress(ExportProcessorDelegate& delegate, const PipelinedMixer &mixer, double t0, double t1)
 {
    delegate.OnProgress(EvalExportProgress(mixer, t0, t1));
    if(delegate.IsStopped())
@@ -20,7 +20,7 @@
 
 class TrackList;
 class WaveTrack;
-class Mixer;
+class PipelinedMixer;
 
 namespace MixerOptions
 {
@@ -32,7 +32,8 @@ class IMPORT_EXPORT_API ExportPluginHelpers final
 {
 public:
 
-   static std::unique_ptr<Mixer> CreateMixer(const TrackList &tracks,
+   //! The mixer runs on a thread of its own, overlapping with encoding
+   static std::unique_ptr<PipelinedMixer> CreateMixer(const TrackList &tracks,
          bool selectionOnly,
          double startTime, double stopTime,
          unsigned numOutChannels, size_t outBufferSize, bool outInterleaved,
@@ -41,7 +42,7 @@ public:
 
    ///\brief Sends progress update to delegate and retrieves state update from it.
    ///Typically used inside each export iteration.
-   static ExportResult UpdateProgress(ExportProcessorDelegate& delegate, Mixer& mixer, double t0, double t1);
+   static ExportResult UpdateProgress(ExportProcessorDelegate& delegate, const PipelinedMixer& mixer, double t0, double t1);
 
    template<typename T>
    static T GetParameterValue(const ExportProcessor::Parameters& parameters, int id, T defaultValue = T())
@@ -482,34 +482,12 @@ std::unique_ptr<ExtImportItem> Importer::CreateDefaultImportItem()
    return new_item;
 }
 
-// returns number of tracks imported
-bool Importer::Import(
-   AudacityProject& project, const FilePath& fName,
-   ImportProgressListener* importProgressListener,
-   WaveTrackFactory* trackFactory, TrackHolders& tracks, Tags* tags,
-   std::optional<LibFileFormats::AcidizerTags>& outAcidTags,
-   TranslatableString& errorMessage)
+ImportPluginList Importer::GetPluginsToTry(const FilePath &fName)
 {
-   AudacityProject *pProj = &project;
-   auto cleanup = valueRestorer( pProj->mbBusyImporting, true );
-
    const FileExtension extension{ fName.AfterLast(wxT('.')) };
 
-   // Bug #2647: Peter has a Word 2000 .doc file that is recognized and imported by FFmpeg.
-   if (wxFileName(fName).GetExt() == wxT("doc")) {
-      errorMessage =
-         XO("\"%s\" \nis a not an audio file. \nAudacity cannot open this type of file.")
-         .Format( fName );
-      return false;
-   }
-
-   using ImportPluginPtrs = std::vector< ImportPlugin* >;
-
    // This list is used to call plugins in correct order
-   ImportPluginPtrs importPlugins;
-
-   // This list is used to remember plugins that should have been compatible with the file.
-   ImportPluginPtrs compatiblePlugins;
+   ImportPluginList importPlugins;
 
    // Not implemented (yet?)
    wxString mime_type = wxT("*");
@@ -622,6 +600,62 @@ bool Importer::Import(
       }
    }
 
+
+   return importPlugins;
+}
+
+std::unique_ptr<ImportFileHandle> Importer::Open(
+   AudacityProject& project, const FilePath& fName,
+   ImportProgressListener& importProgressListener)
+{
+   // Leave unusual files to Import, which explains the failures
+   if (wxFileName(fName).GetExt() == wxT("doc"))
+      return nullptr;
+
+   for (const auto plugin : GetPluginsToTry(fName))
+   {
+      wxLogMessage(wxT("Opening with %s"),plugin->GetPluginStringID());
+      auto inFile = plugin->Open(fName, &project);
+      if ( (inFile != NULL) && (inFile->GetStreamCount() > 0) )
+      {
+         wxLogMessage(wxT("Open(%s) succeeded"), fName);
+         if (!importProgressListener.OnImportFileOpened(*inFile))
+            return nullptr;
+         return inFile;
+      }
+   }
+   return nullptr;
+}
+
+// returns number of tracks imported
+bool Importer::Import(
+   AudacityProject& project, const FilePath& fName,
+   ImportProgressListener* importProgressListener,
+   WaveTrackFactory* trackFactory, TrackHolders& tracks, Tags* tags,
+   std::optional<LibFileFormats::AcidizerTags>& outAcidTags,
+   TranslatableString& errorMessage)
+{
+   AudacityProject *pProj = &project;
+   auto cleanup = valueRestorer( pProj->mbBusyImporting, true );
+
+   const FileExtension extension{ fName.AfterLast(wxT('.')) };
+
+   // Bug #2647: Peter has a Word 2000 .doc file that is recognized and imported by FFmpeg.
+   if (wxFileName(fName).GetExt() == wxT("doc")) {
+      errorMessage =
+         XO("\"%s\" \nis a not an audio file. \nAudacity cannot open this type of file.")
+         .Format( fName );
+      return false;
+   }
+
+   using ImportPluginPtrs = std::vector< ImportPlugin* >;
+
+   // This list is used to remember plugins that should have been compatible with the file.
+   ImportPluginPtrs compatiblePlugins;
+
+   // Plugins to try, in the correct order
+   const auto importPlugins = GetPluginsToTry(fName);
+
    ImportProgressResultProxy importResultProxy(importProgressListener);
 
    // Try the import plugins, in the permuted sequences just determined
@@ -844,3 +878,4 @@ bool Importer::Import(
 }
 
 BoolSetting NewImportingSession{ L"/NewImportingSession", false };
+BoolSetting ConcurrentImport{ L"/Import/Concurrent", false };
@@ -26,6 +26,7 @@ class Tags;
 class WaveTrackFactory;
 class Track;
 class TrackList;
+class ImportFileHandle;
 class ImportPlugin;
 class ImportProgressListener;
 class UnusableImportPlugin;
@@ -182,7 +183,22 @@ public:
        std::optional<LibFileFormats::AcidizerTags>& outAcidTags,
        TranslatableString& errorMessage);
 
+   //! Probe the file with the plugins in the order that `Import` would try
+   //! them, stopping at the first that opens it; don't decode it yet
+   /*!
+    The listener's `OnImportFileOpened` is called, in this thread, with the
+    handle, which may then be imported in another thread.
+    @return null if no plugin could open the file, or the listener declined it;
+    `Import` may still succeed with a plugin that fails later in probing, and
+    explains failures
+    */
+   std::unique_ptr<ImportFileHandle> Open(
+      AudacityProject& project, const FilePath& fName,
+      ImportProgressListener& importProgressListener);
+
  private:
+   ImportPluginList GetPluginsToTry(const FilePath &fName);
+
     struct Traits : Registry::DefaultTraits
     {
        using LeafTypes = List<ImporterItem>;
@@ -204,4 +220,8 @@ public:
 
 extern IMPORT_EXPORT_API BoolSetting NewImportingSession;
 
+//! Whether several files imported together may be decoded concurrently, by
+//! the importers that support it
+extern IMPORT_EXPORT_API BoolSetting ConcurrentImport;
+
 #endif
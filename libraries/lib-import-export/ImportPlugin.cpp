@@ -80,3 +80,8 @@ TranslatableString ImportFileHandle::GetErrorMessage() const
 {
    return {};
 }
+
+bool ImportFileHandle::SupportsConcurrentImport() const
+{
+   return false;
+}
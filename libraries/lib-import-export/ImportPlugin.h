@@ -49,6 +49,7 @@ but little else.
 #include "Identifier.h"
 #include "Internat.h"
 #include "wxArrayStringEx.h"
+#include <atomic>
 #include <memory>
 #include <optional>
 
@@ -153,13 +154,23 @@ public:
    virtual void Cancel() = 0;
 
    virtual void Stop() = 0;
+
+   //! Whether Import() may run in a worker thread, while other files are
+   //! imported in others
+   /*!
+    Such an Import() must not show dialogs or read preferences; it may read
+    them when the file is opened.  By default false; override only for
+    importers audited for this.
+    */
+   virtual bool SupportsConcurrentImport() const;
 };
 
 class IMPORT_EXPORT_API ImportFileHandleEx : public ImportFileHandle
 {
    FilePath mFilename;
-   bool mCancelled{false};
-   bool mStopped{false};
+   // Cancel() and Stop() may be called from another thread than Import()
+   std::atomic<bool> mCancelled{false};
+   std::atomic<bool> mStopped{false};
 public:
    ImportFileHandleEx(const FilePath& filename);
 
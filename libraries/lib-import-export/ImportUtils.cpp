@@ -16,10 +16,18 @@
 #include "QualitySettings.h"
 #include "BasicUI.h"
 
+#include <mutex>
+#include <wx/thread.h>
+
 sampleFormat ImportUtils::ChooseFormat(sampleFormat effectiveFormat)
 {
-   // Consult user preference
-   auto defaultFormat = QualitySettings::SampleFormatChoice();
+   // Consult user preference; files may be decoded in several threads at
+   // once, which must not read the configuration concurrently
+   static std::mutex preferenceMutex;
+   auto defaultFormat = [&]{
+      std::lock_guard<std::mutex> lock{ preferenceMutex };
+      return QualitySettings::SampleFormatChoice();
+   }();
 
    // Don't choose format narrower than effective or default
    auto format = std::max(effectiveFormat, defaultFormat);
@@ -42,6 +50,11 @@ ImportUtils::NewWaveTrack(WaveTrackFactory &trackFactory,
 
 void ImportUtils::ShowMessageBox(const TranslatableString &message, const TranslatableString& caption)
 {
+   // Files may be decoded in worker threads; show the message later then
+   if (!wxIsMainThread()) {
+      BasicUI::CallAfter([=]{ ShowMessageBox(message, caption); });
+      return;
+   }
    BasicUI::ShowMessageBox(message,
                            BasicUI::MessageBoxOptions().Caption(caption));
 }
@@ -0,0 +1,394 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file MappedPCM.cpp
+
+**********************************************************************/
+#include "MappedPCM.h"
+
+#include <sndfile.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || (defined(_M_AMD64) || defined(_M_X64))
+#include <emmintrin.h>
+#define MAPPED_PCM_SSE2
+#endif
+
+namespace MappedPCM {
+
+size_t Region::BytesPerSample() const
+{
+   switch (encoding) {
+   case Encoding::Int16:
+      return 2;
+   case Encoding::Int24:
+      return 3;
+   default:
+      return 4;
+   }
+}
+
+namespace {
+
+bool HostIsLittleEndian()
+{
+   const uint16_t one = 1;
+   return *reinterpret_cast<const unsigned char*>(&one) == 1;
+}
+
+bool HasId(const unsigned char *p, const char *id)
+{
+   return memcmp(p, id, 4) == 0;
+}
+
+uint32_t LE32(const unsigned char *p)
+{
+   return uint32_t(p[0]) | uint32_t(p[1]) << 8 |
+      uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+}
+
+uint64_t LE64(const unsigned char *p)
+{
+   return uint64_t(LE32(p)) | uint64_t(LE32(p + 4)) << 32;
+}
+
+uint32_t BE32(const unsigned char *p)
+{
+   return uint32_t(p[3]) | uint32_t(p[2]) << 8 |
+      uint32_t(p[1]) << 16 | uint32_t(p[0]) << 24;
+}
+
+std::optional<Region> MakeRegion(const unsigned char *file, size_t size,
+   uint64_t offset, uint64_t dataSize,
+   unsigned channels, size_t frames, Encoding encoding, bool bigEndian)
+{
+   if (offset > size)
+      return {};
+   Region region{ file + offset, frames, channels, encoding, bigEndian };
+   const auto available = std::min<uint64_t>(dataSize, size - offset);
+   // Never trust a frame count that would read past the mapping
+   if (channels == 0 ||
+       frames > available / region.BytesPerFrame())
+      return {};
+   return region;
+}
+
+std::optional<Region> FindWaveData(const unsigned char *file, size_t size,
+   unsigned channels, size_t frames, Encoding encoding)
+{
+   // RIFX (big-endian RIFF) is rare enough to leave to libsndfile
+   const bool rf64 = HasId(file, "RF64");
+   if (!(rf64 || HasId(file, "RIFF")) || !HasId(file + 8, "WAVE"))
+      return {};
+
+   uint64_t ds64DataSize = 0;
+   for (size_t pos = 12; pos + 8 <= size;) {
+      const auto body = pos + 8;
+      const uint64_t chunkSize = LE32(file + pos + 4);
+      if (HasId(file + pos, "ds64") && body + 16 <= size)
+         ds64DataSize = LE64(file + body + 8);
+      else if (HasId(file + pos, "data")) {
+         const auto dataSize = (rf64 && chunkSize == 0xFFFFFFFF)
+            ? ds64DataSize : chunkSize;
+         return MakeRegion(file, size, body, dataSize,
+            channels, frames, encoding, false);
+      }
+      if (chunkSize > size - body)
+         break;
+      // Chunks are padded to even length
+      pos = body + chunkSize + (chunkSize & 1);
+   }
+   return {};
+}
+
+std::optional<Region> FindAiffData(const unsigned char *file, size_t size,
+   unsigned channels, size_t frames, Encoding encoding)
+{
+   const bool aifc = HasId(file + 8, "AIFC");
+   if (!HasId(file, "FORM") || !(aifc || HasId(file + 8, "AIFF")))
+      return {};
+
+   // Plain AIFF is always big-endian; AIFC names its encoding
+   bool bigEndian = true;
+   bool sawCommon = !aifc;
+   for (size_t pos = 12; pos + 8 <= size;) {
+      const auto body = pos + 8;
+      const uint64_t chunkSize = BE32(file + pos + 4);
+      if (aifc && HasId(file + pos, "COMM")) {
+         // channels (2), frames (4), bits (2), 80 bit rate (10), compression
+         if (chunkSize < 22 || body + 22 > size)
+            return {};
+         const auto compression = file + body + 18;
+         if (HasId(compression, "sowt"))
+            bigEndian = false;
+         else if (!(HasId(compression, "NONE") || HasId(compression, "twos") ||
+            HasId(compression, "fl32") || HasId(compression, "FL32")))
+            return {};
+         sawCommon = true;
+      }
+      else if (HasId(file + pos, "SSND")) {
+         if (!sawCommon || chunkSize < 8 || body + 8 > size)
+            return {};
+         const uint64_t offset = BE32(file + body);
+         if (offset > chunkSize - 8)
+            return {};
+         return MakeRegion(file, size, body + 8 + offset,
+            chunkSize - 8 - offset, channels, frames, encoding, bigEndian);
+      }
+      if (chunkSize > size - body)
+         break;
+      pos = body + chunkSize + (chunkSize & 1);
+   }
+   return {};
+}
+
+// Scalar readers, correct on hosts of either byte order
+
+template<bool bigEndian> int16_t ReadInt16(const unsigned char *p)
+{
+   return bigEndian
+      ? int16_t(uint16_t(p[0]) << 8 | p[1])
+      : int16_t(uint16_t(p[1]) << 8 | p[0]);
+}
+
+template<Encoding encoding, bool bigEndian>
+float ReadFloat(const unsigned char *p)
+{
+   // Scale factors are those of libsndfile, so that results are identical
+   if constexpr (encoding == Encoding::Int16)
+      return ReadInt16<bigEndian>(p) * (1.0f / 0x8000);
+   else if constexpr (encoding == Encoding::Int24) {
+      // Put the 24 bits at the top of a 32 bit word, as libsndfile does
+      const auto bits = bigEndian
+         ? uint32_t(p[0]) << 24 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 8
+         : uint32_t(p[2]) << 24 | uint32_t(p[1]) << 16 | uint32_t(p[0]) << 8;
+      return float(int32_t(bits)) * (1.0f / 0x80000000);
+   }
+   else {
+      const auto bits = bigEndian ? BE32(p) : LE32(p);
+      if constexpr (encoding == Encoding::Int32)
+         return float(int32_t(bits)) * (1.0f / 0x80000000);
+      else {
+         float result;
+         memcpy(&result, &bits, sizeof(result));
+         return result;
+      }
+   }
+}
+
+template<Encoding encoding, bool bigEndian>
+void GatherFloats(const unsigned char *src, size_t stride, size_t len,
+   float *dst)
+{
+   for (size_t ii = 0; ii < len; ++ii, src += stride)
+      dst[ii] = ReadFloat<encoding, bigEndian>(src);
+}
+
+template<bool bigEndian>
+void GatherShorts(const unsigned char *src, size_t stride, size_t len,
+   int16_t *dst)
+{
+   for (size_t ii = 0; ii < len; ++ii, src += stride)
+      dst[ii] = ReadInt16<bigEndian>(src);
+}
+
+#ifdef MAPPED_PCM_SSE2
+// Vectorized kernels for the most common layouts, which are little-endian
+// like the host.  Each returns how many frames it handled; the scalar loops
+// finish the remainder.
+
+// Sign-extended 32 bit lanes from the even (left) or odd (right) 16 bit lanes
+inline __m128i Even16(__m128i v)
+{
+   return _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+}
+
+inline __m128i Odd16(__m128i v)
+{
+   return _mm_srai_epi32(v, 16);
+}
+
+size_t StereoShorts(const unsigned char *src, unsigned channel, size_t len,
+   int16_t *dst)
+{
+   const auto select = channel == 0 ? Even16 : Odd16;
+   size_t ii = 0;
+   for (; ii + 8 <= len; ii += 8, src += 32) {
+      const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+      const auto b =
+         _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + ii),
+         _mm_packs_epi32(select(a), select(b)));
+   }
+   return ii;
+}
+
+size_t StereoShortsToFloats(const unsigned char *src, unsigned channel,
+   size_t len, float *dst)
+{
+   const auto select = channel == 0 ? Even16 : Odd16;
+   const auto scale = _mm_set1_ps(1.0f / 0x8000);
+   size_t ii = 0;
+   for (; ii + 4 <= len; ii += 4, src += 16) {
+      const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+      _mm_storeu_ps(dst + ii, _mm_mul_ps(_mm_cvtepi32_ps(select(v)), scale));
+   }
+   return ii;
+}
+
+size_t MonoShortsToFloats(const unsigned char *src, size_t len, float *dst)
+{
+   const auto scale = _mm_set1_ps(1.0f / 0x8000);
+   size_t ii = 0;
+   for (; ii + 8 <= len; ii += 8, src += 16) {
+      const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+      const auto lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+      const auto hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+      _mm_storeu_ps(dst + ii, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+      _mm_storeu_ps(dst + ii + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+   }
+   return ii;
+}
+
+size_t StereoFloats(const unsigned char *src, unsigned channel, size_t len,
+   float *dst)
+{
+   const auto in = reinterpret_cast<const float*>(src);
+   size_t ii = 0;
+   if (channel == 0)
+      for (; ii + 4 <= len; ii += 4) {
+         const auto a = _mm_loadu_ps(in + 2 * ii);
+         const auto b = _mm_loadu_ps(in + 2 * ii + 4);
+         _mm_storeu_ps(dst + ii, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+      }
+   else
+      for (; ii + 4 <= len; ii += 4) {
+         const auto a = _mm_loadu_ps(in + 2 * ii);
+         const auto b = _mm_loadu_ps(in + 2 * ii + 4);
+         _mm_storeu_ps(dst + ii, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+      }
+   return ii;
+}
+#endif
+
+template<bool bigEndian>
+void DeinterleaveFloats(const Region &region, const unsigned char *src,
+   size_t len, float *dst)
+{
+   const auto stride = region.BytesPerFrame();
+   switch (region.encoding) {
+   case Encoding::Int16:
+      GatherFloats<Encoding::Int16, bigEndian>(src, stride, len, dst);
+      break;
+   case Encoding::Int24:
+      GatherFloats<Encoding::Int24, bigEndian>(src, stride, len, dst);
+      break;
+   case Encoding::Int32:
+      GatherFloats<Encoding::Int32, bigEndian>(src, stride, len, dst);
+      break;
+   case Encoding::Float32:
+      GatherFloats<Encoding::Float32, bigEndian>(src, stride, len, dst);
+      break;
+   }
+}
+
+}
+
+std::optional<Region> FindSoundData(const unsigned char *file, size_t size,
+   int sfFormat, unsigned channels, size_t frames)
+{
+   if (!file || size < 12)
+      return {};
+
+   Encoding encoding;
+   switch (sfFormat & SF_FORMAT_SUBMASK) {
+   case SF_FORMAT_PCM_16:
+      encoding = Encoding::Int16;
+      break;
+   case SF_FORMAT_PCM_24:
+      encoding = Encoding::Int24;
+      break;
+   case SF_FORMAT_PCM_32:
+      encoding = Encoding::Int32;
+      break;
+   case SF_FORMAT_FLOAT:
+      encoding = Encoding::Float32;
+      break;
+   default:
+      return {};
+   }
+
+   switch (sfFormat & SF_FORMAT_TYPEMASK) {
+   case SF_FORMAT_WAV:
+   case SF_FORMAT_WAVEX:
+   case SF_FORMAT_RF64:
+      return FindWaveData(file, size, channels, frames, encoding);
+   case SF_FORMAT_AIFF:
+      return FindAiffData(file, size, channels, frames, encoding);
+   default:
+      return {};
+   }
+}
+
+void Deinterleave(const Region &region, unsigned channel,
+   size_t start, size_t len, samplePtr dst, sampleFormat dstFormat)
+{
+   const auto stride = region.BytesPerFrame();
+   // The vector kernels take whole frames; the scalar loops take the channel
+   const auto frames = region.data + start * stride;
+   const auto src = frames + channel * region.BytesPerSample();
+
+   if (dstFormat == int16Sample) {
+      assert(region.encoding == Encoding::Int16);
+      auto out = reinterpret_cast<int16_t*>(dst);
+      if (region.bigEndian)
+         GatherShorts<true>(src, stride, len, out);
+      else {
+         size_t done = 0;
+#ifdef MAPPED_PCM_SSE2
+         if (region.channels == 2)
+            done = StereoShorts(frames, channel, len, out);
+#endif
+         if (region.channels == 1 && HostIsLittleEndian()) {
+            memcpy(out, src, len * sizeof(int16_t));
+            done = len;
+         }
+         GatherShorts<false>(src + done * stride, stride, len - done,
+            out + done);
+      }
+      return;
+   }
+
+   assert(dstFormat == floatSample);
+   auto out = reinterpret_cast<float*>(dst);
+   if (region.bigEndian) {
+      DeinterleaveFloats<true>(region, src, len, out);
+      return;
+   }
+   size_t done = 0;
+#ifdef MAPPED_PCM_SSE2
+   if (region.encoding == Encoding::Int16) {
+      if (region.channels == 2)
+         done = StereoShortsToFloats(frames, channel, len, out);
+      else if (region.channels == 1)
+         done = MonoShortsToFloats(src, len, out);
+   }
+   else if (region.encoding == Encoding::Float32 && region.channels == 2)
+      done = StereoFloats(frames, channel, len, out);
+#endif
+   if (region.encoding == Encoding::Float32 && region.channels == 1 &&
+       HostIsLittleEndian()) {
+      memcpy(out, src, len * sizeof(float));
+      done = len;
+   }
+   DeinterleaveFloats<false>(region, src + done * stride, len - done,
+      out + done);
+}
+
+}
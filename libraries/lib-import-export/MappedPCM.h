@@ -0,0 +1,61 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file MappedPCM.h
+  @brief Reading uncompressed sound data directly from a memory-mapped file
+
+**********************************************************************/
+#ifndef __AUDACITY_MAPPED_PCM__
+#define __AUDACITY_MAPPED_PCM__
+
+#include "SampleFormat.h"
+
+#include <cstddef>
+#include <optional>
+
+namespace MappedPCM {
+
+enum class Encoding { Int16, Int24, Int32, Float32 };
+
+//! Interleaved frames of sound data found in the image of a file
+struct Region
+{
+   const unsigned char *data;
+   size_t frames;
+   unsigned channels;
+   Encoding encoding;
+   bool bigEndian;
+
+   size_t BytesPerSample() const;
+   size_t BytesPerFrame() const { return channels * BytesPerSample(); }
+};
+
+//! Locate the sound data in the image of a WAV, RF64 or AIFF file
+/*!
+ @param file the whole file, for instance from a `MemoryMappedFile`
+ @param sfFormat the `SF_INFO::format` libsndfile reported for the file
+ @param frames the `SF_INFO::frames` libsndfile reported for the file
+ @return nullopt for containers or encodings not handled here, or if the
+ chunk structure does not agree with what libsndfile reported; then the file
+ should be read through libsndfile
+ */
+IMPORT_EXPORT_API std::optional<Region> FindSoundData(
+   const unsigned char *file, size_t size,
+   int sfFormat, unsigned channels, size_t frames);
+
+//! Copy samples of one channel out of the region into contiguous storage
+/*!
+ Conversion to `floatSample` scales exactly as libsndfile's `sf_readf_float`
+ does; `int16Sample` may be requested only for `Encoding::Int16`.
+
+ @param start first frame to copy
+ @pre `start + len <= region.frames`
+ */
+IMPORT_EXPORT_API void Deinterleave(const Region &region, unsigned channel,
+   size_t start, size_t len, samplePtr dst, sampleFormat dstFormat);
+
+}
+
+#endif
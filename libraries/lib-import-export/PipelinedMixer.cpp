@@ -0,0 +1,138 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file PipelinedMixer.cpp
+
+**********************************************************************/
+#include "PipelinedMixer.h"
+#include "Mix.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+PipelinedMixer::PipelinedMixer(std::unique_ptr<Mixer> mixer, size_t depth)
+   : mMixer{ move(mixer) }
+   , mBytesPerFrame{ SAMPLE_SIZE(mMixer->Format()) *
+      (mMixer->Interleaved() ? mMixer->NumChannels() : 1) }
+   , mSlots(std::max<size_t>(depth, 2))
+   , mCurrentTime{ mMixer->MixGetCurrentTime() }
+{
+   const auto interleaved = mMixer->Interleaved();
+   const auto nBuffers = interleaved ? 1 : mMixer->NumChannels();
+   const auto bufferSize = mMixer->BufferSize() *
+      (interleaved ? mMixer->NumChannels() : 1);
+   for (auto &slot : mSlots)
+      for (size_t ii = 0; ii < nBuffers; ++ii)
+         slot.buffers.emplace_back(bufferSize, mMixer->Format());
+}
+
+PipelinedMixer::~PipelinedMixer()
+{
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mStopping = true;
+   }
+   mCondition.notify_all();
+   if (mThread.joinable())
+      mThread.join();
+}
+
+size_t PipelinedMixer::BufferSize() const
+{
+   return mMixer->BufferSize();
+}
+
+void PipelinedMixer::Produce()
+{
+   try {
+      while (true) {
+         size_t index;
+         {
+            std::unique_lock<std::mutex> lock{ mMutex };
+            mCondition.wait(lock, [this]{
+               return mStopping || mFilled < mSlots.size(); });
+            if (mStopping)
+               return;
+            index = mWriteIndex;
+         }
+
+         // The consumer does not touch this slot until it is counted as filled
+         auto &slot = mSlots[index];
+         slot.samples = mMixer->Process();
+         slot.time = mMixer->MixGetCurrentTime();
+         const auto bytes = slot.samples * mBytesPerFrame;
+         if (mMixer->Interleaved())
+            memcpy(slot.buffers[0].ptr(), mMixer->GetBuffer(), bytes);
+         else
+            for (size_t ii = 0; ii < slot.buffers.size(); ++ii)
+               memcpy(slot.buffers[ii].ptr(), mMixer->GetBuffer(ii), bytes);
+
+         {
+            std::lock_guard<std::mutex> lock{ mMutex };
+            if (slot.samples == 0) {
+               mFinished = true;
+               mEndTime = slot.time;
+            }
+            else {
+               mWriteIndex = (mWriteIndex + 1) % mSlots.size();
+               ++mFilled;
+            }
+         }
+         mCondition.notify_all();
+         if (slot.samples == 0)
+            return;
+      }
+   }
+   catch (...) {
+      {
+         std::lock_guard<std::mutex> lock{ mMutex };
+         mException = std::current_exception();
+         mFinished = true;
+      }
+      mCondition.notify_all();
+   }
+}
+
+size_t PipelinedMixer::Process()
+{
+   if (!mThread.joinable())
+      mThread = std::thread{ [this]{ Produce(); } };
+
+   std::unique_lock<std::mutex> lock{ mMutex };
+   if (mReading) {
+      // Release the slot returned by the previous call
+      mReading = false;
+      mReadIndex = (mReadIndex + 1) % mSlots.size();
+      --mFilled;
+      mCondition.notify_all();
+   }
+   mCondition.wait(lock, [this]{ return mFilled > 0 || mFinished; });
+   if (mFilled == 0) {
+      if (mException)
+         std::rethrow_exception(std::exchange(mException, nullptr));
+      mCurrentTime = mEndTime;
+      return 0;
+   }
+   mReading = true;
+   const auto &slot = mSlots[mReadIndex];
+   mCurrentTime = slot.time;
+   return slot.samples;
+}
+
+constSamplePtr PipelinedMixer::GetBuffer()
+{
+   return mSlots[mReadIndex].buffers[0].ptr();
+}
+
+constSamplePtr PipelinedMixer::GetBuffer(int channel)
+{
+   return mSlots[mReadIndex].buffers[channel].ptr();
+}
+
+double PipelinedMixer::MixGetCurrentTime() const
+{
+   return mCurrentTime;
+}
@@ -0,0 +1,92 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file PipelinedMixer.h
+  @brief Mixes ahead on a separate thread, while the exporter encodes
+
+**********************************************************************/
+#pragma once
+
+#include "SampleFormat.h"
+
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Mixer;
+
+//! Wraps a Mixer so that mixing, resampling and dithering of the next buffers
+//! overlap with the encoding and writing of the current one
+/*!
+ Presents the part of the Mixer interface that exporters use.  The mixer runs
+ on a producer thread, started by the first call to Process(), which fills a
+ small ring of buffers; exceptions thrown by the mixer are rethrown by
+ Process().  Buffers returned by GetBuffer() remain valid until the next call
+ to Process().
+ */
+class IMPORT_EXPORT_API PipelinedMixer final
+{
+public:
+   //! Buffers in the ring: one being encoded, the others mixed ahead
+   static constexpr size_t DefaultDepth = 3;
+
+   /*!
+    @pre `mixer != nullptr`
+    @param depth at least 2
+    */
+   explicit PipelinedMixer(
+      std::unique_ptr<Mixer> mixer, size_t depth = DefaultDepth);
+   PipelinedMixer(const PipelinedMixer&) = delete;
+   PipelinedMixer &operator=(const PipelinedMixer&) = delete;
+   //! Stops the producer thread, discarding anything mixed ahead
+   ~PipelinedMixer();
+
+   size_t BufferSize() const;
+
+   //! Wait for the next buffer, releasing the previous one
+   /*!
+    @return number of output samples, or 0 when the mix is complete
+    */
+   size_t Process();
+
+   constSamplePtr GetBuffer();
+   constSamplePtr GetBuffer(int channel);
+
+   //! Time at the end of the buffer last returned by Process()
+   double MixGetCurrentTime() const;
+
+private:
+   struct Slot
+   {
+      std::vector<SampleBuffer> buffers;
+      size_t samples{};
+      double time{};
+   };
+
+   void Produce();
+
+   const std::unique_ptr<Mixer> mMixer;
+   const size_t mBytesPerFrame;
+   std::vector<Slot> mSlots;
+
+   std::mutex mMutex;
+   std::condition_variable mCondition;
+   //! Slots filled and not yet released by the consumer
+   size_t mFilled{ 0 };
+   size_t mReadIndex{ 0 };
+   size_t mWriteIndex{ 0 };
+   bool mReading{ false };
+   bool mFinished{ false };
+   bool mStopping{ false };
+   std::exception_ptr mException;
+   //! Mixer time when it had nothing more to mix
+   double mEndTime{};
+
+   double mCurrentTime;
+   std::thread mThread;
+};
@@ -0,0 +1,218 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  PipelinedMixerTests.cpp
+
+**********************************************************************/
+#include "PipelinedMixer.h"
+
+#include "Mix.h"
+#include "MockedPrefs.h"
+#include "WideSampleSequence.h"
+
+#include "sndfile.h"
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace
+{
+MockedPrefs prefs;
+
+constexpr auto twoPi = 6.283185307179586;
+
+//! A mono sine wave, long enough to keep the mixer busy
+class SineSequence final : public WideSampleSequence
+{
+public:
+   SineSequence(double rate, double duration)
+       : mRate { rate }
+       , mDuration { duration }
+   {
+   }
+
+   size_t NChannels() const override
+   {
+      return 1;
+   }
+
+   float GetChannelGain(int) const override
+   {
+      return 1.f;
+   }
+
+   bool DoGet(
+      size_t, size_t, const samplePtr buffers[], sampleFormat format,
+      sampleCount start, size_t len, bool, fillFormat, bool,
+      sampleCount*) const override
+   {
+      REQUIRE(format == floatSample);
+      const auto end = static_cast<long long>(mRate * mDuration);
+      const auto out = reinterpret_cast<float*>(buffers[0]);
+      for (size_t ii = 0; ii < len; ++ii)
+      {
+         const auto sample = start.as_long_long() + static_cast<long long>(ii);
+         out[ii] = sample < 0 || sample >= end ?
+                      0.f :
+                      0.5f * std::sin(twoPi * 440 * sample / mRate);
+      }
+      return true;
+   }
+
+   double GetStartTime() const override
+   {
+      return 0.;
+   }
+
+   double GetEndTime() const override
+   {
+      return mDuration;
+   }
+
+   double GetRate() const override
+   {
+      return mRate;
+   }
+
+   sampleFormat WidestEffectiveFormat() const override
+   {
+      return floatSample;
+   }
+
+   bool HasTrivialEnvelope() const override
+   {
+      return true;
+   }
+
+   void GetEnvelopeValues(double* buffer, size_t bufferLen, double, bool)
+      const override
+   {
+      std::fill(buffer, buffer + bufferLen, 1.0);
+   }
+
+   AudioGraph::ChannelType GetChannelType() const override
+   {
+      return AudioGraph::MonoChannel;
+   }
+
+private:
+   const double mRate;
+   const double mDuration;
+};
+
+constexpr auto channels = 2u;
+constexpr size_t bufferSize = 4096;
+
+//! Resampling from 44.1 to 48 kHz gives the mixer real work to do
+std::unique_ptr<Mixer> MakeMixer(double duration, bool interleaved)
+{
+   Mixer::Inputs inputs;
+   inputs.emplace_back(std::make_shared<SineSequence>(44100, duration));
+   return std::make_unique<Mixer>(
+      move(inputs), true, Mixer::WarpOptions { 1.0, 1.0 }, 0.0, duration,
+      channels, bufferSize, interleaved, 48000, floatSample);
+}
+
+//! Mixes everything into an interleaved vector, from a Mixer or a
+//! PipelinedMixer
+template<typename MixerType>
+std::vector<float> MixAll(MixerType& mixer, bool interleaved)
+{
+   std::vector<float> result;
+   while (const auto samples = mixer.Process())
+   {
+      const auto offset = result.size();
+      result.resize(offset + samples * channels);
+      for (size_t ii = 0; ii < samples; ++ii)
+         for (unsigned channel = 0; channel < channels; ++channel)
+            result[offset + ii * channels + channel] = interleaved ?
+               reinterpret_cast<const float*>(
+                  mixer.GetBuffer())[ii * channels + channel] :
+               reinterpret_cast<const float*>(mixer.GetBuffer(channel))[ii];
+   }
+   return result;
+}
+
+//! Mixes and encodes everything with libsndfile, as an exporter would
+template<typename MixerType>
+void Export(MixerType& mixer, int format, const std::string& filename)
+{
+   SF_INFO info {};
+   info.samplerate = 48000;
+   info.channels = channels;
+   info.format = format;
+   const auto file = sf_open(filename.c_str(), SFM_WRITE, &info);
+   REQUIRE(file != nullptr);
+   while (const auto samples = mixer.Process())
+      sf_writef_float(
+         file, reinterpret_cast<const float*>(mixer.GetBuffer()), samples);
+   sf_close(file);
+}
+} // namespace
+
+TEST_CASE("PipelinedMixer delivers what the mixer delivers")
+{
+   const auto interleaved = GENERATE(true, false);
+   constexpr auto duration = 2.0;
+
+   auto serial = MakeMixer(duration, interleaved);
+   const auto expected = MixAll(*serial, interleaved);
+
+   PipelinedMixer pipelined { MakeMixer(duration, interleaved) };
+   const auto actual = MixAll(pipelined, interleaved);
+
+   REQUIRE(!expected.empty());
+   REQUIRE(actual == expected);
+   REQUIRE(pipelined.MixGetCurrentTime() == serial->MixGetCurrentTime());
+   REQUIRE(pipelined.Process() == 0);
+}
+
+TEST_CASE("PipelinedMixer may be destroyed before the mix is complete")
+{
+   PipelinedMixer pipelined { MakeMixer(60.0, true), 2 };
+   REQUIRE(pipelined.Process() > 0);
+   REQUIRE(pipelined.MixGetCurrentTime() > 0.0);
+}
+
+// Hidden; run with the [benchmark] tag
+TEST_CASE("PipelinedMixer export throughput", "[.][benchmark]")
+{
+   constexpr auto duration = 600.0;
+   const std::pair<const char*, int> formats[] {
+      { "WAV 16 bit", SF_FORMAT_WAV | SF_FORMAT_PCM_16 },
+      { "FLAC", SF_FORMAT_FLAC | SF_FORMAT_PCM_16 },
+      { "Ogg Vorbis", SF_FORMAT_OGG | SF_FORMAT_VORBIS },
+   };
+   const std::string filename = std::tmpnam(nullptr);
+
+   const auto time = [&](auto&& exportIt) {
+      const auto start = std::chrono::steady_clock::now();
+      exportIt();
+      return std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start)
+         .count();
+   };
+
+   for (const auto& [name, format] : formats)
+   {
+      const auto serialSeconds = time([&] {
+         auto mixer = MakeMixer(duration, true);
+         Export(*mixer, format, filename);
+      });
+      const auto pipelinedSeconds = time([&] {
+         PipelinedMixer mixer { MakeMixer(duration, true) };
+         Export(mixer, format, filename);
+      });
+      std::cout << name << ": serial " << duration / serialSeconds
+                << "x real time, pipelined " << duration / pipelinedSeconds
+                << "x real time\n";
+   }
+   std::remove(filename.c_str());
+}
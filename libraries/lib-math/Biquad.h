@@ -12,10 +12,11 @@ Max Maisel
 #ifndef __BIQUAD_H__
 #define __BIQUAD_H__
 
+#include "BiquadCascade.h"
 #include "MemoryX.h"
 
 /// \brief Represents a biquad digital filter.
-struct Biquad
+struct MATH_API Biquad
 {
    Biquad();
    void Reset();
@@ -49,6 +50,13 @@ struct Biquad
       return fOut;
    }
 
+   //! Coefficients, for processing with a BiquadCascade
+   BiquadCascade::Section GetSection() const
+   {
+      return { fNumerCoeffs[B0], fNumerCoeffs[B1], fNumerCoeffs[B2],
+         fDenomCoeffs[A1], fDenomCoeffs[A2] };
+   }
+
    double fNumerCoeffs[3]; // B0 B1 B2
    double fDenomCoeffs[2]; // A1 A2, A0 == 1.0
    double fPrevIn;
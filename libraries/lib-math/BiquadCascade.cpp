@@ -0,0 +1,220 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  BiquadCascade.cpp
+
+**********************************************************************/
+#include "BiquadCascade.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || (defined(_M_AMD64) || defined(_M_X64))
+#include <emmintrin.h>
+#define BIQUAD_CASCADE_SSE2
+#endif
+
+namespace {
+// Histories of one section for a pair of channels: x1, x2, y1, y2, each for
+// both channels
+constexpr size_t SectionHistorySize = 8;
+
+// Histories smaller than this are flushed to zero
+constexpr double FlushThreshold = 1e-30;
+
+#ifdef BIQUAD_CASCADE_SSE2
+//! Filter a pair of channels through N sections in one pass; without a
+//! second channel, in1 repeats in0, and out1 is null
+template<size_t N> void FilterPair(
+   const BiquadCascade::Section *sections, double *histories,
+   const float *in0, const float *in1, float *out0, float *out1, size_t len)
+{
+   __m128d b0[N], b1[N], b2[N], a1[N], a2[N], y1[N], y2[N];
+   for (size_t kk = 0; kk < N; ++kk) {
+      const auto &section = sections[kk];
+      b0[kk] = _mm_set1_pd(section.b0);
+      b1[kk] = _mm_set1_pd(section.b1);
+      b2[kk] = _mm_set1_pd(section.b2);
+      a1[kk] = _mm_set1_pd(section.a1);
+      a2[kk] = _mm_set1_pd(section.a2);
+      y1[kk] = _mm_loadu_pd(histories + kk * SectionHistorySize + 4);
+      y2[kk] = _mm_loadu_pd(histories + kk * SectionHistorySize + 6);
+   }
+   auto x1 = _mm_loadu_pd(histories), x2 = _mm_loadu_pd(histories + 2);
+
+   for (size_t ii = 0; ii < len; ++ii) {
+      const auto x = _mm_set_pd(in1[ii], in0[ii]);
+      auto input = x, input1 = x1, input2 = x2;
+      for (size_t kk = 0; kk < N; ++kk) {
+         // The recursion limits the speed; so subtract the term of the last
+         // output after all others
+         const auto y = _mm_sub_pd(
+            _mm_sub_pd(
+               _mm_add_pd(
+                  _mm_add_pd(
+                     _mm_mul_pd(input, b0[kk]), _mm_mul_pd(input1, b1[kk])),
+                  _mm_mul_pd(input2, b2[kk])),
+               _mm_mul_pd(y2[kk], a2[kk])),
+            _mm_mul_pd(y1[kk], a1[kk]));
+         // The output history is the input history of the next section
+         input1 = y1[kk];
+         input2 = y2[kk];
+         y2[kk] = y1[kk];
+         y1[kk] = y;
+         input = y;
+      }
+      x2 = x1;
+      x1 = x;
+      out0[ii] = static_cast<float>(_mm_cvtsd_f64(input));
+      if (out1)
+         out1[ii] =
+            static_cast<float>(_mm_cvtsd_f64(_mm_unpackhi_pd(input, input)));
+   }
+
+   _mm_storeu_pd(histories, x1);
+   _mm_storeu_pd(histories + 2, x2);
+   for (size_t kk = 0; kk < N; ++kk) {
+      const auto pHistory = histories + kk * SectionHistorySize;
+      if (kk > 0) {
+         _mm_storeu_pd(pHistory, y1[kk - 1]);
+         _mm_storeu_pd(pHistory + 2, y2[kk - 1]);
+      }
+      _mm_storeu_pd(pHistory + 4, y1[kk]);
+      _mm_storeu_pd(pHistory + 6, y2[kk]);
+   }
+}
+#else
+//! Filter one channel, in the given lane of the histories of its pair,
+//! through N sections in one pass
+template<size_t N> void FilterOne(
+   const BiquadCascade::Section *sections, double *histories, size_t lane,
+   const float *in, float *out, size_t len)
+{
+   double y1[N], y2[N];
+   for (size_t kk = 0; kk < N; ++kk) {
+      y1[kk] = histories[kk * SectionHistorySize + 4 + lane];
+      y2[kk] = histories[kk * SectionHistorySize + 6 + lane];
+   }
+   auto x1 = histories[lane], x2 = histories[2 + lane];
+
+   for (size_t ii = 0; ii < len; ++ii) {
+      const double x = in[ii];
+      auto input = x, input1 = x1, input2 = x2;
+      for (size_t kk = 0; kk < N; ++kk) {
+         const auto &section = sections[kk];
+         const auto y = input * section.b0 + input1 * section.b1
+            + input2 * section.b2 - y2[kk] * section.a2 - y1[kk] * section.a1;
+         input1 = y1[kk];
+         input2 = y2[kk];
+         y2[kk] = y1[kk];
+         y1[kk] = y;
+         input = y;
+      }
+      x2 = x1;
+      x1 = x;
+      out[ii] = static_cast<float>(input);
+   }
+
+   histories[lane] = x1;
+   histories[2 + lane] = x2;
+   for (size_t kk = 0; kk < N; ++kk) {
+      const auto pHistory = histories + kk * SectionHistorySize;
+      if (kk > 0) {
+         pHistory[lane] = y1[kk - 1];
+         pHistory[2 + lane] = y2[kk - 1];
+      }
+      pHistory[4 + lane] = y1[kk];
+      pHistory[6 + lane] = y2[kk];
+   }
+}
+#endif
+
+template<size_t N> void FilterGroup(
+   const BiquadCascade::Section *sections, double *histories,
+   const float *in0, const float *in1, float *out0, float *out1, size_t len)
+{
+#ifdef BIQUAD_CASCADE_SSE2
+   FilterPair<N>(sections, histories, in0, in1 ? in1 : in0, out0, out1, len);
+#else
+   FilterOne<N>(sections, histories, 0, in0, out0, len);
+   if (in1)
+      FilterOne<N>(sections, histories, 1, in1, out1, len);
+#endif
+}
+
+using GroupFunction = void (*)(const BiquadCascade::Section *, double *,
+   const float *, const float *, float *, float *, size_t);
+constexpr GroupFunction GroupFunctions[BiquadCascade::MaxFusedSections] {
+   FilterGroup<1>, FilterGroup<2>, FilterGroup<3>, FilterGroup<4>,
+   FilterGroup<5>,
+};
+}
+
+BiquadCascade::BiquadCascade(size_t nChannels)
+   : mNChannels{ nChannels }
+{
+}
+
+void BiquadCascade::SetSections(const Section *sections, size_t nSections)
+{
+   if (nSections != mSections.size()) {
+      mSections.assign(sections, sections + nSections);
+      Reset();
+   }
+   else
+      std::copy(sections, sections + nSections, mSections.begin());
+}
+
+void BiquadCascade::Reset()
+{
+   mHistories.assign(
+      (mNChannels + 1) / 2 * mSections.size() * SectionHistorySize, 0.0);
+}
+
+void BiquadCascade::Process(
+   const float *const in[], float *const out[], size_t len)
+{
+   for (size_t offset = 0; offset < len; offset += MaxPiece) {
+      ProcessPiece(in, out, offset, std::min(MaxPiece, len - offset));
+      FlushDenormals();
+   }
+}
+
+void BiquadCascade::ProcessPiece(
+   const float *const in[], float *const out[], size_t offset, size_t len)
+{
+   const auto nSections = mSections.size();
+   for (size_t channel = 0; channel < mNChannels; channel += 2) {
+      const bool pair = channel + 1 < mNChannels;
+      const float *in0 = in[channel] + offset,
+         *in1 = pair ? in[channel + 1] + offset : nullptr;
+      const auto out0 = out[channel] + offset,
+         out1 = pair ? out[channel + 1] + offset : nullptr;
+      const auto histories =
+         mHistories.data() + channel / 2 * nSections * SectionHistorySize;
+      if (nSections == 0) {
+         std::copy(in0, in0 + len, out0);
+         if (pair)
+            std::copy(in1, in1 + len, out1);
+         continue;
+      }
+      // Later groups of sections filter the output of earlier groups
+      for (size_t first = 0; first < nSections; first += MaxFusedSections) {
+         const auto count = std::min(MaxFusedSections, nSections - first);
+         GroupFunctions[count - 1](mSections.data() + first,
+            histories + first * SectionHistorySize,
+            in0, in1, out0, out1, len);
+         in0 = out0;
+         in1 = out1;
+      }
+   }
+}
+
+void BiquadCascade::FlushDenormals()
+{
+   for (auto &history : mHistories)
+      if (std::abs(history) < FlushThreshold)
+         history = 0;
+}
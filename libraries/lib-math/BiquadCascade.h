@@ -0,0 +1,67 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file BiquadCascade.h
+  @brief Cascades of second-order IIR sections, for several channels at once
+
+**********************************************************************/
+#ifndef __AUDACITY_BIQUAD_CASCADE__
+#define __AUDACITY_BIQUAD_CASCADE__
+
+#include <cstddef>
+#include <vector>
+
+//! Runs the same cascade of second-order sections on several channels
+/*!
+ All calculation is in double precision, in direct form I, as for Biquad.
+ One pass over the samples does up to MaxFusedSections sections, keeping
+ the intermediate results in registers; where SSE2 is available, channels
+ go two at a time through the lanes of vectors.
+
+ Histories too small to matter are flushed to zero after each MaxPiece
+ samples, so that decay into silence does not slow down with denormal
+ numbers.
+ */
+class MATH_API BiquadCascade
+{
+public:
+   //! Coefficients of one section, normalized so that a0 is 1
+   struct Section {
+      double b0 = 1, b1 = 0, b2 = 0, a1 = 0, a2 = 0;
+   };
+
+   static constexpr size_t MaxFusedSections = 5;
+   static constexpr size_t MaxPiece = 4096;
+
+   explicit BiquadCascade(size_t nChannels = 1);
+
+   size_t NChannels() const { return mNChannels; }
+   size_t NSections() const { return mSections.size(); }
+
+   //! Replace the coefficients
+   /*!
+    Histories are kept if the number of sections does not change, so that
+    parameters can change during play
+    */
+   void SetSections(const Section *sections, size_t nSections);
+   //! Clear the histories of all channels
+   void Reset();
+
+   //! Filter len samples of each channel; out may be the same as in
+   void Process(const float *const in[], float *const out[], size_t len);
+
+private:
+   void ProcessPiece(const float *const in[], float *const out[],
+      size_t offset, size_t len);
+   void FlushDenormals();
+
+   std::vector<Section> mSections;
+   size_t mNChannels;
+   //! For each pair of channels, and each section, the histories of input
+   //! and output, with the pair interleaved
+   std::vector<double> mHistories;
+};
+
+#endif
@@ -27,10 +27,17 @@
   - Triangle dithering
   - Noise-shaped dithering
 
-Dither class. You must construct an instance because it keeps
-state. Call Dither::Apply() to apply the dither. You can call
-Reset() between subsequent dithers to reset the dither state
-and get deterministic behaviour.
+Dither class. The state is kept for each thread, so that conversions
+in different threads do not interfere. Call Dither::Apply() to apply
+the dither. You can call Reset() between subsequent dithers to reset
+the dither state, and ResetNoise() to make the noise deterministic.
+Each thread's noise begins from different seeds, so that conversions in
+parallel do not add correlated noise; ResetNoise() uses the same seeds
+in every thread.
+
+Where the processor supports SSE2, conversions and the noise
+generator use vectorised kernels that give the same results as the
+scalar loops.
 
 *//*******************************************************************/
 
@@ -48,12 +55,21 @@ and get deterministic behaviour.
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iterator>
 //#include <sys/types.h>
 //#include <memory.h>
 //#include <assert.h>
 
 #include <wx/defs.h>
 
+#if defined(__SSE2__) || (defined(_M_AMD64) || defined(_M_X64))
+#include <emmintrin.h>
+#define DITHER_SSE2
+#endif
+
 //////////////////////////////////////////////////////////////////////////
 
 // Constants for the noise shaping buffer
@@ -63,46 +79,141 @@ constexpr int BUF_MASK = 7;
 // Lipshitz's minimally audible FIR
 const float SHAPED_BS[] = { 2.033f, -2.165f, 1.959f, -1.590f, 0.6149f };
 
-// Dither state
-struct State {
-    int mPhase;
-    float mTriangleState;
-    float mBuffer[8 /* = BUF_SIZE */];
-} mState;
+// Noise comes from four interleaved xorshift32 generators, so that four
+// values can be made at once; value n of the sequence comes from lane n % 4
+constexpr uint32_t NOISE_SEEDS[] = {
+   0x9E3779B9u, 0x7F4A7C15u, 0x85EBCA6Bu, 0xC2B2AE35u };
+constexpr int NOISE_LANES = 4;
 
-using Ditherer = float (*)(State &, float);
+// Counts the threads that have made dither state, so that each seeds its
+// noise differently
+static std::atomic<uint32_t> sThreadCount{ 0 };
 
-// This is supposed to produce white noise and no dc
-static inline float DITHER_NOISE()
+// Mixes a thread's number into a seed; the first thread keeps NOISE_SEEDS,
+// and the result is never zero, which would stall xorshift
+static uint32_t ThreadSeed(uint32_t seed, uint32_t thread)
 {
-    return rand() / (float)RAND_MAX - 0.5f;
+    uint32_t x = thread * 0x9E3779B9u;
+    x ^= x >> 16;
+    x *= 0x85EBCA6Bu;
+    x ^= x >> 13;
+    x = seed ^ x;
+    return x ? x : seed;
 }
 
+// Dither state, one for each thread, because sample conversions may run in
+// several threads at once
+struct State {
+    State()
+    {
+        const auto thread = sThreadCount.fetch_add(1, std::memory_order_relaxed);
+        for (int ii = 0; ii < 4 /* = NOISE_LANES */; ++ii)
+            mLanes[ii] = ThreadSeed(NOISE_SEEDS[ii], thread);
+    }
+
+    int mPhase{ 0 };
+    float mTriangleState{ 0 };
+    float mBuffer[8 /* = BUF_SIZE */]{};
+
+    uint32_t mLanes[4 /* = NOISE_LANES */];
+    // Noise made in the last group of four but not yet used
+    float mSpare[4 /* = NOISE_LANES */]{};
+    int mSpareCount{ 0 };
+};
+static thread_local State mState;
+
+// Samples are converted this many at a time through buffers on the stack
+constexpr size_t BLOCK_SIZE = 256;
+
+// Whether to use the vectorised kernels; they give the same results as the
+// scalar loops
+static std::atomic<bool> sVectorised{
+#ifdef DITHER_SSE2
+   // SSE2 is part of every x86-64 processor, and 32-bit builds define
+   // __SSE2__ only when they already require it
+   true
+#else
+   false
+#endif
+};
+
 // Defines for sample conversion
 constexpr auto CONVERT_DIV16 = float(1<<15);
 constexpr auto CONVERT_DIV24 = float(1<<23);
 
-// Dereference sample pointer and convert to float sample
-static inline float FROM_INT16(const short *ptr)
+// This is supposed to produce white noise and no dc; the value is in
+// [-0.5, 0.5)
+static inline float DITHER_NOISE(uint32_t x)
+{
+    return float(x >> 8) * (1.0f / (1 << 24)) - 0.5f;
+}
+
+static inline uint32_t NEXT_NOISE(uint32_t x)
+{
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+// Fill `dst` with `groups` times NOISE_LANES values of noise
+static void NoiseGroups(State &state, float *dst, size_t groups, bool vectorised)
 {
-    return *ptr / CONVERT_DIV16;
+#ifdef DITHER_SSE2
+    if (vectorised) {
+        auto lanes =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(state.mLanes));
+        const auto scale = _mm_set1_ps(1.0f / (1 << 24));
+        const auto half = _mm_set1_ps(0.5f);
+        for (; groups > 0; --groups, dst += NOISE_LANES) {
+            lanes = _mm_xor_si128(lanes, _mm_slli_epi32(lanes, 13));
+            lanes = _mm_xor_si128(lanes, _mm_srli_epi32(lanes, 17));
+            lanes = _mm_xor_si128(lanes, _mm_slli_epi32(lanes, 5));
+            const auto values =
+                _mm_cvtepi32_ps(_mm_srli_epi32(lanes, 8));
+            _mm_storeu_ps(dst, _mm_sub_ps(_mm_mul_ps(values, scale), half));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(state.mLanes), lanes);
+        return;
+    }
+#endif
+    for (; groups > 0; --groups, dst += NOISE_LANES)
+        for (int lane = 0; lane < NOISE_LANES; ++lane) {
+            auto &x = state.mLanes[lane];
+            x = NEXT_NOISE(x);
+            dst[lane] = DITHER_NOISE(x);
+        }
 }
 
-static inline float FROM_INT24(const int *ptr)
+// Fill `dst` with the next `count` values of noise
+static void FillNoise(State &state, float *dst, size_t count, bool vectorised)
 {
-    return *ptr / CONVERT_DIV24;
+    const auto takeSpare = [&]{
+        for (; count > 0 && state.mSpareCount > 0; --count)
+            *dst++ = state.mSpare[NOISE_LANES - state.mSpareCount--];
+    };
+    takeSpare();
+    const auto groups = count / NOISE_LANES;
+    NoiseGroups(state, dst, groups, vectorised);
+    dst += groups * NOISE_LANES;
+    count -= groups * NOISE_LANES;
+    if (count > 0) {
+        NoiseGroups(state, state.mSpare, 1, vectorised);
+        state.mSpareCount = NOISE_LANES;
+        takeSpare();
+    }
 }
 
 // For float, we internally allow values greater than 1.0, which
 // would blow up the dithering to int values.  FROM_FLOAT is
 // only used to dither to int, so clip here.
-static inline float FROM_FLOAT(const float *ptr)
+static inline float FROM_FLOAT(float sample)
 {
-    return *((float*)(ptr)) > 1.0
-        ?  1.0 :
-        *((float*)(ptr)) < -1.0
-            ? -1.0 :
-            *((float*)(ptr));
+    return sample > 1.0f
+        ?  1.0f :
+        sample < -1.0f
+            ? -1.0f :
+            sample;
 }
 
 // Store float sample 'sample' into pointer 'ptr', clip it, if necessary
@@ -119,70 +230,189 @@ static inline void IMPLEMENT_STORE(
         *ptr = static_cast<dst_type>(x);
 }
 
-// Dither single float 'sample' and store it in pointer 'dst', using 'dither' as algorithm
-static inline void DITHER_TO_INT16(Ditherer dither, State &state,
-   short *dst, float sample)
+#ifdef DITHER_SSE2
+
+// The vectorised loads and stores handle strides 1 and 2 (deinterleaving a
+// channel of a stereo buffer) and return how many samples they did, leaving
+// the rest to the scalar loops.  Interleaving stores stay scalar, so that the
+// samples of the other channels are never written.
+
+static size_t LoadSSE2(
+    float *dst, const short *src, size_t stride, size_t count, float scale)
 {
-    IMPLEMENT_STORE<short>(dst,
-        dither(state, sample * CONVERT_DIV16),
-        short(-32768), short(32767));
+    const auto vscale = _mm_set1_ps(scale);
+    size_t ii = 0;
+    if (stride == 1)
+        for (; ii + 8 <= count; ii += 8) {
+            const auto v =
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + ii));
+            // Sign-extend by unpacking into the high halves and shifting down
+            const auto lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+            const auto hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+            _mm_storeu_ps(dst + ii, _mm_mul_ps(_mm_cvtepi32_ps(lo), vscale));
+            _mm_storeu_ps(dst + ii + 4,
+                _mm_mul_ps(_mm_cvtepi32_ps(hi), vscale));
+        }
+    else if (stride == 2)
+        // Each load reads one sample past the last one used
+        for (; ii + 5 <= count; ii += 4) {
+            const auto v = _mm_loadu_si128(
+                reinterpret_cast<const __m128i *>(src + 2 * ii));
+            const auto even = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+            _mm_storeu_ps(dst + ii,
+                _mm_mul_ps(_mm_cvtepi32_ps(even), vscale));
+        }
+    return ii;
 }
 
-// Dither single float 'sample' and store it in pointer 'dst', using 'dither' as algorithm
-static inline void DITHER_TO_INT24(Ditherer dither, State &state,
-   int *dst, float sample)
+static size_t LoadSSE2(
+    float *dst, const int *src, size_t stride, size_t count, float scale)
 {
-    IMPLEMENT_STORE<int>(dst,
-        dither(state, sample * CONVERT_DIV24), -8388608, 8388607);
+    const auto vscale = _mm_set1_ps(scale);
+    size_t ii = 0;
+    if (stride == 1)
+        for (; ii + 4 <= count; ii += 4) {
+            const auto v =
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + ii));
+            _mm_storeu_ps(dst + ii, _mm_mul_ps(_mm_cvtepi32_ps(v), vscale));
+        }
+    else if (stride == 2)
+        for (; ii + 5 <= count; ii += 4) {
+            const auto a = _mm_loadu_si128(
+                reinterpret_cast<const __m128i *>(src + 2 * ii));
+            const auto b = _mm_loadu_si128(
+                reinterpret_cast<const __m128i *>(src + 2 * ii + 4));
+            const auto even = _mm_unpacklo_epi64(
+                _mm_shuffle_epi32(a, _MM_SHUFFLE(2, 0, 2, 0)),
+                _mm_shuffle_epi32(b, _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(dst + ii,
+                _mm_mul_ps(_mm_cvtepi32_ps(even), vscale));
+        }
+    return ii;
 }
 
-// Implement one single dither step
+// Clips like FROM_FLOAT; the operand order lets NaN through, as there
+static size_t LoadSSE2(
+    float *dst, const float *src, size_t stride, size_t count, float scale)
+{
+    const auto vscale = _mm_set1_ps(scale);
+    const auto lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(1.0f);
+    const auto clip = [&](__m128 v){
+        return _mm_mul_ps(_mm_min_ps(hi, _mm_max_ps(lo, v)), vscale);
+    };
+    size_t ii = 0;
+    if (stride == 1)
+        for (; ii + 4 <= count; ii += 4)
+            _mm_storeu_ps(dst + ii, clip(_mm_loadu_ps(src + ii)));
+    else if (stride == 2)
+        for (; ii + 5 <= count; ii += 4) {
+            const auto a = _mm_loadu_ps(src + 2 * ii);
+            const auto b = _mm_loadu_ps(src + 2 * ii + 4);
+            _mm_storeu_ps(dst + ii,
+                clip(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))));
+        }
+    return ii;
+}
 
-// Implement a dithering loop
-template<typename srcType, typename dstType>
-static inline void DITHER_LOOP( Ditherer dither, State &state,
-    void (*store)(Ditherer, State &, dstType *, float),
-    float (*load)(const srcType *),
-    samplePtr dst, sampleFormat dstFormat, size_t dstStride,
-    constSamplePtr src, sampleFormat srcFormat, size_t srcStride, size_t len)
+// _mm_cvtps_epi32 rounds in the current mode, like lrintf
+static size_t StoreSSE2(short *dst, size_t stride, const float *src, size_t count)
 {
-    char *d;
-    const char *s;
-    unsigned int ii;
-    for (d = (char*)dst, s = (char*)src, ii = 0;
-        ii < len;
-        ii++, d += SAMPLE_SIZE(dstFormat) * dstStride,
-        s += SAMPLE_SIZE(srcFormat) * srcStride) {
-            store(dither, state, reinterpret_cast<dstType *>(d), load(reinterpret_cast<const srcType *>(s)));
+    size_t ii = 0;
+    if (stride == 1)
+        for (; ii + 8 <= count; ii += 8) {
+            const auto lo = _mm_cvtps_epi32(_mm_loadu_ps(src + ii));
+            const auto hi = _mm_cvtps_epi32(_mm_loadu_ps(src + ii + 4));
+            // Saturation clips to the range of short
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + ii),
+                _mm_packs_epi32(lo, hi));
         }
+    return ii;
 }
 
-// Implement a dither. There are only 3 cases where we must dither,
-// in all other cases, no dithering is necessary.
-static inline void DITHER( Ditherer dither, State &state,
-   samplePtr dst, sampleFormat dstFormat, size_t dstStride,
-   constSamplePtr src, sampleFormat srcFormat, size_t srcStride, size_t len)
+static size_t StoreSSE2(int *dst, size_t stride, const float *src, size_t count)
 {
-    if (srcFormat == int24Sample && dstFormat == int16Sample)
-        DITHER_LOOP<int, short>(dither, state,
-            DITHER_TO_INT16, FROM_INT24, dst,
-            int16Sample, dstStride, src, int24Sample, srcStride, len);
-    else if (srcFormat == floatSample && dstFormat == int16Sample)
-        DITHER_LOOP<float, short>(dither, state,
-            DITHER_TO_INT16, FROM_FLOAT, dst,
-            int16Sample, dstStride, src, floatSample, srcStride, len);
-    else if (srcFormat == floatSample && dstFormat == int24Sample)
-        DITHER_LOOP<float, int>(dither, state,
-            DITHER_TO_INT24, FROM_FLOAT, dst,
-            int24Sample, dstStride, src, floatSample, srcStride, len);
+    const auto maxBound = _mm_set1_epi32(8388607);
+    const auto minBound = _mm_set1_epi32(-8388608);
+    size_t ii = 0;
+    if (stride == 1)
+        for (; ii + 4 <= count; ii += 4) {
+            auto x = _mm_cvtps_epi32(_mm_loadu_ps(src + ii));
+            // SSE2 lacks _mm_min_epi32 and _mm_max_epi32
+            const auto over = _mm_cmpgt_epi32(x, maxBound);
+            x = _mm_or_si128(_mm_and_si128(over, maxBound),
+                _mm_andnot_si128(over, x));
+            const auto under = _mm_cmplt_epi32(x, minBound);
+            x = _mm_or_si128(_mm_and_si128(under, minBound),
+                _mm_andnot_si128(under, x));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + ii), x);
+        }
+    return ii;
+}
+
+#endif
+
+// Convert `count` samples, `stride` apart, to float, multiplied by `scale`;
+// float samples are first clipped with FROM_FLOAT
+static void LoadBlock(float *dst, constSamplePtr src, sampleFormat format,
+    size_t stride, size_t count, float scale, bool vectorised)
+{
+    size_t ii = 0;
+    const auto load = [&](auto s, auto convert){
+#ifdef DITHER_SSE2
+        if (vectorised)
+            ii = LoadSSE2(dst, s, stride, count, scale);
+#endif
+        for (; ii < count; ++ii)
+            dst[ii] = convert(s[ii * stride]) * scale;
+    };
+    const auto identity = [](auto sample){ return sample; };
+    if (format == int16Sample)
+        load(reinterpret_cast<const short *>(src), identity);
+    else if (format == int24Sample)
+        load(reinterpret_cast<const int *>(src), identity);
+    else if (format == floatSample)
+        load(reinterpret_cast<const float *>(src), FROM_FLOAT);
     else { wxASSERT(false); }
 }
 
+// Store `count` float samples, `stride` apart; int samples are rounded and
+// clipped
+static void StoreBlock(samplePtr dst, sampleFormat format, size_t stride,
+    const float *src, size_t count, bool vectorised)
+{
+    size_t ii = 0;
+    if (format == floatSample) {
+        auto d = reinterpret_cast<float *>(dst);
+        for (; ii < count; ++ii)
+            d[ii * stride] = src[ii];
+    } else
+    if (format == int16Sample) {
+        auto d = reinterpret_cast<short *>(dst);
+#ifdef DITHER_SSE2
+        if (vectorised)
+            ii = StoreSSE2(d, stride, src, count);
+#endif
+        for (; ii < count; ++ii)
+            IMPLEMENT_STORE<short>(
+                d + ii * stride, src[ii], short(-32768), short(32767));
+    } else
+    if (format == int24Sample) {
+        auto d = reinterpret_cast<int *>(dst);
+#ifdef DITHER_SSE2
+        if (vectorised)
+            ii = StoreSSE2(d, stride, src, count);
+#endif
+        for (; ii < count; ++ii)
+            IMPLEMENT_STORE<int>(d + ii * stride, src[ii], -8388608, 8388607);
+    } else { wxASSERT(false); }
+}
 
-static inline float NoDither(State &, float sample);
-static inline float RectangleDither(State &, float sample);
-static inline float TriangleDither(State &state, float sample);
-static inline float ShapedDither(State &state, float sample);
+static void RectangleDither(State &state, float *samples, size_t count,
+    bool vectorised);
+static void TriangleDither(State &state, float *samples, size_t count,
+    bool vectorised);
+static void ShapedDither(State &state, float *samples, size_t count,
+    bool vectorised);
 
 Dither::Dither()
 {
@@ -197,8 +427,26 @@ void Dither::Reset()
     memset(mState.mBuffer, 0, sizeof(float) * BUF_SIZE);
 }
 
-// This only decides if we must dither at all, the dithers
-// are all implemented using macros.
+void Dither::ResetNoise()
+{
+    std::copy(std::begin(NOISE_SEEDS), std::end(NOISE_SEEDS), mState.mLanes);
+    mState.mSpareCount = 0;
+}
+
+void Dither::SetVectorised(bool vectorised)
+{
+#ifdef DITHER_SSE2
+    sVectorised.store(vectorised, std::memory_order_relaxed);
+#endif
+}
+
+bool Dither::IsVectorised()
+{
+    return sVectorised.load(std::memory_order_relaxed);
+}
+
+// This only decides if we must dither at all; the conversions go through
+// blocks of float samples on the stack.
 //
 // "source" and "dest" can contain either interleaved or non-interleaved
 // samples.  They do not have to be the same...one can be interleaved while
@@ -236,6 +484,24 @@ void Dither::Apply(enum DitherType ditherType,
     if (len == 0)
         return; // nothing to do
 
+    const auto vectorised = IsVectorised();
+    float samples[BLOCK_SIZE];
+
+    // Convert the samples block by block, modifying each between load and
+    // store
+    const auto convert = [&](float scale, auto modify){
+        const auto srcStep = SAMPLE_SIZE(sourceFormat) * sourceStride;
+        const auto dstStep = SAMPLE_SIZE(destFormat) * destStride;
+        for (size_t done = 0; done < len; done += BLOCK_SIZE) {
+            const auto count = std::min<size_t>(BLOCK_SIZE, len - done);
+            LoadBlock(samples, source + done * srcStep, sourceFormat,
+                sourceStride, count, scale, vectorised);
+            modify(count);
+            StoreBlock(dest + done * dstStep, destFormat, destStride,
+                samples, count, vectorised);
+        }
+    };
+
     if (destFormat == sourceFormat)
     {
         // No need to dither, because source and destination
@@ -276,22 +542,14 @@ void Dither::Apply(enum DitherType ditherType,
     {
         // No need to dither, just convert samples to float.
         // No clipping should be necessary.
-        auto d = (float*)dest;
-
-        if (sourceFormat == int16Sample)
-        {
-            auto s = (const short*)source;
-            for (i = 0; i < len; i++, d += destStride, s += sourceStride)
-                *d = FROM_INT16(s);
-        } else
-        if (sourceFormat == int24Sample)
-        {
-            auto s = (const int*)source;
-            for (i = 0; i < len; i++, d += destStride, s += sourceStride)
-                *d = FROM_INT24(s);
-        } else {
-            wxASSERT(false); // source format unknown
-        }
+        const auto scale = 1.0f / (sourceFormat == int16Sample
+            ? CONVERT_DIV16 : CONVERT_DIV24);
+        if (destStride == 1)
+            // Skip the intermediate block
+            LoadBlock(reinterpret_cast<float *>(dest), source, sourceFormat,
+                sourceStride, len, scale, vectorised);
+        else
+            convert(scale, [](size_t){});
     } else
     if (destFormat == int24Sample && sourceFormat == int16Sample)
     {
@@ -302,22 +560,30 @@ void Dither::Apply(enum DitherType ditherType,
             *d = ((int)*s) << 8;
     } else
     {
-        // We must do dithering
+        // We must do dithering.  The scale takes int24 samples to int16
+        // exactly, and float samples to either
+        const auto scale = destFormat == int16Sample
+            ? (sourceFormat == int24Sample
+               ? CONVERT_DIV16 / CONVERT_DIV24 : CONVERT_DIV16)
+            : CONVERT_DIV24;
         switch (ditherType)
         {
         case DitherType::none:
-            DITHER(NoDither, mState, dest, destFormat, destStride, source, sourceFormat, sourceStride, len);
+            convert(scale, [](size_t){});
             break;
         case DitherType::rectangle:
-            DITHER(RectangleDither, mState, dest, destFormat, destStride, source, sourceFormat, sourceStride, len);
+            convert(scale, [&](size_t count){
+                RectangleDither(mState, samples, count, vectorised); });
             break;
         case DitherType::triangle:
             Reset(); // reset dither filter for this NEW conversion
-            DITHER(TriangleDither, mState, dest, destFormat, destStride, source, sourceFormat, sourceStride, len);
+            convert(scale, [&](size_t count){
+                TriangleDither(mState, samples, count, vectorised); });
             break;
         case DitherType::shaped:
             Reset(); // reset dither filter for this NEW conversion
-            DITHER(ShapedDither, mState, dest, destFormat, destStride, source, sourceFormat, sourceStride, len);
+            convert(scale, [&](size_t count){
+                ShapedDither(mState, samples, count, vectorised); });
             break;
         default:
             wxASSERT(false); // unknown dither algorithm
@@ -325,53 +591,79 @@ void Dither::Apply(enum DitherType ditherType,
     }
 }
 
-// Dither implementations
-
-// No dither, just return sample
-inline float NoDither(State &, float sample)
-{
-    return sample;
-}
+// Dither implementations, each for a block of samples already scaled to the
+// integer range
 
 // Rectangle dithering, apply one-step noise
-inline float RectangleDither(State &, float sample)
+void RectangleDither(State &state, float *samples, size_t count,
+    bool vectorised)
 {
-    return sample - DITHER_NOISE();
+    float noise[BLOCK_SIZE];
+    FillNoise(state, noise, count, vectorised);
+    size_t ii = 0;
+#ifdef DITHER_SSE2
+    if (vectorised)
+        for (; ii + 4 <= count; ii += 4)
+            _mm_storeu_ps(samples + ii, _mm_sub_ps(
+                _mm_loadu_ps(samples + ii), _mm_loadu_ps(noise + ii)));
+#endif
+    for (; ii < count; ++ii)
+        samples[ii] = samples[ii] - noise[ii];
 }
 
 // Triangle dither - high pass filtered
-inline float TriangleDither(State &state, float sample)
+void TriangleDither(State &state, float *samples, size_t count,
+    bool vectorised)
 {
-    float r = DITHER_NOISE();
-    float result = sample + r - state.mTriangleState;
-    state.mTriangleState = r;
-
-    return result;
+    // noise[ii] is the noise of the sample before samples[ii]
+    float noise[BLOCK_SIZE + 1];
+    noise[0] = state.mTriangleState;
+    FillNoise(state, noise + 1, count, vectorised);
+    size_t ii = 0;
+#ifdef DITHER_SSE2
+    if (vectorised)
+        for (; ii + 4 <= count; ii += 4)
+            _mm_storeu_ps(samples + ii, _mm_sub_ps(
+                _mm_add_ps(_mm_loadu_ps(samples + ii),
+                    _mm_loadu_ps(noise + ii + 1)),
+                _mm_loadu_ps(noise + ii)));
+#endif
+    for (; ii < count; ++ii)
+        samples[ii] = samples[ii] + noise[ii + 1] - noise[ii];
+    state.mTriangleState = noise[count];
 }
 
 // Shaped dither
-inline float ShapedDither(State &state, float sample)
+void ShapedDither(State &state, float *samples, size_t count,
+    bool vectorised)
 {
-    // Generate triangular dither, +-1 LSB, flat psd
-    float r = DITHER_NOISE() + DITHER_NOISE();
-    if(sample != sample)  // test for NaN
-       sample = 0; // and do the best we can with it
-
-    // Run FIR
-    float xe = sample + state.mBuffer[state.mPhase] * SHAPED_BS[0]
-        + state.mBuffer[(state.mPhase - 1) & BUF_MASK] * SHAPED_BS[1]
-        + state.mBuffer[(state.mPhase - 2) & BUF_MASK] * SHAPED_BS[2]
-        + state.mBuffer[(state.mPhase - 3) & BUF_MASK] * SHAPED_BS[3]
-        + state.mBuffer[(state.mPhase - 4) & BUF_MASK] * SHAPED_BS[4];
-
-    // Accumulate FIR and triangular noise
-    float result = xe + r;
-
-    // Roll buffer and store last error
-    state.mPhase = (state.mPhase + 1) & BUF_MASK;
-    state.mBuffer[state.mPhase] = xe - lrintf(result);
-
-    return result;
+    // The error feedback is serial, but the noise can be made in advance
+    float noise[2 * BLOCK_SIZE];
+    FillNoise(state, noise, 2 * count, vectorised);
+    for (size_t ii = 0; ii < count; ++ii) {
+        auto sample = samples[ii];
+
+        // Generate triangular dither, +-1 LSB, flat psd
+        float r = noise[2 * ii] + noise[2 * ii + 1];
+        if(sample != sample)  // test for NaN
+           sample = 0; // and do the best we can with it
+
+        // Run FIR
+        float xe = sample + state.mBuffer[state.mPhase] * SHAPED_BS[0]
+            + state.mBuffer[(state.mPhase - 1) & BUF_MASK] * SHAPED_BS[1]
+            + state.mBuffer[(state.mPhase - 2) & BUF_MASK] * SHAPED_BS[2]
+            + state.mBuffer[(state.mPhase - 3) & BUF_MASK] * SHAPED_BS[3]
+            + state.mBuffer[(state.mPhase - 4) & BUF_MASK] * SHAPED_BS[4];
+
+        // Accumulate FIR and triangular noise
+        float result = xe + r;
+
+        // Roll buffer and store last error
+        state.mPhase = (state.mPhase + 1) & BUF_MASK;
+        state.mBuffer[state.mPhase] = xe - lrintf(result);
+
+        samples[ii] = result;
+    }
 }
 
 static const std::initializer_list<EnumValueSymbol> choicesDither{
@@ -34,6 +34,17 @@ public:
     /// Reset state of the dither.
     void Reset();
 
+    /// Restart the dither noise of the calling thread from seeds shared by
+    /// all threads, so that the following conversions are reproducible.
+    /// Otherwise each thread's noise starts from seeds of its own.
+    static void ResetNoise();
+
+    /// Choose between vectorised and scalar conversion.  Both give the same
+    /// results; vectorised is the default where the processor supports it,
+    /// and cannot be chosen where it does not.
+    static void SetVectorised(bool vectorised);
+    static bool IsVectorised();
+
     /// Apply the actual dithering. Expects the source sample in the
     /// 'source' variable, the destination sample in the 'dest' variable,
     /// and hints to the formats of the samples. Even if the sample formats
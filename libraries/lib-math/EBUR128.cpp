@@ -0,0 +1,319 @@
+/**********************************************************************
+
+Audacity: A Digital Audio Editor
+
+EBUR128.cpp
+
+Max Maisel
+
+***********************************************************************/
+
+#include "EBUR128.h"
+#include <algorithm>
+
+#if defined(__SSE2__) || (defined(_M_AMD64) || defined(_M_X64))
+#include <emmintrin.h>
+#define EBUR128_SSE2
+#endif
+
+namespace {
+// Histories of a pair of channels through both filters: input, output of
+// the first filter, output of the second; the latest sample first
+constexpr size_t PairStateSize = 12;
+}
+
+EBUR128::EBUR128(double rate, size_t channels)
+   : mChannelCount{ channels }
+   , mStepSize( ceil(0.1 * rate) ) // 100 ms steps
+{
+   mLoudnessHist.reinit(HIST_BIN_COUNT);
+   mStepRing.reinit(SHORT_TERM_STEPS);
+   mFilterState.reinit((mChannelCount + 1) / 2 * PairStateSize);
+
+   const auto filter = CalcWeightingFilter(rate);
+   for (size_t ii = 0; ii < 2; ++ii) {
+      std::copy(filter[ii].fNumerCoeffs, filter[ii].fNumerCoeffs + 3,
+         mCoefficients[ii]);
+      std::copy(filter[ii].fDenomCoeffs, filter[ii].fDenomCoeffs + 2,
+         mCoefficients[ii] + 3);
+   }
+   Reset();
+}
+
+void EBUR128::Reset()
+{
+   std::fill(mLoudnessHist.get(), mLoudnessHist.get() + HIST_BIN_COUNT, 0);
+   std::fill(mStepRing.get(), mStepRing.get() + SHORT_TERM_STEPS, 0);
+   std::fill(mFilterState.get(),
+      mFilterState.get() + (mChannelCount + 1) / 2 * PairStateSize, 0);
+   mHistogramCount = 0;
+   mHistogramLoudness.reset();
+   mStepCount = 0;
+   mStepPos = 0;
+   mStepPower = 0;
+}
+
+// fs: sample rate
+// returns array of two Biquads
+//
+// EBU R128 parameter sampling rate adaption after
+// Mansbridge, Stuart, Saoirse Finn, and Joshua D. Reiss.
+// "Implementation and Evaluation of Autonomous Multi-track Fader Control."
+// Paper presented at the 132nd Audio Engineering Society Convention,
+// Budapest, Hungary, 2012."
+ArrayOf<Biquad> EBUR128::CalcWeightingFilter(double fs)
+{
+   ArrayOf<Biquad> pBiquad(size_t(2), true);
+
+   //
+   // HSF pre filter
+   //
+   double db =    3.999843853973347;
+   double f0 = 1681.974450955533;
+   double Q  =    0.7071752369554196;
+   double K  = tan(M_PI * f0 / fs);
+
+   double Vh = pow(10.0, db / 20.0);
+   double Vb = pow(Vh, 0.4996667741545416);
+
+   double a0 = 1.0 + K / Q + K * K;
+
+   pBiquad[0].fNumerCoeffs[Biquad::B0] = (Vh + Vb * K / Q + K * K) / a0;
+   pBiquad[0].fNumerCoeffs[Biquad::B1] =       2.0 * (K * K -  Vh) / a0;
+   pBiquad[0].fNumerCoeffs[Biquad::B2] = (Vh - Vb * K / Q + K * K) / a0;
+
+   pBiquad[0].fDenomCoeffs[Biquad::A1] =   2.0 * (K * K - 1.0) / a0;
+   pBiquad[0].fDenomCoeffs[Biquad::A2] = (1.0 - K / Q + K * K) / a0;
+
+   //
+   // HPF weighting filter
+   //
+   f0 = 38.13547087602444;
+   Q  =  0.5003270373238773;
+   K  = tan(M_PI * f0 / fs);
+
+   pBiquad[1].fNumerCoeffs[Biquad::B0] =  1.0;
+   pBiquad[1].fNumerCoeffs[Biquad::B1] = -2.0;
+   pBiquad[1].fNumerCoeffs[Biquad::B2] =  1.0;
+
+   pBiquad[1].fDenomCoeffs[Biquad::A1] = 2.0 * (K * K - 1.0) / (1.0 + K / Q + K * K);
+   pBiquad[1].fDenomCoeffs[Biquad::A2] = (1.0 - K / Q + K * K) / (1.0 + K / Q + K * K);
+
+   return pBiquad;
+}
+
+void EBUR128::ProcessSamples(const float *const channels[], size_t len)
+{
+   size_t pos = 0;
+   while (pos < len) {
+      // Filter up to the end of the step, summing the power of all channels.
+      // As a result, stereo tracks appear about 3 LUFS louder, as specified.
+      const auto count = std::min(len - pos, mStepSize - mStepPos);
+      for (size_t channel = 0; channel < mChannelCount; channel += 2)
+         mStepPower += FilterChannels(channel, channels, pos, count);
+      pos += count;
+      mStepPos += count;
+      if (mStepPos == mStepSize)
+         AddStep();
+   }
+}
+
+/// Filters len samples from pos of a channel and the next one, if any,
+/// and returns the sum of squares of the results
+double EBUR128::FilterChannels(
+   size_t channel, const float *const channels[], size_t pos, size_t len)
+{
+   const auto first = channels[channel] + pos;
+   const bool pair = channel + 1 < mChannelCount;
+   // Without a second channel, filter the first one twice, but count it once
+   const auto second = pair ? channels[channel + 1] + pos : first;
+   const auto state = mFilterState.get() + channel / 2 * PairStateSize;
+   const auto &hsf = mCoefficients[0], &hpf = mCoefficients[1];
+
+#ifdef EBUR128_SSE2
+   // Biquad must use double for all calculations, so two channels fill
+   // a vector
+   auto x1 = _mm_loadu_pd(state), x2 = _mm_loadu_pd(state + 2),
+      u1 = _mm_loadu_pd(state + 4), u2 = _mm_loadu_pd(state + 6),
+      y1 = _mm_loadu_pd(state + 8), y2 = _mm_loadu_pd(state + 10);
+   const auto b0 = _mm_set1_pd(hsf[0]), b1 = _mm_set1_pd(hsf[1]),
+      b2 = _mm_set1_pd(hsf[2]), a1 = _mm_set1_pd(hsf[3]),
+      a2 = _mm_set1_pd(hsf[4]);
+   const auto c0 = _mm_set1_pd(hpf[0]), c1 = _mm_set1_pd(hpf[1]),
+      c2 = _mm_set1_pd(hpf[2]), d1 = _mm_set1_pd(hpf[3]),
+      d2 = _mm_set1_pd(hpf[4]);
+   auto power = _mm_setzero_pd();
+   for (size_t ii = 0; ii < len; ++ii) {
+      // The recursion limits the speed; so subtract the term of the last
+      // output after all others
+      const auto x = _mm_set_pd(second[ii], first[ii]);
+      const auto u = _mm_sub_pd(
+         _mm_sub_pd(
+            _mm_add_pd(_mm_add_pd(_mm_mul_pd(x, b0), _mm_mul_pd(x1, b1)),
+               _mm_mul_pd(x2, b2)),
+            _mm_mul_pd(u2, a2)),
+         _mm_mul_pd(u1, a1));
+      const auto y = _mm_sub_pd(
+         _mm_sub_pd(
+            _mm_add_pd(_mm_add_pd(_mm_mul_pd(u, c0), _mm_mul_pd(u1, c1)),
+               _mm_mul_pd(u2, c2)),
+            _mm_mul_pd(y2, d2)),
+         _mm_mul_pd(y1, d1));
+      x2 = x1; x1 = x;
+      u2 = u1; u1 = u;
+      y2 = y1; y1 = y;
+      power = _mm_add_pd(power, _mm_mul_pd(y, y));
+   }
+   _mm_storeu_pd(state, x1); _mm_storeu_pd(state + 2, x2);
+   _mm_storeu_pd(state + 4, u1); _mm_storeu_pd(state + 6, u2);
+   _mm_storeu_pd(state + 8, y1); _mm_storeu_pd(state + 10, y2);
+   double sums[2];
+   _mm_storeu_pd(sums, power);
+   return pair ? sums[0] + sums[1] : sums[0];
+#else
+   double result = 0;
+   for (size_t lane = 0; lane < (pair ? 2 : 1); ++lane) {
+      const auto input = lane ? second : first;
+      auto x1 = state[lane], x2 = state[2 + lane],
+         u1 = state[4 + lane], u2 = state[6 + lane],
+         y1 = state[8 + lane], y2 = state[10 + lane];
+      for (size_t ii = 0; ii < len; ++ii) {
+         const double x = input[ii];
+         const auto u =
+            x * hsf[0] + x1 * hsf[1] + x2 * hsf[2] - u2 * hsf[4] - u1 * hsf[3];
+         const auto y =
+            u * hpf[0] + u1 * hpf[1] + u2 * hpf[2] - y2 * hpf[4] - y1 * hpf[3];
+         x2 = x1; x1 = x;
+         u2 = u1; u1 = u;
+         y2 = y1; y1 = y;
+         result += y * y;
+      }
+      state[lane] = x1; state[2 + lane] = x2;
+      state[4 + lane] = u1; state[6 + lane] = u2;
+      state[8 + lane] = y1; state[10 + lane] = y2;
+   }
+   return result;
+#endif
+}
+
+void EBUR128::AddStep()
+{
+   mStepRing[mStepCount % SHORT_TERM_STEPS] = mStepPower;
+   ++mStepCount;
+   mStepPos = 0;
+   mStepPower = 0;
+   // A new full block of samples was submitted.
+   if (mStepCount >= BLOCK_STEPS)
+      AddBlockToHistogram(MeanPower(BLOCK_STEPS));
+}
+
+/// Mean power of the last nSteps complete steps, or of all samples if
+/// fewer steps are complete
+double EBUR128::MeanPower(size_t nSteps) const
+{
+   double sum = 0;
+   size_t count = 0;
+   if (mStepCount >= nSteps) {
+      for (size_t ii = mStepCount - nSteps; ii < mStepCount; ++ii)
+         sum += mStepRing[ii % SHORT_TERM_STEPS];
+      count = nSteps * mStepSize;
+   }
+   else {
+      for (size_t ii = 0; ii < mStepCount; ++ii)
+         sum += mStepRing[ii];
+      sum += mStepPower;
+      count = mStepCount * mStepSize + mStepPos;
+   }
+   return count ? sum / count : 0;
+}
+
+double EBUR128::MomentaryLoudness() const
+{
+   return K_OFFSET * MeanPower(BLOCK_STEPS);
+}
+
+double EBUR128::ShortTermLoudness() const
+{
+   return K_OFFSET * MeanPower(SHORT_TERM_STEPS);
+}
+
+double EBUR128::IntegrativeLoudness()
+{
+   // EBU R128: z_i = mean square without root
+
+   if (mHistogramLoudness)
+      return *mHistogramLoudness;
+
+   // Handle incomplete block if no non-zero block was found.
+   if(mHistogramCount == 0)
+   {
+      // One block passes the relative threshold that it sets by itself.
+      // This is not cached, because more samples may change it.
+      const auto power = MeanPower(BLOCK_STEPS);
+      return power > 0 && log10(power) > GAMMA_A ? K_OFFSET * power : 0;
+   }
+
+   // Calculate Gamma_R from histogram.
+   double sum_v;
+   long int sum_c;
+   HistogramSums(0, sum_v, sum_c);
+
+   // Histogram values are simplified log(x^2) immediate values
+   // without -0.691 + 10*(...) to safe computing power. This is
+   // possible because they will cancel out anyway.
+   // The -1 in the line below is the -10 LUFS from the EBU R128
+   // specification without the scaling factor of 10.
+   double Gamma_R = log10(sum_v/sum_c) - 1;
+   const auto idx_R =
+      round((Gamma_R - GAMMA_A) * double(HIST_BIN_COUNT) / -GAMMA_A - 1);
+
+   // Apply Gamma_R threshold and calculate gated loudness (extent).
+   // Gamma_R may lie below the absolute threshold.
+   HistogramSums(idx_R < 0 ? 0 : size_t(idx_R) + 1, sum_v, sum_c);
+   // LUFS is defined as -0.691 dB + 10*log10(sum(channels))
+   // If sum_c is 0, silence was processed.
+   mHistogramLoudness = sum_c == 0 ? 0 : K_OFFSET * sum_v / sum_c;
+   return *mHistogramLoudness;
+}
+
+void
+EBUR128::HistogramSums(size_t start_idx, double& sum_v, long int& sum_c) const
+{
+    // Values of consecutive bins are in geometric progression
+    const double ratio = pow(10, -GAMMA_A / double(HIST_BIN_COUNT));
+    double val = pow(10, -GAMMA_A / double(HIST_BIN_COUNT) * (start_idx+1) + GAMMA_A);
+    sum_v = 0;
+    sum_c = 0;
+    for(size_t i = start_idx; i < HIST_BIN_COUNT; ++i)
+    {
+       sum_v += val * mLoudnessHist[i];
+       sum_c += mLoudnessHist[i];
+       val *= ratio;
+    }
+}
+
+/// Process new full block of the given mean power. Incomplete blocks shall
+/// be discarded according to the EBU R128 specification.
+void EBUR128::AddBlockToHistogram(double power)
+{
+   // Histogram values are simplified log10() immediate values
+   // without -0.691 + 10*(...) to safe computing power. This is
+   // possible because these constant cancel out anyway during the
+   // following processing steps.
+   // Silence is below the EBU R128 absolute threshold anyway.
+   if (power <= 0)
+      return;
+   const double blockVal = log10(power);
+   // log(blockVal) is within ]-inf, 1]
+   const auto idx =
+      round((blockVal - GAMMA_A) * double(HIST_BIN_COUNT) / -GAMMA_A - 1);
+
+   // idx is within ]-inf, HIST_BIN_COUNT-1], discard indices below 0
+   // as they are below the EBU R128 absolute threshold anyway.
+   if(idx >= 0 && idx < HIST_BIN_COUNT)
+   {
+      ++mLoudnessHist[size_t(idx)];
+      ++mHistogramCount;
+      mHistogramLoudness.reset();
+   }
+}
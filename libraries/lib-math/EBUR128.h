@@ -0,0 +1,90 @@
+/**********************************************************************
+
+Audacity: A Digital Audio Editor
+
+EBUR128.h
+
+Max Maisel
+
+***********************************************************************/
+
+#ifndef __EBUR128_H__
+#define __EBUR128_H__
+
+#include "Biquad.h"
+#include <memory>
+#include <optional>
+#include "SampleFormat.h"
+
+#include <cmath>
+
+/// \brief Implements EBU-R128 loudness measurement.
+/*!
+ Samples are processed in blocks of any length.  The K-weighted power of all
+ channels is summed in steps of 100 ms; gating blocks of 400 ms overlap by
+ three steps.
+
+ Loudness values are mean squares scaled by -0.691 dB, as the specification
+ defines; IntegrativeLoudnessToLUFS converts any of them.
+ */
+class MATH_API EBUR128
+{
+public:
+   EBUR128(double rate, size_t channels);
+   EBUR128(const EBUR128&) = delete;
+   EBUR128(EBUR128&&) = delete;
+   ~EBUR128() = default;
+
+   static ArrayOf<Biquad> CalcWeightingFilter(double fs);
+
+   //! Forget all samples processed so far
+   void Reset();
+   //! Measure len samples from each of the channels given at construction
+   void ProcessSamples(const float *const channels[], size_t len);
+
+   //! Loudness of the last 400 ms, or of all samples, if fewer
+   double MomentaryLoudness() const;
+   //! Loudness of the last 3 s, or of all samples, if fewer
+   double ShortTermLoudness() const;
+   //! Gated loudness of all samples
+   double IntegrativeLoudness();
+   inline double IntegrativeLoudnessToLUFS(double loudness)
+      { return 10 * log10(loudness); }
+
+private:
+   double FilterChannels(
+      size_t channel, const float *const channels[], size_t pos, size_t len);
+   void AddStep();
+   double MeanPower(size_t nSteps) const;
+   void HistogramSums(size_t start_idx, double& sum_v, long int& sum_c) const;
+   void AddBlockToHistogram(double power);
+
+   static constexpr size_t HIST_BIN_COUNT = 65536;
+   /// EBU R128 absolute threshold
+   static constexpr double GAMMA_A = (-70.0 + 0.691) / 10.0;
+   /// -0.691 dB, as a factor of power
+   static constexpr double K_OFFSET = 0.8529037031;
+   /// Steps of 100 ms in a gating block, and in the short-term window
+   static constexpr size_t BLOCK_STEPS = 4;
+   static constexpr size_t SHORT_TERM_STEPS = 30;
+
+   ArrayOf<long int> mLoudnessHist;
+   long int mHistogramCount{ 0 };
+   /// Gated loudness of the histogram, until another block is added
+   std::optional<double> mHistogramLoudness;
+   /// Summed power of the last SHORT_TERM_STEPS steps, as a ring
+   Doubles mStepRing;
+   size_t mStepCount{ 0 };
+   size_t mStepPos{ 0 };
+   double mStepPower{ 0 };
+   const size_t mChannelCount;
+   const size_t mStepSize;
+
+   /// Coefficients of the HSF pre filter and the HPF weighting filter
+   double mCoefficients[2][5];
+   /// Filter histories of pairs of channels, interleaved by pair so that
+   /// one vector holds the same history of both channels
+   Doubles mFilterState;
+};
+
+#endif
@@ -16,9 +16,10 @@
 
       libsoxr, written by Rob Sykes. LGPL.
 
-   Since Audacity always does resampling on mono streams that are
-   contiguous in memory, this class doesn't support multiple channels
-   or some of the other optional features of some of these resamplers.
+   Channels are contiguous in memory, each in its own buffer; one
+   instance may resample several channels at once.  This class
+   doesn't support some of the other optional features of some of
+   these resamplers.
 
 *//*******************************************************************/
 
@@ -29,7 +30,18 @@
 
 #include <soxr.h>
 
-Resample::Resample(const bool useBestMethod, const double dMinFactor, const double dMaxFactor)
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <tuple>
+
+Resample::Resample(const bool useBestMethod, const double dMinFactor, const double dMaxFactor,
+   const unsigned channels)
+   : mMinFactor{ dMinFactor }, mMaxFactor{ dMaxFactor }, mChannels{ channels }
 {
    this->SetMethod(useBestMethod);
    soxr_quality_spec_t q_spec;
@@ -43,13 +55,124 @@ Resample::Resample(const bool useBestMethod, const double dMinFactor, const doub
       mbWantConstRateResampling = false; // variable rate resampling
       q_spec = soxr_quality_spec(SOXR_HQ, SOXR_VR);
    }
-   mHandle.reset(soxr_create(1, dMinFactor, 1, 0, 0, &q_spec, 0));
+   // Split channels, so that callers need not interleave
+   const auto io_spec = soxr_io_spec(SOXR_FLOAT32_S, SOXR_FLOAT32_S);
+   mHandle.reset(soxr_create(1, dMinFactor, channels, 0, &io_spec, &q_spec, 0));
 }
 
 Resample::~Resample()
 {
 }
 
+bool Resample::Reset()
+{
+   // soxr_clear() discards all state and initializes again with the same
+   // parameters, so this is safe even after flushing (see bug 2025)
+   return mHandle && !soxr_clear(mHandle.get());
+}
+
+//! Resamplers reset and ready for reuse, and a thread to reset recycled ones
+class Resample::Pool final
+{
+public:
+   static Pool &Get()
+   {
+      // Never destroyed, so that the thread need not be joined during static
+      // destruction
+      static const auto pPool = new Pool;
+      return *pPool;
+   }
+
+   std::unique_ptr<Resample> Take(int method, bool constRate,
+      double minFactor, double maxFactor, unsigned channels)
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      const Key key{ method, constRate, minFactor, maxFactor, channels };
+      // Prefer the most recently recycled
+      const auto iter = std::find_if(mReady.begin(), mReady.end(),
+         [&](const auto &entry){ return entry.first == key; });
+      if (iter == mReady.end())
+         return {};
+      auto result = move(iter->second);
+      mReady.erase(iter);
+      return result;
+   }
+
+   void Put(std::unique_ptr<Resample> pResample)
+   {
+      {
+         std::lock_guard<std::mutex> lock{ mMutex };
+         if (!mStarted) {
+            std::thread{ [this]{ Run(); } }.detach();
+            mStarted = true;
+         }
+         mRecycled.push_back(move(pResample));
+      }
+      mCondition.notify_one();
+   }
+
+private:
+   using Key = std::tuple<int, bool, double, double, unsigned>;
+
+   //! Most resamplers kept ready, for all sets of parameters together; the
+   //! least recently recycled are destroyed first
+   /*! Factors of variable rate resampling vary freely, so the sets of
+    parameters seen in a session are unbounded */
+   static constexpr size_t MaxReady = 16;
+
+   void Run()
+   {
+      std::unique_lock<std::mutex> lock{ mMutex };
+      while (true) {
+         mCondition.wait(lock, [this]{ return !mRecycled.empty(); });
+         auto pResample = move(mRecycled.front());
+         mRecycled.pop_front();
+         lock.unlock();
+         // Filters are initialized here, not in the thread that recycled
+         if (pResample->Reset()) {
+            const auto &r = *pResample;
+            Key key{ r.mMethod, r.mbWantConstRateResampling,
+               r.mMinFactor, r.mMaxFactor, r.mChannels };
+            lock.lock();
+            mReady.emplace_front(key, move(pResample));
+            if (mReady.size() > MaxReady) {
+               pResample = move(mReady.back().second);
+               mReady.pop_back();
+            }
+            lock.unlock();
+         }
+         // Destroy any resampler not kept without the lock
+         pResample.reset();
+         lock.lock();
+      }
+   }
+
+   std::mutex mMutex;
+   std::condition_variable mCondition;
+   std::deque<std::unique_ptr<Resample>> mRecycled;
+   //! Most recently recycled first
+   std::list<std::pair<Key, std::unique_ptr<Resample>>> mReady;
+   bool mStarted{ false };
+};
+
+std::unique_ptr<Resample> Resample::Acquire(const bool useBestMethod,
+   const double dMinFactor, const double dMaxFactor, const unsigned channels)
+{
+   const auto method = useBestMethod
+      ? BestMethodSetting.ReadEnum() : FastMethodSetting.ReadEnum();
+   if (auto result = Pool::Get().Take(method, dMinFactor == dMaxFactor,
+      dMinFactor, dMaxFactor, channels))
+      return result;
+   return std::make_unique<Resample>(
+      useBestMethod, dMinFactor, dMaxFactor, channels);
+}
+
+void Resample::Recycle(std::unique_ptr<Resample> pResample)
+{
+   if (pResample)
+      Pool::Get().Put(move(pResample));
+}
+
 //////////
 static const std::initializer_list<EnumValueSymbol> methodNames{
    { wxT("LowQuality"), XO("Low Quality (Fastest)") },
@@ -92,6 +215,23 @@ std::pair<size_t, size_t>
                         float       *outBuffer,
                         size_t       outBufferLen)
 {
+   assert(mChannels == 1);
+   return Process(factor, &inBuffer, inBufferLen, lastFlag,
+      &outBuffer, outBufferLen);
+}
+
+std::pair<size_t, size_t>
+      Resample::Process(double       factor,
+                        const float *const inBuffers[],
+                        size_t       inBufferLen,
+                        bool         lastFlag,
+                        float *const outBuffers[],
+                        size_t       outBufferLen)
+{
+   // With split channels, soxr takes arrays of buffer pointers
+   const auto inBuffer = static_cast<soxr_in_t>(inBuffers);
+   const auto outBuffer = static_cast<soxr_out_t>(
+      const_cast<float **>(outBuffers));
    size_t idone, odone;
    if (mbWantConstRateResampling)
    {
@@ -36,9 +36,30 @@ class MATH_API Resample final
    /// the fast method.
    // dMinFactor and dMaxFactor specify the range of factors for variable-rate resampling.
    // For constant-rate, pass the same value for both.
-   Resample(const bool useBestMethod, const double dMinFactor, const double dMaxFactor);
+   // channels is how many channels each call to Process() resamples at once,
+   // each in its own buffers.
+   Resample(const bool useBestMethod, const double dMinFactor, const double dMaxFactor,
+      const unsigned channels = 1);
    ~Resample();
 
+   unsigned Channels() const { return mChannels; }
+
+   //! Take an unused resampler with these parameters from a pool, or construct
+   //! one if there is none
+   /*! Repeated seeks, as in looped play or scrubbing, can then avoid the cost
+    of initializing filters in the thread that needs the resampler */
+   static std::unique_ptr<Resample> Acquire(const bool useBestMethod,
+      const double dMinFactor, const double dMaxFactor,
+      const unsigned channels = 1);
+
+   //! Give back a resampler no longer needed, even one that has been flushed
+   /*! It is reset in a background thread, then kept for a later Acquire() */
+   static void Recycle(std::unique_ptr<Resample> pResample);
+
+   //! Make ready to resample a new signal, as if newly constructed
+   /*! @return false if the resampler is unusable */
+   bool Reset();
+
    static EnumSetting< int > FastMethodSetting;
    static EnumSetting< int > BestMethodSetting;
 
@@ -53,7 +74,8 @@ class MATH_API Resample final
     * This function may do nothing if you don't pass a large enough output
     * buffer (i.e. there is no where to put a full block of output data)
     @param factor The scaling factor to resample by.
-    @param inBuffer Buffer of input samples to be processed (mono)
+    @param inBuffer Buffer of input samples to be processed (mono; requires
+    Channels() == 1)
     @param inBufferLen Length of the input buffer, in samples.
     @param lastFlag Flag to indicate this is the last lot of input samples and
     the buffer needs to be emptied out into the rate converter.
@@ -72,6 +94,15 @@ class MATH_API Resample final
                         float       *outBuffer,
                         size_t       outBufferLen);
 
+   //! Like the other Process(), but with buffers for each of Channels()
+   std::pair<size_t, size_t>
+                Process(double       factor,
+                        const float *const inBuffers[],
+                        size_t       inBufferLen,
+                        bool         lastFlag,
+                        float *const outBuffers[],
+                        size_t       outBufferLen);
+
  protected:
    void SetMethod(const bool useBestMethod);
 
@@ -79,6 +110,11 @@ class MATH_API Resample final
    int   mMethod; // resampler-specific enum for resampling method
    soxrHandle mHandle; // constant-rate or variable-rate resampler (XOR per instance)
    bool mbWantConstRateResampling;
+   double mMinFactor, mMaxFactor;
+   unsigned mChannels;
+
+ private:
+   class Pool;
 };
 
 #endif // __AUDACITY_RESAMPLE_H__
@@ -0,0 +1,299 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  BiquadCascadeTest.cpp
+
+**********************************************************************/
+#include "BiquadCascade.h"
+#include "Biquad.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+//! Low pass section, from the Audio EQ Cookbook
+BiquadCascade::Section LowPass(double cutoff, double q)
+{
+   const auto w = 2 * M_PI * cutoff, alpha = std::sin(w) / (2 * q),
+              a0 = 1 + alpha, c = std::cos(w);
+   return { (1 - c) / 2 / a0, (1 - c) / a0, (1 - c) / 2 / a0, -2 * c / a0,
+            (1 - alpha) / a0 };
+}
+
+std::vector<BiquadCascade::Section> MakeSections(size_t count)
+{
+   std::vector<BiquadCascade::Section> result;
+   for (size_t ii = 0; ii < count; ++ii)
+      result.push_back(LowPass(0.02 + 0.03 * ii, 0.5 + 0.8 * ii));
+   return result;
+}
+
+//! One section at a time, in double precision, as Biquad::ProcessOne
+std::vector<float> Reference(
+   const std::vector<BiquadCascade::Section>& sections,
+   const std::vector<float>& input)
+{
+   std::vector<double> signal(input.begin(), input.end());
+   for (const auto& section : sections)
+   {
+      double x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+      for (auto& sample : signal)
+      {
+         const auto y = sample * section.b0 + x1 * section.b1 +
+                        x2 * section.b2 - y1 * section.a1 - y2 * section.a2;
+         x2 = x1;
+         x1 = sample;
+         y2 = y1;
+         y1 = y;
+         sample = y;
+      }
+   }
+   return { signal.begin(), signal.end() };
+}
+
+std::vector<std::vector<float>> Noise(size_t nChannels, size_t len)
+{
+   std::mt19937 engine { 7 };
+   std::uniform_real_distribution<float> distribution { -1.f, 1.f };
+   std::vector<std::vector<float>> result(nChannels, std::vector<float>(len));
+   for (auto& channel : result)
+      std::generate(
+         channel.begin(), channel.end(), [&] { return distribution(engine); });
+   return result;
+}
+
+//! Shelving section of Bass and Treble, with its coefficients
+BiquadCascade::Section Shelf(double hz, double gain, double rate, bool bass)
+{
+   const double w = 2 * M_PI * hz / rate, slope = 0.4,
+                a = std::exp(std::log(10.0) * gain / 40),
+                b = std::sqrt((a * a + 1) / slope - std::pow(a - 1, 2)),
+                c = std::cos(w), s = std::sin(w), sign = bass ? 1 : -1;
+   const double a0 = (a + 1) + sign * (a - 1) * c + b * s;
+   return { a * ((a + 1) - sign * (a - 1) * c + b * s) / a0,
+            sign * 2 * a * ((a - 1) - sign * (a + 1) * c) / a0,
+            a * ((a + 1) - sign * (a - 1) * c - b * s) / a0,
+            -sign * 2 * ((a - 1) + sign * (a + 1) * c) / a0,
+            ((a + 1) + sign * (a - 1) * c - b * s) / a0 };
+}
+
+Biquad MakeBiquad(const BiquadCascade::Section& section)
+{
+   Biquad result;
+   result.fNumerCoeffs[Biquad::B0] = section.b0;
+   result.fNumerCoeffs[Biquad::B1] = section.b1;
+   result.fNumerCoeffs[Biquad::B2] = section.b2;
+   result.fDenomCoeffs[Biquad::A1] = section.a1;
+   result.fDenomCoeffs[Biquad::A2] = section.a2;
+   return result;
+}
+
+//! Largest difference of the cascade from Biquad::Process applied section by
+//! section, as the effects did before, relative to the largest output
+double ChainDifference(
+   std::vector<Biquad> biquads, const std::vector<float>& input)
+{
+   auto expected = input;
+   for (auto& biquad : biquads)
+      biquad.Process(expected.data(), expected.data(), expected.size());
+
+   std::vector<BiquadCascade::Section> sections;
+   for (const auto& biquad : biquads)
+      sections.push_back(biquad.GetSection());
+   BiquadCascade cascade;
+   cascade.SetSections(sections.data(), sections.size());
+   auto actual = input;
+   const float* in[] { actual.data() };
+   float* out[] { actual.data() };
+   cascade.Process(in, out, actual.size());
+
+   double difference = 0, peak = 0;
+   for (size_t ii = 0; ii < input.size(); ++ii)
+   {
+      difference =
+         std::max<double>(difference, std::abs(actual[ii] - expected[ii]));
+      peak = std::max<double>(peak, std::abs(expected[ii]));
+   }
+   return difference / peak;
+}
+
+void Process(BiquadCascade& cascade, std::vector<std::vector<float>>& channels,
+   size_t offset, size_t len)
+{
+   std::vector<const float*> in;
+   std::vector<float*> out;
+   for (auto& channel : channels)
+   {
+      in.push_back(channel.data() + offset);
+      out.push_back(channel.data() + offset);
+   }
+   cascade.Process(in.data(), out.data(), len);
+}
+} // namespace
+
+TEST_CASE("BiquadCascade matches one section at a time")
+{
+   constexpr size_t len = 10000;
+   const auto nSections = GENERATE(0, 1, 2, 5, 7);
+   const auto nChannels = GENERATE(1, 2, 3);
+   const auto sections = MakeSections(nSections);
+   auto channels = Noise(nChannels, len);
+   std::vector<std::vector<float>> expected;
+   for (const auto& channel : channels)
+      expected.push_back(Reference(sections, channel));
+
+   BiquadCascade cascade { size_t(nChannels) };
+   cascade.SetSections(sections.data(), sections.size());
+   Process(cascade, channels, 0, len);
+   for (size_t channel = 0; channel < channels.size(); ++channel)
+      for (size_t ii = 0; ii < len; ++ii)
+         REQUIRE(
+            channels[channel][ii] ==
+            Approx(expected[channel][ii]).margin(1e-5));
+}
+
+TEST_CASE("BiquadCascade matches the Biquad chains of the effects")
+{
+   const auto input = Noise(1, 20000)[0];
+
+   SECTION("Bass and Treble")
+   {
+      for (const double rate : { 8000., 44100., 96000. })
+         for (const double bass : { -30., -6., 0., 12., 30. })
+            for (const double treble : { -30., 0., 6., 30. })
+            {
+               const std::vector<Biquad> biquads {
+                  MakeBiquad(Shelf(250, bass, rate, true)),
+                  MakeBiquad(Shelf(4000, treble, rate, false))
+               };
+               REQUIRE(ChainDifference(biquads, input) < 1e-5);
+            }
+   }
+
+   SECTION("Classic Filters")
+   {
+      // Filters of each order and kind, normalized cutoffs from very low
+      // to near Nyquist, and ripples as the effect allows them
+      for (int order = Biquad::MIN_Order; order <= Biquad::MAX_Order; ++order)
+         for (const int type : { Biquad::kLowPass, Biquad::kHighPass })
+            for (const double cutoff : { 0.002, 0.05, 0.45 })
+               for (int kind = 0; kind < 3; ++kind)
+               {
+                  const auto filter =
+                     kind == 0 ?
+                        Biquad::CalcButterworthFilter(order, 1, cutoff, type) :
+                     kind == 1 ? Biquad::CalcChebyshevType1Filter(
+                                    order, 1, cutoff, 1.0, type) :
+                                 Biquad::CalcChebyshevType2Filter(
+                                    order, 1, cutoff, 30.0, type);
+                  const std::vector<Biquad> biquads(
+                     filter.get(), filter.get() + (order + 1) / 2);
+                  REQUIRE(ChainDifference(biquads, input) < 1e-5);
+               }
+   }
+}
+
+TEST_CASE("BiquadCascade gives the same results in any blocks and lanes")
+{
+   constexpr size_t len = 3 * BiquadCascade::MaxPiece + 100;
+   const auto sections = MakeSections(6);
+   const auto input = Noise(3, len);
+
+   auto whole = input;
+   BiquadCascade cascade { 3 };
+   cascade.SetSections(sections.data(), sections.size());
+   Process(cascade, whole, 0, len);
+
+   auto blocks = input;
+   cascade.Reset();
+   for (size_t offset = 0, size = 1; offset < len; size = size * 3 % 997 + 1)
+   {
+      const auto count = std::min(size, len - offset);
+      Process(cascade, blocks, offset, count);
+      offset += count;
+   }
+   REQUIRE(blocks == whole);
+
+   // Each channel alone, as the first of a pair, or alone in the last pair
+   for (size_t channel = 0; channel < 3; ++channel)
+   {
+      std::vector<std::vector<float>> one { input[channel] };
+      BiquadCascade mono;
+      mono.SetSections(sections.data(), sections.size());
+      Process(mono, one, 0, len);
+      REQUIRE(one[0] == whole[channel]);
+   }
+}
+
+TEST_CASE("BiquadCascade keeps histories when coefficients change")
+{
+   constexpr size_t len = 2000;
+   const auto sections = MakeSections(2);
+   const auto input = Noise(1, len);
+
+   auto once = input;
+   BiquadCascade cascade;
+   cascade.SetSections(sections.data(), sections.size());
+   Process(cascade, once, 0, len);
+
+   auto twice = input;
+   cascade.Reset();
+   Process(cascade, twice, 0, len / 2);
+   cascade.SetSections(sections.data(), sections.size());
+   Process(cascade, twice, len / 2, len - len / 2);
+   REQUIRE(twice == once);
+}
+
+TEST_CASE("BiquadCascade decays to exact silence")
+{
+   // A resonant section rings for a long time after an impulse
+   const BiquadCascade::Section sections[] { LowPass(0.001, 20) };
+   BiquadCascade cascade;
+   cascade.SetSections(sections, 1);
+   std::vector<std::vector<float>> signal { std::vector<float>(4000000) };
+   signal[0][0] = 1;
+   Process(cascade, signal, 0, signal[0].size());
+   REQUIRE(signal[0][1000] != 0);
+   REQUIRE(signal[0].back() == 0);
+}
+
+// Hidden; run with the [benchmark] tag
+TEST_CASE("BiquadCascade throughput", "[.][benchmark]")
+{
+   using namespace std::chrono;
+   constexpr size_t len = 1 << 20;
+   const auto sections = MakeSections(5);
+   for (const size_t nChannels : { 1, 2 })
+   {
+      const auto input = Noise(nChannels, len);
+
+      // As Biquad::Process: a pass for each section and channel
+      auto start = steady_clock::now();
+      std::vector<std::vector<float>> expected;
+      for (const auto& channel : input)
+         expected.push_back(Reference(sections, channel));
+      const auto separate =
+         duration<double, std::milli>(steady_clock::now() - start).count();
+
+      auto channels = input;
+      BiquadCascade cascade { nChannels };
+      cascade.SetSections(sections.data(), sections.size());
+      start = steady_clock::now();
+      Process(cascade, channels, 0, len);
+      const auto fused =
+         duration<double, std::milli>(steady_clock::now() - start).count();
+      REQUIRE(channels[0][len - 1] == Approx(expected[0][len - 1]).margin(1e-5));
+
+      std::cout << nChannels << " channel(s), 10th order: " << separate
+                << " ms section by section, " << fused << " ms fused\n";
+   }
+}
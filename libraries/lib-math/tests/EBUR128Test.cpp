@@ -0,0 +1,180 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  EBUR128Test.cpp
+
+**********************************************************************/
+#include "EBUR128.h"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+//! The measurement as EBUR128 made it before it processed blocks: each
+//! sample filtered by a Biquad of each channel, and the power of the last
+//! 400 ms summed again at each 100 ms step
+class PerSampleLoudness
+{
+public:
+   PerSampleLoudness(double rate, size_t channels)
+       : mBlockSize(std::ceil(0.4 * rate))
+       , mBlockOverlap(std::ceil(0.1 * rate))
+       , mRing(mBlockSize)
+       , mHistogram(HistBinCount)
+   {
+      for (size_t channel = 0; channel < channels; ++channel)
+         mFilters.push_back(EBUR128::CalcWeightingFilter(rate));
+   }
+
+   void Process(const std::vector<std::vector<float>>& channels)
+   {
+      for (size_t ii = 0, len = channels[0].size(); ii < len; ++ii)
+      {
+         for (size_t channel = 0; channel < channels.size(); ++channel)
+         {
+            auto& filter = mFilters[channel];
+            const double value =
+               filter[1].ProcessOne(filter[0].ProcessOne(channels[channel][ii]));
+            if (channel == 0)
+               mRing[mRingPos] = value * value;
+            else
+               mRing[mRingPos] += value * value;
+         }
+         ++mRingPos;
+         ++mRingSize;
+         if (mRingPos % mBlockOverlap == 0 && mRingSize >= mBlockSize)
+            AddBlock(mBlockSize);
+         if (mRingPos == mBlockSize)
+            mRingPos = 0;
+      }
+   }
+
+   double IntegrativeLoudness()
+   {
+      double sum;
+      long count;
+      Sums(0, sum, count);
+      if (count == 0)
+      {
+         AddBlock(mRingSize);
+         Sums(0, sum, count);
+      }
+      const double gammaR = std::log10(sum / count) - 1;
+      const size_t indexR =
+         std::round((gammaR - GammaA) * double(HistBinCount) / -GammaA - 1);
+      Sums(indexR + 1, sum, count);
+      return count == 0 ? 0 : 0.8529037031 * sum / count;
+   }
+
+private:
+   static constexpr size_t HistBinCount = 65536;
+   static constexpr double GammaA = (-70.0 + 0.691) / 10.0;
+
+   void Sums(size_t start, double& sum, long& count) const
+   {
+      sum = 0;
+      count = 0;
+      for (size_t ii = start; ii < HistBinCount; ++ii)
+      {
+         const double value =
+            -GammaA / double(HistBinCount) * (ii + 1) + GammaA;
+         sum += std::pow(10, value) * mHistogram[ii];
+         count += mHistogram[ii];
+      }
+   }
+
+   void AddBlock(size_t validLen)
+   {
+      mRingSize = mBlockSize;
+      double power = 0;
+      for (size_t ii = 0; ii < validLen; ++ii)
+         power += mRing[ii];
+      power = std::log10(power / double(validLen));
+      const size_t index =
+         std::round((power - GammaA) * double(HistBinCount) / -GammaA - 1);
+      if (index < HistBinCount)
+         ++mHistogram[index];
+   }
+
+   const size_t mBlockSize;
+   const size_t mBlockOverlap;
+   std::vector<ArrayOf<Biquad>> mFilters;
+   std::vector<double> mRing;
+   size_t mRingPos { 0 };
+   size_t mRingSize { 0 };
+   std::vector<long> mHistogram;
+};
+
+double ToLUFS(double loudness)
+{
+   return 10 * std::log10(loudness);
+}
+} // namespace
+
+TEST_CASE("EBUR128 agrees with the per-sample measurement")
+{
+   std::mt19937 engine { 5 };
+   std::normal_distribution<float> noise;
+   // Rates whose 100 ms steps divide the 400 ms blocks exactly, as they
+   // must for the old block boundaries to be the same
+   for (const double rate : { 8000., 44100., 48000., 96000. })
+      for (const size_t nChannels : { 1, 2, 3 })
+         for (const double seconds : { 0.5, 5.0 })
+         {
+            const size_t len = seconds * rate;
+            std::vector<std::vector<float>> channels(
+               nChannels, std::vector<float>(len));
+            // Noise that changes level every third of a second, sometimes
+            // below the absolute gate
+            float amplitude = 0.1f;
+            for (size_t ii = 0; ii < len; ++ii)
+            {
+               if (ii % size_t(rate / 3) == 0)
+                  amplitude = std::pow(10.f, -float(engine() % 60) / 20.f) *
+                              (engine() % 7 == 0 ? 0 : 1);
+               for (size_t channel = 0; channel < nChannels; ++channel)
+                  channels[channel][ii] =
+                     amplitude * noise(engine) * (channel + 1) * 0.3f;
+            }
+
+            PerSampleLoudness reference { rate, nChannels };
+            reference.Process(channels);
+
+            // Blocks of varying lengths, not aligned with the steps
+            EBUR128 loudness { rate, nChannels };
+            std::vector<const float*> pointers(nChannels);
+            for (size_t pos = 0, blockLen = 1000; pos < len;)
+            {
+               const auto count = std::min(blockLen, len - pos);
+               for (size_t channel = 0; channel < nChannels; ++channel)
+                  pointers[channel] = channels[channel].data() + pos;
+               loudness.ProcessSamples(pointers.data(), count);
+               pos += count;
+               blockLen = blockLen * 7 % 4093 + 1;
+            }
+
+            const auto expected = ToLUFS(reference.IntegrativeLoudness());
+            const auto actual = ToLUFS(loudness.IntegrativeLoudness());
+            REQUIRE(std::abs(actual - expected) < 0.01);
+         }
+}
+
+TEST_CASE("EBUR128 measures a full scale sine in one channel at -3.01 LUFS")
+{
+   constexpr double rate = 48000;
+   std::vector<float> sine(5 * rate);
+   for (size_t ii = 0; ii < sine.size(); ++ii)
+      sine[ii] = std::sin(2 * M_PI * 997 * ii / rate);
+   const float* channels[] { sine.data() };
+   EBUR128 loudness { rate, 1 };
+   loudness.ProcessSamples(channels, sine.size());
+   REQUIRE(std::abs(ToLUFS(loudness.IntegrativeLoudness()) + 3.01) < 0.01);
+   REQUIRE(std::abs(ToLUFS(loudness.MomentaryLoudness()) + 3.01) < 0.01);
+   REQUIRE(std::abs(ToLUFS(loudness.ShortTermLoudness()) + 3.01) < 0.01);
+}
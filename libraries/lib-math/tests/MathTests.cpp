@@ -8,10 +8,20 @@
   Matthieu Hodgkinson
 
 **********************************************************************/
+#include "Dither.h"
 #include "LinearFit.h"
 
 #include <catch2/catch.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
 TEST_CASE("LinearFit")
 {
    SECTION("exact fit, no weights")
@@ -63,3 +73,199 @@ TEST_CASE("LinearFit")
       REQUIRE(result.second == 0.0);
    }
 }
+
+namespace
+{
+// Interleaved buffers of random samples, with some floats out of range
+std::vector<char> RandomSamples(sampleFormat format, size_t count)
+{
+   std::mt19937 engine { 42 };
+   std::vector<char> result(count * SAMPLE_SIZE(format));
+   for (size_t ii = 0; ii < count; ++ii)
+   {
+      if (format == int16Sample)
+         reinterpret_cast<short*>(result.data())[ii] = engine();
+      else if (format == int24Sample)
+         reinterpret_cast<int*>(result.data())[ii] =
+            int(engine() % (1 << 24)) - (1 << 23);
+      else
+         reinterpret_cast<float*>(result.data())[ii] =
+            std::uniform_real_distribution<float> { -1.2f, 1.2f }(engine);
+   }
+   return result;
+}
+
+// The value of sample `ii` of a buffer, as float in [-1, 1]
+float ReadSample(const std::vector<char>& buffer, sampleFormat format, size_t ii)
+{
+   if (format == int16Sample)
+      return reinterpret_cast<const short*>(buffer.data())[ii] / 32768.0f;
+   if (format == int24Sample)
+      return reinterpret_cast<const int*>(buffer.data())[ii] / 8388608.0f;
+   return reinterpret_cast<const float*>(buffer.data())[ii];
+}
+
+std::vector<char> Convert(
+   DitherType ditherType, const std::vector<char>& source,
+   sampleFormat sourceFormat, sampleFormat destFormat, unsigned len,
+   unsigned sourceStride, unsigned destStride, bool vectorised)
+{
+   Dither::SetVectorised(vectorised);
+   Dither::ResetNoise();
+   std::vector<char> dest(len * destStride * SAMPLE_SIZE(destFormat));
+   Dither {}.Apply(
+      ditherType, source.data(), sourceFormat, dest.data(), destFormat, len,
+      sourceStride, destStride);
+   return dest;
+}
+
+const sampleFormat formats[] { int16Sample, int24Sample, floatSample };
+} // namespace
+
+TEST_CASE("Dither::Apply converts without dither exactly")
+{
+   constexpr unsigned len = 1001;
+   for (const auto sourceFormat : formats)
+      for (const auto destFormat : formats)
+         for (const auto stride : { 1u, 2u, 3u })
+         {
+            const auto source = RandomSamples(sourceFormat, len * stride);
+            const auto dest = Convert(
+               DitherType::none, source, sourceFormat, destFormat, len,
+               stride, 1, Dither::IsVectorised());
+            const auto scale = destFormat == int16Sample ? 32768.0f :
+                               destFormat == int24Sample ? 8388608.0f :
+                                                           1.0f;
+            for (size_t ii = 0; ii < len; ++ii)
+            {
+               auto expected = ReadSample(source, sourceFormat, ii * stride);
+               if (destFormat != floatSample)
+                  expected = std::min(
+                     std::nearbyint(std::clamp(expected, -1.0f, 1.0f) * scale),
+                     scale - 1) / scale;
+               REQUIRE(ReadSample(dest, destFormat, ii) == expected);
+            }
+         }
+}
+
+TEST_CASE("Dither::Apply gives the same results vectorised and scalar")
+{
+   const auto vectorised = Dither::IsVectorised();
+   for (const auto ditherType : { DitherType::none, DitherType::rectangle,
+                                  DitherType::triangle, DitherType::shaped })
+      for (const auto sourceFormat : formats)
+         for (const auto destFormat : formats)
+            for (const auto len : { 3u, 257u, 1000u })
+               for (const auto& [sourceStride, destStride] :
+                    { std::pair { 1u, 1u }, { 2u, 1u }, { 1u, 2u }, { 3u, 2u } })
+               {
+                  const auto source =
+                     RandomSamples(sourceFormat, len * sourceStride);
+                  const auto scalar = Convert(
+                     ditherType, source, sourceFormat, destFormat, len,
+                     sourceStride, destStride, false);
+                  const auto simd = Convert(
+                     ditherType, source, sourceFormat, destFormat, len,
+                     sourceStride, destStride, true);
+                  REQUIRE(scalar == simd);
+               }
+   Dither::SetVectorised(vectorised);
+}
+
+TEST_CASE("Triangle dither stays within one step and has no offset")
+{
+   constexpr unsigned len = 100000;
+   const auto source = RandomSamples(floatSample, len);
+   const auto dest = Convert(
+      DitherType::triangle, source, floatSample, int16Sample, len, 1, 1,
+      Dither::IsVectorised());
+   double sum = 0;
+   size_t count = 0;
+   for (size_t ii = 0; ii < len; ++ii)
+   {
+      // Skip samples near full scale, where clipping adds error
+      const auto exact = ReadSample(source, floatSample, ii) * 32768;
+      if (std::abs(exact) > 32000)
+         continue;
+      const auto error = ReadSample(dest, int16Sample, ii) * 32768 - exact;
+      REQUIRE(std::abs(error) < 1.5);
+      sum += error;
+      ++count;
+   }
+   REQUIRE(std::abs(sum / count) < 0.01);
+}
+
+TEST_CASE("Dither noise differs between threads unless reset")
+{
+   constexpr unsigned len = 1000;
+   const auto source = RandomSamples(floatSample, len);
+   const auto convert = [&](bool reset) {
+      std::vector<char> dest;
+      std::thread { [&] {
+         if (reset)
+            dest = Convert(
+               DitherType::triangle, source, floatSample, int16Sample, len,
+               1, 1, Dither::IsVectorised());
+         else
+         {
+            dest.resize(len * SAMPLE_SIZE(int16Sample));
+            Dither {}.Apply(
+               DitherType::triangle, source.data(), floatSample, dest.data(),
+               int16Sample, len);
+         }
+      } }.join();
+      return dest;
+   };
+   REQUIRE(convert(false) != convert(false));
+   REQUIRE(convert(true) == convert(true));
+}
+
+// Hidden; run with the [benchmark] tag
+TEST_CASE("Dither::Apply throughput", "[.][benchmark]")
+{
+   constexpr unsigned len = 1 << 16;
+   constexpr auto repeats = 500;
+   const auto vectorised = Dither::IsVectorised();
+   const auto time = [&](DitherType ditherType, sampleFormat sourceFormat,
+                         sampleFormat destFormat, unsigned sourceStride,
+                         bool vectorised) {
+      const auto source = RandomSamples(sourceFormat, len * sourceStride);
+      std::vector<char> dest(len * SAMPLE_SIZE(destFormat));
+      Dither::SetVectorised(vectorised);
+      const auto start = std::chrono::steady_clock::now();
+      for (auto ii = 0; ii < repeats; ++ii)
+         Dither {}.Apply(
+            ditherType, source.data(), sourceFormat, dest.data(), destFormat,
+            len, sourceStride);
+      return std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start)
+         .count();
+   };
+   const struct
+   {
+      const char* name;
+      DitherType ditherType;
+      sampleFormat sourceFormat, destFormat;
+      unsigned sourceStride;
+   } cases[] {
+      { "int16 to float", DitherType::none, int16Sample, floatSample, 1 },
+      { "stereo int16 to float", DitherType::none, int16Sample, floatSample, 2 },
+      { "int24 to float", DitherType::none, int24Sample, floatSample, 1 },
+      { "float to int16", DitherType::none, floatSample, int16Sample, 1 },
+      { "float to int16, triangle", DitherType::triangle, floatSample,
+        int16Sample, 1 },
+      { "float to int16, shaped", DitherType::shaped, floatSample, int16Sample,
+        1 },
+      { "float to int24, rectangle", DitherType::rectangle, floatSample,
+        int24Sample, 1 },
+   };
+   for (const auto& c : cases)
+      std::cout << c.name << ": scalar "
+                << time(c.ditherType, c.sourceFormat, c.destFormat,
+                        c.sourceStride, false)
+                << " ms, vectorised "
+                << time(c.ditherType, c.sourceFormat, c.destFormat,
+                        c.sourceStride, true)
+                << " ms for " << repeats << " x " << len << " samples\n";
+   Dither::SetVectorised(vectorised);
+}
@@ -14,6 +14,7 @@
 #include "EffectStage.h"
 #include "AudacityException.h"
 #include "AudioGraphBuffers.h"
+#include "AudioTrace.h"
 #include "WideSampleSequence.h"
 #include <cassert>
 
@@ -118,6 +119,8 @@ std::optional<size_t> EffectStage::Acquire(Buffers &data, size_t bound)
    assert(AcceptsBlockSize(data.BlockSize()));
    // pre, needed for Process() and Discard()
    assert(bound <= std::min(data.BlockSize(), data.Remaining()));
+   auto stopwatch =
+      AudioTrace::CreateStopwatch(AudioTrace::SectionID::EffectStage);
 
    // For each input block of samples, we pass it to the effect along with a
    // variable output location.  This output location is simply a pointer into a
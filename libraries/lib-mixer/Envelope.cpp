@@ -32,6 +32,13 @@ a draggable point type.
 #include <float.h>
 #include <math.h>
 
+#include <algorithm>
+
+#if defined(__SSE2__) || (defined(_M_AMD64) || defined(_M_X64))
+#include <emmintrin.h>
+#define ENVELOPE_SSE2
+#endif
+
 #include <wx/wxcrtvararg.h>
 #include <wx/brush.h>
 #include <wx/pen.h>
@@ -942,119 +949,187 @@ void Envelope::GetValues( double *buffer, int bufferLen,
    GetValuesRelative( buffer, bufferLen, t0, tstep);
 }
 
+namespace {
+//! dst[i] = start + i * step, computed from the index so that no error
+//! accumulates along the segment
+void FillRamp(double *dst, int count, double start, double step)
+{
+   int i = 0;
+#ifdef ENVELOPE_SSE2
+   const auto vStart = _mm_set1_pd(start);
+   const auto vStep = _mm_set1_pd(step);
+   const auto two = _mm_set1_pd(2.0);
+   auto index = _mm_set_pd(1.0, 0.0);
+   for (; i + 2 <= count; i += 2) {
+      _mm_storeu_pd(dst + i, _mm_add_pd(vStart, _mm_mul_pd(index, vStep)));
+      index = _mm_add_pd(index, two);
+   }
+#endif
+   for (; i < count; ++i)
+      dst[i] = start + i * step;
+}
+
+//! dst[i] = pow(10, logStart + i * logStep), by a recurrence that is
+//! re-anchored often enough to keep the rounding error negligible
+void FillExponentialRamp(double *dst, int count, double logStart, double logStep)
+{
+   constexpr int AnchorInterval = 64;
+   const auto ratio = pow(10.0, logStep);
+   for (int i = 0; i < count; i += AnchorInterval) {
+      auto value = pow(10.0, logStart + i * logStep);
+      for (int j = i, end = std::min(count, i + AnchorInterval); j < end; ++j) {
+         dst[j] = value;
+         value *= ratio;
+      }
+   }
+}
+
+//! Given `pred(first)`, find the least index in (first, last] for which
+//! `pred` fails, or `last`, assuming `pred` is monotone
+template<typename Pred> int RunEnd(int first, int last, const Pred &pred)
+{
+   // Gallop, then bisect
+   int lo = first, hi = first;
+   for (int step = 1;; step *= 2) {
+      hi = lo + step;
+      if (hi >= last) {
+         hi = last;
+         break;
+      }
+      if (!pred(hi))
+         break;
+      lo = hi;
+   }
+   while (hi - lo > 1) {
+      const auto mid = lo + (hi - lo) / 2;
+      (pred(mid) ? lo : hi) = mid;
+   }
+   return hi;
+}
+}
+
 void Envelope::GetValuesRelative
    (double *buffer, int bufferLen, double t0, double tstep, bool leftLimit)
    const
 {
    // JC: If bufferLen ==0 we have probably just allocated a zero sized buffer.
    // wxASSERT( bufferLen > 0 );
+   if (bufferLen <= 0)
+      return;
 
-   const auto epsilon = tstep / 2;
-   int len = mEnv.size();
-
-   double t = t0;
-   double increment = 0;
-   if ( len > 1 && t <= mEnv[0].GetT() && mEnv[0].GetT() == mEnv[1].GetT() )
-      increment = leftLimit ? -epsilon : epsilon;
+   // Get easiest cases out the way first...
+   // IF empty envelope THEN default value
+   const int len = mEnv.size();
+   if (len == 0) {
+      std::fill(buffer, buffer + bufferLen, mDefaultValue);
+      return;
+   }
 
-   double tprev, vprev, tnext = 0, vnext, vstep = 0;
+   // Evaluate one segment between points (or one run before or after all
+   // points) at a time.  Sample times are computed from the index, not
+   // accumulated.
+   const auto tFirst = mEnv[0].GetT();
+   const auto tLast = mEnv[len - 1].GetT();
 
-   for (int b = 0; b < bufferLen; b++) {
+   // Sample times are nudged toward the chosen side of a discontinuity by
+   // half a sample, but never by less than the roundoff in computing them
+   // (here or in GetValues()), so that GetValue() at a sample time picks the
+   // same side as GetValues() does for that sample
+   const auto roundoff =
+      8 * DBL_EPSILON * (fabs(mOffset) + std::max(fabs(t0), fabs(tLast)));
+   const auto epsilon = std::max(tstep / 2, roundoff);
 
-      // Get easiest cases out the way first...
-      // IF empty envelope THEN default value
-      if (len <= 0) {
-         buffer[b] = mDefaultValue;
-         t += tstep;
-         continue;
-      }
+   double increment = 0;
+   if ( len > 1 && t0 <= tFirst && tFirst == mEnv[1].GetT() )
+      increment = leftLimit ? -epsilon : epsilon;
 
-      auto tplus = t + increment;
+   const auto tPlus = [&](int b){ return t0 + b * tstep + increment; };
+   const auto isBefore = [&](int b){
+      const auto tplus = tPlus(b);
+      return leftLimit ? tplus <= tFirst : tplus < tFirst;
+   };
+   const auto isAfter = [&](int b){
+      const auto tplus = tPlus(b);
+      return leftLimit ? tplus > tLast : tplus >= tLast;
+   };
 
+   for (int b = 0; b < bufferLen;) {
       // IF before envelope THEN first value
-      if ( leftLimit ? tplus <= mEnv[0].GetT() : tplus < mEnv[0].GetT() ) {
-         buffer[b] = mEnv[0].GetVal();
-         t += tstep;
+      if (isBefore(b)) {
+         const auto end = RunEnd(b, bufferLen, isBefore);
+         std::fill(buffer + b, buffer + end, mEnv[0].GetVal());
+         b = end;
          continue;
       }
-      // IF after envelope THEN last value
-      if ( leftLimit
-            ? tplus > mEnv[len - 1].GetT() : tplus >= mEnv[len - 1].GetT() ) {
-         buffer[b] = mEnv[len - 1].GetVal();
-         t += tstep;
-         continue;
+      // IF after envelope THEN last value, for the rest of the buffer
+      if (isAfter(b)) {
+         std::fill(buffer + b, buffer + bufferLen, mEnv[len - 1].GetVal());
+         return;
       }
 
-      // be careful to get the correct limit even in case epsilon == 0
-      if ( b == 0 ||
-           ( leftLimit ? tplus > tnext : tplus >= tnext ) ) {
-
-         // We're beyond our tnext, so find the next one.
-         // Don't just increment lo or hi because we might
-         // be zoomed far out and that could be a large number of
-         // points to move over.  That's why we binary search.
-
-         int lo,hi;
-         if ( leftLimit )
-            BinarySearchForTime_LeftLimit( lo, hi, tplus );
-         else
-            BinarySearchForTime( lo, hi, tplus );
-
-         // mEnv[0] is before tplus because of eliminations above, therefore lo >= 0
-         // mEnv[len - 1] is after tplus, therefore hi <= len - 1
-         wxASSERT( lo >= 0 && hi <= len - 1 );
-
-         tprev = mEnv[lo].GetT();
-         tnext = mEnv[hi].GetT();
-
-         if ( hi + 1 < len && tnext == mEnv[ hi + 1 ].GetT() )
-            // There is a discontinuity after this point-to-point interval.
-            // Usually will stop evaluating in this interval when time is slightly
-            // before tNext, then use the right limit.
-            // This is the right intent
-            // in case small roundoff errors cause a sample time to be a little
-            // before the envelope point time.
-            // Less commonly we want a left limit, so we continue evaluating in
-            // this interval until shortly after the discontinuity.
-            increment = leftLimit ? -epsilon : epsilon;
-         else
-            increment = 0;
-
-         vprev = GetInterpolationStartValueAtPoint( lo );
-         vnext = GetInterpolationStartValueAtPoint( hi );
-
-         // Interpolate, either linear or log depending on mDB.
-         double dt = (tnext - tprev);
-         double to = t - tprev;
-         double v;
-         if (dt > 0.0)
-         {
-            v = (vprev * (dt - to) + vnext * to) / dt;
-            vstep = (vnext - vprev) * tstep / dt;
-         }
+      // Find the point-to-point interval.  Don't just increment lo or hi
+      // because we might be zoomed far out and that could be a large number
+      // of points to move over.  That's why we binary search.
+      int lo, hi;
+      if ( leftLimit )
+         BinarySearchForTime_LeftLimit( lo, hi, tPlus(b) );
+      else
+         BinarySearchForTime( lo, hi, tPlus(b) );
+
+      // mEnv[0] is before tplus because of eliminations above, therefore lo >= 0
+      // mEnv[len - 1] is after tplus, therefore hi <= len - 1
+      wxASSERT( lo >= 0 && hi <= len - 1 );
+
+      const auto tprev = mEnv[lo].GetT();
+      const auto tnext = mEnv[hi].GetT();
+
+      if ( hi + 1 < len && tnext == mEnv[ hi + 1 ].GetT() )
+         // There is a discontinuity after this point-to-point interval.
+         // Usually will stop evaluating in this interval when time is slightly
+         // before tNext, then use the right limit.
+         // This is the right intent
+         // in case small roundoff errors cause a sample time to be a little
+         // before the envelope point time.
+         // Less commonly we want a left limit, so we continue evaluating in
+         // this interval until shortly after the discontinuity.
+         increment = leftLimit ? -epsilon : epsilon;
+      else
+         increment = 0;
+
+      // The samples after the first that remain in the interval, with the
+      // new increment; be careful to get the correct limit even in case
+      // epsilon == 0
+      const auto isInside = [&](int b){
+         const auto tplus = tPlus(b);
+         return leftLimit ? tplus <= tnext : tplus < tnext;
+      };
+      // The nudge applies to this sample too, though it was found without;
+      // the side chosen must not depend on where the buffer begins
+      if (!isInside(b))
+         continue;
+      const auto end = (b + 1 < bufferLen && isInside(b + 1))
+         ? RunEnd(b + 1, bufferLen, isInside)
+         : b + 1;
+
+      const auto vprev = GetInterpolationStartValueAtPoint( lo );
+      const auto vnext = GetInterpolationStartValueAtPoint( hi );
+
+      // Interpolate, either linear or log depending on mDB.
+      const double dt = (tnext - tprev);
+      if (dt <= 0.0 || vprev == vnext) {
+         const auto v = mDB ? pow(10.0, vnext) : vnext;
+         std::fill(buffer + b, buffer + end, v);
+      }
+      else {
+         const double to = t0 + b * tstep - tprev;
+         const auto v = (vprev * (dt - to) + vnext * to) / dt;
+         const auto vstep = (vnext - vprev) * tstep / dt;
+         if (mDB)
+            FillExponentialRamp(buffer + b, end - b, v, vstep);
          else
-         {
-            v = vnext;
-            vstep = 0.0;
-         }
-
-         // An adjustment if logarithmic scale.
-         if( mDB )
-         {
-            v = pow(10.0, v);
-            vstep = pow( 10.0, vstep );
-         }
-
-         buffer[b] = v;
-      } else {
-         if (mDB){
-            buffer[b] = buffer[b - 1] * vstep;
-         }else{
-            buffer[b] = buffer[b - 1] + vstep;
-         }
+            FillRamp(buffer + b, end - b, v, vstep);
       }
-
-      t += tstep;
+      b = end;
    }
 }
 
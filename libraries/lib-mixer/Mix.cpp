@@ -18,6 +18,7 @@
 #include "MixerSource.h"
 
 #include <cmath>
+#include "AudioTrace.h"
 #include "EffectStage.h"
 #include "Dither.h"
 #include "Resample.h"
@@ -271,6 +272,8 @@ static void MixBuffers(unsigned numChannels,
 size_t Mixer::Process(const size_t maxToProcess)
 {
    assert(maxToProcess <= BufferSize());
+   auto stopwatch =
+      AudioTrace::CreateStopwatch(AudioTrace::SectionID::MixerProcess);
 
    // MB: this is wrong! mT represented warped time, and mTime is too inaccurate to use
    // it here. It's also unnecessary I think.
@@ -70,6 +70,9 @@ class MIXER_API Mixer {
    virtual ~ Mixer();
 
    size_t BufferSize() const { return mBufferSize; }
+   unsigned NumChannels() const { return mNumChannels; }
+   bool Interleaved() const { return mInterleaved; }
+   sampleFormat Format() const { return mFormat; }
 
    //
    // Processing
@@ -14,11 +14,14 @@
 #include "MixerSource.h"
 
 #include "AudioGraphBuffers.h"
+#include "AudioTrace.h"
 #include "Envelope.h"
 #include "Resample.h"
 #include "WideSampleSequence.h"
 #include "float_cast.h"
 
+#include <utility>
+
 namespace {
 template<typename T, typename F> std::vector<T>
 initVector(size_t dim1, const F &f)
@@ -37,12 +40,17 @@ initVector(size_t dim1, size_t dim2)
 }
 }
 
+#define stackAllocate(T, count) static_cast<T*>(alloca(count * sizeof(T)))
+
 void MixerSource::MakeResamplers()
 {
-   for (size_t j = 0; j < mnChannels; ++j)
-      mResample[j] = std::make_unique<Resample>(
-         mResampleParameters.mHighQuality,
-         mResampleParameters.mMinFactor, mResampleParameters.mMaxFactor);
+   // Acquire the replacement first, so that the pool cannot hand back the
+   // resampler being replaced; the pool resets that one in the background
+   // for later reuse
+   auto pResample = Resample::Acquire(mResampleParameters.mHighQuality,
+      mResampleParameters.mMinFactor, mResampleParameters.mMaxFactor,
+      mnChannels);
+   Resample::Recycle(std::exchange(mResample, move(pResample)));
 }
 
 namespace {
@@ -91,6 +99,10 @@ size_t MixerSource::MixVariableRates(
 
    size_t out = 0;
 
+   // Sized in the constructor, so that nothing is allocated here
+   assert(nChannels >= mnChannels ||
+      (mnChannels - nChannels) * (maxOut + 1) <= mDiscards.size());
+
    /* time is floating point. Sample rate is integer. The number of samples
     * has to be integer, but the multiplication gives a float result, which we
     * round to get an integer result. TODO: is this always right or can it be
@@ -174,28 +186,29 @@ size_t MixerSource::MixVariableRates(
                t, t + (double)thisProcessLen / sequenceRate);
       }
 
-      std::pair<size_t, size_t> results;
-      for (size_t iChannel = 0; iChannel < nChannels; ++iChannel) {
-         const auto queue = mSampleQueue[iChannel].data();
-         const auto pResample = mResample[iChannel].get();
-         const auto pFloat = floatBuffers[iChannel];
-         // Assuming that progress of the Resampler depends only
-         // on the size of its inputs, this assignment has the same effect on
-         // each pass.
-         results = pResample->Process(factor,
-            &queue[queueStart],
-            thisProcessLen,
-            last,
-            // PRL:  Bug2536: crash in soxr happened on Mac, sometimes, when
-            // maxOut - out == 1 and &pFloat[out + 1] was an unmapped
-            // address, because soxr, strangely, fetched an 8-byte (misaligned!)
-            // value from &pFloat[out], but did nothing with it anyway,
-            // in soxr_output_no_callback.
-            // Now we make the bug go away by allocating a little more space in
-            // the buffer than we need.
-            &pFloat[out],
-            maxOut - out);
+      // One resampler does all channels; those beyond nChannels are
+      // resampled too, into the discards
+      const auto inputs = stackAllocate(const float *, mnChannels);
+      const auto outputs = stackAllocate(float *, mnChannels);
+      for (size_t iChannel = 0; iChannel < mnChannels; ++iChannel) {
+         inputs[iChannel] = &mSampleQueue[iChannel][queueStart];
+         // PRL:  Bug2536: crash in soxr happened on Mac, sometimes, when
+         // maxOut - out == 1 and &pFloat[out + 1] was an unmapped
+         // address, because soxr, strangely, fetched an 8-byte (misaligned!)
+         // value from &pFloat[out], but did nothing with it anyway,
+         // in soxr_output_no_callback.
+         // Now we make the bug go away by allocating a little more space in
+         // the buffer than we need.
+         outputs[iChannel] = iChannel < nChannels
+            ? &floatBuffers[iChannel][out]
+            : &mDiscards[(iChannel - nChannels) * (maxOut + 1)];
       }
+      const auto results = [&]{
+         auto stopwatch =
+            AudioTrace::CreateStopwatch(AudioTrace::SectionID::Resample);
+         return mResample->Process(factor,
+            inputs, thisProcessLen, last, outputs, maxOut - out);
+      }();
 
       const auto input_used = results.first;
       queueStart += input_used;
@@ -301,17 +314,23 @@ MixerSource::MixerSource(
    , mQueueStart{ 0 }
    , mQueueLen{ 0 }
    , mResampleParameters{ highQuality, mpLeader->GetRate(), rate, options }
-   , mResample( mnChannels )
    , mEnvValues( std::max(sQueueMaxLen, bufferSize) )
    , mpMap{ pMap }
 {
    assert(mTimesAndSpeed);
+   // Room for all channels but one, for the largest block accepted, plus one
+   // sample each (see Bug2536 in MixVariableRates())
+   if (mnChannels > 1)
+      mDiscards.resize((mnChannels - 1) * (mEnvValues.size() + 1));
    auto t0 = mTimesAndSpeed->mT0;
    mSamplePos = GetSequence().TimeToLongSamples(t0);
    MakeResamplers();
 }
 
-MixerSource::~MixerSource() = default;
+MixerSource::~MixerSource()
+{
+   Resample::Recycle(move(mResample));
+}
 
 const WideSampleSequence &MixerSource::GetSequence() const
 {
@@ -333,14 +352,14 @@ bool MixerSource::AcceptsBlockSize(size_t blockSize) const
    return blockSize <= mEnvValues.size();
 }
 
-#define stackAllocate(T, count) static_cast<T*>(alloca(count * sizeof(T)))
-
 std::optional<size_t> MixerSource::Acquire(Buffers &data, size_t bound)
 {
    assert(AcceptsBuffers(data));
    assert(AcceptsBlockSize(data.BlockSize()));
    assert(bound <= data.BlockSize());
    assert(data.BlockSize() <= data.Remaining());
+   auto stopwatch =
+      AudioTrace::CreateStopwatch(AudioTrace::SectionID::MixerSourceAcquire);
 
    auto &[mT0, mT1, _, mTime] = *mTimesAndSpeed;
    const bool backwards = (mT1 < mT0);
@@ -125,7 +125,11 @@ private:
    int mQueueLen;
 
    const ResampleParameters mResampleParameters;
-   std::vector<std::unique_ptr<Resample>> mResample;
+   //! Resamples all channels at once
+   std::unique_ptr<Resample> mResample;
+
+   //! Output of the resampler for channels not passed to Acquire()
+   std::vector<float> mDiscards;
 
    //! Gain envelopes are applied to input before other transformations
    std::vector<double> mEnvValues;
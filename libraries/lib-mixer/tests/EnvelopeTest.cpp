@@ -0,0 +1,188 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  EnvelopeTest.cpp
+
+**********************************************************************/
+#include "Envelope.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+// The former sample-by-sample evaluation, for comparison; the envelope must
+// have points
+void ReferenceValues(
+   const Envelope& env, double* buffer, int bufferLen, double t0, double tstep)
+{
+   const int len = env.GetNumberOfPoints();
+   const auto startValue = [&](int ii) {
+      return env.GetExponential() ? log10(env[ii].GetVal()) : env[ii].GetVal();
+   };
+   const auto epsilon = tstep / 2;
+   double t = t0;
+   double increment = 0;
+   if (len > 1 && t <= env[0].GetT() && env[0].GetT() == env[1].GetT())
+      increment = epsilon;
+
+   double tnext = 0, vstep = 0;
+   for (int b = 0; b < bufferLen; ++b, t += tstep)
+   {
+      const auto tplus = t + increment;
+      if (tplus < env[0].GetT())
+      {
+         buffer[b] = env[0].GetVal();
+         continue;
+      }
+      if (tplus >= env[len - 1].GetT())
+      {
+         buffer[b] = env[len - 1].GetVal();
+         continue;
+      }
+      if (b == 0 || tplus >= tnext)
+      {
+         // First point after tplus
+         int hi = 0;
+         while (env[hi].GetT() <= tplus)
+            ++hi;
+         const auto lo = hi - 1;
+         const auto tprev = env[lo].GetT();
+         tnext = env[hi].GetT();
+         increment =
+            (hi + 1 < len && tnext == env[hi + 1].GetT()) ? epsilon : 0;
+         const auto vprev = startValue(lo), vnext = startValue(hi);
+         const auto dt = tnext - tprev, to = t - tprev;
+         auto v = vnext;
+         vstep = 0;
+         if (dt > 0)
+         {
+            v = (vprev * (dt - to) + vnext * to) / dt;
+            vstep = (vnext - vprev) * tstep / dt;
+         }
+         if (env.GetExponential())
+         {
+            v = pow(10.0, v);
+            vstep = pow(10.0, vstep);
+         }
+         buffer[b] = v;
+      }
+      else if (env.GetExponential())
+         buffer[b] = buffer[b - 1] * vstep;
+      else
+         buffer[b] = buffer[b - 1] + vstep;
+   }
+}
+
+Envelope MakeEnvelope(bool exponential)
+{
+   Envelope env { exponential, 0.01, 4.0, 1.0 };
+   // Point times are not multiples of the sample period; includes a
+   // discontinuity at 0.61 and a flat segment
+   env.Insert(0.0137, 0.5);
+   env.Insert(0.2519, 2.0);
+   env.Insert(0.61, 0.25);
+   env.Insert(0.61, 1.5);
+   env.Insert(0.8333, 1.5);
+   env.Insert(1.2071, 0.1);
+   return env;
+}
+
+void RequireClose(const std::vector<double>& actual,
+   const std::vector<double>& expected)
+{
+   REQUIRE(actual.size() == expected.size());
+   for (size_t ii = 0; ii < actual.size(); ++ii)
+      REQUIRE(actual[ii] == Approx(expected[ii]).epsilon(1e-9));
+}
+} // namespace
+
+TEST_CASE("Envelope::GetValues agrees with sample-by-sample evaluation")
+{
+   constexpr auto rate = 1000.0;
+   constexpr auto bufferLen = 1500;
+   for (const auto exponential : { false, true })
+   {
+      const auto env = MakeEnvelope(exponential);
+      for (const auto t0 : { -0.1, 0.0, 0.3, 0.6, 1.1 })
+      {
+         std::vector<double> values(bufferLen), expected(bufferLen);
+         env.GetValues(values.data(), bufferLen, t0, 1 / rate);
+         ReferenceValues(env, expected.data(), bufferLen, t0, 1 / rate);
+         RequireClose(values, expected);
+      }
+   }
+}
+
+TEST_CASE("Envelope::GetValues agrees with GetValue")
+{
+   const auto env = MakeEnvelope(false);
+   std::vector<double> values(400);
+   env.GetValues(values.data(), values.size(), 0.0, 1 / 300.0);
+   for (size_t ii = 0; ii < values.size(); ++ii)
+      REQUIRE(values[ii] == Approx(env.GetValue(ii / 300.0)).epsilon(1e-9));
+
+   // Sample 183 falls on the discontinuity; both take the right limit
+   REQUIRE(env.GetValue(0.61) == 1.5);
+   REQUIRE(values[183] == 1.5);
+
+   // Likewise when the sample time falls short of it by roundoff, even for
+   // the first sample of a buffer
+   const auto t0 = 0.61 - 61 * 0.001;
+   const auto t = t0 + 61 * 0.001;
+   REQUIRE(t < 0.61);
+   REQUIRE(env.GetValue(t) == 1.5);
+   env.GetValues(values.data(), values.size(), t0, 0.001);
+   REQUIRE(values[61] == 1.5);
+   env.GetValues(values.data(), 1, t, 0.001);
+   REQUIRE(values[0] == 1.5);
+}
+
+TEST_CASE("Envelope::GetValues of an envelope without points")
+{
+   Envelope env { false, 0.0, 2.0, 0.5 };
+   std::vector<double> values(100);
+   env.GetValues(values.data(), values.size(), 0.0, 0.01);
+   REQUIRE(std::all_of(
+      values.begin(), values.end(), [](double v) { return v == 0.5; }));
+}
+
+// Hidden; run with the [benchmark] tag
+TEST_CASE("Envelope::GetValues cost", "[.][benchmark]")
+{
+   constexpr auto rate = 44100.0;
+   constexpr auto bufferLen = 4096;
+   constexpr auto buffers = 20000;
+   for (const auto exponential : { false, true })
+   {
+      Envelope env { exponential, 0.01, 4.0, 1.0 };
+      for (auto ii = 0; ii < 40; ++ii)
+         env.Insert(ii * 0.25, 0.2 + (ii % 5) * 0.3);
+
+      std::vector<double> values(bufferLen);
+      const auto time = [&](auto evaluate) {
+         const auto start = std::chrono::steady_clock::now();
+         for (auto ii = 0; ii < buffers; ++ii)
+            evaluate(values.data(), (ii % 200) * bufferLen / rate);
+         return std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - start)
+            .count();
+      };
+      const auto segmentwise = time([&](double* buffer, double t0) {
+         env.GetValues(buffer, bufferLen, t0, 1 / rate);
+      });
+      const auto reference = time([&](double* buffer, double t0) {
+         ReferenceValues(env, buffer, bufferLen, t0, 1 / rate);
+      });
+      std::cout << (exponential ? "exponential" : "linear")
+                << ": segment-wise " << segmentwise << " ms, sample-by-sample "
+                << reference << " ms for " << buffers << " buffers\n";
+   }
+}
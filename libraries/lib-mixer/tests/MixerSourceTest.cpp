@@ -0,0 +1,252 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  MixerSourceTest.cpp
+
+**********************************************************************/
+#include "Mix.h"
+#include "MockedPrefs.h"
+#include "Resample.h"
+#include "WideSampleSequence.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+MockedPrefs prefs;
+
+constexpr auto twoPi = 6.283185307179586;
+
+//! A stereo sequence, with a different sine wave in each channel
+class StereoSineSequence final : public WideSampleSequence
+{
+public:
+   StereoSineSequence(double rate, double duration)
+       : mRate { rate }
+       , mDuration { duration }
+   {
+   }
+
+   size_t NChannels() const override
+   {
+      return 2;
+   }
+
+   float GetChannelGain(int) const override
+   {
+      return 1.f;
+   }
+
+   bool DoGet(
+      size_t iChannel, size_t nBuffers, const samplePtr buffers[],
+      sampleFormat format, sampleCount start, size_t len, bool backwards,
+      fillFormat, bool, sampleCount*) const override
+   {
+      REQUIRE(format == floatSample);
+      const auto end = static_cast<long long>(mRate * mDuration);
+      for (size_t ii = 0; ii < nBuffers; ++ii)
+      {
+         const auto frequency = iChannel + ii == 0 ? 440.0 : 660.0;
+         const auto out = reinterpret_cast<float*>(buffers[ii]);
+         for (size_t jj = 0; jj < len; ++jj)
+         {
+            const auto sample = start.as_long_long() +
+                                (backwards ? -1 - static_cast<long long>(jj) :
+                                             static_cast<long long>(jj));
+            out[jj] = sample < 0 || sample >= end ?
+                         0.f :
+                         0.5f * std::sin(twoPi * frequency * sample / mRate);
+         }
+      }
+      return true;
+   }
+
+   double GetStartTime() const override
+   {
+      return 0.;
+   }
+
+   double GetEndTime() const override
+   {
+      return mDuration;
+   }
+
+   double GetRate() const override
+   {
+      return mRate;
+   }
+
+   sampleFormat WidestEffectiveFormat() const override
+   {
+      return floatSample;
+   }
+
+   bool HasTrivialEnvelope() const override
+   {
+      return true;
+   }
+
+   void GetEnvelopeValues(double* buffer, size_t bufferLen, double, bool)
+      const override
+   {
+      std::fill(buffer, buffer + bufferLen, 1.0);
+   }
+
+   AudioGraph::ChannelType GetChannelType() const override
+   {
+      return AudioGraph::LeftChannel;
+   }
+
+private:
+   const double mRate;
+   const double mDuration;
+};
+
+constexpr auto loopDuration = 0.25;
+constexpr size_t bufferSize = 1024;
+
+//! Plays 44.1 kHz at 48 kHz, as for a device at a different rate; with a
+//! speed range, resampling is at variable rate, as for scrubbing
+std::unique_ptr<Mixer> MakeLoopMixer(bool variableRate)
+{
+   Mixer::Inputs inputs;
+   inputs.emplace_back(std::make_shared<StereoSineSequence>(44100, 10.0));
+   const auto warp = variableRate ? Mixer::WarpOptions { 0.5, 2.0 } :
+                                    Mixer::WarpOptions { 0.0, 0.0 };
+   return std::make_unique<Mixer>(
+      move(inputs), true, warp, 0.0, loopDuration, 2, bufferSize, false,
+      48000, floatSample, false);
+}
+
+//! Mixes one pass of the loop, then seeks back to its start
+std::vector<float> PlayLoop(Mixer& mixer)
+{
+   std::vector<float> result;
+   while (const auto samples = mixer.Process())
+      for (unsigned channel = 0; channel < 2; ++channel)
+      {
+         const auto buffer =
+            reinterpret_cast<const float*>(mixer.GetBuffer(channel));
+         result.insert(result.end(), buffer, buffer + samples);
+      }
+   mixer.Reposition(0.0, true);
+   return result;
+}
+} // namespace
+
+TEST_CASE("Resample does several channels as separate instances would")
+{
+   constexpr size_t len = 20000, blockSize = 1024;
+   std::vector<float> left(len), right(len);
+   for (size_t ii = 0; ii < len; ++ii)
+   {
+      left[ii] = std::sin(ii * 0.01f);
+      right[ii] = 0.3f * std::cos(ii * 0.037f);
+   }
+   for (const auto& [minFactor, maxFactor] :
+        { std::pair { 48000 / 44100.0, 48000 / 44100.0 }, { 0.5, 2.0 } })
+   {
+      Resample monoLeft { true, minFactor, maxFactor },
+         monoRight { true, minFactor, maxFactor },
+         stereo { true, minFactor, maxFactor, 2 };
+      std::vector<float> expectedLeft(3 * len), expectedRight(3 * len),
+         actualLeft(3 * len), actualRight(3 * len);
+      size_t outLeft = 0, outRight = 0, outStereo = 0;
+      for (size_t pos = 0; pos < len; pos += blockSize)
+      {
+         const auto count = std::min(blockSize, len - pos);
+         const auto last = pos + count == len;
+         outLeft += monoLeft
+                       .Process(
+                          minFactor, &left[pos], count, last,
+                          &expectedLeft[outLeft], 3 * len - outLeft)
+                       .second;
+         outRight += monoRight
+                        .Process(
+                           minFactor, &right[pos], count, last,
+                           &expectedRight[outRight], 3 * len - outRight)
+                        .second;
+         const float* inputs[] { &left[pos], &right[pos] };
+         float* outputs[] { &actualLeft[outStereo], &actualRight[outStereo] };
+         outStereo += stereo
+                         .Process(
+                            minFactor, inputs, count, last, outputs,
+                            3 * len - outStereo)
+                         .second;
+      }
+      REQUIRE(outLeft > 0);
+      REQUIRE(outStereo == outLeft);
+      REQUIRE(outStereo == outRight);
+      REQUIRE(actualLeft == expectedLeft);
+      REQUIRE(actualRight == expectedRight);
+   }
+}
+
+TEST_CASE("Mixer repeats a loop exactly with recycled resamplers")
+{
+   const auto variableRate = GENERATE(false, true);
+   const auto mixer = MakeLoopMixer(variableRate);
+   const auto first = PlayLoop(*mixer);
+   REQUIRE(!first.empty());
+   for (auto ii = 0; ii < 5; ++ii)
+   {
+      // Give the pool time to reset the recycled resampler, on some passes
+      if (ii % 2)
+         std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      REQUIRE(PlayLoop(*mixer) == first);
+   }
+}
+
+// Hidden; run with the [benchmark] tag
+TEST_CASE("Looped play seek latency", "[.][benchmark]")
+{
+   using namespace std::chrono;
+   constexpr auto loops = 400;
+   for (const auto variableRate : { false, true })
+   {
+      const auto mixer = MakeLoopMixer(variableRate);
+      double mixing = 0, seeking = 0, worstSeek = 0;
+      for (auto ii = 0; ii < loops; ++ii)
+      {
+         auto start = steady_clock::now();
+         while (mixer->Process())
+            ;
+         mixing += duration<double, std::milli>(steady_clock::now() - start)
+                      .count();
+         start = steady_clock::now();
+         mixer->Reposition(0.0, true);
+         const auto seek =
+            duration<double, std::milli>(steady_clock::now() - start).count();
+         seeking += seek;
+         worstSeek = std::max(worstSeek, seek);
+      }
+
+      // What each seek cost before pooling: new resamplers for each channel
+      const auto factor = 48000 / 44100.0;
+      const auto minFactor = variableRate ? factor / 2 : factor,
+                 maxFactor = variableRate ? factor * 2 : factor;
+      const auto start = steady_clock::now();
+      for (auto ii = 0; ii < loops; ++ii)
+      {
+         Resample left { false, minFactor, maxFactor },
+            right { false, minFactor, maxFactor };
+      }
+      const auto constructing =
+         duration<double, std::milli>(steady_clock::now() - start).count();
+
+      std::cout << (variableRate ? "variable rate" : "constant rate")
+                << ": seek mean " << seeking / loops << " ms, worst "
+                << worstSeek << " ms; constructing two resamplers "
+                << constructing / loops << " ms; mixing "
+                << loops * loopDuration * 1000 / mixing << "x real time\n";
+   }
+}
@@ -15,6 +15,7 @@ Matthieu Hodgkinson
 #include "MirTypes.h"
 #include "MirUtils.h"
 #include "MusicInformationRetrieval.h"
+#include "Parallel.h"
 
 #include <array>
 #include <cassert>
@@ -175,15 +176,24 @@ OnsetQuantization RunQuantizationExperiment(
    QuantizationFitDebugOutput* debugOutput)
 {
    const auto quantizations = [&]() {
-      std::unordered_map<int, OnsetQuantization> quantizations;
-      std::transform(
-         possibleNumTatums.begin(), possibleNumTatums.end(),
-         std::inserter(quantizations, quantizations.end()), [&](int numTatums) {
+      // The experiments are independent of one another and only read the
+      // shared ODF data, so they are evaluated concurrently. They are then
+      // gathered in the original order, so that the selection of the best fit
+      // doesn't depend on thread scheduling.
+      const auto experiments = Parallel::Transform<OnsetQuantization>(
+         possibleNumTatums.size(), [&](size_t i) {
+            const auto numTatums = possibleNumTatums[i];
             const auto lag = GetOnsetLag(odf, numTatums);
             const auto distance = GetQuantizationDistance(
                peakIndices, peakValues, odf.size(), numTatums, lag);
-            return std::make_pair(
-               numTatums, OnsetQuantization { distance, lag, numTatums });
+            return OnsetQuantization { distance, lag, numTatums };
+         });
+      std::unordered_map<int, OnsetQuantization> quantizations;
+      std::transform(
+         experiments.begin(), experiments.end(),
+         std::inserter(quantizations, quantizations.end()),
+         [](const OnsetQuantization& experiment) {
+            return std::make_pair(experiment.numDivisions, experiment);
          });
       return quantizations;
    }();
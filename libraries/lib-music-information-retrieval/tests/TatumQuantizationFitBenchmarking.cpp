@@ -1,6 +1,7 @@
 #include "MirFakes.h"
 #include "MirTestUtils.h"
 #include "MusicInformationRetrieval.h"
+#include "Parallel.h"
 #include "WavMirAudioReader.h"
 
 #include <catch2/catch.hpp>
@@ -203,6 +204,9 @@ TEST_CASE("TatumQuantizationFitBenchmarking")
    const auto numFiles = audioFiles.size();
    auto count = 0;
    std::chrono::milliseconds computationTime { 0 };
+   // Single-threaded reference pass, which the parallel pass below is compared
+   // against.
+   Parallel::SetMaxConcurrency(1);
    std::transform(
       audioFiles.begin(), audioFiles.begin() + numFiles,
       std::back_inserter(samples), [&](const std::string& wavFile) {
@@ -235,9 +239,37 @@ TEST_CASE("TatumQuantizationFitBenchmarking")
          return Sample { truth, debugOutput.score, error };
       });
 
+   Parallel::SetMaxConcurrency(0);
+
+   // Now analyze all files concurrently, the way clips are analyzed on import,
+   // and check that the results do not depend on it.
+   const auto parallelStart = std::chrono::steady_clock::now();
+   const auto parallelScores = Parallel::Transform<double>(
+      numFiles, [&](size_t i) {
+         const WavMirAudioReader audio { audioFiles[i] };
+         QuantizationFitDebugOutput debugOutput;
+         std::function<void(double)> progressCb;
+         GetMusicalMeterFromSignal(audio, tolerance, progressCb, &debugOutput);
+         return debugOutput.score;
+      });
+   const auto parallelTime =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+         std::chrono::steady_clock::now() - parallelStart);
+   for (size_t i = 0; i < numFiles; ++i)
+      REQUIRE(parallelScores[i] == samples[i].score);
+
    {
+      // The serial figure excludes file reading, while the parallel one
+      // includes it, so the speedup is rather under-estimated.
       std::ofstream timeMeasurementFile { "./timeMeasurement.txt" };
-      timeMeasurementFile << computationTime.count() << "ms\n";
+      timeMeasurementFile
+         << computationTime.count() << "ms\n"
+         << "parallel (" << Parallel::DefaultConcurrency()
+         << " threads, wall-clock): " << parallelTime.count() << "ms\n"
+         << "speedup: "
+         << 1. * computationTime.count() / std::max<long long>(
+                                               parallelTime.count(), 1)
+         << "\n";
    }
 
    // AUC of ROC curve. Tells how good our loop/not-loop clasifier is.
@@ -466,6 +466,9 @@ sqlite3_stmt *DBConnection::Prepare(enum StatementID id, const char *sql)
    // to different SQL statements, see enum StatementID
    // We have relatively few threads running at any one time,
    // e.g. main gui thread, a playback thread, a thread for compacting.
+   // Blocks loaded in parallel by ProjectSerializer are loaded in the
+   // persistent threads of Parallel::For, which are reused, so they add
+   // statements for a bounded number of thread ids only.
    // However the cache might keep growing, as we start/stop audio,
    // perhaps, if we chose to use a new thread each time.
    // For 3.0.0 I think that's OK.  If it's a data leak it's a slow 
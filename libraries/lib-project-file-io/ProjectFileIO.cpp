@@ -2081,7 +2081,9 @@ auto ProjectFileIO::LoadProject(const FilePath &fileName, bool ignoreAutosave)
       BufferedProjectBlobStream stream(
          DB(), "main", useAutosave ? "autosave" : "project", rowId);
 
-      success = ProjectSerializer::Decode(stream, this);
+      // Clips, with their sequences and block arrays, are the bulk of the
+      // document and independent of each other
+      success = ProjectSerializer::Decode(stream, this, { "waveclip" });
 
       if (!success)
       {
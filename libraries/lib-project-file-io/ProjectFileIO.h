@@ -350,4 +350,9 @@ private:
    std::shared_ptr<AudacityProject> mpProject;
 };
 
+//! Whether a new sample block made in the main thread, with the same contents
+//! as a live block of the project, shares that block, and its row in the
+//! database, instead
+extern PROJECT_FILE_IO_API BoolSetting DeduplicateSampleBlocks;
+
 #endif
@@ -16,6 +16,7 @@
 #include "ProjectSerializer.h"
 
 #include <algorithm>
+#include <cassert>
 #include <cstdint>
 #include <mutex>
 #include <wx/ustring.h>
@@ -26,6 +27,7 @@
 #include <wx/log.h>
 
 #include "BufferedStreamReader.h"
+#include "Parallel.h"
 
 ///
 /// ProjectSerializer class
@@ -74,7 +76,8 @@ enum FieldTypes
    FT_Raw,           // type, string length, string
    FT_Push,          // type only
    FT_Pop,           // type only
-   FT_Name           // type, ID, name length, name
+   FT_Name,          // type, ID, name length, name
+   FT_Binary         // type, ID, data length, data
 };
 
 // Static so that the dict can be reused each time.
@@ -199,61 +202,63 @@ using Digits = Int; // Instead, just an unsigned char?
 static const auto WriteDigits = WriteInt;
 static const auto ReadDigits = ReadInt;
 
-class XMLTagHandlerAdapter final
+//! One item of a decoded document
+/*! Names and string values view storage that outlives the decoding */
+struct Event final
 {
-public:
-   explicit XMLTagHandlerAdapter(XMLTagHandler* handler) noexcept
-       : mBaseHandler(handler)
-   {
-   }
+   enum Kind : unsigned char { StartTag, EndTag, Attribute, Content };
+
+   Kind kind;
+   //! For a StartTag, index of the matching EndTag, or of the end of the
+   //! document if the tag is never closed
+   size_t match;
+   std::string_view name;
+   //! Attribute value, or the text of Content
+   XMLAttributeValueView value;
+};
+using Events = std::vector<Event>;
 
+//! Collects the decoded document, so that it can be replayed to handlers,
+//! partly concurrently
+class DocumentRecorder final
+{
+public:
    void EmitStartTag(const std::string_view& name)
    {
-      if (mInTag)
-         EmitStartTag();
-
-      mCurrentTagName = name;
-      mInTag = true;
+      mOpenTags.push_back(mEvents.size());
+      mEvents.push_back({ Event::StartTag, 0, name, {} });
    }
 
    void EndTag(const std::string_view& name)
    {
-      if (mInTag)
-         EmitStartTag();
-
-      if (XMLTagHandler* const handler = mHandlers.back())
-         handler->HandleXMLEndTag(name);
-
-      mHandlers.pop_back();
+      if (!mOpenTags.empty())
+      {
+         mEvents[mOpenTags.back()].match = mEvents.size();
+         mOpenTags.pop_back();
+      }
+      mEvents.push_back({ Event::EndTag, 0, name, {} });
    }
 
    void WriteAttr(const std::string_view& name, std::string value)
    {
-      assert(mInTag);
-
-      if (!mInTag)
-         return;
-
-      mAttributes.emplace_back(name, CacheString(std::move(value)));
+      WriteAttr(name, CacheString(std::move(value)));
    }
 
    template <typename T> void WriteAttr(const std::string_view& name, T value)
    {
-      assert(mInTag);
+      assert(InTag());
 
-      if (!mInTag)
+      if (!InTag())
          return;
 
-      mAttributes.emplace_back(name, XMLAttributeValueView(value));
+      mEvents.push_back(
+         { Event::Attribute, 0, name, XMLAttributeValueView(value) });
    }
 
    void WriteData(std::string value)
    {
-      if (mInTag)
-         EmitStartTag();
-
-      if (XMLTagHandler* const handler = mHandlers.back())
-         handler->HandleXMLContent(CacheString(std::move(value)));
+      mEvents.push_back({ Event::Content, 0, {},
+         XMLAttributeValueView(CacheString(std::move(value))) });
    }
 
    void WriteRaw(std::string)
@@ -264,64 +269,155 @@ public:
       // which are ignored
    }
 
-   bool Finalize()
+   const Events& Finalize()
    {
-      if (mInTag)
-      {
-         EmitStartTag();
-         EndTag(mCurrentTagName);
-      }
+      // A document ending right after a start tag closes that tag
+      if (InTag())
+         EndTag(mEvents[mOpenTags.back()].name);
+
+      for (auto index : mOpenTags)
+         mEvents[index].match = mEvents.size();
+      mOpenTags.clear();
+
+      return mEvents;
+   }
+
+private:
+   bool InTag() const
+   {
+      return !mEvents.empty() && (mEvents.back().kind == Event::StartTag ||
+                                  mEvents.back().kind == Event::Attribute);
+   }
+
+   std::string_view CacheString(std::string string)
+   {
+      mStringsCache.emplace_back(std::move(string));
+      return mStringsCache.back();
+   }
+
+   Events mEvents;
+   std::vector<size_t> mOpenTags;
+   std::deque<std::string> mStringsCache;
+};
+
+//! Sends recorded events to a tree of XMLTagHandler
+class XMLTagHandlerAdapter final
+{
+public:
+   XMLTagHandlerAdapter(
+      const Events& events,
+      const ProjectSerializer::IndependentTags& independentTags) noexcept
+       : mEvents(events)
+       , mIndependentTags(independentTags)
+   {
+   }
+
+   //! Returns false if the base handler rejected the document
+   bool Replay(XMLTagHandler* handler)
+   {
+      mBaseHandler = handler;
+      Replay(0, mEvents.size(), true);
+
+      // All handlers of independent subtrees are attached; now build the
+      // subtrees
+      Parallel::For(mDeferred.size(), [this](size_t ii) {
+         const auto [subtreeHandler, begin] = mDeferred[ii];
+         XMLTagHandlerAdapter subtree { mEvents, mIndependentTags };
+         subtree.mBaseHandler = subtreeHandler;
+         subtree.Replay(
+            begin, std::min(mEvents[begin].match + 1, mEvents.size()), false);
+      });
 
       return mBaseHandler != nullptr;
    }
 
 private:
-   void EmitStartTag()
+   void Replay(size_t begin, size_t end, bool defer)
    {
+      for (auto ii = begin; ii < end; ++ii)
+      {
+         const auto& event = mEvents[ii];
+         switch (event.kind)
+         {
+         case Event::StartTag:
+            ii = StartTag(ii, end, defer);
+            break;
+
+         case Event::EndTag:
+            if (mHandlers.empty())
+               break;
+            if (XMLTagHandler* const handler = mHandlers.back())
+               handler->HandleXMLEndTag(event.name);
+            mHandlers.pop_back();
+            break;
+
+         case Event::Content:
+            if (mHandlers.empty())
+               break;
+            if (XMLTagHandler* const handler = mHandlers.back())
+               handler->HandleXMLContent(
+                  event.value.Get<std::string_view>());
+            break;
+
+         default:
+            break;
+         }
+      }
+   }
+
+   //! Returns the index of the last event consumed
+   size_t StartTag(size_t ii, size_t end, bool defer)
+   {
+      const auto& event = mEvents[ii];
+
+      XMLTagHandler* handler = nullptr;
       if (mHandlers.empty())
+         handler = mBaseHandler;
+      else if (XMLTagHandler* const parent = mHandlers.back())
+         handler = parent->HandleXMLChild(event.name);
+
+      if (handler && defer && !mHandlers.empty() && IsIndependent(event.name))
       {
-         mHandlers.push_back(mBaseHandler);
+         mDeferred.emplace_back(handler, ii);
+         return std::min(event.match, end - 1);
       }
-      else
+
+      mAttributes.clear();
+      auto last = ii;
+      while (last + 1 < end && mEvents[last + 1].kind == Event::Attribute)
       {
-         if (XMLTagHandler* const handler = mHandlers.back())
-            mHandlers.push_back(handler->HandleXMLChild(mCurrentTagName));
-         else
-            mHandlers.push_back(NULL);
+         ++last;
+         mAttributes.emplace_back(mEvents[last].name, mEvents[last].value);
       }
 
-      if (XMLTagHandler*& handler = mHandlers.back())
+      mHandlers.push_back(handler);
+      if (handler && !handler->HandleXMLTag(event.name, mAttributes))
       {
-         if (!handler->HandleXMLTag(mCurrentTagName, mAttributes))
-         {
-            handler = nullptr;
+         mHandlers.back() = nullptr;
 
-            if (mHandlers.size() == 1)
-               mBaseHandler = nullptr;
-         }
+         if (mHandlers.size() == 1)
+            mBaseHandler = nullptr;
       }
 
-      mStringsCache.clear();
-      mAttributes.clear();
-      mInTag = false;
+      return last;
    }
 
-   std::string_view CacheString(std::string string)
+   bool IsIndependent(const std::string_view& name) const
    {
-      mStringsCache.emplace_back(std::move(string));
-      return mStringsCache.back();
+      return std::find(mIndependentTags.begin(), mIndependentTags.end(),
+                       name) != mIndependentTags.end();
    }
 
-   XMLTagHandler* mBaseHandler;
-
-   std::vector<XMLTagHandler*> mHandlers;
+   const Events& mEvents;
+   const ProjectSerializer::IndependentTags& mIndependentTags;
 
-   std::string_view mCurrentTagName;
+   XMLTagHandler* mBaseHandler { nullptr };
 
-   std::deque<std::string> mStringsCache;
+   std::vector<XMLTagHandler*> mHandlers;
    AttributesList mAttributes;
 
-   bool mInTag { false };
+   //! Handlers of independent subtrees, with the indices of their start tags
+   std::vector<std::pair<XMLTagHandler*, size_t>> mDeferred;
 };
 
 // template<typename BaseCharType>
@@ -458,6 +554,17 @@ void ProjectSerializer::WriteAttr(const wxString & name, double value, int digit
    WriteDigits( mBuffer, digits );
 }
 
+bool ProjectSerializer::WriteBinaryAttr(
+   const wxString & name, const void *data, size_t size)
+{
+   mBuffer.AppendByte(FT_Binary);
+   WriteName(name);
+
+   WriteLength( mBuffer, size );
+   mBuffer.AppendData(data, size);
+   return true;
+}
+
 void ProjectSerializer::WriteData(const wxString & value)
 {
    mBuffer.AppendByte(FT_Data);
@@ -526,30 +633,31 @@ bool ProjectSerializer::DictChanged() const
 }
 
 // See ProjectFileIO::LoadProject() for explanation of the blockids arg
-bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler)
+bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler,
+   const IndependentTags &independentTags)
 {
    if (handler == nullptr)
       return false;
 
-   XMLTagHandlerAdapter adapter(handler);
+   DocumentRecorder adapter;
 
    std::vector<char> bytes;
-   IdMap mIds;
-   std::vector<IdMap> mIdStack;
+   // Each distinct name is stored once, for the whole decoding; the
+   // dictionaries map ids to views of those names
+   std::unordered_set<std::string> mNames;
+   std::vector<std::string_view> mIds;
+   std::vector<std::vector<std::string_view>> mIdStack;
    char mCharSize = 0;
 
-   mIds.clear();
-
    struct Error{}; // exception type for short-range try/catch
    auto Lookup = [&mIds]( UShort id ) -> std::string_view
    {
-      auto iter = mIds.find( id );
-      if (iter == mIds.end())
+      if (id >= mIds.size() || mIds[id].data() == nullptr)
       {
          throw Error{};
       }
 
-      return iter->second;
+      return mIds[id];
    };
 
    int64_t stringsCount = 0;
@@ -593,14 +701,16 @@ bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler)
          {
             case FT_Push:
             {
-               mIdStack.push_back(mIds);
+               mIdStack.push_back(std::move(mIds));
                mIds.clear();
             }
             break;
 
             case FT_Pop:
             {
-               mIds = mIdStack.back();
+               if (mIdStack.empty())
+                  throw Error{};
+               mIds = std::move(mIdStack.back());
                mIdStack.pop_back();
             }
             break;
@@ -609,7 +719,9 @@ bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler)
             {
                id = ReadUShort( in );
                auto len = ReadUShort( in );
-               mIds[id] = ReadString(len);
+               if (id >= mIds.size())
+                  mIds.resize(id + 1);
+               mIds[id] = *mNames.insert(ReadString(len)).first;
             }
             break;
 
@@ -708,6 +820,20 @@ bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler)
             }
             break;
 
+            case FT_Binary:
+            {
+               id = ReadUShort( in );
+               int len = ReadLength( in );
+               if (len < 0)
+                  throw Error{};
+               std::string value(len, '\0');
+               if (in.Read(value.data(), len) != size_t(len))
+                  throw Error{};
+
+               adapter.WriteAttr(Lookup(id), std::move(value));
+            }
+            break;
+
             case FT_Data:
             {
                int len = ReadLength( in );
@@ -744,5 +870,6 @@ bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler)
    wxLogInfo(
       "Loaded %lld string %f Kb in size", stringsCount, stringsLength / 1024.0);
 
-   return adapter.Finalize();
+   return XMLTagHandlerAdapter { adapter.Finalize(), independentTags }
+      .Replay(handler);
 }
@@ -16,8 +16,10 @@
 #include "MemoryStream.h" // member variables
 #include <wx/mstream.h>
 
+#include <string_view>
 #include <unordered_set>
 #include <unordered_map>
+#include <vector>
 
 #include "Identifier.h"
 
@@ -30,7 +32,6 @@ class BufferedStreamReader;
 ///
 
 using NameMap = std::unordered_map<wxString, unsigned short>;
-using IdMap = std::unordered_map<unsigned short, std::string>;
 
 // This class's overrides do NOT throw AudacityException.
 class PROJECT_FILE_IO_API ProjectSerializer final : public XMLWriter
@@ -56,6 +57,9 @@ public:
    void WriteAttr(const wxString & name, float value, int digits = -1) override;
    void WriteAttr(const wxString & name, double value, int digits = -1) override;
 
+   bool WriteBinaryAttr(
+      const wxString & name, const void *data, size_t size) override;
+
    void WriteData(const wxString & value) override;
    void Write(const wxString & data) override;
 
@@ -65,8 +69,19 @@ public:
    bool IsEmpty() const;
    bool DictChanged() const;
 
+   //! Tags of elements whose subtrees may be built concurrently
+   /*!
+    The handler of each such element is still requested from its parent in
+    document order, on the calling thread, so that it is attached in order;
+    the element and its descendants are then handled on worker threads, after
+    the rest of the document.  Their handlers must not touch state shared with
+    other subtrees.
+    */
+   using IndependentTags = std::vector<std::string_view>;
+
    // Returns empty string if decoding fails
-   static bool Decode(BufferedStreamReader& in, XMLTagHandler* handler);
+   static bool Decode(BufferedStreamReader& in, XMLTagHandler* handler,
+      const IndependentTags &independentTags = {});
 
 private:
    void WriteName(const wxString& name);
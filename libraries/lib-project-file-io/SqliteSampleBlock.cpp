@@ -20,12 +20,22 @@ Paul Licameli -- split from SampleBlock.cpp and SampleBlock.h
 
 #include "SampleBlock.h" // to inherit
 #include "UndoManager.h"
+#include "UndoStateSpiller.h"
 #include "WaveTrack.h"
 
 #include "SentryHelper.h"
 #include <wx/log.h>
+#include <wx/thread.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <functional>
 #include <mutex>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
 
 class SqliteSampleBlockFactory;
 
@@ -76,6 +86,8 @@ public:
    /// Gets extreme values for the entire block
    MinMaxRMS DoGetMinMaxRMS() const override;
 
+   SampleStats DoGetStats() override;
+
    size_t GetSpaceUsage() const override;
    void SaveXML(XMLWriter &xmlFile) override;
 
@@ -118,6 +130,10 @@ private:
 
    SampleBlockID mBlockID{ 0 };
 
+   //! Hash of the contents, if the factory indexed this block for
+   //! deduplication
+   std::optional<size_t> mContentHash;
+
    ArrayOf<char> mSamples;
    size_t mSampleBytes;
    size_t mSampleCount;
@@ -129,6 +145,12 @@ private:
    double mSumMax;
    double mSumRms;
 
+   //! Calculated with the summaries for a new block, else from the samples
+   //! when first wanted; not stored in the database, where older versions
+   //! would not expect more columns
+   std::optional<SampleStats> mStats;
+   std::mutex mStatsMutex;
+
 #if defined(WORDS_BIGENDIAN)
 #error All sample block data is little endian...big endian not yet supported
 #endif
@@ -144,6 +166,7 @@ static std::map< SampleBlockID, std::shared_ptr<SqliteSampleBlock> >
 class SqliteSampleBlockFactory final
    : public SampleBlockFactory
    , public std::enable_shared_from_this<SqliteSampleBlockFactory>
+   , private PrefsListener
 {
 public:
    explicit SqliteSampleBlockFactory( AudacityProject &project );
@@ -164,10 +187,21 @@ public:
       sampleFormat srcformat,
       const AttributesList &attrs) override;
 
+   //! Number of entries in the index of contents
+   size_t CountIndexed();
+
 private:
+   void UpdatePrefs() override;
+
    void OnBeginPurge(size_t begin, size_t end);
    void OnEndPurge();
 
+   //! A live block made by DoCreate with the same samples, if any
+   std::shared_ptr<SqliteSampleBlock> FindDuplicate(size_t hash,
+      constSamplePtr src, size_t numsamples, sampleFormat srcformat);
+   //! Called by a dying block that was indexed under hash
+   void ForgetContent(size_t hash);
+
    friend SqliteSampleBlock;
 
    AudacityProject &mProject;
@@ -182,11 +216,43 @@ private:
    using AllBlocksMap =
       std::map< SampleBlockID, std::weak_ptr< SqliteSampleBlock > >;
    AllBlocksMap mAllBlocks;
+   // Blocks may be created from worker threads, as in concurrent import
+   std::mutex mAllBlocksMutex;
+   // Ids of blocks in mAllBlocks that another thread is still loading, each
+   // with where the loading thread leaves any exception for the waiters
+   std::unordered_map<SampleBlockID, std::shared_ptr<std::exception_ptr>>
+      mLoadingBlocks;
+   std::condition_variable mBlockLoaded;
+
+   // Blocks made by DoCreate, by hash of their contents, so that identical
+   // samples can share one block; also guarded by mAllBlocksMutex
+   std::unordered_multimap<size_t, std::weak_ptr<SqliteSampleBlock>>
+      mContentIndex;
+
+   //! Copy of DeduplicateSampleBlocks, updated in the main thread, because
+   //! blocks are also made in the audio thread and import workers, and
+   //! reading the preferences there is not safe
+   std::atomic<bool> mDeduplicate;
 };
 
+BoolSetting DeduplicateSampleBlocks{ L"/Directories/DeduplicateBlocks", true };
+
+namespace {
+size_t ContentHash(
+   constSamplePtr src, size_t numsamples, sampleFormat format)
+{
+   const auto hash = std::hash<std::string_view>{}({
+      reinterpret_cast<const char*>(src), numsamples * SAMPLE_SIZE(format) });
+   // The same bytes in another format are other samples
+   return hash ^ (std::hash<unsigned>{}(format) + 0x9e3779b9 +
+                  (hash << 6) + (hash >> 2));
+}
+}
+
 SqliteSampleBlockFactory::SqliteSampleBlockFactory( AudacityProject &project )
    : mProject{ project }
    , mppConnection{ ConnectionPtr::Get(project).shared_from_this() }
+   , mDeduplicate{ DeduplicateSampleBlocks.Read() }
 {
    mUndoSubscription = UndoManager::Get(project)
       .Subscribe([this](UndoRedoMessage message){
@@ -203,19 +269,91 @@ SqliteSampleBlockFactory::SqliteSampleBlockFactory( AudacityProject &project )
 
 SqliteSampleBlockFactory::~SqliteSampleBlockFactory() = default;
 
+void SqliteSampleBlockFactory::UpdatePrefs()
+{
+   mDeduplicate.store(
+      DeduplicateSampleBlocks.Read(), std::memory_order_relaxed);
+}
+
+size_t SqliteSampleBlockFactory::CountIndexed()
+{
+   std::lock_guard<std::mutex> lock(mAllBlocksMutex);
+   return mContentIndex.size();
+}
+
 SampleBlockPtr SqliteSampleBlockFactory::DoCreate(
    constSamplePtr src, size_t numsamples, sampleFormat srcformat )
 {
+   std::optional<size_t> hash;
+   // Only blocks made in the main thread, as by editing and effects; blocks
+   // made while recording, or by import workers, are rarely duplicates, and
+   // hashing them would cost the recording path
+   if (wxIsMainThread() && mDeduplicate.load(std::memory_order_relaxed)) {
+      hash = ContentHash(src, numsamples, srcformat);
+      // Blocks are immutable, so one with the same samples can be shared,
+      // with no new row to write
+      if (auto pBlock = FindDuplicate(*hash, src, numsamples, srcformat))
+         return pBlock;
+   }
+
    auto sb = std::make_shared<SqliteSampleBlock>(shared_from_this());
    sb->SetSamples(src, numsamples, srcformat);
    // block id has now been assigned
+   std::lock_guard<std::mutex> lock(mAllBlocksMutex);
    mAllBlocks[ sb->GetBlockID() ] = sb;
+   if (hash) {
+      sb->mContentHash = hash;
+      mContentIndex.emplace(*hash, sb);
+   }
    return sb;
 }
 
+auto SqliteSampleBlockFactory::FindDuplicate(size_t hash,
+   constSamplePtr src, size_t numsamples, sampleFormat srcformat)
+   -> std::shared_ptr<SqliteSampleBlock>
+{
+   std::vector<std::shared_ptr<SqliteSampleBlock>> candidates;
+   {
+      std::lock_guard<std::mutex> lock(mAllBlocksMutex);
+      const auto [begin, end] = mContentIndex.equal_range(hash);
+      for (auto iter = begin; iter != end; ++iter)
+         if (auto pBlock = iter->second.lock())
+            candidates.push_back(move(pBlock));
+   }
+   // Release of the candidates happens without the lock, in case one of
+   // them becomes the last reference and its destructor calls ForgetContent
+
+   // Equal hashes are not proof; compare the samples
+   std::optional<SampleBuffer> buffer;
+   for (auto &pBlock : candidates) {
+      if (pBlock->GetSampleFormat() != srcformat ||
+          pBlock->GetSampleCount() != numsamples)
+         continue;
+      if (!buffer)
+         buffer.emplace(numsamples, srcformat);
+      if (pBlock->GetSamples(
+             buffer->ptr(), srcformat, 0, numsamples, false) == numsamples &&
+          memcmp(buffer->ptr(), src, numsamples * SAMPLE_SIZE(srcformat)) == 0)
+         return move(pBlock);
+   }
+   return {};
+}
+
+void SqliteSampleBlockFactory::ForgetContent(size_t hash)
+{
+   std::lock_guard<std::mutex> lock(mAllBlocksMutex);
+   const auto [begin, end] = mContentIndex.equal_range(hash);
+   for (auto iter = begin; iter != end;)
+      if (iter->second.expired())
+         iter = mContentIndex.erase(iter);
+      else
+         ++iter;
+}
+
 auto SqliteSampleBlockFactory::GetActiveBlockIDs() -> SampleBlockIDs
 {
    SampleBlockIDs result;
+   std::lock_guard<std::mutex> lock(mAllBlocksMutex);
    for (auto end = mAllBlocks.end(), it = mAllBlocks.begin(); it != end;) {
       if (it->second.expired())
          // Tighten up the map
@@ -232,6 +370,8 @@ SampleBlockPtr SqliteSampleBlockFactory::DoCreateSilent(
    size_t numsamples, sampleFormat )
 {
    auto id = -static_cast< SampleBlockID >(numsamples);
+   static std::mutex silentBlocksMutex;
+   std::lock_guard<std::mutex> lock(silentBlocksMutex);
    auto &result = sSilentBlocks[ id ];
    if ( !result ) {
       result = std::make_shared<SqliteSampleBlock>(nullptr);
@@ -268,11 +408,22 @@ SampleBlockPtr SqliteSampleBlockFactory::DoCreateFromXML(
          }
          else {
             // First see if this block id was previously loaded
+            std::unique_lock<std::mutex> lock(mAllBlocksMutex);
             auto &wb = mAllBlocks[ nValue ];
             auto pb = wb.lock();
-            if (pb)
-               // Reuse the block
+            if (pb) {
+               // Reuse the block, once another thread has finished loading it
+               const auto iter = mLoadingBlocks.find(nValue);
+               if (iter != mLoadingBlocks.end()) {
+                  const auto pError = iter->second;
+                  mBlockLoaded.wait(lock,
+                     [&]{ return mLoadingBlocks.count(nValue) == 0; });
+                  // Don't use a block that failed to load
+                  if (*pError)
+                     std::rethrow_exception(*pError);
+               }
                sb = pb;
+            }
             else {
                // First sight of this id
                auto ssb =
@@ -280,9 +431,36 @@ SampleBlockPtr SqliteSampleBlockFactory::DoCreateFromXML(
                wb = ssb;
                sb = ssb;
                ssb->mSampleFormat = srcformat;
-               // This may throw database errors
-               // It initializes the rest of the fields
-               ssb->Load((SampleBlockID) nValue);
+
+               // Query the database without the lock, so that clips being
+               // deserialized concurrently don't wait for each other
+               const auto pError = std::make_shared<std::exception_ptr>();
+               mLoadingBlocks.emplace(nValue, pError);
+               lock.unlock();
+               auto loaded = finally([&]{
+                  {
+                     std::lock_guard<std::mutex> guard(mAllBlocksMutex);
+                     mLoadingBlocks.erase(nValue);
+                     if (*pError) {
+                        // Forget the half-initialized block, so that a later
+                        // attempt loads it again
+                        const auto iter = mAllBlocks.find(nValue);
+                        if (iter != mAllBlocks.end() &&
+                            iter->second.lock() == ssb)
+                           mAllBlocks.erase(iter);
+                     }
+                  }
+                  mBlockLoaded.notify_all();
+               });
+               try {
+                  // This may throw database errors
+                  // It initializes the rest of the fields
+                  ssb->Load((SampleBlockID) nValue);
+               }
+               catch (...) {
+                  *pError = std::current_exception();
+                  throw;
+               }
             }
          }
          found++;
@@ -346,6 +524,9 @@ SqliteSampleBlock::SqliteSampleBlock(
 
 SqliteSampleBlock::~SqliteSampleBlock()
 {
+   if (mContentHash)
+      mpFactory->ForgetContent(*mContentHash);
+
    DeletionCallback::Call(*this);
 
    if (IsSilent()) {
@@ -565,6 +746,28 @@ MinMaxRMS SqliteSampleBlock::DoGetMinMaxRMS() const
    return { (float) mSumMin, (float) mSumMax, (float) mSumRms };
 }
 
+SampleStats SqliteSampleBlock::DoGetStats()
+{
+   if (IsSilent())
+      return SampleStats::Zeroes(mSampleCount);
+
+   std::lock_guard<std::mutex> lock(mStatsMutex);
+   if (!mStats)
+   {
+      if (!mValid)
+      {
+         Load(mBlockID);
+      }
+
+      SampleBuffer blockData(mSampleCount, floatSample);
+      const auto copied =
+         DoGetSamples(blockData.ptr(), floatSample, 0, mSampleCount);
+      mStats = SampleStats::Calculate(
+         (const float *) blockData.ptr(), copied);
+   }
+   return *mStats;
+}
+
 size_t SqliteSampleBlock::GetSpaceUsage() const
 {
    if (IsSilent())
@@ -799,26 +1002,33 @@ void SqliteSampleBlock::Commit(Sizes sizes)
       wxASSERT_MSG(false, wxT("Binding failed...bug!!!"));
    }
 
-   // Execute the statement
-   rc = sqlite3_step(stmt);
-   if (rc != SQLITE_DONE)
+   // Execute the statement, holding the connection's mutex until the new row
+   // id is retrieved, because other threads may insert blocks meanwhile
    {
-      ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
-      ADD_EXCEPTION_CONTEXT("sqlite3.context", "SqliteSampleBlock::Commit::step");
+      const auto dbMutex = sqlite3_db_mutex(db);
+      sqlite3_mutex_enter(dbMutex);
+      auto unlock = finally([&]{ sqlite3_mutex_leave(dbMutex); });
+
+      rc = sqlite3_step(stmt);
+      if (rc != SQLITE_DONE)
+      {
+         ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
+         ADD_EXCEPTION_CONTEXT("sqlite3.context", "SqliteSampleBlock::Commit::step");
 
-      wxLogDebug(wxT("SqliteSampleBlock::Commit - SQLITE error %s"), sqlite3_errmsg(db));
+         wxLogDebug(wxT("SqliteSampleBlock::Commit - SQLITE error %s"), sqlite3_errmsg(db));
 
-      // Clear statement bindings and rewind statement
-      sqlite3_clear_bindings(stmt);
-      sqlite3_reset(stmt);
+         // Clear statement bindings and rewind statement
+         sqlite3_clear_bindings(stmt);
+         sqlite3_reset(stmt);
 
-      // Just showing the user a simple message, not the library error too
-      // which isn't internationalized
-      Conn()->ThrowException( true );
-   }
+         // Just showing the user a simple message, not the library error too
+         // which isn't internationalized
+         Conn()->ThrowException( true );
+      }
 
-   // Retrieve returned data
-   mBlockID = sqlite3_last_insert_rowid(db);
+      // Retrieve returned data
+      mBlockID = sqlite3_last_insert_rowid(db);
+   }
 
    // Reset local arrays
    mSamples.reset();
@@ -902,7 +1112,7 @@ auto SqliteSampleBlock::SetSizes(
 /// Calculates summary block data describing this sample data.
 ///
 /// This method also has the side effect of setting the mSumMin,
-/// mSumMax, and mSumRms members of this class.
+/// mSumMax, mSumRms, and mStats members of this class.
 ///
 void SqliteSampleBlock::CalcSummary(Sizes sizes)
 {
@@ -1055,6 +1265,8 @@ void SqliteSampleBlock::CalcSummary(Sizes sizes)
 
    mSumMin = min;
    mSumMax = max;
+
+   mStats = SampleStats::Calculate(samples, mSampleCount);
 }
 
 //! Just to find a denominator for a progress indicator.
@@ -1063,12 +1275,12 @@ static size_t EstimateRemovedBlocks(
    AudacityProject &project, size_t begin, size_t end)
 {
    auto &manager = UndoManager::Get(project);
+   auto &spiller = UndoStateSpiller::Get(project);
 
    // Collect ids that survive
    SampleBlockIDSet wontDelete;
    auto f = [&](const UndoStackElem &elem) {
-      if (auto pTracks = TrackList::FindUndoTracks(elem))
-         InspectBlocks(*pTracks, {}, &wontDelete);
+      spiller.InspectBlocks(elem, {}, &wontDelete);
    };
    manager.VisitStates(f, 0, begin);
    manager.VisitStates(f, end, manager.GetNumStates());
@@ -1079,16 +1291,14 @@ static size_t EstimateRemovedBlocks(
    // Collect ids that won't survive (and are not negative pseudo ids)
    SampleBlockIDSet seen, mayDelete;
    manager.VisitStates([&](const UndoStackElem &elem) {
-      if (auto pTracks = TrackList::FindUndoTracks(elem)) {
-         InspectBlocks(*pTracks,
-            [&](const SampleBlock &block){
-               auto id = block.GetBlockID();
-               if (id > 0 && !wontDelete.count(id))
-                  mayDelete.insert(id);
-            },
-            &seen
-         );
-      }
+      spiller.InspectBlocks(elem,
+         [&](const SampleBlock &block){
+            auto id = block.GetBlockID();
+            if (id > 0 && !wontDelete.count(id))
+               mayDelete.insert(id);
+         },
+         &seen
+      );
    }, begin, end);
    return mayDelete.size();
 }
@@ -1132,3 +1342,11 @@ static SampleBlockFactory::Factory::Scope scope{ []( AudacityProject &project )
 {
    return std::make_shared<SqliteSampleBlockFactory>( project );
 } };
+
+// For tests only, which declare it themselves
+PROJECT_FILE_IO_API size_t CountIndexedSampleBlocks(AudacityProject &project)
+{
+   const auto pFactory = std::dynamic_pointer_cast<SqliteSampleBlockFactory>(
+      WaveTrackFactory::Get(project).GetSampleBlockFactory());
+   return pFactory ? pFactory->CountIndexed() : 0;
+}
@@ -0,0 +1,437 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  UndoStateSpiller.cpp
+
+*******************************************************************//**
+
+\class UndoStateSpiller
+\brief Spills old states of undo history to a scratch database, when they
+occupy more memory than UndoMemoryBudget allows
+
+*//*******************************************************************/
+
+#include "UndoStateSpiller.h"
+
+#include <sqlite3.h>
+
+#include <cstring>
+#include <unordered_set>
+#include <utility>
+
+#include <wx/filefn.h>
+#include <wx/filename.h>
+#include <wx/log.h>
+
+#include "AudacityException.h"
+#include "BufferedStreamReader.h"
+#include "Envelope.h"
+#include "MemoryX.h"
+#include "Project.h"
+#include "ProjectSerializer.h"
+#include "Sequence.h"
+#include "TempDirectory.h"
+#include "UndoManager.h"
+#include "WaveClip.h"
+
+IntSetting UndoMemoryBudget{ L"/History/MemoryBudget", 1024 };
+
+namespace {
+constexpr auto UndoStateTag = "undostate";
+
+//! Rough size of a track object and its attachments, less its clips
+constexpr size_t TrackBytes = 4096;
+
+template<typename F> void VisitClips(const TrackList &tracks, const F &f)
+{
+   for (auto wt : tracks.Any<const WaveTrack>())
+      for (const auto pChannel : TrackList::Channels(wt))
+         for (const auto &clip : pChannel->GetAllClips())
+            f(std::as_const(*clip));
+}
+
+//! Estimate the memory of tracks, not counting block arrays that
+//! `pPrevious` shares
+size_t EstimateMemory(const TrackList &tracks, const TrackList *pPrevious)
+{
+   std::unordered_set<const BlockArray *> shared;
+   if (pPrevious)
+      VisitClips(*pPrevious, [&](const WaveClip &clip){
+         for (size_t ii = 0, width = clip.GetWidth(); ii < width; ++ii)
+            shared.insert(clip.GetSequenceBlockArray(ii));
+      });
+
+   size_t result = tracks.Size() * TrackBytes;
+   VisitClips(tracks, [&](const WaveClip &clip){
+      result += sizeof(WaveClip);
+      if (const auto pEnvelope = clip.GetEnvelope())
+         result += pEnvelope->GetNumberOfPoints() * sizeof(EnvPoint);
+      for (size_t ii = 0, width = clip.GetWidth(); ii < width; ++ii) {
+         const auto pBlocks = clip.GetSequenceBlockArray(ii);
+         if (!shared.count(pBlocks))
+            result += sizeof(Sequence) + pBlocks->size() * sizeof(SeqBlock);
+      }
+   });
+   return result;
+}
+
+//! Feeds ProjectSerializer::Decode from a buffer
+class MemoryStreamReader final : public BufferedStreamReader
+{
+public:
+   explicit MemoryStreamReader(const std::vector<char> &bytes)
+      : mBytes{ bytes }
+   {}
+
+protected:
+   bool HasMoreData() const override
+   {
+      return mOffset < mBytes.size();
+   }
+
+   size_t ReadData(void* buffer, size_t maxBytes) override
+   {
+      const auto count = std::min(maxBytes, mBytes.size() - mOffset);
+      memcpy(buffer, mBytes.data() + mOffset, count);
+      mOffset += count;
+      return count;
+   }
+
+private:
+   const std::vector<char> &mBytes;
+   size_t mOffset{ 0 };
+};
+
+//! Re-creates the tracks of a spilled state in the project
+class UndoStateReader final : public XMLTagHandler
+{
+public:
+   explicit UndoStateReader(AudacityProject &project)
+      : mProject{ project }
+   {}
+
+   bool HandleXMLTag(const std::string_view& tag, const AttributesList &) override
+   {
+      return tag == UndoStateTag;
+   }
+
+   XMLTagHandler *HandleXMLChild(const std::string_view& tag) override
+   {
+      return ProjectFileIORegistry::Get().CallObjectAccessor(tag, mProject);
+   }
+
+private:
+   AudacityProject &mProject;
+};
+
+//! Append bytes of a MemoryStream to a vector
+void Append(std::vector<char> &bytes, const MemoryStream &stream)
+{
+   const auto data = static_cast<const char *>(stream.GetData());
+   bytes.insert(bytes.end(), data, data + stream.GetSize());
+}
+
+//! Read one blob column of a row of the undostates table
+bool ReadBlob(sqlite3 *db, const char *sql, long long rowID,
+   std::vector<char> &bytes)
+{
+   sqlite3_stmt *stmt = nullptr;
+   auto cleanup = finally([&]{ sqlite3_finalize(stmt); });
+   if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK ||
+       sqlite3_bind_int64(stmt, 1, rowID) != SQLITE_OK ||
+       sqlite3_step(stmt) != SQLITE_ROW)
+      return false;
+   const auto data = static_cast<const char *>(sqlite3_column_blob(stmt, 0));
+   const auto size = sqlite3_column_bytes(stmt, 0);
+   bytes.assign(data, data + (data ? size : 0));
+   return true;
+}
+}
+
+//! Identifies one spilled state and forgets it when destroyed
+/*! Owned by the function that re-creates the state's tracks */
+struct UndoStateSpiller::SpilledState {
+   SpilledState(std::weak_ptr<UndoStateSpiller> wSpiller,
+      const UndoStackElem &elem, long long rowID, size_t bytes)
+      : wSpiller{ move(wSpiller) }, elem{ elem }, rowID{ rowID }, bytes{ bytes }
+   {}
+   ~SpilledState()
+   {
+      if (auto pSpiller = wSpiller.lock())
+         pSpiller->Forget(*this);
+   }
+
+   const std::weak_ptr<UndoStateSpiller> wSpiller;
+   const UndoStackElem &elem;
+   const long long rowID;
+   const size_t bytes;
+};
+
+static const AudacityProject::AttachedObjects::RegisteredFactory sSpillerKey{
+   [](AudacityProject &project) {
+      return std::make_shared<UndoStateSpiller>(project);
+   }
+};
+
+UndoStateSpiller &UndoStateSpiller::Get(AudacityProject &project)
+{
+   return project.AttachedObjects::Get<UndoStateSpiller>(sSpillerKey);
+}
+
+const UndoStateSpiller &UndoStateSpiller::Get(const AudacityProject &project)
+{
+   return Get(const_cast<AudacityProject &>(project));
+}
+
+UndoStateSpiller::UndoStateSpiller(AudacityProject &project)
+   : mProject{ project }
+   , mSubscription{ UndoManager::Get(project)
+      .Subscribe(*this, &UndoStateSpiller::OnUndoRedo) }
+{
+}
+
+UndoStateSpiller::~UndoStateSpiller()
+{
+   mPins.clear();
+   if (mDB) {
+      sqlite3_close(mDB);
+      wxRemoveFile(mFileName);
+   }
+}
+
+void UndoStateSpiller::OnUndoRedo(const UndoRedoMessage &message)
+{
+   switch (message.type) {
+   case UndoRedoMessage::Modified:
+   case UndoRedoMessage::Purge:
+      // Tracks of states were destroyed, and their addresses may be reused
+      mEstimates.clear();
+      [[fallthrough]];
+   case UndoRedoMessage::Pushed:
+   case UndoRedoMessage::UndoOrRedo:
+   case UndoRedoMessage::Reset:
+      if (const auto budget = UndoMemoryBudget.Read(); budget > 0)
+         Enforce(size_t(budget) << 20);
+      break;
+   default:
+      break;
+   }
+}
+
+size_t UndoStateSpiller::GetMemoryUsage()
+{
+   decltype(mEstimates) estimates;
+   size_t result = 0;
+   const TrackList *pPrevious = nullptr;
+   UndoManager::Get(mProject).VisitStates([&](const UndoStackElem &elem){
+      const auto pTracks = TrackList::FindUndoTracks(elem);
+      if (!pTracks)
+         return;
+      auto iter = mEstimates.find(pTracks);
+      auto estimate = (iter != mEstimates.end() &&
+            iter->second.pPrevious == pPrevious)
+         ? iter->second
+         : Estimate{ pPrevious, EstimateMemory(*pTracks, pPrevious) };
+      result += estimate.bytes;
+      estimates.emplace(pTracks, estimate);
+      pPrevious = pTracks;
+   }, false);
+   mEstimates.swap(estimates);
+   return result;
+}
+
+size_t UndoStateSpiller::Enforce(size_t budget)
+{
+   auto &manager = UndoManager::Get(mProject);
+   const auto current = manager.GetCurrentState();
+   const auto saved = manager.GetSavedState();
+   std::vector<const UndoStackElem *> elems;
+   manager.VisitStates(
+      [&](const UndoStackElem &elem){ elems.push_back(&elem); }, false);
+
+   size_t result = 0;
+   for (size_t ii = 0; ii < elems.size() && GetMemoryUsage() > budget; ++ii) {
+      if (ii == current || static_cast<int>(ii) == saved)
+         continue;
+      if (const auto pTracks = TrackList::FindUndoTracks(*elems[ii]);
+         pTracks && Spill(*elems[ii], *pTracks))
+         ++result;
+   }
+   return result;
+}
+
+void UndoStateSpiller::InspectBlocks(const UndoStackElem &elem,
+   BlockInspector inspector, SampleBlockIDSet *pIDs)
+{
+   if (const auto pTracks = TrackList::FindUndoTracks(elem)) {
+      ::InspectBlocks(*pTracks, move(inspector), pIDs);
+      return;
+   }
+   const auto iter = mSpilled.find(&elem);
+   if (iter == mSpilled.end())
+      return;
+   for (const auto id : ReadBlockIDs(iter->second->rowID)) {
+      if (pIDs && !pIDs->insert(id).second)
+         continue;
+      if (const auto pin = mPins.find(id); inspector && pin != mPins.end())
+         inspector(*pin->second.first);
+   }
+}
+
+bool UndoStateSpiller::OpenDB()
+{
+   if (mDB)
+      return true;
+
+   mFileName = wxFileName::CreateTempFileName(
+      wxFileName{ TempDirectory::TempDir(), wxT("undo") }.GetFullPath());
+   if (mFileName.empty())
+      return false;
+
+   if (sqlite3_open(mFileName.ToUTF8(), &mDB) != SQLITE_OK ||
+       sqlite3_exec(mDB,
+          // Nothing is worth recovering after a crash
+          "PRAGMA journal_mode = OFF;"
+          "PRAGMA synchronous = OFF;"
+          "CREATE TABLE undostates"
+          "("
+          "  id                   INTEGER PRIMARY KEY,"
+          "  doc                  BLOB,"
+          "  blockids             BLOB"
+          ");",
+          nullptr, nullptr, nullptr) != SQLITE_OK)
+   {
+      wxLogMessage("Failed to create undo history database %s: %s",
+         mFileName, sqlite3_errmsg(mDB));
+      sqlite3_close(mDB);
+      mDB = nullptr;
+      wxRemoveFile(mFileName);
+      return false;
+   }
+   return true;
+}
+
+bool UndoStateSpiller::Spill(const UndoStackElem &elem, const TrackList &tracks)
+{
+   if (!OpenDB())
+      return false;
+
+   // Collect the blocks to keep alive while the state is spilled; silent
+   // blocks have no rows in the project file
+   std::vector<SampleBlockPtr> blocks;
+   std::vector<SampleBlockID> ids;
+   SampleBlockIDSet seen;
+   VisitClips(tracks, [&](const WaveClip &clip){
+      for (size_t ii = 0, width = clip.GetWidth(); ii < width; ++ii)
+         for (const auto &block : *clip.GetSequenceBlockArray(ii)) {
+            const auto &pBlock = block.sb;
+            if (!pBlock || pBlock->GetBlockID() <= 0 ||
+                !seen.insert(pBlock->GetBlockID()).second)
+               continue;
+            blocks.push_back(pBlock);
+            ids.push_back(pBlock->GetBlockID());
+         }
+   });
+
+   std::vector<char> bytes;
+   {
+      ProjectSerializer doc;
+      doc.StartTag(UndoStateTag);
+      tracks.Any().Visit([&](const Track &track){ track.WriteXML(doc); });
+      doc.EndTag(UndoStateTag);
+      // The dictionary precedes the document, as in the project file
+      Append(bytes, doc.GetDict());
+      Append(bytes, doc.GetData());
+   }
+
+   sqlite3_stmt *stmt = nullptr;
+   auto cleanup = finally([&]{ sqlite3_finalize(stmt); });
+   if (sqlite3_prepare_v2(mDB,
+          "INSERT INTO undostates(doc, blockids) VALUES(?1, ?2);",
+          -1, &stmt, nullptr) != SQLITE_OK ||
+       sqlite3_bind_blob(stmt, 1, bytes.data(), bytes.size(),
+          SQLITE_STATIC) != SQLITE_OK ||
+       sqlite3_bind_blob(stmt, 2, ids.data(), ids.size() * sizeof(ids[0]),
+          SQLITE_STATIC) != SQLITE_OK ||
+       sqlite3_step(stmt) != SQLITE_DONE)
+   {
+      wxLogMessage("Failed to spill undo state: %s", sqlite3_errmsg(mDB));
+      return false;
+   }
+
+   for (auto &pBlock : blocks) {
+      auto &pin = mPins[pBlock->GetBlockID()];
+      if (!pin.first)
+         pin.first = move(pBlock);
+      ++pin.second;
+   }
+
+   const auto pState = std::make_shared<SpilledState>(weak_from_this(),
+      elem, sqlite3_last_insert_rowid(mDB), bytes.size());
+   mSpilled.emplace(&elem, pState.get());
+   mSpilledBytes += pState->bytes;
+   mEstimates.erase(&tracks);
+
+   TrackList::ReleaseUndoTracks(elem, [pState](AudacityProject &project){
+      UndoStateSpiller::Get(project).Load(*pState);
+   });
+   return true;
+}
+
+void UndoStateSpiller::Load(const SpilledState &state)
+{
+   std::vector<char> bytes;
+   if (!mDB || !ReadBlob(mDB,
+         "SELECT doc FROM undostates WHERE id = ?1;", state.rowID, bytes))
+      throw SimpleMessageBoxException{
+         ExceptionType::Internal,
+         XO("Could not read undo history from %s").Format(mFileName),
+         XO("Warning"),
+         "Error:_Disk_full_or_not_writable"
+      };
+
+   MemoryStreamReader stream{ bytes };
+   UndoStateReader reader{ mProject };
+   if (!ProjectSerializer::Decode(stream, &reader, { "waveclip" }))
+      throw SimpleMessageBoxException{
+         ExceptionType::Internal,
+         XO("Could not decode undo history from %s").Format(mFileName),
+         XO("Warning"),
+         "Error:_Disk_full_or_not_writable"
+      };
+
+   for (const auto pTrack : TrackList::Get(mProject))
+      pTrack->LinkConsistencyFix();
+}
+
+std::vector<SampleBlockID> UndoStateSpiller::ReadBlockIDs(long long rowID)
+{
+   std::vector<char> bytes;
+   if (!mDB || !ReadBlob(mDB,
+         "SELECT blockids FROM undostates WHERE id = ?1;", rowID, bytes))
+      return {};
+   std::vector<SampleBlockID> ids(bytes.size() / sizeof(SampleBlockID));
+   memcpy(ids.data(), bytes.data(), ids.size() * sizeof(SampleBlockID));
+   return ids;
+}
+
+void UndoStateSpiller::Forget(const SpilledState &state)
+{
+   // Blocks used by no other state are deleted from the project file here,
+   // unless the state's tracks were re-created
+   for (const auto id : ReadBlockIDs(state.rowID))
+      if (const auto iter = mPins.find(id);
+          iter != mPins.end() && --iter->second.second == 0)
+         mPins.erase(iter);
+
+   sqlite3_stmt *stmt = nullptr;
+   auto cleanup = finally([&]{ sqlite3_finalize(stmt); });
+   if (sqlite3_prepare_v2(mDB, "DELETE FROM undostates WHERE id = ?1;",
+          -1, &stmt, nullptr) == SQLITE_OK &&
+       sqlite3_bind_int64(stmt, 1, state.rowID) == SQLITE_OK)
+      sqlite3_step(stmt);
+
+   mSpilledBytes -= state.bytes;
+   mSpilled.erase(&state.elem);
+}
@@ -0,0 +1,102 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  UndoStateSpiller.h
+
+**********************************************************************/
+
+#ifndef __AUDACITY_UNDO_STATE_SPILLER__
+#define __AUDACITY_UNDO_STATE_SPILLER__
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "ClientData.h" // to inherit
+#include "Observer.h"
+#include "Prefs.h"
+#include "SampleBlock.h"
+#include "WaveTrack.h" // for BlockInspector, SampleBlockIDSet
+
+struct sqlite3;
+
+class AudacityProject;
+struct UndoRedoMessage;
+struct UndoStackElem;
+
+//! Megabytes of memory that undo history may occupy before older states are
+//! spilled to disk; zero for no limit
+extern PROJECT_FILE_IO_API IntSetting UndoMemoryBudget;
+
+///\brief Keeps the memory held by undo history within UndoMemoryBudget
+/*!
+ When the estimated memory of the states of history exceeds the budget, the
+ tracks of the oldest states are serialized with ProjectSerializer into a
+ scratch database and freed.  They are read back only when the state is
+ restored.  The current and the last saved states are never spilled.
+
+ Sample blocks used by spilled states are kept alive, so that their rows in the
+ project file are not deleted before the states are discarded.
+ */
+class PROJECT_FILE_IO_API UndoStateSpiller final
+   : public ClientData::Base
+   , public std::enable_shared_from_this<UndoStateSpiller>
+{
+public:
+   static UndoStateSpiller &Get(AudacityProject &project);
+   static const UndoStateSpiller &Get(const AudacityProject &project);
+
+   explicit UndoStateSpiller(AudacityProject &project);
+   UndoStateSpiller(const UndoStateSpiller &) = delete;
+   UndoStateSpiller &operator=(const UndoStateSpiller &) = delete;
+   ~UndoStateSpiller() override;
+
+   //! Estimated bytes of memory held by states of history not spilled
+   /*! Parts of tracks shared with the next older state are counted once */
+   size_t GetMemoryUsage();
+
+   //! Bytes of serialized states in the scratch database
+   size_t GetSpilledUsage() const { return mSpilledBytes; }
+
+   size_t GetSpilledCount() const { return mSpilled.size(); }
+
+   //! Spill the oldest states until GetMemoryUsage() is at most `budget`
+   /*! @return how many states were spilled */
+   size_t Enforce(size_t budget);
+
+   //! Like InspectBlocks, for the tracks of a state, whether spilled or not
+   void InspectBlocks(const UndoStackElem &elem,
+      BlockInspector inspector, SampleBlockIDSet *pIDs = nullptr);
+
+private:
+   struct SpilledState;
+   struct Estimate {
+      const TrackList *pPrevious;
+      size_t bytes;
+   };
+
+   void OnUndoRedo(const UndoRedoMessage &message);
+   bool Spill(const UndoStackElem &elem, const TrackList &tracks);
+   void Load(const SpilledState &state);
+   void Forget(const SpilledState &state);
+   std::vector<SampleBlockID> ReadBlockIDs(long long rowID);
+   bool OpenDB();
+
+   AudacityProject &mProject;
+   Observer::Subscription mSubscription;
+
+   //! Estimates for states not spilled, keyed by their tracks
+   std::unordered_map<const TrackList *, Estimate> mEstimates;
+
+   std::unordered_map<const UndoStackElem *, SpilledState *> mSpilled;
+   size_t mSpilledBytes{ 0 };
+
+   //! Blocks used by spilled states, and how many states use each
+   std::unordered_map<SampleBlockID, std::pair<SampleBlockPtr, size_t>> mPins;
+
+   FilePath mFileName;
+   sqlite3 *mDB{};
+};
+
+#endif
@@ -0,0 +1,259 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ProjectSerializerTest.cpp
+
+**********************************************************************/
+#include "BufferedStreamReader.h"
+#include "MockedPrefs.h"
+#include "ProjectSerializer.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+MockedPrefs prefs;
+
+class ByteReader final : public BufferedStreamReader
+{
+public:
+   explicit ByteReader(const std::vector<char>& bytes)
+       : mBytes { bytes }
+   {
+   }
+
+protected:
+   bool HasMoreData() const override
+   {
+      return mOffset < mBytes.size();
+   }
+
+   size_t ReadData(void* buffer, size_t maxBytes) override
+   {
+      const auto count = std::min(maxBytes, mBytes.size() - mOffset);
+      memcpy(buffer, mBytes.data() + mOffset, count);
+      mOffset += count;
+      return count;
+   }
+
+private:
+   const std::vector<char>& mBytes;
+   size_t mOffset { 0 };
+};
+
+//! Records everything it is given, so that decodings can be compared
+struct Node final : XMLTagHandler
+{
+   bool HandleXMLTag(
+      const std::string_view& tag, const AttributesList& attrs) override
+   {
+      this->tag = tag;
+      for (const auto& [name, value] : attrs)
+         attributes.emplace_back(std::string(name), value.ToString());
+      return true;
+   }
+
+   void HandleXMLEndTag(const std::string_view& tag) override
+   {
+      ended = (tag == this->tag);
+   }
+
+   void HandleXMLContent(const std::string_view& content) override
+   {
+      text += content;
+   }
+
+   XMLTagHandler* HandleXMLChild(const std::string_view&) override
+   {
+      return children.emplace_back(std::make_unique<Node>()).get();
+   }
+
+   bool operator==(const Node& other) const
+   {
+      if (tag != other.tag || attributes != other.attributes ||
+          text != other.text || ended != other.ended ||
+          children.size() != other.children.size())
+         return false;
+      for (size_t ii = 0; ii < children.size(); ++ii)
+         if (!(*children[ii] == *other.children[ii]))
+            return false;
+      return true;
+   }
+
+   std::string tag;
+   std::vector<std::pair<std::string, std::string>> attributes;
+   std::string text;
+   bool ended { false };
+   std::vector<std::unique_ptr<Node>> children;
+};
+
+void Append(std::vector<char>& bytes, const MemoryStream& stream)
+{
+   for (const auto [data, size] : stream)
+   {
+      const auto begin = static_cast<const char*>(data);
+      bytes.insert(bytes.end(), begin, begin + size);
+   }
+}
+
+//! A project document shaped like a saved one, with
+//! tracks * clips * blocks wave blocks
+std::vector<char> MakeProject(int tracks, int clips, int blocks)
+{
+   ProjectSerializer doc;
+   doc.StartTag("project");
+   doc.WriteAttr("version", wxString("3.0.0"));
+   doc.WriteAttr("rate", 44100.0);
+   for (int tt = 0; tt < tracks; ++tt)
+   {
+      doc.StartTag("wavetrack");
+      doc.WriteAttr("name", wxString::Format("Track %d", tt));
+      doc.WriteAttr("rate", 44100);
+      doc.WriteAttr("gain", 1.0);
+      for (int cc = 0; cc < clips; ++cc)
+      {
+         doc.StartTag("waveclip");
+         doc.WriteAttr("offset", cc * 10.0, 8);
+         doc.WriteAttr("name", wxString::Format("Clip %d", cc));
+         doc.StartTag("sequence");
+         doc.WriteAttr("maxsamples", 262144);
+         doc.WriteAttr("sampleformat", 262159);
+         doc.WriteAttr("numsamples", 262144LL * blocks);
+         for (long long bb = 0; bb < blocks; ++bb)
+         {
+            doc.StartTag("waveblock");
+            doc.WriteAttr("start", 262144LL * bb);
+            doc.WriteAttr(
+               "blockid", 1LL + bb + blocks * (cc + clips * (long long)tt));
+            doc.EndTag("waveblock");
+         }
+         doc.EndTag("sequence");
+         doc.StartTag("envelope");
+         doc.WriteAttr("numpoints", 1);
+         doc.StartTag("controlpoint");
+         doc.WriteAttr("t", 0.5, 12);
+         doc.WriteAttr("val", 0.75, 12);
+         doc.EndTag("controlpoint");
+         doc.EndTag("envelope");
+         doc.EndTag("waveclip");
+      }
+      doc.EndTag("wavetrack");
+   }
+   doc.StartTag("tags");
+   doc.WriteData("some text");
+   doc.EndTag("tags");
+   doc.EndTag("project");
+
+   std::vector<char> bytes;
+   // The dictionary precedes the document, as in the project file
+   Append(bytes, doc.GetDict());
+   Append(bytes, doc.GetData());
+   return bytes;
+}
+
+bool Decode(const std::vector<char>& bytes, Node& root,
+   const ProjectSerializer::IndependentTags& independentTags)
+{
+   ByteReader reader { bytes };
+   return ProjectSerializer::Decode(reader, &root, independentTags);
+}
+} // namespace
+
+TEST_CASE("ProjectSerializer decodes what it encoded")
+{
+   const auto bytes = MakeProject(2, 3, 4);
+   Node root;
+   REQUIRE(Decode(bytes, root, {}));
+   REQUIRE(root.tag == "project");
+   REQUIRE(root.ended);
+   REQUIRE(root.children.size() == 3);
+   const auto& track = *root.children[1];
+   REQUIRE(track.tag == "wavetrack");
+   REQUIRE(track.attributes[0] ==
+           std::pair<std::string, std::string> { "name", "Track 1" });
+   REQUIRE(track.children.size() == 3);
+   const auto& sequence = *track.children[2]->children[0];
+   REQUIRE(sequence.tag == "sequence");
+   REQUIRE(sequence.children.size() == 4);
+   REQUIRE(sequence.children[3]->attributes[1] ==
+           std::pair<std::string, std::string> { "blockid", "24" });
+   REQUIRE(root.children[2]->text == "some text");
+}
+
+TEST_CASE("ProjectSerializer round-trips binary attributes")
+{
+   const std::string payload { "\x01\x00\xff\x80 binary", 11 };
+   ProjectSerializer doc;
+   doc.StartTag("sequence");
+   REQUIRE(doc.WriteBinaryAttr("blocks", payload.data(), payload.size()));
+   doc.WriteAttr("numsamples", 5LL);
+   doc.EndTag("sequence");
+   std::vector<char> bytes;
+   Append(bytes, doc.GetDict());
+   Append(bytes, doc.GetData());
+
+   struct Reader final : XMLTagHandler
+   {
+      bool HandleXMLTag(
+         const std::string_view&, const AttributesList& attrs) override
+      {
+         std::string_view view;
+         if (attrs.size() == 2 && attrs[0].first == "blocks" &&
+             attrs[0].second.TryGet(view))
+            blocks = view;
+         return true;
+      }
+      XMLTagHandler* HandleXMLChild(const std::string_view&) override
+      {
+         return nullptr;
+      }
+      std::string blocks;
+   } reader;
+   ByteReader stream { bytes };
+   REQUIRE(ProjectSerializer::Decode(stream, &reader));
+   REQUIRE(reader.blocks == payload);
+}
+
+TEST_CASE("ProjectSerializer builds independent subtrees as serially")
+{
+   const auto bytes = MakeProject(5, 7, 30);
+   Node serial, concurrent;
+   REQUIRE(Decode(bytes, serial, {}));
+   REQUIRE(Decode(bytes, concurrent, { "waveclip" }));
+   REQUIRE(serial == concurrent);
+}
+
+// Hidden; run with the [benchmark] tag
+TEST_CASE("ProjectSerializer decoding of a large project", "[.][benchmark]")
+{
+   using namespace std::chrono;
+   // 128k wave blocks
+   const auto bytes = MakeProject(16, 32, 256);
+   for (const auto concurrent : { false, true })
+   {
+      const ProjectSerializer::IndependentTags tags =
+         concurrent ? ProjectSerializer::IndependentTags { "waveclip" } :
+                      ProjectSerializer::IndependentTags {};
+      double best = 0;
+      for (auto ii = 0; ii < 5; ++ii)
+      {
+         Node root;
+         const auto start = steady_clock::now();
+         REQUIRE(Decode(bytes, root, tags));
+         const auto elapsed =
+            duration<double, std::milli>(steady_clock::now() - start).count();
+         best = ii == 0 ? elapsed : std::min(best, elapsed);
+      }
+      std::cout << (concurrent ? "concurrent clips: " : "serial: ") << best
+                << " ms for " << bytes.size() / 1024 << " KB\n";
+   }
+}
@@ -0,0 +1,181 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SqliteSampleBlockTest.cpp
+
+**********************************************************************/
+#include "MockedPrefs.h"
+#include "Project.h"
+#include "ProjectFileIO.h"
+#include "SampleBlock.h"
+#include "WaveTrack.h"
+
+#include <catch2/catch.hpp>
+
+#include <wx/filename.h>
+
+#include <atomic>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+//! How many entries the index of block contents of the project has; each
+//! dying block removes its own; defined in SqliteSampleBlock.cpp for tests
+PROJECT_FILE_IO_API size_t CountIndexedSampleBlocks(AudacityProject& project);
+
+namespace
+{
+MockedPrefs prefs;
+
+//! A project with its database open in a file of its own
+struct OpenProject
+{
+   OpenProject()
+       : fileName { wxFileName::CreateTempFileName(wxT("blocks")) }
+   {
+      REQUIRE(ProjectFileIO::InitializeSQL());
+      auto& projectFileIO = ProjectFileIO::Get(*project);
+      projectFileIO.SetFileName(fileName);
+      REQUIRE(projectFileIO.OpenProject());
+   }
+
+   ~OpenProject()
+   {
+      ProjectFileIO::Get(*project).CloseProject();
+      project.reset();
+      ProjectFileIO::RemoveProject(fileName);
+   }
+
+   SampleBlockFactory& Factory()
+   {
+      return *WaveTrackFactory::Get(*project).GetSampleBlockFactory();
+   }
+
+   bool HasRow(SampleBlockID id)
+   {
+      return ProjectFileIO::Get(*project).GetBlockUsage(id) > 0;
+   }
+
+   const FilePath fileName;
+   std::shared_ptr<AudacityProject> project { AudacityProject::Create() };
+};
+
+std::vector<float> Ramp(size_t len, float first)
+{
+   std::vector<float> samples(len);
+   std::iota(samples.begin(), samples.end(), first);
+   return samples;
+}
+
+SampleBlockPtr
+Create(SampleBlockFactory& factory, const std::vector<float>& samples)
+{
+   return factory.Create(
+      reinterpret_cast<constSamplePtr>(samples.data()), samples.size(),
+      floatSample);
+}
+} // namespace
+
+TEST_CASE("Sample blocks with identical contents share one row")
+{
+   OpenProject open;
+   auto& factory = open.Factory();
+   const auto samples = Ramp(1000, 0);
+
+   const auto first = Create(factory, samples);
+   const auto second = Create(factory, samples);
+   REQUIRE(first == second);
+   REQUIRE(open.HasRow(first->GetBlockID()));
+
+   // Other samples, or the same samples in another format, are other blocks
+   const auto other = Create(factory, Ramp(1000, 1));
+   REQUIRE(other->GetBlockID() != first->GetBlockID());
+   const auto shorter = Create(factory, Ramp(999, 0));
+   REQUIRE(shorter->GetBlockID() != first->GetBlockID());
+   const auto asInts = factory.Create(
+      reinterpret_cast<constSamplePtr>(samples.data()), samples.size(),
+      int24Sample);
+   REQUIRE(asInts->GetBlockID() != first->GetBlockID());
+}
+
+TEST_CASE("A shared row survives until the last holder releases it")
+{
+   OpenProject open;
+   auto& factory = open.Factory();
+   const auto samples = Ramp(1000, 0);
+
+   auto first = Create(factory, samples);
+   auto second = Create(factory, samples);
+   const auto id = first->GetBlockID();
+   REQUIRE(second->GetBlockID() == id);
+
+   first.reset();
+   REQUIRE(open.HasRow(id));
+   std::vector<float> read(samples.size());
+   REQUIRE(
+      second->GetSamples(
+         reinterpret_cast<samplePtr>(read.data()), floatSample, 0,
+         read.size()) == read.size());
+   REQUIRE(read == samples);
+
+   second.reset();
+   REQUIRE(!open.HasRow(id));
+}
+
+TEST_CASE("A dying sample block forgets its contents")
+{
+   OpenProject open;
+   auto& factory = open.Factory();
+   const auto samples = Ramp(1000, 0);
+
+   auto block = Create(factory, samples);
+   auto other = Create(factory, Ramp(1000, 1));
+   REQUIRE(CountIndexedSampleBlocks(*open.project) == 2);
+
+   const auto id = block->GetBlockID();
+   block.reset();
+   REQUIRE(CountIndexedSampleBlocks(*open.project) == 1);
+
+   // The same contents again make a new block, not the dead one
+   block = Create(factory, samples);
+   REQUIRE(block->GetBlockID() != id);
+   REQUIRE(open.HasRow(block->GetBlockID()));
+   REQUIRE(CountIndexedSampleBlocks(*open.project) == 2);
+}
+
+TEST_CASE("No thread gets a sample block that failed to load")
+{
+   OpenProject open;
+   auto& factory = open.Factory();
+   // No such row
+   const AttributesList attrs {
+      { "blockid", XMLAttributeValueView { 1000000LL } }
+   };
+
+   constexpr size_t nThreads = 8;
+   std::atomic<bool> go { false };
+   std::atomic<size_t> failures { 0 };
+   std::vector<std::thread> threads;
+   for (size_t ii = 0; ii < nThreads; ++ii)
+      threads.emplace_back([&] {
+         while (!go)
+            std::this_thread::yield();
+         try
+         {
+            factory.CreateFromXML(floatSample, attrs);
+         }
+         catch (...)
+         {
+            ++failures;
+         }
+      });
+   go = true;
+   for (auto& thread : threads)
+      thread.join();
+   REQUIRE(failures == nThreads);
+
+   // A later attempt loads again, and fails again
+   REQUIRE_THROWS(factory.CreateFromXML(floatSample, attrs));
+}
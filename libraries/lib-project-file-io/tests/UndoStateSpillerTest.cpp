@@ -0,0 +1,233 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  UndoStateSpillerTest.cpp
+
+**********************************************************************/
+#include "FileNames.h"
+#include "MockedPrefs.h"
+#include "Project.h"
+#include "ProjectFileIO.h"
+#include "ProjectHistory.h"
+#include "Sequence.h"
+#include "UndoManager.h"
+#include "UndoStateSpiller.h"
+#include "WaveTrack.h"
+
+#include <catch2/catch.hpp>
+
+#include <wx/filename.h>
+
+#include <numeric>
+#include <vector>
+
+namespace
+{
+MockedPrefs prefs;
+
+//! A project with its database open in a file of its own, and a history
+//! that begins with a saved state of no tracks
+struct OpenProject
+{
+   OpenProject()
+       : fileName { wxFileName::CreateTempFileName(wxT("spill")) }
+   {
+      // Spilled states go to the temporary directory
+      gPrefs->Write(
+         FileNames::PreferenceKey(
+            FileNames::Operation::Temp, FileNames::PathType::_None),
+         wxFileName::GetTempDir());
+      // Enforced only where a test sets it
+      UndoMemoryBudget.Write(0);
+
+      REQUIRE(ProjectFileIO::InitializeSQL());
+      auto& projectFileIO = ProjectFileIO::Get(*project);
+      projectFileIO.SetFileName(fileName);
+      REQUIRE(projectFileIO.OpenProject());
+      UndoStateSpiller::Get(*project);
+      ProjectHistory::Get(*project).InitialState();
+   }
+
+   ~OpenProject()
+   {
+      UndoMemoryBudget.Reset();
+      ProjectFileIO::Get(*project).CloseProject();
+      project.reset();
+      ProjectFileIO::RemoveProject(fileName);
+   }
+
+   std::shared_ptr<WaveTrack> AddTrack(const std::vector<float>& samples)
+   {
+      const auto track =
+         WaveTrackFactory::Get(*project).Create(floatSample, 44100);
+      TrackList::Get(*project).Add(track);
+      Append(*track, samples);
+      return track;
+   }
+
+   static void Append(WaveTrack& track, const std::vector<float>& samples)
+   {
+      track.GetChannel(0)->Append(
+         reinterpret_cast<constSamplePtr>(samples.data()), floatSample,
+         samples.size());
+      track.Flush();
+   }
+
+   void Push()
+   {
+      ProjectHistory::Get(*project).PushState(
+         Verbatim("Edit"), Verbatim("Edit"), UndoPush::NOAUTOSAVE);
+   }
+
+   const UndoStackElem& State(size_t index)
+   {
+      const UndoStackElem* result = nullptr;
+      size_t ii = 0;
+      UndoManager::Get(*project).VisitStates(
+         [&](const UndoStackElem& elem) {
+            if (ii++ == index)
+               result = &elem;
+         },
+         false);
+      REQUIRE(result);
+      return *result;
+   }
+
+   UndoStateSpiller& Spiller()
+   {
+      return UndoStateSpiller::Get(*project);
+   }
+
+   const FilePath fileName;
+   std::shared_ptr<AudacityProject> project { AudacityProject::Create() };
+};
+
+std::vector<float> Ramp(size_t len, float first)
+{
+   std::vector<float> samples(len);
+   std::iota(samples.begin(), samples.end(), first);
+   return samples;
+}
+
+std::vector<float> GetSamples(const WaveTrack& track)
+{
+   std::vector<float> samples(track.GetVisibleSampleCount().as_size_t());
+   REQUIRE(
+      track.GetChannel(0)->GetFloats(samples.data(), 0, samples.size()));
+   return samples;
+}
+
+// Small blocks, so that block arrays are long enough to count
+struct SmallBlocks
+{
+   SmallBlocks()
+       : oldSize { Sequence::GetMaxDiskBlockSize() }
+   {
+      Sequence::SetMaxDiskBlockSize(1024);
+   }
+   ~SmallBlocks()
+   {
+      Sequence::SetMaxDiskBlockSize(oldSize);
+   }
+   const size_t oldSize;
+};
+} // namespace
+
+TEST_CASE("Undo history is spilled beyond its memory budget")
+{
+   OpenProject open;
+   // Enough tracks that a few states exceed one megabyte
+   constexpr size_t nTracks = 100;
+   std::vector<std::shared_ptr<WaveTrack>> tracks;
+   for (size_t ii = 0; ii < nTracks; ++ii)
+      tracks.push_back(open.AddTrack(Ramp(100, ii)));
+   open.Push();
+   REQUIRE(open.Spiller().GetSpilledCount() == 0);
+
+   UndoMemoryBudget.Write(1);
+   for (size_t ii = 0; ii < 4; ++ii)
+   {
+      OpenProject::Append(*tracks[ii], Ramp(100, 0));
+      open.Push();
+   }
+
+   auto& spiller = open.Spiller();
+   REQUIRE(spiller.GetSpilledCount() >= 2);
+   REQUIRE(spiller.GetMemoryUsage() <= size_t { 1 } << 20);
+   REQUIRE(spiller.GetSpilledUsage() > 0);
+
+   // Never the current or the saved state
+   auto& manager = UndoManager::Get(*open.project);
+   REQUIRE(TrackList::FindUndoTracks(open.State(manager.GetCurrentState())));
+   REQUIRE(TrackList::FindUndoTracks(open.State(manager.GetSavedState())));
+}
+
+TEST_CASE("A spilled undo state is restored with its samples")
+{
+   OpenProject open;
+   const auto first = Ramp(5000, 0);
+   const auto second = Ramp(3000, 10000);
+   const auto track = open.AddTrack(first);
+   track->SetName(wxT("Spilled"));
+   open.Push();
+   OpenProject::Append(*track, second);
+   open.Push();
+
+   // State 0 is saved and state 2 is current
+   auto& spiller = open.Spiller();
+   REQUIRE(spiller.Enforce(0) == 1);
+   REQUIRE(spiller.GetSpilledCount() == 1);
+   REQUIRE(!TrackList::FindUndoTracks(open.State(1)));
+   const auto spilledBytes = spiller.GetSpilledUsage();
+   REQUIRE(spilledBytes > 0);
+
+   auto& history = ProjectHistory::Get(*open.project);
+   history.SetStateTo(1, false);
+   auto& tracks = TrackList::Get(*open.project);
+   REQUIRE(tracks.Size() == 1);
+   // Tracks are re-created from the serialized state, so their TrackIds are
+   // new; compare what was written instead
+   const auto restored = *tracks.Any<WaveTrack>().begin();
+   REQUIRE(restored->GetName() == wxT("Spilled"));
+   REQUIRE(GetSamples(*restored) == first);
+
+   // The state holds its tracks in memory again
+   REQUIRE(spiller.GetSpilledCount() == 0);
+   REQUIRE(spiller.GetSpilledUsage() == 0);
+   REQUIRE(TrackList::FindUndoTracks(open.State(1)));
+
+   history.SetStateTo(2, false);
+   auto both = first;
+   both.insert(both.end(), second.begin(), second.end());
+   REQUIRE(GetSamples(**tracks.Any<WaveTrack>().begin()) == both);
+}
+
+TEST_CASE("Undo memory counts block arrays shared between states once")
+{
+   SmallBlocks smallBlocks;
+   OpenProject open;
+   const auto track = open.AddTrack(Ramp(100 * 1024, 0));
+   open.Push();
+   auto& spiller = open.Spiller();
+   const auto one = spiller.GetMemoryUsage();
+
+   // An unchanged state shares the block arrays of the one before
+   const auto arrayBytes = 100 * sizeof(SeqBlock);
+   open.Push();
+   const auto two = spiller.GetMemoryUsage();
+   REQUIRE(two > one);
+   REQUIRE(two - one < arrayBytes);
+
+   // A changed state has an array of its own
+   OpenProject::Append(*track, Ramp(1024, 0));
+   open.Push();
+   const auto three = spiller.GetMemoryUsage();
+   REQUIRE(three - two > arrayBytes);
+
+   // Spilling frees the estimate of the state
+   REQUIRE(spiller.Enforce(two) >= 1);
+   REQUIRE(spiller.GetMemoryUsage() <= two);
+   REQUIRE(spiller.GetMemoryUsage() < three);
+}
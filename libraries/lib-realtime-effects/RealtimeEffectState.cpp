@@ -10,6 +10,7 @@
 
 #include "RealtimeEffectState.h"
 
+#include "AudioTrace.h"
 #include "Channel.h"
 #include "EffectInterface.h"
 #include "MessageBuffer.h"
@@ -538,6 +539,8 @@ size_t RealtimeEffectState::Process(
    const float *const *inbuf, float *const *outbuf, float *const dummybuf,
    size_t numSamples)
 {
+   auto stopwatch =
+      AudioTrace::CreateStopwatch(AudioTrace::SectionID::RealtimeEffect);
    auto pInstance = mwInstance.lock();
    if (!mPlugin || !pInstance || !mLastActive) {
       // Process trivially
@@ -1386,6 +1386,26 @@ struct TrackListRestorer final : UndoStateExtension {
    }
    void RestoreUndoRedoState(AudacityProject &project) override {
       auto &dstTracks = TrackList::Get(project);
+      if (mLoader) {
+         // Keep the present tracks until the released ones are re-created
+         const auto pOldTracks = TrackList::Create(nullptr);
+         for (auto pTrack : dstTracks)
+            pOldTracks->Append(std::move(*pTrack->Duplicate()));
+         dstTracks.Clear();
+         try {
+            mLoader(project);
+         }
+         catch (...) {
+            dstTracks.Clear();
+            dstTracks.Append(std::move(*pOldTracks));
+            throw;
+         }
+         mLoader = nullptr;
+         mpTracks = TrackList::Create(nullptr);
+         for (auto pTrack : dstTracks)
+            mpTracks->Append(std::move(*pTrack->Duplicate()));
+         return;
+      }
       dstTracks.Clear();
       for (auto pTrack : *mpTracks)
          dstTracks.Append(std::move(*pTrack->Duplicate()));
@@ -1393,7 +1413,9 @@ struct TrackListRestorer final : UndoStateExtension {
    bool CanUndoOrRedo(const AudacityProject &project) override {
       return !TrackList::Get(project).HasPendingTracks();
    }
-   const std::shared_ptr<TrackList> mpTracks;
+   //! Null while released
+   std::shared_ptr<TrackList> mpTracks;
+   TrackList::UndoTracksLoader mLoader;
 };
 
 UndoRedoExtensionRegistry::Entry sEntry {
@@ -1403,7 +1425,7 @@ UndoRedoExtensionRegistry::Entry sEntry {
 };
 }
 
-TrackList *TrackList::FindUndoTracks(const UndoStackElem &state)
+static TrackListRestorer *FindRestorer(const UndoStackElem &state)
 {
    auto &exts = state.state.extensions;
    auto end = exts.end(),
@@ -1411,10 +1433,28 @@ TrackList *TrackList::FindUndoTracks(const UndoStackElem &state)
          return dynamic_cast<TrackListRestorer*>(pExt.get());
       });
    if (iter != end)
-      return static_cast<TrackListRestorer*>(iter->get())->mpTracks.get();
+      return static_cast<TrackListRestorer*>(iter->get());
    return nullptr;
 }
 
+TrackList *TrackList::FindUndoTracks(const UndoStackElem &state)
+{
+   if (const auto pRestorer = FindRestorer(state))
+      return pRestorer->mpTracks.get();
+   return nullptr;
+}
+
+bool TrackList::ReleaseUndoTracks(
+   const UndoStackElem &state, UndoTracksLoader loader)
+{
+   const auto pRestorer = FindRestorer(state);
+   if (!pRestorer || !pRestorer->mpTracks || !loader)
+      return false;
+   pRestorer->mLoader = std::move(loader);
+   pRestorer->mpTracks.reset();
+   return true;
+}
+
 TrackListHolder TrackList::Temporary(AudacityProject *pProject,
    const Track::Holder &left, const Track::Holder &right)
 {
@@ -1011,8 +1011,21 @@ class TRACK_API TrackList final
    static TrackList &Get( AudacityProject &project );
    static const TrackList &Get( const AudacityProject &project );
 
+   //! @return null if there are no tracks in the state, or they were released
    static TrackList *FindUndoTracks(const UndoStackElem &state);
 
+   //! Adds re-created tracks to the emptied TrackList of the project
+   using UndoTracksLoader = std::function<void(AudacityProject &project)>;
+
+   //! Free the copies of tracks held by a state of undo history
+   /*!
+    If the state is restored, `loader` is called once to re-create the tracks,
+    and then destroyed; copies are held again.
+    @return whether the state held tracks in memory
+    */
+   static bool ReleaseUndoTracks(
+      const UndoStackElem &state, UndoTracksLoader loader);
+
    // Create an empty TrackList
    // Don't call directly -- use Create() instead
    explicit TrackList( AudacityProject *pOwner );
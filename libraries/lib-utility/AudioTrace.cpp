@@ -0,0 +1,327 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file AudioTrace.cpp
+
+**********************************************************************/
+#include "AudioTrace.h"
+
+#include <atomic>
+#include <cstdio>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace
+{
+using Clock = AudioTrace::Clock;
+using SectionID = AudioTrace::SectionID;
+
+struct Event
+{
+   Clock::time_point start;
+   Clock::duration duration;
+   SectionID section;
+};
+
+//! About 0.75 MB per thread; a minute or more of playback at typical latencies
+constexpr size_t EventsPerThread = 1 << 15;
+constexpr auto MaxThreads = AudioTrace::MaxThreads;
+
+//! Events of one thread at a time
+/*!
+ Only the thread that has claimed the buffer writes the events and the counts.
+ It publishes each event by a release store of the count; a reader that finds
+ the current generation may read that many events.
+ */
+struct ThreadBuffer
+{
+   //! Null until the first Start()
+   std::atomic<Event*> events { nullptr };
+   std::atomic<size_t> count { 0 };
+   std::atomic<size_t> dropped { 0 };
+   std::atomic<unsigned> generation { 0 };
+
+   std::atomic<bool> claimed { false };
+   //! Whether any thread ever claimed the buffer, so it has a row
+   std::atomic<bool> used { false };
+   //! Incremented as each thread gives the buffer back
+   std::atomic<unsigned> releases { 0 };
+
+   // Guarded by the mutex of the registry
+   std::string name;
+   //! Value of releases when the name was set; the name is stale after
+   unsigned nameReleases { 0 };
+};
+
+struct Registry
+{
+   std::mutex mutex;
+   ThreadBuffer buffers[MaxThreads];
+   std::atomic<bool> tracing { false };
+   std::atomic<unsigned> generation { 0 };
+   //! Events of threads that found no free buffer
+   std::atomic<size_t> unbuffered { 0 };
+   // Guarded by the mutex
+   std::unique_ptr<Event[]> storage;
+   Clock::time_point start {};
+};
+
+Registry& GetRegistry()
+{
+   static Registry registry;
+   return registry;
+}
+
+//! Gives the buffer of the calling thread back to the pool when the thread
+//! ends
+struct ThreadBufferHolder
+{
+   ~ThreadBufferHolder()
+   {
+      if (pBuffer)
+      {
+         // The next thread to claim the buffer names it anew, if at all
+         pBuffer->releases.fetch_add(1, std::memory_order_relaxed);
+         pBuffer->claimed.store(false, std::memory_order_release);
+      }
+   }
+
+   ThreadBuffer* pBuffer { nullptr };
+};
+
+//! Claim a buffer for the calling thread, if not done already
+/*! Does not lock or allocate
+ @return null if all are claimed by other threads; try again later
+ */
+ThreadBuffer* GetThreadBuffer() noexcept
+{
+   thread_local ThreadBufferHolder holder;
+   if (holder.pBuffer)
+      return holder.pBuffer;
+
+   for (auto& buffer : GetRegistry().buffers)
+   {
+      bool claimed = false;
+      if (buffer.claimed.compare_exchange_strong(
+             claimed, true, std::memory_order_acquire,
+             std::memory_order_relaxed))
+      {
+         buffer.used.store(true, std::memory_order_relaxed);
+         return holder.pBuffer = &buffer;
+      }
+   }
+   return nullptr;
+}
+
+void AddEvent(const Event& event) noexcept
+{
+   auto& registry = GetRegistry();
+   const auto pBuffer = GetThreadBuffer();
+   if (!pBuffer)
+   {
+      registry.unbuffered.fetch_add(1, std::memory_order_relaxed);
+      return;
+   }
+   auto& buffer = *pBuffer;
+   const auto events = buffer.events.load(std::memory_order_acquire);
+   if (!events)
+      return;
+
+   const auto generation = registry.generation.load(std::memory_order_relaxed);
+   if (buffer.generation.load(std::memory_order_relaxed) != generation)
+   {
+      // First event since Start(); forget the older ones
+      buffer.count.store(0, std::memory_order_relaxed);
+      buffer.dropped.store(0, std::memory_order_relaxed);
+      buffer.generation.store(generation, std::memory_order_release);
+   }
+
+   const auto count = buffer.count.load(std::memory_order_relaxed);
+   if (count == EventsPerThread)
+   {
+      buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+   }
+   events[count] = event;
+   buffer.count.store(count + 1, std::memory_order_release);
+}
+
+void WriteString(std::ostream& stream, const std::string& string)
+{
+   stream << '"';
+   for (const auto ch : string)
+   {
+      if (ch == '"' || ch == '\\')
+         stream << '\\' << ch;
+      else if (static_cast<unsigned char>(ch) < 0x20)
+         stream << ' ';
+      else
+         stream << ch;
+   }
+   stream << '"';
+}
+
+//! Microseconds with fixed precision, regardless of the flags of the stream
+void WriteMicroseconds(std::ostream& stream, Clock::duration duration)
+{
+   char buffer[32];
+   std::snprintf(
+      buffer, sizeof buffer, "%.3f",
+      std::chrono::duration<double, std::micro>(duration).count());
+   stream << buffer;
+}
+} // namespace
+
+AudioTrace::Stopwatch::Stopwatch(SectionID section) noexcept
+    : mSection { section }
+    , mActive { GetRegistry().tracing.load(std::memory_order_relaxed) }
+{
+   if (mActive)
+      mStart = Clock::now();
+}
+
+AudioTrace::Stopwatch::~Stopwatch() noexcept
+{
+   if (mActive)
+      AddEvent({ mStart, Clock::now() - mStart, mSection });
+}
+
+AudioTrace::Stopwatch AudioTrace::CreateStopwatch(SectionID section) noexcept
+{
+   return Stopwatch { section };
+}
+
+const char* AudioTrace::GetSectionName(SectionID section) noexcept
+{
+   static const char* const names[] {
+      "Mixer::Process",     "MixerSource::Acquire",
+      "Resample",           "EffectStage",
+      "RealtimeEffect",     "ProcessPlaybackSlices",
+      "Playback Put",       "DrainRecordBuffers",
+      "AudioCallback",
+   };
+   static_assert(
+      std::size(names) == static_cast<size_t>(SectionID::Count),
+      "Name every section");
+   const auto index = static_cast<size_t>(section);
+   return index < std::size(names) ? names[index] : "";
+}
+
+void AudioTrace::Start()
+{
+   auto& registry = GetRegistry();
+   std::lock_guard<std::mutex> lock { registry.mutex };
+   if (!registry.storage)
+   {
+      registry.storage =
+         std::make_unique<Event[]>(MaxThreads * EventsPerThread);
+      for (size_t ii = 0; ii < MaxThreads; ++ii)
+         registry.buffers[ii].events.store(
+            registry.storage.get() + ii * EventsPerThread,
+            std::memory_order_release);
+   }
+   registry.start = Clock::now();
+   registry.unbuffered.store(0, std::memory_order_relaxed);
+   registry.generation.fetch_add(1, std::memory_order_relaxed);
+   registry.tracing.store(true, std::memory_order_relaxed);
+}
+
+void AudioTrace::Stop() noexcept
+{
+   GetRegistry().tracing.store(false, std::memory_order_relaxed);
+}
+
+bool AudioTrace::IsTracing() noexcept
+{
+   return GetRegistry().tracing.load(std::memory_order_relaxed);
+}
+
+void AudioTrace::SetThreadName(const char* name)
+{
+   const auto pBuffer = GetThreadBuffer();
+   if (!pBuffer)
+      return;
+   auto& registry = GetRegistry();
+   std::lock_guard<std::mutex> lock { registry.mutex };
+   pBuffer->name = name;
+   pBuffer->nameReleases =
+      pBuffer->releases.load(std::memory_order_relaxed);
+}
+
+void AudioTrace::WriteChromeTrace(std::ostream& stream)
+{
+   auto& registry = GetRegistry();
+
+   // Copy what the mutex guards, and write without blocking other threads
+   struct Row
+   {
+      const ThreadBuffer* pBuffer;
+      size_t id;
+      std::string name;
+   };
+   std::vector<Row> rows;
+   unsigned generation;
+   Clock::time_point start;
+   {
+      std::lock_guard<std::mutex> lock { registry.mutex };
+      generation = registry.generation.load(std::memory_order_relaxed);
+      start = registry.start;
+      for (size_t ii = 0; ii < MaxThreads; ++ii)
+      {
+         const auto& buffer = registry.buffers[ii];
+         if (!buffer.used.load(std::memory_order_relaxed))
+            continue;
+         // The name of a thread that has ended is stale
+         const bool named = buffer.nameReleases ==
+            buffer.releases.load(std::memory_order_relaxed);
+         rows.push_back({ &buffer, ii + 1, named ? buffer.name : "" });
+      }
+   }
+
+   stream << "{\"traceEvents\":[";
+   const char* separator = "\n";
+   size_t dropped = registry.unbuffered.load(std::memory_order_relaxed);
+   for (const auto& [pBuffer, id, name] : rows)
+   {
+      const auto& buffer = *pBuffer;
+      if (!name.empty())
+      {
+         stream << separator
+                << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+                << id << ",\"args\":{\"name\":";
+         WriteString(stream, name);
+         stream << "}}";
+         separator = ",\n";
+      }
+
+      // Events of earlier generations are stale
+      if (buffer.generation.load(std::memory_order_acquire) != generation)
+         continue;
+      const auto events = buffer.events.load(std::memory_order_relaxed);
+      const auto count = buffer.count.load(std::memory_order_acquire);
+      dropped += buffer.dropped.load(std::memory_order_relaxed);
+      for (size_t ii = 0; ii < count; ++ii)
+      {
+         const auto& event = events[ii];
+         // A section may have begun before Start() and ended after
+         if (event.start < start)
+            continue;
+         stream << separator << "{\"name\":\""
+                << GetSectionName(event.section)
+                << "\",\"cat\":\"audio\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+                << id << ",\"ts\":";
+         WriteMicroseconds(stream, event.start - start);
+         stream << ",\"dur\":";
+         WriteMicroseconds(stream, event.duration);
+         stream << "}";
+         separator = ",\n";
+      }
+   }
+   stream << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":"
+          << dropped << "}}\n";
+}
@@ -0,0 +1,104 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file AudioTrace.h
+  @brief Timings of each stage of the audio path, for offline analysis
+
+**********************************************************************/
+#ifndef __AUDACITY_AUDIO_TRACE__
+#define __AUDACITY_AUDIO_TRACE__
+
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+
+//! Records when each stage of playback and recording begins and ends
+/*!
+ Like FrameStatistics, but keeping every event rather than summaries, so that
+ the interleaving of the audio thread with the audio callback can be seen.
+
+ Each thread records into a buffer of its own, without locks or allocation.
+ While not tracing, a stopwatch costs one relaxed atomic load; while tracing,
+ two reads of the clock.  The first Start() allocates a pool of MaxThreads
+ buffers.  A thread claims one with an atomic flag at its first event, and
+ gives it back when it ends, so that the threads of successive streams share
+ one row of the trace.  Events beyond the capacity of a buffer, and events of
+ threads that find no free buffer, are dropped and counted.
+ */
+class UTILITY_API AudioTrace final
+{
+public:
+   using Clock = std::chrono::steady_clock;
+
+   //! Most threads whose events are recorded at once
+   static constexpr size_t MaxThreads = 16;
+
+   //! ID of the traced section
+   enum class SectionID
+   {
+      //! Mixer::Process, for playback, export or preview
+      MixerProcess,
+      //! Fetching and resampling one sequence and applying its envelope
+      MixerSourceAcquire,
+      //! Resampling of one sequence
+      Resample,
+      //! A destructive effect applied in a Mixer
+      EffectStage,
+      //! One realtime effect processing one group of channels
+      RealtimeEffect,
+      //! Mixing and effecting of a batch of playback by the audio thread
+      PlaybackSlices,
+      //! Copying into the ring buffers for playback
+      PlaybackPut,
+      //! Draining of the ring buffers for recording by the audio thread
+      DrainRecordBuffers,
+      //! One call of the audio callback, for playback and recording
+      AudioCallback,
+      //! Number of the sections
+      Count
+   };
+
+   //! RAII wrapper used to time a section
+   class UTILITY_API Stopwatch final
+   {
+   public:
+      Stopwatch(const Stopwatch&) = delete;
+      Stopwatch& operator=(const Stopwatch&) = delete;
+      ~Stopwatch() noexcept;
+   private:
+      explicit Stopwatch(SectionID section) noexcept;
+
+      Clock::time_point mStart;
+      SectionID mSection;
+      bool mActive;
+
+      friend class AudioTrace;
+   };
+
+   //! Create a Stopwatch for the section specified
+   static Stopwatch CreateStopwatch(SectionID section) noexcept;
+
+   //! Name used for the section in written traces
+   static const char* GetSectionName(SectionID section) noexcept;
+
+   //! Discard all events recorded so far, and begin recording
+   /*! The first call allocates the buffers */
+   static void Start();
+   //! Stop recording; the events remain to be written
+   static void Stop() noexcept;
+   static bool IsTracing() noexcept;
+
+   //! Name the calling thread in traces written later
+   static void SetThreadName(const char* name);
+
+   //! Write the events since the last Start() in the Trace Event Format of
+   //! chrome://tracing and Perfetto
+   /*!
+    May be called while tracing, but not concurrently with Start()
+    */
+   static void WriteChromeTrace(std::ostream& stream);
+};
+
+#endif
@@ -0,0 +1,118 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file Parallel.cpp
+
+**********************************************************************/
+#include "Parallel.h"
+
+#include <condition_variable>
+#include <deque>
+
+namespace {
+std::atomic<size_t> sMaxConcurrency{ 0 };
+
+//! Threads that wait for work and never end
+class Pool
+{
+public:
+   static Pool &Get()
+   {
+      // Never destroyed, so that the threads need not be joined during static
+      // destruction
+      static const auto pPool = new Pool;
+      return *pPool;
+   }
+
+   void Run(size_t nHelpers, const std::function<void()> &work)
+   {
+      Job job{ &work };
+      {
+         std::lock_guard<std::mutex> lock{ mMutex };
+         job.queued = nHelpers;
+         for (size_t i = 0; i < nHelpers; ++i)
+            mQueue.push_back(&job);
+         // Start only as many threads as calls in progress need at once
+         while (mThreads - mBusy < mQueue.size()) {
+            std::thread{ [this]{ Serve(); } }.detach();
+            ++mThreads;
+         }
+      }
+      mWorkCondition.notify_all();
+
+      work();
+
+      std::unique_lock<std::mutex> lock{ mMutex };
+      // A helper starting now would find nothing left to do
+      if (job.queued) {
+         mQueue.erase(std::remove(mQueue.begin(), mQueue.end(), &job),
+            mQueue.end());
+         job.queued = 0;
+      }
+      mDoneCondition.wait(lock, [&]{ return job.running == 0; });
+   }
+
+private:
+   struct Job
+   {
+      const std::function<void()> *pWork;
+      size_t queued{ 0 };
+      size_t running{ 0 };
+   };
+
+   void Serve()
+   {
+      std::unique_lock<std::mutex> lock{ mMutex };
+      while (true) {
+         mWorkCondition.wait(lock, [this]{ return !mQueue.empty(); });
+         auto &job = *mQueue.front();
+         mQueue.pop_front();
+         --job.queued;
+         ++job.running;
+         ++mBusy;
+         lock.unlock();
+         (*job.pWork)();
+         lock.lock();
+         --mBusy;
+         if (--job.running == 0)
+            mDoneCondition.notify_all();
+      }
+   }
+
+   std::mutex mMutex;
+   std::condition_variable mWorkCondition;
+   std::condition_variable mDoneCondition;
+   std::deque<Job*> mQueue;
+   size_t mThreads{ 0 };
+   size_t mBusy{ 0 };
+};
+}
+
+size_t Parallel::DefaultConcurrency()
+{
+   if (const auto max = sMaxConcurrency.load(std::memory_order_relaxed))
+      return max;
+   return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+bool &Parallel::detail::InWorker()
+{
+   static thread_local bool inWorker = false;
+   return inWorker;
+}
+
+void Parallel::detail::RunOnPool(
+   size_t nHelpers, const std::function<void()> &work)
+{
+   if (nHelpers == 0)
+      work();
+   else
+      Pool::Get().Run(nHelpers, work);
+}
+
+void Parallel::SetMaxConcurrency(size_t maxThreads)
+{
+   sMaxConcurrency.store(maxThreads, std::memory_order_relaxed);
+}
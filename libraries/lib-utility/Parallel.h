@@ -0,0 +1,118 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file Parallel.h
+  @brief Helpers to spread independent work items over several threads
+
+**********************************************************************/
+#ifndef __AUDACITY_PARALLEL__
+#define __AUDACITY_PARALLEL__
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace Parallel {
+
+//! Number of threads that independent work is spread over by default
+/*! Never less than one.  May be overridden with `SetMaxConcurrency`, for
+ instance to compare serial and parallel timings in benchmarks. */
+UTILITY_API size_t DefaultConcurrency();
+
+//! Set the value returned by `DefaultConcurrency`; 0 restores the hardware
+//! default
+UTILITY_API void SetMaxConcurrency(size_t maxThreads);
+
+namespace detail {
+//! True in threads that are executing work items of `For`
+UTILITY_API bool &InWorker();
+
+//! Call `work` in the calling thread and in up to `nHelpers` threads of a
+//! pool that persists between calls; returns when all calls have returned
+/*! `work` must not throw.  Helpers that have not started by the time the
+ calling thread returns from `work` are not waited for. */
+UTILITY_API void RunOnPool(size_t nHelpers, const std::function<void()> &work);
+}
+
+//! Call `f(i)` for each `i` in [0, count), spreading the indices over at most
+//! `maxThreads` threads, the calling thread included
+/*!
+ The other threads are kept in a pool for later calls, so that each thread
+ lives for the whole session, as do any resources it keeps for itself.
+
+ Returns only when all calls have completed.  The order in which the indices
+ are visited is unspecified, so `f` must not depend on it.
+
+ If any call throws, indices not yet started are skipped, and the first
+ exception caught is rethrown in the calling thread.
+
+ Calls nested in the work items of another `For` run serially, so that nesting
+ does not multiply the number of threads.
+ */
+template<typename F>
+void For(size_t count, const F& f, size_t maxThreads = DefaultConcurrency())
+{
+   const auto nThreads = detail::InWorker() ?
+      1 : std::min(count, std::max<size_t>(maxThreads, 1));
+   if (nThreads <= 1) {
+      for (size_t i = 0; i < count; ++i)
+         f(i);
+      return;
+   }
+
+   std::atomic<size_t> next{ 0 };
+   std::atomic<bool> failed{ false };
+   std::exception_ptr pException;
+   std::mutex exceptionMutex;
+
+   const auto work = [&] {
+      auto &inWorker = detail::InWorker();
+      const auto wasInWorker = inWorker;
+      inWorker = true;
+      try {
+         for (size_t i; !failed.load(std::memory_order_relaxed) &&
+            (i = next.fetch_add(1, std::memory_order_relaxed)) < count;)
+            f(i);
+      }
+      catch (...) {
+         std::lock_guard<std::mutex> lock{ exceptionMutex };
+         if (!pException)
+            pException = std::current_exception();
+         failed.store(true, std::memory_order_relaxed);
+      }
+      inWorker = wasInWorker;
+   };
+
+   detail::RunOnPool(nThreads - 1, work);
+
+   if (pException)
+      std::rethrow_exception(pException);
+}
+
+//! Like `For`, but collecting the values `f(i)` in a vector, in index order
+/*! `Result` must be move-constructible but need not be default-constructible
+ */
+template<typename Result, typename F>
+std::vector<Result>
+Transform(size_t count, const F& f, size_t maxThreads = DefaultConcurrency())
+{
+   std::vector<std::optional<Result>> slots(count);
+   For(count, [&](size_t i){ slots[i].emplace(f(i)); }, maxThreads);
+   std::vector<Result> results;
+   results.reserve(count);
+   for (auto &slot : slots)
+      results.push_back(std::move(*slot));
+   return results;
+}
+
+}
+
+#endif
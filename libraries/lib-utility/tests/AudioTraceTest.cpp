@@ -0,0 +1,140 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  AudioTraceTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "AudioTrace.h"
+
+#include <future>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+size_t CountOccurrences(const std::string& string, const std::string& pattern)
+{
+   size_t result = 0;
+   for (auto pos = string.find(pattern); pos != std::string::npos;
+        pos = string.find(pattern, pos + 1))
+      ++result;
+   return result;
+}
+
+std::string WriteTrace()
+{
+   std::ostringstream stream;
+   AudioTrace::WriteChromeTrace(stream);
+   return stream.str();
+}
+
+void TimeSections(size_t count)
+{
+   for (size_t ii = 0; ii < count; ++ii)
+   {
+      auto outer =
+         AudioTrace::CreateStopwatch(AudioTrace::SectionID::MixerProcess);
+      auto inner =
+         AudioTrace::CreateStopwatch(AudioTrace::SectionID::Resample);
+   }
+}
+} // namespace
+
+TEST_CASE("AudioTrace records only while tracing")
+{
+   AudioTrace::Start();
+   AudioTrace::Stop();
+   TimeSections(3);
+   auto trace = WriteTrace();
+   REQUIRE(trace.rfind("{\"traceEvents\":[", 0) == 0);
+   REQUIRE(CountOccurrences(trace, "\"ph\":\"X\"") == 0);
+
+   AudioTrace::Start();
+   REQUIRE(AudioTrace::IsTracing());
+   TimeSections(3);
+   AudioTrace::Stop();
+   TimeSections(3);
+   trace = WriteTrace();
+   REQUIRE(CountOccurrences(trace, "\"name\":\"Mixer::Process\"") == 3);
+   REQUIRE(CountOccurrences(trace, "\"name\":\"Resample\"") == 3);
+   REQUIRE(CountOccurrences(trace, "\"droppedEvents\":0") == 1);
+}
+
+TEST_CASE("AudioTrace forgets events at each start")
+{
+   AudioTrace::Start();
+   TimeSections(5);
+   AudioTrace::Start();
+   TimeSections(2);
+   AudioTrace::Stop();
+   REQUIRE(
+      CountOccurrences(WriteTrace(), "\"name\":\"Mixer::Process\"") == 2);
+}
+
+TEST_CASE("AudioTrace gives each thread its own row")
+{
+   AudioTrace::Start();
+   std::promise<void> recorded, written;
+   std::thread thread { [&] {
+      AudioTrace::SetThreadName("Worker \"1\"");
+      TimeSections(4);
+      recorded.set_value();
+      written.get_future().wait();
+   } };
+   TimeSections(1);
+   recorded.get_future().wait();
+   auto trace = WriteTrace();
+   written.set_value();
+   thread.join();
+   REQUIRE(CountOccurrences(trace, "\"name\":\"Mixer::Process\"") == 5);
+   REQUIRE(CountOccurrences(trace, "\"name\":\"Worker \\\"1\\\"\"") == 1);
+   REQUIRE(CountOccurrences(trace, "\"tid\":1,") >= 1);
+   REQUIRE(CountOccurrences(trace, "\"tid\":2,") >= 1);
+
+   // The row of the ended thread keeps its events but not its name, which
+   // would mislabel the next thread to take the row
+   trace = WriteTrace();
+   REQUIRE(CountOccurrences(trace, "\"name\":\"Mixer::Process\"") == 5);
+   REQUIRE(CountOccurrences(trace, "Worker") == 0);
+
+   std::thread { [] { TimeSections(2); } }.join();
+   AudioTrace::Stop();
+   trace = WriteTrace();
+   REQUIRE(CountOccurrences(trace, "\"name\":\"Mixer::Process\"") == 7);
+   REQUIRE(CountOccurrences(trace, "Worker") == 0);
+   REQUIRE(CountOccurrences(trace, "\"tid\":3,") == 0);
+}
+
+TEST_CASE("AudioTrace counts the events of threads beyond its buffers")
+{
+   AudioTrace::Start();
+   // This thread takes one of the buffers, so one of the others finds none
+   TimeSections(1);
+   std::promise<void> written;
+   const auto shared = written.get_future().share();
+   std::vector<std::promise<void>> recorded(AudioTrace::MaxThreads);
+   std::vector<std::thread> threads;
+   for (auto& promise : recorded)
+      threads.emplace_back([&promise, shared] {
+         TimeSections(1);
+         promise.set_value();
+         shared.wait();
+      });
+   for (auto& promise : recorded)
+      promise.get_future().wait();
+   AudioTrace::Stop();
+   const auto trace = WriteTrace();
+   written.set_value();
+   for (auto& thread : threads)
+      thread.join();
+   REQUIRE(
+      CountOccurrences(trace, "\"name\":\"Mixer::Process\"") ==
+      AudioTrace::MaxThreads);
+   REQUIRE(CountOccurrences(trace, "\"droppedEvents\":2") == 1);
+}
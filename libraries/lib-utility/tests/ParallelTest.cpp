@@ -0,0 +1,84 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ParallelTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "Parallel.h"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+TEST_CASE("Parallel::For visits each index once")
+{
+   constexpr size_t count = 1000;
+   std::vector<std::atomic<int>> visits(count);
+   Parallel::For(count, [&](size_t i){ ++visits[i]; }, 4);
+   for (auto &visit : visits)
+      REQUIRE(visit.load() == 1);
+}
+
+TEST_CASE("Parallel::Transform keeps index order")
+{
+   const auto results = Parallel::Transform<std::unique_ptr<size_t>>(
+      100, [](size_t i){ return std::make_unique<size_t>(i * i); }, 8);
+   REQUIRE(results.size() == 100);
+   for (size_t i = 0; i < results.size(); ++i)
+      REQUIRE(*results[i] == i * i);
+}
+
+TEST_CASE("Parallel::For rethrows in the calling thread")
+{
+   REQUIRE_THROWS_AS(
+      Parallel::For(64, [](size_t i){
+         if (i == 13)
+            throw std::runtime_error{ "13" };
+      }, 4),
+      std::runtime_error);
+}
+
+TEST_CASE("Parallel::For nested in a work item runs serially")
+{
+   std::vector<std::atomic<int>> visits(16 * 16);
+   Parallel::For(16, [&](size_t i){
+      const auto thread = std::this_thread::get_id();
+      Parallel::For(16, [&](size_t j){
+         REQUIRE(std::this_thread::get_id() == thread);
+         ++visits[i * 16 + j];
+      }, 4);
+   }, 4);
+   for (auto &visit : visits)
+      REQUIRE(visit.load() == 1);
+}
+
+TEST_CASE("Parallel::SetMaxConcurrency")
+{
+   Parallel::SetMaxConcurrency(3);
+   REQUIRE(Parallel::DefaultConcurrency() == 3);
+   Parallel::SetMaxConcurrency(0);
+   REQUIRE(Parallel::DefaultConcurrency() >= 1);
+}
+
+TEST_CASE("Parallel::For reuses its threads")
+{
+   std::mutex mutex;
+   std::set<std::thread::id> threads;
+   for (size_t ii = 0; ii < 50; ++ii)
+      Parallel::For(16, [&](size_t){
+         std::this_thread::sleep_for(std::chrono::microseconds{ 100 });
+         std::lock_guard<std::mutex> lock{ mutex };
+         threads.insert(std::this_thread::get_id());
+      }, 4);
+   // The calling thread and the pool, which earlier tests may have grown
+   REQUIRE(threads.size() > 1);
+   REQUIRE(threads.size() <= 8);
+}
@@ -93,3 +93,21 @@ size_t SampleBlock::GetSamples(samplePtr dest,
    }
 }
 
+SampleStats SampleBlock::GetStats(bool mayThrow)
+{
+   try{ return DoGetStats(); }
+   catch( ... ) {
+      if( mayThrow )
+         throw;
+      return SampleStats::Zeroes( GetSampleCount() );
+   }
+}
+
+SampleStats SampleBlock::DoGetStats()
+{
+   const auto count = GetSampleCount();
+   SampleBuffer buffer( count, floatSample );
+   DoGetSamples( buffer.ptr(), floatSample, 0, count );
+   return SampleStats::Calculate(
+      reinterpret_cast<const float *>( buffer.ptr() ), count );
+}
@@ -11,6 +11,7 @@ SampleBlock.h
 
 #include "GlobalVariable.h"
 #include "SampleFormat.h"
+#include "SampleStats.h"
 #include "AudioSegmentSampleView.h"
 
 #include <functional>
@@ -85,6 +86,11 @@ public:
    // That may be appropriate when only attempting to display samples, not edit.
    MinMaxRMS GetMinMaxRMS(bool mayThrow = true) const;
 
+   /// Gets further statistics of the entire block
+   // If !mayThrow and there is an error, ignores it and returns statistics of
+   // zeroes.
+   SampleStats GetStats(bool mayThrow = true);
+
    virtual size_t GetSpaceUsage() const = 0;
 
    virtual void SaveXML(XMLWriter &xmlFile) = 0;
@@ -98,6 +104,9 @@ protected:
    virtual MinMaxRMS DoGetMinMaxRMS(size_t start, size_t len) = 0;
 
    virtual MinMaxRMS DoGetMinMaxRMS() const = 0;
+
+   //! Default implementation calculates from the samples each time
+   virtual SampleStats DoGetStats();
 };
 
 // Makes a useful function object
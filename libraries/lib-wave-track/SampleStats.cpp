@@ -0,0 +1,149 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SampleStats.cpp
+
+**********************************************************************/
+#include "SampleStats.h"
+#include "MemoryX.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+std::optional<size_t> SampleStats::SilenceGridIndex(double thresholdDB)
+{
+   const auto steps = (SilenceGridTop - thresholdDB) / SilenceGridStep;
+   if (steps < 0 || steps >= SilenceGridSize || steps != std::floor(steps))
+      return {};
+   return static_cast<size_t>(steps);
+}
+
+double SampleStats::SilenceThreshold(size_t index)
+{
+   return DB_TO_LINEAR(
+      static_cast<double>(SilenceGridTop - SilenceGridStep * int(index)));
+}
+
+SampleStats SampleStats::Calculate(const float *buffer, size_t len)
+{
+   SampleStats result;
+   result.length = len;
+
+   // Find the peak of each chunk.  Any run of silence long enough to list
+   // contains a whole chunk, so the thresholds need looking at only chunk by
+   // chunk, except at the ends of runs.
+   constexpr size_t chunkSize = MinInteriorRun / 2;
+   const auto nChunks = (len + chunkSize - 1) / chunkSize;
+   std::vector<float> peaks(nChunks);
+   double sum = 0;
+   size_t clipped = 0;
+   for (size_t ii = 0; ii < nChunks; ++ii) {
+      const auto begin = buffer + ii * chunkSize,
+         end = buffer + std::min(len, (ii + 1) * chunkSize);
+      float peak = 0;
+      for (auto pSample = begin; pSample != end; ++pSample) {
+         const auto magnitude = std::fabs(*pSample);
+         peak = std::max(peak, magnitude);
+         clipped += (magnitude >= MAX_AUDIO);
+         sum += *pSample;
+      }
+      peaks[ii] = peak;
+   }
+   result.sum = sum;
+   result.clipped = clipped;
+
+   for (size_t ii = 0; ii < SilenceGridSize; ++ii) {
+      const auto threshold = SilenceThreshold(ii);
+      const auto silent = [&](size_t jj) {
+         return std::fabs(buffer[jj]) < threshold;
+      };
+      const auto silentChunk = [&](size_t jj) {
+         return peaks[jj] < threshold;
+      };
+      // Extend a run from a boundary of chunks into neighboring chunks
+      const auto runStart = [&](size_t jj) {
+         const auto stop = jj - std::min(jj, chunkSize);
+         while (jj > stop && silent(jj - 1))
+            --jj;
+         return jj;
+      };
+      const auto runEnd = [&](size_t jj) {
+         const auto stop = std::min(len, jj + chunkSize);
+         while (jj < stop && silent(jj))
+            ++jj;
+         return jj;
+      };
+
+      auto &runs = result.silence[ii];
+      size_t first = 0;
+      while (first < nChunks && silentChunk(first))
+         ++first;
+      if (first == nChunks) {
+         runs.leading = runs.trailing = len;
+         continue;
+      }
+      runs.leading = runEnd(first * chunkSize);
+      size_t last = nChunks;
+      while (silentChunk(last - 1))
+         --last;
+      runs.trailing = len - runStart(std::min(len, last * chunkSize));
+
+      // Chunks first and last - 1 are not silent
+      for (auto jj = first + 1; jj < last;) {
+         if (!silentChunk(jj)) {
+            ++jj;
+            continue;
+         }
+         const auto start = runStart(jj * chunkSize);
+         while (silentChunk(jj))
+            ++jj;
+         const auto end = runEnd(jj * chunkSize);
+         if (end - start >= MinInteriorRun)
+            runs.interior.emplace_back(start, end - start);
+      }
+   }
+
+   return result;
+}
+
+SampleStats SampleStats::Zeroes(sampleCount len)
+{
+   SampleStats result;
+   result.length = len;
+   for (auto &runs : result.silence)
+      runs.leading = runs.trailing = len;
+   return result;
+}
+
+SampleStats &SampleStats::operator +=(const SampleStats &next)
+{
+   for (size_t ii = 0; ii < SilenceGridSize; ++ii) {
+      auto &runs = silence[ii];
+      const auto &nextRuns = next.silence[ii];
+      const bool silent = runs.leading == length,
+         nextSilent = nextRuns.leading == next.length;
+      if (!silent && !nextSilent) {
+         // The runs at the junction join, touching neither end
+         const auto joined = runs.trailing + nextRuns.leading;
+         if (joined >= MinInteriorRun)
+            runs.interior.emplace_back(length - runs.trailing, joined);
+      }
+      // Offset the interior runs of next
+      for (const auto &[start, runLength] : nextRuns.interior)
+         runs.interior.emplace_back(length + start, runLength);
+
+      if (silent)
+         runs.leading += nextRuns.leading;
+      if (nextSilent)
+         runs.trailing += next.length;
+      else
+         runs.trailing = nextRuns.trailing;
+   }
+   length += next.length;
+   sum += next.sum;
+   clipped += next.clipped;
+   return *this;
+}
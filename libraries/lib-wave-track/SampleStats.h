@@ -0,0 +1,73 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SampleStats.h
+  @brief Statistics of ranges of samples that combine for adjacent ranges
+
+**********************************************************************/
+#ifndef __AUDACITY_SAMPLE_STATS__
+#define __AUDACITY_SAMPLE_STATS__
+
+#include "SampleCount.h"
+
+#include <array>
+#include <optional>
+#include <utility>
+#include <vector>
+
+//! Statistics of a range of samples, beyond minimum, maximum and RMS
+/*!
+ Each sample block keeps these for all of its samples.  Statistics of adjacent
+ ranges combine exactly, so that analysis of a long range reads samples only
+ for the blocks that the range covers partly.
+ */
+struct WAVE_TRACK_API SampleStats
+{
+   //! Runs of samples with absolute values below a threshold of silence
+   struct SilenceRuns {
+      //! Run at the start of the range; all of it, if the range is silent
+      sampleCount leading = 0;
+      //! Run at the end of the range; all of it, if the range is silent
+      sampleCount trailing = 0;
+      //! Starts (relative to the range) and lengths of the other runs, in
+      //! order, but only those at least MinInteriorRun long
+      std::vector<std::pair<sampleCount, sampleCount>> interior;
+   };
+
+   //! Shorter runs of silence are not listed in SilenceRuns::interior
+   static constexpr size_t MinInteriorRun = 1024;
+
+   //! Runs of silence are found for thresholds on a grid of decibel levels,
+   //! from SilenceGridTop down by SilenceGridStep
+   static constexpr int SilenceGridTop = -20;
+   static constexpr int SilenceGridStep = 5;
+   static constexpr size_t SilenceGridSize = 13;
+
+   //! @return position in the grid of a threshold in decibels, if it is there
+   static std::optional<size_t> SilenceGridIndex(double thresholdDB);
+
+   //! @return the linear threshold at a position in the grid, as
+   //! DB_TO_LINEAR computes it from decibels
+   static double SilenceThreshold(size_t index);
+
+   //! Statistics of samples
+   static SampleStats Calculate(const float *buffer, size_t len);
+
+   //! Statistics of len samples of zero
+   static SampleStats Zeroes(sampleCount len);
+
+   //! Extend with the statistics of the range that follows this one
+   SampleStats &operator +=(const SampleStats &next);
+
+   sampleCount length = 0;
+   //! Sum of the samples
+   double sum = 0;
+   //! How many samples have absolute value at least MAX_AUDIO
+   sampleCount clipped = 0;
+   //! Runs of silence for each threshold of the grid
+   std::array<SilenceRuns, SilenceGridSize> silence;
+};
+
+#endif
@@ -33,6 +33,7 @@
 
 #include <algorithm>
 #include <optional>
+#include <string>
 #include <float.h>
 #include <math.h>
 
@@ -45,6 +46,79 @@
 #include "SampleBlock.h"
 #include "InconsistencyException.h"
 
+BlockArray &SharedBlockArray::Mutate()
+{
+   if (mpBlocks.use_count() > 1)
+      mpBlocks = std::make_shared<BlockArray>(*mpBlocks);
+   return *mpBlocks;
+}
+
+void SharedBlockArray::Replace(BlockArray &blocks)
+{
+   if (mpBlocks.use_count() > 1)
+      mpBlocks = std::make_shared<BlockArray>();
+   mpBlocks->swap(blocks);
+}
+
+namespace {
+// Encoding of a whole block array, in the "blocks" attribute of a sequence:
+// a format byte; the number of blocks; then for each block, the difference
+// of its start from the previous start, and the zig-zag coded difference of
+// its id from the previous id.  Numbers are unsigned LEB128, seven bits to
+// a byte, least significant first; differences wrap around.
+constexpr char CompactBlocksFormat = 1;
+
+void AppendVarint(std::string &bytes, unsigned long long value)
+{
+   while (value >= 0x80) {
+      bytes.push_back(static_cast<char>((value & 0x7f) | 0x80));
+      value >>= 7;
+   }
+   bytes.push_back(static_cast<char>(value));
+}
+
+bool ReadVarint(std::string_view &bytes, unsigned long long &value)
+{
+   value = 0;
+   for (unsigned shift = 0; shift < 64 && !bytes.empty(); shift += 7) {
+      const auto byte = static_cast<unsigned char>(bytes.front());
+      bytes.remove_prefix(1);
+      value |= static_cast<unsigned long long>(byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+         return true;
+   }
+   return false;
+}
+
+unsigned long long ZigZag(unsigned long long difference)
+{
+   return (difference << 1) ^ (0 - (difference >> 63));
+}
+
+unsigned long long UnZigZag(unsigned long long value)
+{
+   return (value >> 1) ^ (0 - (value & 1));
+}
+
+std::string EncodeBlocks(const BlockArray &blocks)
+{
+   std::string bytes;
+   bytes.reserve(4 * blocks.size() + 8);
+   bytes.push_back(CompactBlocksFormat);
+   AppendVarint(bytes, blocks.size());
+   unsigned long long start = 0, id = 0;
+   for (const auto &block : blocks) {
+      const unsigned long long nextStart = block.start.as_long_long(),
+         nextId = block.sb->GetBlockID();
+      AppendVarint(bytes, nextStart - start);
+      AppendVarint(bytes, ZigZag(nextId - id));
+      start = nextStart;
+      id = nextId;
+   }
+   return bytes;
+}
+}
+
 size_t Sequence::sMaxDiskBlockSize = 1048576;
 
 // Sequence methods
@@ -67,7 +141,13 @@ Sequence::Sequence(
    mMinSamples(orig.mMinSamples),
    mMaxSamples(orig.mMaxSamples)
 {
-   Paste(0, &orig);
+   if (pFactory == orig.mpFactory) {
+      // Share the block array until either sequence changes
+      mBlock = orig.mBlock;
+      mNumSamples = orig.mNumSamples;
+   }
+   else
+      Paste(0, &orig);
 }
 
 Sequence::~Sequence()
@@ -184,7 +264,7 @@ bool Sequence::ConvertToSampleFormat(sampleFormat format,
 
       for (size_t i = 0, nn = mBlock.size(); i < nn; i++)
       {
-         SeqBlock &oldSeqBlock = mBlock[i];
+         const SeqBlock &oldSeqBlock = mBlock[i];
          const auto &oldBlockFile = oldSeqBlock.sb;
          const auto len = oldBlockFile->GetSampleCount();
          ensureSampleBufferSize(bufferOld, oldFormats.Stored(), oldSize, len);
@@ -384,6 +464,37 @@ float Sequence::GetRMS(sampleCount start, sampleCount len, bool mayThrow) const
    return sqrt(sumsq / length.as_double() );
 }
 
+SampleStats Sequence::GetStats(
+   sampleCount start, sampleCount len, bool mayThrow) const
+{
+   SampleStats result;
+   if (len <= 0 || mBlock.size() == 0)
+      return result;
+
+   const auto end = start + len;
+   const unsigned int block0 = FindBlock(start);
+   const unsigned int block1 = FindBlock(end - 1);
+   for (auto b = block0; b <= block1; ++b) {
+      const SeqBlock &theBlock = mBlock[b];
+      const auto &sb = theBlock.sb;
+      const auto blockEnd = theBlock.start + sb->GetSampleCount();
+      const auto s0 = std::max(start, theBlock.start);
+      const auto s1 = std::min(end, blockEnd);
+      if (s0 == theBlock.start && s1 == blockEnd)
+         result += sb->GetStats(mayThrow);
+      else {
+         const auto l0 = ( s1 - s0 ).as_size_t();
+         wxASSERT(l0 <= mMaxSamples);
+         SampleBuffer buffer(l0, floatSample);
+         sb->GetSamples(buffer.ptr(), floatSample,
+            ( s0 - theBlock.start ).as_size_t(), l0, mayThrow);
+         result += SampleStats::Calculate(
+            reinterpret_cast<const float *>(buffer.ptr()), l0);
+      }
+   }
+   return result;
+}
+
 // Must pass in the correct factory for the result.  If it's not the same
 // as in this, then block contents must be copied.
 std::unique_ptr<Sequence> Sequence::Copy( const SampleBlockFactoryPtr &pFactory,
@@ -409,7 +520,8 @@ std::unique_ptr<Sequence> Sequence::Copy( const SampleBlockFactoryPtr &pFactory,
    wxUnusedVar(numBlocks);
    wxASSERT(b0 <= b1);
 
-   dest->mBlock.reserve(b1 - b0 + 1);
+   auto &destBlock = dest->mBlock.Mutate();
+   destBlock.reserve(b1 - b0 + 1);
 
    auto bufferSize = mMaxSamples;
    const auto format = mSampleFormats.Stored();
@@ -439,7 +551,7 @@ std::unique_ptr<Sequence> Sequence::Copy( const SampleBlockFactoryPtr &pFactory,
    // If there are blocks in the middle, use the blocks whole
    for (int bb = b0 + 1; bb < b1; ++bb)
       AppendBlock(pUseFactory, format,
-         dest->mBlock, dest->mNumSamples, mBlock[bb]);
+         destBlock, dest->mNumSamples, mBlock[bb]);
       // Increase ref count or duplicate file
 
    // Do the last block
@@ -460,7 +572,7 @@ std::unique_ptr<Sequence> Sequence::Copy( const SampleBlockFactoryPtr &pFactory,
       else
          // Special case of a whole block
          AppendBlock(pUseFactory, format,
-            dest->mBlock, dest->mNumSamples, block);
+            destBlock, dest->mNumSamples, block);
          // Increase ref count or duplicate file
    }
 
@@ -548,7 +660,7 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
       // minimum size
 
       // Build and swap a copy so there is a strong exception safety guarantee
-      BlockArray newBlock{ mBlock };
+      BlockArray newBlock = mBlock;
       sampleCount samples = mNumSamples;
       for (unsigned int i = 0; i < srcNumBlocks; i++)
          // AppendBlock may throw for limited disk space, if pasting from
@@ -564,8 +676,7 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
 
    const int b = (s == mNumSamples) ? mBlock.size() - 1 : FindBlock(s);
    wxASSERT((b >= 0) && (b < (int)numBlocks));
-   SeqBlock *const pBlock = &mBlock[b];
-   const auto length = pBlock->sb->GetSampleCount();
+   const auto length = mBlock[b].sb->GetSampleCount();
    const auto largerBlockLen = addedLen + length;
    // PRL: when insertion point is the first sample of a block,
    // and the following test fails, perhaps we could test
@@ -574,7 +685,9 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
       // Special case: we can fit all of the NEW samples inside of
       // one block!
 
-      SeqBlock &block = *pBlock;
+      // Copies the array, if shared, before any change
+      auto &blocks = mBlock.Mutate();
+      SeqBlock &block = blocks[b];
       // largerBlockLen is not more than mMaxSamples...
       SampleBuffer buffer(largerBlockLen.as_size_t(), format);
 
@@ -600,7 +713,7 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
 
       // use No-fail-guarantee in remaining steps
       for (unsigned int i = b + 1; i < numBlocks; i++)
-         mBlock[i].start += addedLen;
+         blocks[i].start += addedLen;
 
       mNumSamples += addedLen;
 
@@ -619,7 +732,7 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
    newBlock.reserve(numBlocks + srcNumBlocks + 2);
    newBlock.insert(newBlock.end(), mBlock.begin(), mBlock.begin() + b);
 
-   SeqBlock &splitBlock = mBlock[b];
+   const SeqBlock &splitBlock = mBlock[b];
    auto splitLen = splitBlock.sb->GetSampleCount();
    // s lies within splitBlock
    auto splitPoint = ( s - splitBlock.start ).as_size_t();
@@ -729,7 +842,8 @@ void Sequence::InsertSilence(sampleCount s0, sampleCount len)
    // Could nBlocks overflow a size_t?  Not very likely.  You need perhaps
    // 2 ^ 52 samples which is over 3000 years at 44.1 kHz.
    auto nBlocks = (len + idealSamples - 1) / idealSamples;
-   sTrack.mBlock.reserve(nBlocks.as_size_t());
+   auto &silentBlocks = sTrack.mBlock.Mutate();
+   silentBlocks.reserve(nBlocks.as_size_t());
 
    const auto format = mSampleFormats.Stored();
    if (len >= idealSamples) {
@@ -737,7 +851,7 @@ void Sequence::InsertSilence(sampleCount s0, sampleCount len)
          idealSamples,
          format);
       while (len >= idealSamples) {
-         sTrack.mBlock.push_back(SeqBlock(silentFile, pos));
+         silentBlocks.push_back(SeqBlock(silentFile, pos));
 
          pos += idealSamples;
          len -= idealSamples;
@@ -745,7 +859,7 @@ void Sequence::InsertSilence(sampleCount s0, sampleCount len)
    }
    if (len != 0) {
       // len is not more than idealSamples:
-      sTrack.mBlock.push_back(SeqBlock(
+      silentBlocks.push_back(SeqBlock(
          factory.CreateSilent(len.as_size_t(), format), pos));
       pos += len;
    }
@@ -848,7 +962,7 @@ bool Sequence::HandleXMLTag(const std::string_view& tag, const AttributesList &a
          }
       }
 
-      mBlock.push_back(wb);
+      mBlock.Mutate().push_back(wb);
 
       return true;
    }
@@ -858,6 +972,7 @@ bool Sequence::HandleXMLTag(const std::string_view& tag, const AttributesList &a
    {
       std::optional<sampleFormat> effective;
       sampleFormat stored = floatSample;
+      std::optional<std::string_view> blocks;
       for (auto pair : attrs)
       {
          auto attr = pair.first;
@@ -920,6 +1035,16 @@ bool Sequence::HandleXMLTag(const std::string_view& tag, const AttributesList &a
             }
             mNumSamples = nValue;
          }
+         else if (attr == "blocks")
+         {
+            std::string_view bytes;
+            if (!value.TryGet(bytes))
+            {
+               mErrorOpening = true;
+               return false;
+            }
+            blocks = bytes;
+         }
       } // for
 
       // Set at least the stored format as it was saved
@@ -933,12 +1058,48 @@ bool Sequence::HandleXMLTag(const std::string_view& tag, const AttributesList &a
          return false;
       }
 
+      if (blocks && !ReadBlocks(*blocks)) {
+         mErrorOpening = true;
+         return false;
+      }
+
       return true;
    }
 
    return false;
 }
 
+bool Sequence::ReadBlocks(std::string_view bytes)
+{
+   unsigned long long count;
+   if (bytes.empty() || bytes.front() != CompactBlocksFormat)
+      return false;
+   bytes.remove_prefix(1);
+   // Each block takes at least two bytes
+   if (!ReadVarint(bytes, count) || count > bytes.size() / 2)
+      return false;
+
+   auto &factory = *mpFactory;
+   auto &blocks = mBlock.Mutate();
+   blocks.reserve(blocks.size() + count);
+   AttributesList attrs{ { "blockid", XMLAttributeValueView{} } };
+   unsigned long long start = 0, id = 0;
+   for (; count > 0; --count) {
+      unsigned long long startDifference, idDifference;
+      if (!ReadVarint(bytes, startDifference) ||
+          !ReadVarint(bytes, idDifference))
+         return false;
+      start += startDifference;
+      id += UnZigZag(idDifference);
+
+      attrs[0].second = XMLAttributeValueView{ static_cast<long long>(id) };
+      blocks.push_back({
+         factory.CreateFromXML(mSampleFormats.Stored(), attrs),
+         static_cast<sampleCount::type>(start) });
+   }
+   return bytes.empty();
+}
+
 void Sequence::HandleXMLEndTag(const std::string_view& tag)
 {
    if (tag != "sequence" != 0)
@@ -952,7 +1113,7 @@ void Sequence::HandleXMLEndTag(const std::string_view& tag)
    sampleCount numSamples = 0;
    for (unsigned b = 0, nn = mBlock.size(); b < nn;  b++)
    {
-      SeqBlock &block = mBlock[b];
+      const SeqBlock &block = mBlock[b];
       if (block.start != numSamples)
       {
          wxLogWarning(
@@ -963,7 +1124,7 @@ void Sequence::HandleXMLEndTag(const std::string_view& tag)
             Internat::ToString(block.start.as_double(), 0),
             block.sb->GetBlockID(),
             Internat::ToString(numSamples.as_double(), 0));
-         block.start = numSamples;
+         mBlock.Mutate()[b].start = numSamples;
          mErrorOpening = true;
       }
       numSamples += block.sb->GetSampleCount();
@@ -1007,6 +1168,14 @@ void Sequence::WriteXML(XMLWriter &xmlFile) const
       static_cast<size_t>( mSampleFormats.Effective() ));
    xmlFile.WriteAttr(wxT("numsamples"), mNumSamples.as_long_long() );
 
+   // Long block arrays cost one attribute, not several for each block
+   bool compact = false;
+   if (mBlock.size() >= MinCompactBlocks) {
+      const auto bytes = EncodeBlocks(mBlock);
+      compact =
+         xmlFile.WriteBinaryAttr(wxT("blocks"), bytes.data(), bytes.size());
+   }
+
    for (b = 0; b < mBlock.size(); b++) {
       const SeqBlock &bb = mBlock[b];
 
@@ -1032,6 +1201,9 @@ void Sequence::WriteXML(XMLWriter &xmlFile) const
 //         bb.sb->SetLength(mMaxSamples);
       }
 
+      if (compact)
+         continue;
+
       xmlFile.StartTag(wxT("waveblock"));
       xmlFile.WriteAttr(wxT("start"), bb.start.as_long_long() );
 
@@ -1174,6 +1346,53 @@ bool Sequence::Get(int b, samplePtr buffer, sampleFormat format,
    return result;
 }
 
+bool Sequence::Get(const Sequence *const sequences[], size_t nSequences,
+   const samplePtr buffers[], sampleFormat format,
+   sampleCount start, size_t len, bool mayThrow)
+{
+   const auto inRange = [&](const Sequence *pSequence) {
+      return start >= 0 && start + len <= pSequence->mNumSamples;
+   };
+   if (nSequences < 2 || nSequences > MaxWideRead || len == 0 ||
+      !std::all_of(sequences, sequences + nSequences, inRange)) {
+      // The one-channel reads handle these cases
+      bool result = true;
+      for (size_t ii = 0; ii < nSequences; ++ii)
+         result = sequences[ii]->Get(buffers[ii], format, start, len, mayThrow)
+            && result;
+      return result;
+   }
+
+   // Position of each sequence: its current block, and how many samples it
+   // has read
+   std::pair<int, size_t> positions[MaxWideRead];
+   for (size_t ii = 0; ii < nSequences; ++ii)
+      positions[ii] = { sequences[ii]->FindBlock(start), 0 };
+
+   bool result = true;
+   for (bool more = true; more;) {
+      more = false;
+      for (size_t ii = 0; ii < nSequences; ++ii) {
+         auto &[b, done] = positions[ii];
+         if (done == len)
+            continue;
+         // Read the rest of one block
+         const SeqBlock &block = sequences[ii]->mBlock[b];
+         const auto pos = start + done;
+         const auto bstart = (pos - block.start).as_size_t();
+         const auto blen =
+            std::min(len - done, block.sb->GetSampleCount() - bstart);
+         if (!Read(buffers[ii] + done * SAMPLE_SIZE(format), format,
+            block, bstart, blen, mayThrow))
+            result = false;
+         done += blen;
+         ++b;
+         more = more || done < len;
+      }
+   }
+   return result;
+}
+
 // Pass nullptr to set silence
 /*! @excsafety{Strong} */
 void Sequence::SetSamples(constSamplePtr buffer, sampleFormat format,
@@ -1417,7 +1636,7 @@ SeqBlock::SampleBlockPtr Sequence::DoAppend(
 
    // If the last block is not full, we need to add samples to it
    int numBlocks = mBlock.size();
-   SeqBlock *pLastBlock;
+   const SeqBlock *pLastBlock;
    decltype(pLastBlock->sb->GetSampleCount()) length;
    size_t bufferSize = mMaxSamples;
    const auto dstFormat = mSampleFormats.Stored();
@@ -1564,7 +1783,7 @@ void Sequence::Delete(sampleCount start, sampleCount len)
    const auto format = mSampleFormats.Stored();
    auto sampleSize = SAMPLE_SIZE(format);
 
-   SeqBlock *pBlock;
+   const SeqBlock *pBlock;
    decltype(pBlock->sb->GetSampleCount()) length;
 
    // One buffer for reuse in various branches here
@@ -1577,7 +1796,9 @@ void Sequence::Delete(sampleCount start, sampleCount len)
    // deletion within this block:
    if (b0 == b1 &&
        (length = (pBlock = &mBlock[b0])->sb->GetSampleCount()) - len >= mMinSamples) {
-      SeqBlock &b = *pBlock;
+      // Copies the array, if shared, before any change
+      auto &blocks = mBlock.Mutate();
+      SeqBlock &b = blocks[b0];
       // start is within block
       auto pos = ( start - b.start ).as_size_t();
 
@@ -1606,7 +1827,7 @@ void Sequence::Delete(sampleCount start, sampleCount len)
       // use No-fail-guarantee in remaining steps
 
       for (unsigned int j = b0 + 1; j < numBlocks; j++)
-         mBlock[j].start -= len;
+         blocks[j].start -= len;
 
       mNumSamples -= len;
 
@@ -1690,7 +1911,7 @@ void Sequence::Delete(sampleCount start, sampleCount len)
 
          newBlock.push_back(SeqBlock(file, start));
       } else {
-         SeqBlock &postpostBlock = mBlock[b1 + 1];
+         const SeqBlock &postpostBlock = mBlock[b1 + 1];
          const auto postpostLen = postpostBlock.sb->GetSampleCount();
          const auto sum = postpostLen + postBufferLen;
 
@@ -1785,7 +2006,7 @@ void Sequence::CommitChangesIfConsistent
    // now commit
    // use No-fail-guarantee
 
-   mBlock.swap(newBlock);
+   mBlock.Replace(newBlock);
    mNumSamples = numSamples;
 }
 
@@ -1799,31 +2020,34 @@ void Sequence::AppendBlocksIfConsistent
    if (additionalBlocks.empty())
       return;
 
+   // Copies the array, if shared, before any change
+   auto &blocks = mBlock.Mutate();
+
    bool tmpValid = false;
    SeqBlock tmp;
 
-   if ( replaceLast && ! mBlock.empty() ) {
-      tmp = mBlock.back(), tmpValid = true;
-      mBlock.pop_back();
+   if ( replaceLast && ! blocks.empty() ) {
+      tmp = blocks.back(), tmpValid = true;
+      blocks.pop_back();
    }
 
-   auto prevSize = mBlock.size();
+   auto prevSize = blocks.size();
 
    bool consistent = false;
    auto cleanup = finally( [&] {
       if ( !consistent ) {
-         mBlock.resize( prevSize );
+         blocks.resize( prevSize );
          if ( tmpValid )
-            mBlock.push_back( tmp );
+            blocks.push_back( tmp );
       }
    } );
 
    std::copy( additionalBlocks.begin(), additionalBlocks.end(),
-              std::back_inserter( mBlock ) );
+              std::back_inserter( blocks ) );
 
    // Check consistency only of the blocks that were added,
    // avoiding quadratic time for repeated checking of repeating appends
-   ConsistencyCheck( mBlock, mMaxSamples, prevSize, numSamples, whereStr ); // may throw
+   ConsistencyCheck( blocks, mMaxSamples, prevSize, numSamples, whereStr ); // may throw
 
    // now commit
    // use No-fail-guarantee
@@ -14,11 +14,13 @@
 
 #include <vector>
 #include <functional>
+#include <memory>
 
 #include "SampleFormat.h"
 #include "XMLTagHandler.h"
 
 #include "SampleCount.h"
+#include "SampleStats.h"
 #include "AudioSegmentSampleView.h"
 
 class SampleBlock;
@@ -50,6 +52,38 @@ class SeqBlock {
 class BlockArray : public std::vector<SeqBlock> {};
 using BlockPtrArray = std::vector<SeqBlock*>; // non-owning pointers
 
+//! The block array of a Sequence, shared by copies of the sequence
+/*!
+ Copies share one array until one of them is changed, so that copying a
+ sequence, as for each undo state, costs no more than copying a pointer, however
+ many blocks it has.  Reading is as for a const BlockArray; writing must go
+ through Mutate() or Replace().
+ */
+class WAVE_TRACK_API SharedBlockArray {
+public:
+   SharedBlockArray() : mpBlocks{ std::make_shared<BlockArray>() } {}
+
+   operator const BlockArray &() const { return *mpBlocks; }
+
+   size_t size() const { return mpBlocks->size(); }
+   bool empty() const { return mpBlocks->empty(); }
+   const SeqBlock &operator [](size_t ii) const { return (*mpBlocks)[ii]; }
+   const SeqBlock &back() const { return mpBlocks->back(); }
+   BlockArray::const_iterator begin() const { return mpBlocks->begin(); }
+   BlockArray::const_iterator end() const { return mpBlocks->end(); }
+
+   //! Get the array for changing in place, first copying it if shared
+   /*! @excsafety{Strong} */
+   BlockArray &Mutate();
+
+   //! Exchange contents with `blocks`; other sharers keep the old contents
+   /*! @excsafety{Strong} */
+   void Replace(BlockArray &blocks);
+
+private:
+   std::shared_ptr<BlockArray> mpBlocks;
+};
+
 class WAVE_TRACK_API Sequence final : public XMLTagHandler{
  public:
 
@@ -86,6 +120,20 @@ class WAVE_TRACK_API Sequence final : public XMLTagHandler{
    bool Get(samplePtr buffer, sampleFormat format,
             sampleCount start, size_t len, bool mayThrow) const;
 
+   //! Most sequences that the static Get reads together, as the channels of
+   //! a stereo track; it reads more one at a time
+   static constexpr size_t MaxWideRead = 2;
+
+   //! Get the same range of several sequences, such as the channels of a clip
+   /*!
+    Each sequence's first block is found only once, and the reads alternate
+    between the sequences block by block, so that corresponding blocks of the
+    channels are fetched back to back
+    */
+   static bool Get(const Sequence *const sequences[], size_t nSequences,
+      const samplePtr buffers[], sampleFormat format,
+      sampleCount start, size_t len, bool mayThrow);
+
    /*!
     Get a view of the lesser of `len` samples or what remains after `start`
     @pre `start < GetNumSamples()`
@@ -172,6 +220,11 @@ class WAVE_TRACK_API Sequence final : public XMLTagHandler{
    XMLTagHandler *HandleXMLChild(const std::string_view& tag) override;
    void WriteXML(XMLWriter &xmlFile) const /* not override */;
 
+   //! Block arrays at least this long are written by WriteXML as one binary
+   //! attribute, if the writer supports that, rather than an element for each
+   //! block; reading that back requires project format 3.6
+   static constexpr size_t MinCompactBlocks = 64;
+
    bool GetErrorOpening() { return mErrorOpening; }
 
    //
@@ -200,6 +253,10 @@ class WAVE_TRACK_API Sequence final : public XMLTagHandler{
    std::pair<float, float> GetMinMax(
       sampleCount start, sampleCount len, bool mayThrow) const;
    float GetRMS(sampleCount start, sampleCount len, bool mayThrow) const;
+   //! Statistics of whole blocks are combined; samples are read only for
+   //! blocks that the range covers partly
+   SampleStats GetStats(
+      sampleCount start, sampleCount len, bool mayThrow) const;
 
    //
    // Getting block size and alignment information
@@ -215,7 +272,8 @@ class WAVE_TRACK_API Sequence final : public XMLTagHandler{
    // you're doing!
    //
 
-   BlockArray &GetBlockArray() { return mBlock; }
+   //! Copies the blocks first, if shared with another sequence
+   BlockArray &GetBlockArray() { return mBlock.Mutate(); }
    const BlockArray &GetBlockArray() const { return mBlock; }
 
    size_t GetAppendBufferLen() const { return mAppendBufferLen; }
@@ -235,7 +293,7 @@ class WAVE_TRACK_API Sequence final : public XMLTagHandler{
 
    SampleBlockFactoryPtr mpFactory;
 
-   BlockArray    mBlock;
+   SharedBlockArray mBlock;
    SampleFormats  mSampleFormats;
 
    // Not size_t!  May need to be large:
@@ -257,6 +315,10 @@ class WAVE_TRACK_API Sequence final : public XMLTagHandler{
    //! @return possibly a large or negative value
    sampleCount GetBlockStart(sampleCount position) const;
 
+   //! Append blocks from the "blocks" attribute written by WriteXML
+   //! @return false if the encoding is not understood
+   bool ReadBlocks(std::string_view bytes);
+
    //! Does not do any dithering
    /*! @excsafety{Strong} */
    SeqBlock::SampleBlockPtr DoAppend(
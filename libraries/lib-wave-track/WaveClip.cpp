@@ -179,10 +179,36 @@ bool WaveClip::GetSamples(size_t ii,
 bool WaveClip::GetSamples(samplePtr buffers[], sampleFormat format,
    sampleCount start, size_t len, bool mayThrow) const
 {
-   bool result = true;
-   for (size_t ii = 0, width = GetWidth(); result && ii < width; ++ii)
-      result = GetSamples(ii, buffers[ii], format, start, len, mayThrow);
-   return result;
+   const WaveClip *const clips[]{ this };
+   return GetSamples(clips, 1, buffers, format, start, len, mayThrow);
+}
+
+bool WaveClip::GetSamples(const WaveClip *const clips[], size_t nClips,
+   const samplePtr buffers[], sampleFormat format,
+   sampleCount start, size_t len, bool mayThrow)
+{
+   if (nClips == 0)
+      return true;
+   start += clips[0]->TimeToSamples(clips[0]->mTrimLeft);
+   const Sequence *sequences[Sequence::MaxWideRead];
+   size_t nSequences = 0;
+   for (size_t ii = 0; ii < nClips; ++ii)
+      nSequences += clips[ii]->GetWidth();
+   if (nSequences > Sequence::MaxWideRead) {
+      // Too many to read together
+      bool result = true;
+      for (size_t ii = 0, iBuffer = 0; result && ii < nClips; ++ii)
+         for (const auto &pSequence : clips[ii]->mSequences)
+            result = result && pSequence->Get(
+               buffers[iBuffer++], format, start, len, mayThrow);
+      return result;
+   }
+   nSequences = 0;
+   for (size_t ii = 0; ii < nClips; ++ii)
+      for (const auto &pSequence : clips[ii]->mSequences)
+         sequences[nSequences++] = pSequence.get();
+   return Sequence::Get(
+      sequences, nSequences, buffers, format, start, len, mayThrow);
 }
 
 /*! @excsafety{Strong} */
@@ -262,7 +288,8 @@ BlockArray* WaveClip::GetSequenceBlockArray(size_t ii)
 const BlockArray* WaveClip::GetSequenceBlockArray(size_t ii) const
 {
    assert(ii < GetWidth());
-   return &mSequences[ii]->GetBlockArray();
+   const Sequence &sequence = *mSequences[ii];
+   return &sequence.GetBlockArray();
 }
 
 size_t WaveClip::GetAppendBufferLen() const
@@ -463,6 +490,14 @@ float WaveClip::GetRMS(size_t ii, double t0, double t1, bool mayThrow) const
    return mSequences[ii]->GetRMS(s0, s1-s0, mayThrow);
 }
 
+SampleStats WaveClip::GetStats(size_t ii,
+   sampleCount start, sampleCount len, bool mayThrow) const
+{
+   assert(ii < GetWidth());
+   return mSequences[ii]
+      ->GetStats(start + TimeToSamples(mTrimLeft), len, mayThrow);
+}
+
 void WaveClip::ConvertToSampleFormat(sampleFormat format,
    const std::function<void(size_t)> & progressReport)
 {
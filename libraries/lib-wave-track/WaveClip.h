@@ -19,6 +19,7 @@
 #include "ClipInterface.h"
 #include "XMLTagHandler.h"
 #include "SampleCount.h"
+#include "SampleStats.h"
 #include "AudioSegmentSampleView.h"
 
 #include <wx/longlong.h>
@@ -356,6 +357,17 @@ public:
    bool GetSamples(samplePtr buffers[], sampleFormat format,
                    sampleCount start, size_t len, bool mayThrow = true) const;
 
+   //! Get (non-interleaved) samples from all channels of several clips
+   /*!
+    The clips must be trimmed alike, as are the clips that correspond in the
+    channels of one track.  The sequences are read together, block by block.
+    @param start relative to clip play start sample
+    @pre `buffers` has as many entries as the sum of the widths
+    */
+   static bool GetSamples(const WaveClip *const clips[], size_t nClips,
+      const samplePtr buffers[], sampleFormat format,
+      sampleCount start, size_t len, bool mayThrow = true);
+
    //! @param ii identifies the channel
    /*!
     @pre `ii < GetWidth()`
@@ -455,6 +467,14 @@ public:
     @copydoc GetMinMax
     */
    float GetRMS(size_t ii, double t0, double t1, bool mayThrow) const;
+   //! Statistics of samples of one channel, mostly from those of whole blocks
+   /*!
+    @param ii identifies the channel
+    @param start relative to clip play start sample
+    @pre `ii < GetWidth()`
+    */
+   SampleStats GetStats(size_t ii,
+      sampleCount start, sampleCount len, bool mayThrow) const;
 
    /** Whenever you do an operation to the sequence that will change the number
     * of samples (that is, the length of the clip), you will want to call this
@@ -41,6 +41,7 @@ from the project that will own the track.
 #include <numeric>
 #include <optional>
 #include <type_traits>
+#include <utility>
 
 #include "float_cast.h"
 
@@ -1255,7 +1256,9 @@ size_t WaveTrack::CountBlocks() const
    size_t result{};
    for (const auto pChannel : TrackList::Channels(this)) {
       for (auto& clip : pChannel->GetClips())
-         result += clip->GetWidth() * clip->GetSequenceBlockArray(0)->size();
+         // Read through const, so as not to unshare the blocks
+         result += clip->GetWidth() *
+            std::as_const(*clip).GetSequenceBlockArray(0)->size();
    }
    return result;
 }
@@ -3173,6 +3176,80 @@ float WaveChannel::GetRMS(double t0, double t1, bool mayThrow) const
    return duration > 0 ? sqrt(sumsq / duration) : 0.0;
 }
 
+std::optional<SampleStats> WaveChannel::GetStats(sampleCount start,
+   sampleCount len, bool mayThrow, sampleCount *pNumWithinClips) const
+{
+   SampleStats result;
+   sampleCount numWithinClips = 0;
+   const auto end = start + len;
+   auto position = start;
+   for (const auto clip : GetTrack().SortedClipArray()) {
+      const auto clipStart = clip->GetPlayStartSample();
+      const auto s0 = std::max(position, clipStart);
+      const auto s1 = std::min(end, clip->GetPlayEndSample());
+      if (s0 >= s1)
+         continue;
+      if (clip->HasPitchOrSpeed())
+         return {};
+      // Gaps between clips read as zeroes
+      if (s0 > position)
+         result += SampleStats::Zeroes(s0 - position);
+      // TODO wide wave tracks -- choose correct channel
+      result += clip->GetStats(0, s0 - clipStart, s1 - s0, mayThrow);
+      numWithinClips += s1 - s0;
+      position = s1;
+   }
+   if (end > position)
+      result += SampleStats::Zeroes(end - position);
+   if (pNumWithinClips)
+      *pNumWithinClips = numWithinClips;
+   return result;
+}
+
+namespace {
+//! Whether clips of the same index in each channel cover the same samples
+//! the same way, so that they can be read together
+bool ClipsCorrespond(const WaveTrack *const channels[], size_t nChannels)
+{
+   const auto &clips = channels[0]->GetClips();
+   for (size_t iChannel = 1; iChannel < nChannels; ++iChannel) {
+      const auto &otherClips = channels[iChannel]->GetClips();
+      if (otherClips.size() != clips.size())
+         return false;
+      for (size_t ii = 0; ii < clips.size(); ++ii) {
+         const auto &clip = *clips[ii], &other = *otherClips[ii];
+         if (clip.GetWidth() != 1 || other.GetWidth() != 1 ||
+            other.GetPlayStartSample() != clip.GetPlayStartSample() ||
+            other.GetPlayEndSample() != clip.GetPlayEndSample() ||
+            other.TimeToSamples(other.GetTrimLeft()) !=
+               clip.TimeToSamples(clip.GetTrimLeft()))
+            return false;
+      }
+   }
+   return true;
+}
+
+void FillSamples(
+   samplePtr buffer, sampleFormat format, size_t len, fillFormat fill)
+{
+   // Usually we fill in empty space with zero
+   if (fill == FillFormat::fillZero)
+      ClearSamples(buffer, format, 0, len);
+   // but we don't have to.
+   else if (fill == FillFormat::fillTwo)
+   {
+      wxASSERT( format==floatSample );
+      float * pBuffer = (float*)buffer;
+      for(size_t i=0;i<len;i++)
+         pBuffer[i]=2.0f;
+   }
+   else
+   {
+      wxFAIL_MSG(wxT("Invalid fill format"));
+   }
+}
+}
+
 bool WaveTrack::DoGet(size_t iChannel, size_t nBuffers,
    const samplePtr buffers[], sampleFormat format,
    sampleCount start, size_t len, bool backwards, fillFormat fill,
@@ -3193,6 +3270,16 @@ bool WaveTrack::DoGet(size_t iChannel, size_t nBuffers,
       iter.emplace(ppLeader.advance(IsLeader() ? iChannel : 1));
       pTrack = **iter;
    }
+   if (iter && nBuffers > 1 && nBuffers <= Sequence::MaxWideRead) {
+      // Read the channels together, if their clips correspond
+      const WaveTrack *channels[Sequence::MaxWideRead];
+      auto channelIter = *iter;
+      for (size_t ii = 0; ii < nBuffers; ++ii, ++channelIter)
+         channels[ii] = *channelIter;
+      if (ClipsCorrespond(channels, nBuffers))
+         return GetWide(channels, nBuffers, buffers, format,
+            start, len, backwards, fill, mayThrow, pNumWithinClips);
+   }
    return std::all_of(buffers, buffers + nBuffers, [&](samplePtr buffer) {
       const auto result = pTrack->GetOne(
          buffer, format, start, len, backwards, fill, mayThrow,
@@ -3420,23 +3507,7 @@ bool WaveTrack::GetOne(
       }
    }
    if (doClear)
-   {
-      // Usually we fill in empty space with zero
-      if (fill == FillFormat::fillZero)
-         ClearSamples(buffer, format, 0, len);
-      // but we don't have to.
-      else if (fill == FillFormat::fillTwo)
-      {
-         wxASSERT( format==floatSample );
-         float * pBuffer = (float*)buffer;
-         for(size_t i=0;i<len;i++)
-            pBuffer[i]=2.0f;
-      }
-      else
-      {
-         wxFAIL_MSG(wxT("Invalid fill format"));
-      }
-   }
+      FillSamples(buffer, format, len, fill);
 
    // Iterate the clips.  They are not necessarily sorted by time.
    for (const auto &clip: mClips)
@@ -3488,6 +3559,74 @@ bool WaveTrack::GetOne(
    return result;
 }
 
+bool WaveTrack::GetWide(const WaveTrack *const channels[], size_t nChannels,
+   const samplePtr buffers[], sampleFormat format, sampleCount start,
+   size_t len, bool backwards, fillFormat fill, bool mayThrow,
+   sampleCount* pNumWithinClips)
+{
+   if (backwards)
+      start -= len;
+   const auto &clips = channels[0]->mClips;
+   // As in GetOne, don't clear if the buffer is contained within one clip
+   const bool doClear = std::none_of(clips.begin(), clips.end(),
+      [&](const WaveClipHolder &clip) {
+         return start >= clip->GetPlayStartSample() &&
+            start + len <= clip->GetPlayEndSample();
+      });
+   if (doClear)
+      for (size_t iChannel = 0; iChannel < nChannels; ++iChannel)
+         FillSamples(buffers[iChannel], format, len, fill);
+
+   bool result = true;
+   sampleCount samplesCopied = 0;
+   assert(nChannels <= Sequence::MaxWideRead); // precondition
+   const WaveClip *group[Sequence::MaxWideRead];
+   samplePtr destinations[Sequence::MaxWideRead];
+   for (size_t ii = 0; ii < clips.size(); ++ii)
+   {
+      const auto &clip = *clips[ii];
+      auto clipStart = clip.GetPlayStartSample();
+      auto clipEnd = clip.GetPlayEndSample();
+
+      if (clipEnd > start && clipStart < start+len)
+      {
+         for (size_t iChannel = 0; iChannel < nChannels; ++iChannel) {
+            group[iChannel] = channels[iChannel]->mClips[ii].get();
+            if (group[iChannel]->HasPitchOrSpeed())
+               return false;
+         }
+
+         // Clip sample region and Get/Put sample region overlap, as in GetOne
+         auto samplesToCopy =
+            std::min( start+len - clipStart, clip.GetVisibleSampleCount() );
+         auto startDelta = clipStart - start;
+         decltype(startDelta) inclipDelta = 0;
+         if (startDelta < 0)
+         {
+            inclipDelta = -startDelta; // make positive value
+            samplesToCopy -= inclipDelta;
+            startDelta = 0;
+         }
+
+         for (size_t iChannel = 0; iChannel < nChannels; ++iChannel)
+            destinations[iChannel] = buffers[iChannel] +
+               startDelta.as_size_t() * SAMPLE_SIZE(format);
+         if (!WaveClip::GetSamples(group, nChannels,
+               destinations, format, inclipDelta,
+               samplesToCopy.as_size_t(), mayThrow))
+            result = false;
+         else
+            samplesCopied += samplesToCopy;
+      }
+   }
+   if( pNumWithinClips )
+      *pNumWithinClips = samplesCopied;
+   if (result == true && backwards)
+      for (size_t iChannel = 0; iChannel < nChannels; ++iChannel)
+         ReverseSamples(buffers[iChannel], format, 0, len);
+   return result;
+}
+
 ChannelGroupSampleView
 WaveTrack::GetSampleView(double t0, double t1, bool mayThrow) const
 {
@@ -3686,8 +3825,10 @@ void WaveTrack::GetEnvelopeValues(
             rlen = std::min(rlen, size_t(floor(0.5 + (dClipEndTime - rt0) / tstep)));
          }
          // Samples are obtained for the purpose of rendering a wave track,
-         // so quantize time
-         clip->GetEnvelope()->GetValues(rbuf, rlen, rt0, tstep);
+         // so quantize time.  A trivial envelope leaves the values at 1.0.
+         if (const auto pEnvelope = clip->GetEnvelope();
+             !pEnvelope->IsTrivial())
+            pEnvelope->GetValues(rbuf, rlen, rt0, tstep);
       }
    }
    if (backwards)
@@ -4483,7 +4624,7 @@ void VisitBlocks(TrackList &tracks, BlockVisitor visitor,
          for (const auto &clip : pChannel->GetAllClips())
             // Scan all sample blocks within current clip
             for (size_t ii = 0, width = clip->GetWidth(); ii < width; ++ii) {
-               auto blocks = clip->GetSequenceBlockArray(ii);
+               auto blocks = std::as_const(*clip).GetSequenceBlockArray(ii);
                for (const auto &block : *blocks) {
                   auto &pBlock = block.sb;
                   if (pBlock) {
@@ -4563,6 +4704,23 @@ ProjectFormatExtensionsRegistry::Extension stretchedClipsExtension(
       return BaseProjectFormatVersion;
    }
 );
+
+// Long block arrays are saved compactly, which older versions can't read;
+// released 3.5 versions would ignore the attribute and open empty sequences,
+// so require the first version that reads it
+ProjectFormatExtensionsRegistry::Extension compactBlocksExtension(
+   [](const AudacityProject& project) -> ProjectFormatVersion {
+      const TrackList& trackList = TrackList::Get(project);
+      for (auto wt : trackList.Any<const WaveTrack>())
+         for (const auto pChannel : TrackList::Channels(wt))
+            for (const auto& clip : pChannel->GetAllClips())
+               for (size_t ii = 0, width = clip->GetWidth(); ii < width; ++ii)
+                  if (clip->GetSequenceBlockArray(ii)->size() >=
+                      Sequence::MinCompactBlocks)
+                     return { 3, 6, 0, 0 };
+      return BaseProjectFormatVersion;
+   }
+);
 }
 
 StringSetting AudioTrackNameSetting{
@@ -16,6 +16,7 @@
 #include "Prefs.h"
 #include "SampleCount.h"
 #include "SampleFormat.h"
+#include "SampleStats.h"
 #include "SampleTrack.h"
 #include "WideSampleSequence.h"
 
@@ -211,6 +212,16 @@ public:
     */
    float GetRMS(double t0, double t1, bool mayThrow = true) const;
 
+   //! Get statistics of samples, as GetFloats would fill a buffer with
+   //! fillZero, reading few samples if the range is aligned with blocks, as by
+   //! GetBestBlockSize
+   /*!
+    @param[out] pNumWithinClips if not null, the number of samples within clips
+    @return nothing if a clip in the range needs rendering of pitch or speed
+    */
+   std::optional<SampleStats> GetStats(sampleCount start, sampleCount len,
+      bool mayThrow = true, sampleCount *pNumWithinClips = nullptr) const;
+
    //! A hint for sizing of well aligned fetches
    inline size_t GetBestBlockSize(sampleCount t) const;
    //! A hint for sizing of well aligned fetches
@@ -1142,6 +1153,16 @@ private:
       samplePtr buffer, sampleFormat format, sampleCount start, size_t len,
       bool backwards, fillFormat fill, bool mayThrow,
       sampleCount* pNumWithinClips) const;
+   //! Like GetOne, for all the channels at once, resolving clips only once
+   /*!
+    @pre the clips of the channels correspond, in order, and have equal play
+    regions and trims
+    @pre `nChannels <= Sequence::MaxWideRead`
+    */
+   static bool GetWide(const WaveTrack *const channels[], size_t nChannels,
+      const samplePtr buffers[], sampleFormat format, sampleCount start,
+      size_t len, bool backwards, fillFormat fill, bool mayThrow,
+      sampleCount* pNumWithinClips);
 
    /*!
     * @brief Helper for GetFloatsCenteredAroundTime. If `direction ==
@@ -0,0 +1,171 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SampleStatsTest.cpp
+
+**********************************************************************/
+#include "SampleStats.h"
+#include "MemoryX.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+// Quiet passages of varying loudness and length between loud ones, and some
+// clipping
+std::vector<float> MakeSamples(size_t len, unsigned seed)
+{
+   std::mt19937 engine { seed };
+   std::uniform_real_distribution<float> noise { -1.f, 1.f };
+   std::uniform_int_distribution<size_t> runLength { 1, 5000 };
+   std::uniform_int_distribution<int> loudness { 0, 14 };
+   std::vector<float> result;
+   while (result.size() < len)
+   {
+      const auto level = loudness(engine);
+      const auto gain = level == 14 ? 1.5f : std::pow(10.f, -level * 0.3f);
+      for (auto count = runLength(engine); count > 0; --count)
+         result.push_back(std::clamp(gain * noise(engine), -1.f, 1.f));
+   }
+   result.resize(len);
+   return result;
+}
+
+// Statistics as found sample by sample, for comparison
+SampleStats Reference(const std::vector<float>& samples)
+{
+   SampleStats result;
+   const auto len = samples.size();
+   result.length = len;
+   for (const auto sample : samples)
+   {
+      result.sum += sample;
+      if (std::fabs(sample) >= MAX_AUDIO)
+         ++result.clipped;
+   }
+   for (size_t ii = 0; ii < SampleStats::SilenceGridSize; ++ii)
+   {
+      const auto threshold = SampleStats::SilenceThreshold(ii);
+      auto& runs = result.silence[ii];
+      size_t jj = 0;
+      while (jj < len)
+      {
+         if (!(std::fabs(samples[jj]) < threshold))
+         {
+            ++jj;
+            continue;
+         }
+         const auto start = jj;
+         while (jj < len && std::fabs(samples[jj]) < threshold)
+            ++jj;
+         if (start == 0)
+            runs.leading = jj;
+         if (jj == len)
+            runs.trailing = len - start;
+         if (start > 0 && jj < len && jj - start >= SampleStats::MinInteriorRun)
+            runs.interior.emplace_back(start, jj - start);
+      }
+   }
+   return result;
+}
+
+void RequireEqual(const SampleStats& actual, const SampleStats& expected)
+{
+   REQUIRE(actual.length == expected.length);
+   REQUIRE(actual.sum == Approx(expected.sum).margin(1e-6));
+   REQUIRE(actual.clipped == expected.clipped);
+   for (size_t ii = 0; ii < SampleStats::SilenceGridSize; ++ii)
+   {
+      const auto& runs = actual.silence[ii];
+      const auto& expectedRuns = expected.silence[ii];
+      REQUIRE(runs.leading == expectedRuns.leading);
+      REQUIRE(runs.trailing == expectedRuns.trailing);
+      REQUIRE(runs.interior == expectedRuns.interior);
+   }
+}
+} // namespace
+
+TEST_CASE("SampleStats::Calculate agrees with sample-by-sample analysis")
+{
+   for (const auto seed : { 1u, 2u, 3u })
+   {
+      const auto samples = MakeSamples(100000, seed);
+      RequireEqual(
+         SampleStats::Calculate(samples.data(), samples.size()),
+         Reference(samples));
+   }
+}
+
+TEST_CASE("SampleStats of adjacent ranges combine exactly")
+{
+   const auto samples = MakeSamples(200000, 4);
+   const auto expected = Reference(samples);
+   std::mt19937 engine { 5 };
+   std::uniform_int_distribution<size_t> pieceLength { 0, 20000 };
+   for (auto trial = 0; trial < 10; ++trial)
+   {
+      SampleStats combined;
+      for (size_t pos = 0; pos < samples.size();)
+      {
+         const auto count =
+            std::min(pieceLength(engine), samples.size() - pos);
+         combined += SampleStats::Calculate(&samples[pos], count);
+         pos += count;
+      }
+      RequireEqual(combined, expected);
+   }
+}
+
+TEST_CASE("SampleStats of zeroes")
+{
+   std::vector<float> samples(3000);
+   samples[1000] = 0.5f;
+   auto combined = SampleStats::Zeroes(1000);
+   combined += SampleStats::Calculate(&samples[1000], 1);
+   combined += SampleStats::Zeroes(1999);
+   RequireEqual(combined, Reference(samples));
+}
+
+TEST_CASE("SampleStats::SilenceGridIndex")
+{
+   REQUIRE(SampleStats::SilenceGridIndex(-20.0) == 0);
+   REQUIRE(SampleStats::SilenceGridIndex(-35.0) == 3);
+   REQUIRE(SampleStats::SilenceGridIndex(-80.0) == 12);
+   REQUIRE(!SampleStats::SilenceGridIndex(-22.0));
+   REQUIRE(!SampleStats::SilenceGridIndex(-15.0));
+   REQUIRE(!SampleStats::SilenceGridIndex(-85.0));
+   REQUIRE(
+      SampleStats::SilenceThreshold(3) == DB_TO_LINEAR(-35.0));
+}
+
+// Hidden; run with the [benchmark] tag
+TEST_CASE("SampleStats::Calculate cost", "[.][benchmark]")
+{
+   using namespace std::chrono;
+   // The usual size of a sample block
+   const auto samples = MakeSamples(262144, 6);
+   constexpr auto blocks = 200;
+   auto start = steady_clock::now();
+   double total = 0;
+   for (auto ii = 0; ii < blocks; ++ii)
+      total += SampleStats::Calculate(samples.data(), samples.size()).sum;
+   const auto stats =
+      duration<double, std::milli>(steady_clock::now() - start).count();
+   start = steady_clock::now();
+   for (auto ii = 0; ii < blocks; ++ii)
+      for (const auto sample : samples)
+         total += sample * sample;
+   const auto squares =
+      duration<double, std::milli>(steady_clock::now() - start).count();
+   std::cout << "statistics " << stats / blocks << " ms per block, sum of "
+             << "squares " << squares / blocks << " ms (" << total << ")\n";
+}
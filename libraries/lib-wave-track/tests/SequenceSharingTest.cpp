@@ -0,0 +1,156 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SequenceSharingTest.cpp
+
+**********************************************************************/
+#include "MockSampleBlockFactory.h"
+#include "MockedPrefs.h"
+#include "Project.h"
+#include "Sequence.h"
+#include "UndoManager.h"
+#include "WaveClip.h"
+#include "WaveTrack.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <utility>
+
+namespace
+{
+MockedPrefs prefs;
+
+std::vector<float> GetAll(const Sequence& sequence)
+{
+   std::vector<float> samples(sequence.GetNumSamples().as_size_t());
+   sequence.Get(
+      reinterpret_cast<samplePtr>(samples.data()), floatSample, 0,
+      samples.size(), true);
+   return samples;
+}
+
+bool SharesBlocks(const Sequence& a, const Sequence& b)
+{
+   return &a.GetBlockArray() == &b.GetBlockArray();
+}
+
+// Small blocks, so that short sequences have many
+struct SmallBlocks
+{
+   SmallBlocks()
+       : oldSize { Sequence::GetMaxDiskBlockSize() }
+   {
+      Sequence::SetMaxDiskBlockSize(1024);
+   }
+   ~SmallBlocks()
+   {
+      Sequence::SetMaxDiskBlockSize(oldSize);
+   }
+   const size_t oldSize;
+};
+} // namespace
+
+TEST_CASE("Sequence copies share blocks until changed")
+{
+   SmallBlocks smallBlocks;
+   const auto factory = std::make_shared<MockSampleBlockFactory>();
+   Sequence original { factory, SampleFormats { floatSample, floatSample } };
+
+   std::vector<float> samples(10000);
+   std::iota(samples.begin(), samples.end(), 0.f);
+   original.Append(
+      reinterpret_cast<constSamplePtr>(samples.data()), floatSample,
+      samples.size(), 1, floatSample);
+   original.Flush();
+   REQUIRE(original.GetBlockArray().size() > 1);
+
+   Sequence copy { original, factory };
+   REQUIRE(SharesBlocks(copy, original));
+   REQUIRE(GetAll(copy) == samples);
+
+   SECTION("Changing the original leaves the copy")
+   {
+      original.Delete(100, 1000);
+      REQUIRE(!SharesBlocks(copy, original));
+      REQUIRE(GetAll(copy) == samples);
+      REQUIRE(original.GetNumSamples() == samples.size() - 1000);
+   }
+
+   SECTION("Changing the copy leaves the original")
+   {
+      const std::vector<float> zeroes(300);
+      copy.SetSamples(
+         reinterpret_cast<constSamplePtr>(zeroes.data()), floatSample, 500,
+         zeroes.size(), floatSample);
+      REQUIRE(!SharesBlocks(copy, original));
+      REQUIRE(GetAll(original) == samples);
+   }
+
+   SECTION("Appending to the copy leaves the original")
+   {
+      copy.Append(
+         reinterpret_cast<constSamplePtr>(samples.data()), floatSample,
+         samples.size(), 1, floatSample);
+      copy.Flush();
+      REQUIRE(GetAll(original) == samples);
+      REQUIRE(copy.GetNumSamples() == 2 * samples.size());
+   }
+
+   SECTION("A copy for another factory does not share")
+   {
+      const auto otherFactory = std::make_shared<MockSampleBlockFactory>();
+      Sequence other { original, otherFactory };
+      REQUIRE(!SharesBlocks(other, original));
+      REQUIRE(GetAll(other) == samples);
+   }
+}
+
+// Hidden; run with the [benchmark] tag
+TEST_CASE("UndoManager::PushState cost against project size", "[.][benchmark]")
+{
+   SmallBlocks smallBlocks;
+   constexpr auto rate = 44100;
+   constexpr auto clipsPerTrack = 10;
+   // Many blocks per clip, all sharing one silent sample block
+   constexpr auto clipDuration = 100 * 256.0 / rate;
+   constexpr auto pushes = 20;
+
+   for (const auto nTracks : { 10, 100, 300 })
+   {
+      const auto project = AudacityProject::Create();
+      const auto factory = std::make_shared<MockSampleBlockFactory>();
+      auto& tracks = TrackList::Get(*project);
+      for (auto ii = 0; ii < nTracks; ++ii)
+      {
+         const auto track =
+            std::make_shared<WaveTrack>(factory, floatSample, rate);
+         tracks.Add(track);
+         for (auto jj = 0; jj < clipsPerTrack; ++jj)
+         {
+            const auto clip = std::make_shared<WaveClip>(
+               1, factory, floatSample, rate, 0);
+            clip->InsertSilence(0, clipDuration);
+            clip->SetSequenceStartTime(jj * 2 * clipDuration);
+            track->AddClip(clip);
+         }
+      }
+
+      auto& undoManager = UndoManager::Get(*project);
+      const auto start = std::chrono::steady_clock::now();
+      for (auto ii = 0; ii < pushes; ++ii)
+         undoManager.PushState(Verbatim("Edit"), Verbatim("Edit"));
+      const auto milliseconds =
+         std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start)
+            .count();
+
+      std::cout << nTracks << " tracks of " << clipsPerTrack
+                << " clips: " << milliseconds / pushes << " ms per push\n";
+      undoManager.ClearStates();
+   }
+}
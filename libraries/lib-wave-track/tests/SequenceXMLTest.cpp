@@ -0,0 +1,312 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SequenceXMLTest.cpp
+
+**********************************************************************/
+#include "MockSampleBlock.h"
+#include "MockedPrefs.h"
+#include "Sequence.h"
+#include "XMLWriter.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace
+{
+MockedPrefs prefs;
+
+//! Keeps every block it makes, so that blocks can be found again by id,
+//! as a project database would; ids of new blocks are chosen by the test
+class ArchiveFactory final : public SampleBlockFactory
+{
+public:
+   SampleBlockIDs GetActiveBlockIDs() override
+   {
+      SampleBlockIDs result;
+      for (const auto& [id, _] : mBlocks)
+         result.insert(id);
+      return result;
+   }
+
+   //! Ids of the next blocks made, by step from the first
+   void NextIds(SampleBlockID first, SampleBlockID step)
+   {
+      mNextId = first;
+      mStep = step;
+   }
+
+private:
+   SampleBlockPtr DoCreate(
+      constSamplePtr src, size_t numsamples, sampleFormat srcformat) override
+   {
+      const auto id = mNextId;
+      mNextId += mStep;
+      return mBlocks[id] = std::make_shared<MockSampleBlock>(
+                id, src, numsamples, srcformat);
+   }
+
+   // Silent blocks have negated lengths for ids, like SqliteSampleBlock
+   SampleBlockPtr
+   DoCreateSilent(size_t numsamples, sampleFormat srcformat) override
+   {
+      const auto id = -static_cast<SampleBlockID>(numsamples);
+      auto& result = mBlocks[id];
+      if (!result)
+      {
+         std::vector<char> silence(numsamples * SAMPLE_SIZE(srcformat));
+         result = std::make_shared<MockSampleBlock>(
+            id, silence.data(), numsamples, srcformat);
+      }
+      return result;
+   }
+
+   SampleBlockPtr
+   DoCreateFromXML(sampleFormat, const AttributesList& attrs) override
+   {
+      for (const auto& [attr, value] : attrs)
+      {
+         long long id;
+         if (attr == "blockid" && value.TryGet(id))
+         {
+            const auto iter = mBlocks.find(id);
+            return iter == mBlocks.end() ? nullptr : iter->second;
+         }
+      }
+      return nullptr;
+   }
+
+   std::map<SampleBlockID, SampleBlockPtr> mBlocks;
+   SampleBlockID mNextId { 1 };
+   SampleBlockID mStep { 1 };
+};
+
+//! Records the tags and attributes written, to replay them to a reader
+class RecordingWriter final : public XMLWriter
+{
+public:
+   struct Tag
+   {
+      bool start;
+      std::string name;
+      std::vector<std::pair<std::string, std::variant<long long, std::string>>>
+         attrs;
+   };
+
+   using XMLWriter::WriteAttr;
+
+   void StartTag(const wxString& name) override
+   {
+      tags.push_back({ true, name.ToStdString(), {} });
+   }
+
+   void EndTag(const wxString& name) override
+   {
+      tags.push_back({ false, name.ToStdString(), {} });
+   }
+
+   void WriteAttr(const wxString& name, int value) override
+   {
+      Add(name, value);
+   }
+
+   void WriteAttr(const wxString& name, long value) override
+   {
+      Add(name, value);
+   }
+
+   void WriteAttr(const wxString& name, long long value) override
+   {
+      Add(name, value);
+   }
+
+   void WriteAttr(const wxString& name, size_t value) override
+   {
+      Add(name, static_cast<long long>(value));
+   }
+
+   bool
+   WriteBinaryAttr(const wxString& name, const void* data, size_t size) override
+   {
+      tags.back().attrs.emplace_back(
+         name.ToStdString(),
+         std::string { static_cast<const char*>(data), size });
+      return true;
+   }
+
+   void Write(const wxString&) override
+   {
+   }
+
+   //! Whether any tag was written with the attribute
+   bool Has(const std::string& name) const
+   {
+      for (const auto& tag : tags)
+         for (const auto& attr : tag.attrs)
+            if (attr.first == name)
+               return true;
+      return false;
+   }
+
+   size_t Count(const std::string& name) const
+   {
+      return std::count_if(tags.begin(), tags.end(), [&](const Tag& tag) {
+         return tag.start && tag.name == name;
+      });
+   }
+
+   void Replay(XMLTagHandler& handler) const
+   {
+      for (const auto& tag : tags)
+      {
+         if (!tag.start)
+         {
+            handler.HandleXMLEndTag(tag.name);
+            continue;
+         }
+         AttributesList attrs;
+         for (const auto& [name, value] : tag.attrs)
+            if (const auto pNumber = std::get_if<long long>(&value))
+               attrs.emplace_back(name, XMLAttributeValueView { *pNumber });
+            else
+               attrs.emplace_back(
+                  name, XMLAttributeValueView { std::string_view {
+                           std::get<std::string>(value) } });
+         REQUIRE(handler.HandleXMLTag(tag.name, attrs));
+      }
+   }
+
+   std::vector<Tag> tags;
+
+private:
+   void Add(const wxString& name, long long value)
+   {
+      tags.back().attrs.emplace_back(name.ToStdString(), value);
+   }
+};
+
+// Blocks of 2048 float samples; smaller would fail the check of maxsamples
+// on reading
+struct SmallBlocks
+{
+   SmallBlocks()
+       : oldSize { Sequence::GetMaxDiskBlockSize() }
+   {
+      Sequence::SetMaxDiskBlockSize(8192);
+   }
+   ~SmallBlocks()
+   {
+      Sequence::SetMaxDiskBlockSize(oldSize);
+   }
+   const size_t oldSize;
+};
+
+const SampleFormats formats { floatSample, floatSample };
+
+void Append(Sequence& sequence, size_t nBlocks)
+{
+   std::vector<float> samples(nBlocks * sequence.GetMaxBlockSize());
+   std::iota(samples.begin(), samples.end(), 0.f);
+   sequence.Append(
+      reinterpret_cast<constSamplePtr>(samples.data()), floatSample,
+      samples.size(), 1, floatSample);
+   sequence.Flush();
+}
+
+std::vector<float> GetAll(const Sequence& sequence)
+{
+   std::vector<float> samples(sequence.GetNumSamples().as_size_t());
+   sequence.Get(
+      reinterpret_cast<samplePtr>(samples.data()), floatSample, 0,
+      samples.size(), true);
+   return samples;
+}
+
+//! Writes the sequence, reads it back into another, and checks that the
+//! block arrays are the same
+RecordingWriter RoundTrip(
+   const std::shared_ptr<ArchiveFactory>& factory, const Sequence& sequence)
+{
+   RecordingWriter writer;
+   sequence.WriteXML(writer);
+
+   Sequence read { factory, formats };
+   writer.Replay(read);
+   REQUIRE(!read.GetErrorOpening());
+   REQUIRE(read.GetNumSamples() == sequence.GetNumSamples());
+
+   const auto& blocks = sequence.GetBlockArray();
+   const auto& readBlocks = read.GetBlockArray();
+   REQUIRE(readBlocks.size() == blocks.size());
+   for (size_t ii = 0; ii < blocks.size(); ++ii)
+   {
+      REQUIRE(readBlocks[ii].start == blocks[ii].start);
+      REQUIRE(readBlocks[ii].sb == blocks[ii].sb);
+   }
+   REQUIRE(GetAll(read) == GetAll(sequence));
+   return writer;
+}
+} // namespace
+
+TEST_CASE("Sequence writes long block arrays compactly and reads them back")
+{
+   SmallBlocks smallBlocks;
+   const auto factory = std::make_shared<ArchiveFactory>();
+
+   SECTION("Below the threshold, one tag for each block")
+   {
+      Sequence sequence { factory, formats };
+      Append(sequence, Sequence::MinCompactBlocks - 1);
+      REQUIRE(
+         sequence.GetBlockArray().size() == Sequence::MinCompactBlocks - 1);
+      const auto writer = RoundTrip(factory, sequence);
+      REQUIRE(!writer.Has("blocks"));
+      REQUIRE(writer.Count("waveblock") == Sequence::MinCompactBlocks - 1);
+   }
+
+   SECTION("At the threshold, one attribute for all blocks")
+   {
+      Sequence sequence { factory, formats };
+      Append(sequence, Sequence::MinCompactBlocks);
+      REQUIRE(sequence.GetBlockArray().size() == Sequence::MinCompactBlocks);
+      const auto writer = RoundTrip(factory, sequence);
+      REQUIRE(writer.Has("blocks"));
+      REQUIRE(writer.Count("waveblock") == 0);
+   }
+
+   SECTION("Silent blocks have negative ids")
+   {
+      Sequence sequence { factory, formats };
+      Append(sequence, Sequence::MinCompactBlocks);
+      const auto blockSize = sequence.GetMaxBlockSize();
+      sequence.InsertSilence(10 * blockSize, 3 * blockSize);
+      sequence.InsertSilence(0, 500);
+      auto nSilent = 0;
+      for (const auto& block : sequence.GetBlockArray())
+         if (block.sb->GetBlockID() < 0)
+            ++nSilent;
+      REQUIRE(nSilent >= 2);
+      const auto writer = RoundTrip(factory, sequence);
+      REQUIRE(writer.Has("blocks"));
+   }
+
+   SECTION("Ids may decrease")
+   {
+      factory->NextIds(1000000, -7);
+      Sequence sequence { factory, formats };
+      Append(sequence, 2 * Sequence::MinCompactBlocks);
+      const auto& blocks = sequence.GetBlockArray();
+      REQUIRE(blocks.back().sb->GetBlockID() < blocks.front().sb->GetBlockID());
+      const auto writer = RoundTrip(factory, sequence);
+      REQUIRE(writer.Has("blocks"));
+   }
+}
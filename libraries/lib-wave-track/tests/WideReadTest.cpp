@@ -0,0 +1,165 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  WideReadTest.cpp
+
+**********************************************************************/
+#include "MockSampleBlockFactory.h"
+#include "MockedPrefs.h"
+#include "Project.h"
+#include "Sequence.h"
+#include "WaveClip.h"
+#include "WaveTrack.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+MockedPrefs prefs;
+
+constexpr auto rate = 44100;
+
+// Small blocks, so that short sequences have many
+struct SmallBlocks
+{
+   SmallBlocks()
+       : oldSize { Sequence::GetMaxDiskBlockSize() }
+   {
+      Sequence::SetMaxDiskBlockSize(1024);
+   }
+   ~SmallBlocks()
+   {
+      Sequence::SetMaxDiskBlockSize(oldSize);
+   }
+   const size_t oldSize;
+};
+
+std::vector<float> Ramp(size_t len, float first)
+{
+   std::vector<float> samples(len);
+   std::iota(samples.begin(), samples.end(), first);
+   return samples;
+}
+
+//! Append in pieces of the given size, so that the blocks end differently
+void AppendInPieces(
+   Sequence& sequence, const std::vector<float>& samples, size_t piece)
+{
+   for (size_t pos = 0; pos < samples.size(); pos += piece)
+   {
+      sequence.Append(
+         reinterpret_cast<constSamplePtr>(samples.data() + pos), floatSample,
+         std::min(piece, samples.size() - pos), 1, floatSample);
+      sequence.Flush();
+   }
+}
+} // namespace
+
+TEST_CASE("Reading sequences together gives what reading each gives")
+{
+   SmallBlocks smallBlocks;
+   const auto factory = std::make_shared<MockSampleBlockFactory>();
+   constexpr size_t len = 5000;
+   Sequence left { factory, SampleFormats { floatSample, floatSample } };
+   Sequence right { factory, SampleFormats { floatSample, floatSample } };
+   AppendInPieces(left, Ramp(len, 0), len);
+   AppendInPieces(right, Ramp(len, -0.5), 100);
+   REQUIRE(left.GetBlockArray().size() != right.GetBlockArray().size());
+
+   const Sequence* const sequences[] { &left, &right };
+   for (const auto [start, count] : std::initializer_list<std::pair<int, int>> {
+           { 0, len }, { 1, 1 }, { 250, 700 }, { 4990, 10 }, { 1234, 0 } })
+   {
+      std::vector<float> wide[2] { std::vector<float>(count),
+                                   std::vector<float>(count) };
+      const samplePtr buffers[] { reinterpret_cast<samplePtr>(wide[0].data()),
+                                  reinterpret_cast<samplePtr>(wide[1].data()) };
+      REQUIRE(Sequence::Get(
+         sequences, 2, buffers, floatSample, start, count, true));
+
+      for (size_t ii = 0; ii < 2; ++ii)
+      {
+         std::vector<float> one(count);
+         sequences[ii]->Get(
+            reinterpret_cast<samplePtr>(one.data()), floatSample, start, count,
+            true);
+         REQUIRE(wide[ii] == one);
+      }
+   }
+
+   SECTION("A range past the end fails without throwing")
+   {
+      std::vector<float> wide[2] { std::vector<float>(10),
+                                   std::vector<float>(10) };
+      const samplePtr buffers[] { reinterpret_cast<samplePtr>(wide[0].data()),
+                                  reinterpret_cast<samplePtr>(wide[1].data()) };
+      REQUIRE(!Sequence::Get(
+         sequences, 2, buffers, floatSample, len - 5, 10, false));
+   }
+}
+
+TEST_CASE("Stereo WaveTrack reads both channels as it reads each")
+{
+   SmallBlocks smallBlocks;
+   const auto project = AudacityProject::Create();
+   const auto factory = std::make_shared<MockSampleBlockFactory>();
+   auto& tracks = TrackList::Get(*project);
+
+   // Clips with a gap between, and trimmed alike in both channels
+   const auto makeChannel = [&](float first) {
+      const auto track =
+         std::make_shared<WaveTrack>(factory, floatSample, rate);
+      tracks.Add(track);
+      for (auto ii = 0; ii < 2; ++ii)
+      {
+         const auto clip =
+            std::make_shared<WaveClip>(1, factory, floatSample, rate, 0);
+         const auto samples = Ramp(3000, first + 10000 * ii);
+         constSamplePtr buffers[] {
+            reinterpret_cast<constSamplePtr>(samples.data())
+         };
+         clip->Append(buffers, floatSample, samples.size(), 1, floatSample);
+         clip->Flush();
+         clip->SetSequenceStartTime(ii * 4000.0 / rate);
+         clip->SetTrimLeft(100.0 / rate);
+         track->AddClip(clip);
+      }
+      return track;
+   };
+   const auto left = makeChannel(0);
+   makeChannel(-0.5);
+   REQUIRE(tracks.MakeMultiChannelTrack(*left, 2));
+   REQUIRE(left->NChannels() == 2);
+
+   for (const auto backwards : { false, true })
+      for (const auto [start, count] :
+           std::initializer_list<std::pair<int, int>> {
+              { 0, 8000 }, { 200, 50 }, { 2800, 1500 }, { 7000, 2000 } })
+      {
+         const auto from = backwards ? start + count : start;
+         std::vector<float> wide[2] { std::vector<float>(count),
+                                      std::vector<float>(count) };
+         float* const buffers[] { wide[0].data(), wide[1].data() };
+         sampleCount wideWithin = 0;
+         REQUIRE(left->GetFloats(
+            0, 2, buffers, from, count, backwards, FillFormat::fillTwo, true,
+            &wideWithin));
+
+         for (size_t iChannel = 0; iChannel < 2; ++iChannel)
+         {
+            std::vector<float> one(count);
+            float* const buffer[] { one.data() };
+            sampleCount within = 0;
+            REQUIRE(left->GetFloats(
+               iChannel, 1, buffer, from, count, backwards,
+               FillFormat::fillTwo, true, &within));
+            REQUIRE(wide[iChannel] == one);
+            REQUIRE(wideWithin == within);
+         }
+      }
+}
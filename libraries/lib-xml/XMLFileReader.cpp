@@ -49,13 +49,19 @@ bool XMLFileReader::Parse(XMLTagHandler *baseHandler,
 
    mBaseHandler = baseHandler;
 
-   const size_t bufferSize = 16384;
-   char buffer[16384];
+   // Read large blocks directly into the parser's own buffer, so that big
+   // projects are not copied again and again in small pieces
+   const size_t bufferSize = 1 << 20;
    int done = 0;
    do {
+      const auto buffer = XML_GetBuffer(mParser, bufferSize);
+      if (!buffer) {
+         mErrorStr = XO("Could not load file: \"%s\"").Format( fname );
+         return false;
+      }
       size_t len = fread(buffer, 1, bufferSize, theXMLFile.fp());
       done = (len < bufferSize);
-      if (!XML_Parse(mParser, buffer, len, done)) {
+      if (!XML_ParseBuffer(mParser, len, done)) {
 
          // Embedded error string from expat doesn't translate (yet)
          // We could make a table of XOs if we wanted so that it could
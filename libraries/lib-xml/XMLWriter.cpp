@@ -199,6 +199,11 @@ void XMLWriter::WriteAttr(const wxString &name, double value, int digits)
       Internat::ToString(value, digits)));
 }
 
+bool XMLWriter::WriteBinaryAttr(const wxString &, const void *, size_t)
+{
+   return false;
+}
+
 void XMLWriter::WriteData(const wxString &value)
 // may throw from Write()
 {
@@ -49,6 +49,12 @@ class XML_API XMLWriter /* not final */ {
    virtual void WriteAttr(const wxString &name, float value, int digits = -1);
    virtual void WriteAttr(const wxString &name, double value, int digits = -1);
 
+   //! Write an attribute whose value is arbitrary bytes
+   /*! Only binary formats can; the default writes nothing and returns false,
+    and then the caller must write the information another way */
+   virtual bool WriteBinaryAttr(
+      const wxString &name, const void *data, size_t size);
+
    virtual void WriteData(const wxString &value);
 
    virtual void WriteSubTree(const wxString &value);
@@ -46,6 +46,7 @@
 #include "ExportOptionsEditor.h"
 #include "ExportOptionsUIServices.h"
 #include "ExportPluginHelpers.h"
+#include "PipelinedMixer.h"
 #include "ExportPluginRegistry.h"
 
 #ifdef USE_LIBID3TAG
@@ -425,7 +426,7 @@ class CLExportProcessor : public ExportProcessor
       unsigned channels;
       wxString cmd;
       bool showOutput;
-      std::unique_ptr<Mixer> mixer;
+      std::unique_ptr<PipelinedMixer> mixer;
       wxString output;
       std::unique_ptr<ExportCLProcess> process;
    } context;
@@ -40,6 +40,7 @@ function.
 #include "ShuttleGui.h"
 
 #include "ExportPluginHelpers.h"
+#include "PipelinedMixer.h"
 #include "PlainExportOptionsEditor.h"
 #include "FFmpegDefines.h"
 #include "ExportOptionsUIServices.h"
@@ -607,7 +608,7 @@ public:
    /// Flushes audio encoder
    bool Finalize();
 
-   std::unique_ptr<Mixer> CreateMixer(const TrackList &tracks,
+   std::unique_ptr<PipelinedMixer> CreateMixer(const TrackList &tracks,
          bool selectionOnly,
          double startTime, double stopTime,
          MixerOptions::Downmix *mixerSpec);
@@ -668,7 +669,7 @@ class FFmpegExportProcessor final : public ExportProcessor
       TranslatableString status;
       double t0;
       double t1;
-      std::unique_ptr<Mixer> mixer;
+      std::unique_ptr<PipelinedMixer> mixer;
       std::unique_ptr<FFmpegExporter> exporter;
    } context;
 
@@ -725,7 +726,7 @@ FFmpegExporter::FFmpegExporter(std::shared_ptr<FFmpegFunctions> ffmpeg,
    }
 }
 
-std::unique_ptr<Mixer> FFmpegExporter::CreateMixer(const TrackList& tracks, bool selectionOnly, double startTime, double stopTime, MixerOptions::Downmix* mixerSpec)
+std::unique_ptr<PipelinedMixer> FFmpegExporter::CreateMixer(const TrackList& tracks, bool selectionOnly, double startTime, double stopTime, MixerOptions::Downmix* mixerSpec)
 {
    return ExportPluginHelpers::CreateMixer(tracks, selectionOnly,
       startTime, stopTime,
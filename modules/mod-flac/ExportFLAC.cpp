@@ -33,9 +33,12 @@ Joshua Haberman
 #include "wxFileNameWrapper.h"
 
 #include "ExportPluginHelpers.h"
+#include "PipelinedMixer.h"
 #include "ExportPluginRegistry.h"
 #include "PlainExportOptionsEditor.h"
 
+#include "ParallelFLACEncoder.h"
+
 //----------------------------------------------------------------------------
 // ExportFLACOptions Class
 //----------------------------------------------------------------------------
@@ -44,7 +47,8 @@ namespace
 {
 enum : int {
    FlacOptionIDBitDepth = 0,
-   FlacOptionIDLevel
+   FlacOptionIDLevel,
+   FlacOptionIDParallel
 };
 
 const std::initializer_list<PlainExportOptionsEditor::OptionDesc> FlacOptions {
@@ -85,6 +89,12 @@ const std::initializer_list<PlainExportOptionsEditor::OptionDesc> FlacOptions {
             XO("8 (best)") ,
          }
       }, wxT("/FileFormats/FLACLevel")
+   },
+   {
+      {
+         FlacOptionIDParallel, XO("Encode on several threads"),
+         true
+      }, wxT("/FileFormats/FLACParallel")
    }
 };
 
@@ -183,8 +193,10 @@ class FLACExportProcessor final : public ExportProcessor
       wxFileNameWrapper fName;
       sampleFormat format;
       FLAC::Encoder::File encoder;
+      //! Used instead of encoder, if not null
+      std::unique_ptr<ParallelFLACEncoder> parallel;
       wxFFile f;
-      std::unique_ptr<Mixer> mixer;
+      std::unique_ptr<PipelinedMixer> mixer;
    } context;
 
 public:
@@ -250,6 +262,9 @@ bool ExportFLAC::ParseConfig(int, const rapidjson::Value& config, ExportProcesso
 
    const auto level = ExportValue(std::to_string(config["level"].GetInt()));
    const auto bitDepth = ExportValue(std::to_string(config["bit_depth"].GetInt()));
+   const auto parallel = ExportValue(
+      !config.HasMember("parallel") || !config["parallel"].IsBool() ||
+      config["parallel"].GetBool());
 
    for(const auto& desc : FlacOptions)
    {
@@ -267,7 +282,8 @@ bool ExportFLAC::ParseConfig(int, const rapidjson::Value& config, ExportProcesso
    }
    ExportProcessor::Parameters result {
       { FlacOptionIDLevel, level },
-      { FlacOptionIDBitDepth, bitDepth }
+      { FlacOptionIDBitDepth, bitDepth },
+      { FlacOptionIDParallel, parallel }
    };
    std::swap(parameters, result);
    return true;
@@ -309,17 +325,62 @@ bool FLACExportProcessor::Initialize(AudacityProject& project,
 
    long levelPref = std::stol(ExportPluginHelpers::GetParameterValue<std::string>(parameters, FlacOptionIDLevel));
    auto bitDepthPref = ExportPluginHelpers::GetParameterValue<std::string>(parameters, FlacOptionIDBitDepth);
+#ifdef LEGACY_FLAC
+   const bool parallel = false;
+#else
+   const bool parallel = ExportPluginHelpers::GetParameterValue<bool>(
+      parameters, FlacOptionIDParallel, true);
+#endif
+
+   unsigned bitsPerSample;
+   if (bitDepthPref == "24") {
+      context.format = int24Sample;
+      bitsPerSample = 24;
+   } else { //convert float to 16 bits
+      context.format = int16Sample;
+      bitsPerSample = 16;
+   }
+
+   // Duplicate the flac command line compression levels
+   if (levelPref < 0 || levelPref > 8) {
+      levelPref = 5;
+   }
+   const auto &flacLevel = flacLevels[levelPref];
+
+   // The settings, applied either to the one encoder, or to one for each
+   // chunk encoded in parallel
+   const auto configure = [=, &flacLevel](FLAC::Encoder::Stream &encoder) {
+      bool success = encoder.set_channels(numChannels) &&
+         encoder.set_sample_rate(lrint(sampleRate)) &&
+         encoder.set_bits_per_sample(bitsPerSample) &&
+         encoder.set_do_exhaustive_model_search(flacLevel.do_exhaustive_model_search) &&
+         encoder.set_do_escape_coding(flacLevel.do_escape_coding);
+
+      if (numChannels != 2) {
+         success = success &&
+         encoder.set_do_mid_side_stereo(false) &&
+         encoder.set_loose_mid_side_stereo(false);
+      }
+      else {
+         success = success &&
+         encoder.set_do_mid_side_stereo(flacLevel.do_mid_side_stereo) &&
+         encoder.set_loose_mid_side_stereo(flacLevel.loose_mid_side_stereo);
+      }
+
+      return success &&
+         encoder.set_qlp_coeff_precision(flacLevel.qlp_coeff_precision) &&
+         encoder.set_min_residual_partition_order(flacLevel.min_residual_partition_order) &&
+         encoder.set_max_residual_partition_order(flacLevel.max_residual_partition_order) &&
+         encoder.set_rice_parameter_search_dist(flacLevel.rice_parameter_search_dist) &&
+         encoder.set_max_lpc_order(flacLevel.max_lpc_order);
+   };
 
-   
    auto& encoder = context.encoder;
 
    bool success = true;
-   success = success &&
 #ifdef LEGACY_FLAC
-   encoder.set_filename(OSOUTPUT(fName)) &&
+   success = encoder.set_filename(OSOUTPUT(fName));
 #endif
-   encoder.set_channels(numChannels) &&
-   encoder.set_sample_rate(lrint(sampleRate));
 
    // See note in MakeMetadata() about a bug in libflac++ 1.1.2
    FLAC__StreamMetadataHandle metadata;
@@ -331,48 +392,11 @@ bool FLACExportProcessor::Initialize(AudacityProject& project,
       throw ExportErrorException("FLAC:283");
    }
 
-   if (success && metadata) {
-      // set_metadata expects an array of pointers to metadata and a size.
-      // The size is 1.
-      FLAC__StreamMetadata *p = metadata.get();
-      success = encoder.set_metadata(&p, 1);
-   }
-
-   
-   if (bitDepthPref == "24") {
-      context.format = int24Sample;
-      success = success && encoder.set_bits_per_sample(24);
-   } else { //convert float to 16 bits
-      context.format = int16Sample;
-      success = success && encoder.set_bits_per_sample(16);
-   }
-
-
-   // Duplicate the flac command line compression levels
-   if (levelPref < 0 || levelPref > 8) {
-      levelPref = 5;
-   }
-   success = success &&
-   encoder.set_do_exhaustive_model_search(flacLevels[levelPref].do_exhaustive_model_search) &&
-   encoder.set_do_escape_coding(flacLevels[levelPref].do_escape_coding);
-
-   if (numChannels != 2) {
-      success = success &&
-      encoder.set_do_mid_side_stereo(false) &&
-      encoder.set_loose_mid_side_stereo(false);
-   }
-   else {
-      success = success &&
-      encoder.set_do_mid_side_stereo(flacLevels[levelPref].do_mid_side_stereo) &&
-      encoder.set_loose_mid_side_stereo(flacLevels[levelPref].loose_mid_side_stereo);
-   }
-
-   success = success &&
-   encoder.set_qlp_coeff_precision(flacLevels[levelPref].qlp_coeff_precision) &&
-   encoder.set_min_residual_partition_order(flacLevels[levelPref].min_residual_partition_order) &&
-   encoder.set_max_residual_partition_order(flacLevels[levelPref].max_residual_partition_order) &&
-   encoder.set_rice_parameter_search_dist(flacLevels[levelPref].rice_parameter_search_dist) &&
-   encoder.set_max_lpc_order(flacLevels[levelPref].max_lpc_order);
+   // set_metadata expects an array of pointers to metadata and a size.
+   // The size is 1.
+   FLAC__StreamMetadata *p = metadata.get();
+   if (!parallel)
+      success = success && configure(encoder) && encoder.set_metadata(&p, 1);
 
    if (!success) {
       // TODO: more precise message
@@ -389,14 +413,20 @@ bool FLACExportProcessor::Initialize(AudacityProject& project,
          .Translation());
    }
 
-   // Even though there is an init() method that takes a filename, use the one that
-   // takes a file handle because wxWidgets can open a file with a Unicode name and
-   // libflac can't (under Windows).
-   int status = encoder.init(context.f.fp());
-   if (status != FLAC__STREAM_ENCODER_INIT_STATUS_OK) {
-      throw ExportException(XO("FLAC encoder failed to initialize\nStatus: %d")
-            .Format( status )
-            .Translation());
+   if (parallel)
+      // Writes the stream header now
+      context.parallel = std::make_unique<ParallelFLACEncoder>(
+         configure, &p, 1, numChannels, bitsPerSample, context.f, fName);
+   else {
+      // Even though there is an init() method that takes a filename, use the one that
+      // takes a file handle because wxWidgets can open a file with a Unicode name and
+      // libflac can't (under Windows).
+      int status = encoder.init(context.f.fp());
+      if (status != FLAC__STREAM_ENCODER_INIT_STATUS_OK) {
+         throw ExportException(XO("FLAC encoder failed to initialize\nStatus: %d")
+               .Format( status )
+               .Translation());
+      }
    }
 #endif
 
@@ -422,6 +452,11 @@ ExportResult FLACExportProcessor::Process(ExportProcessorDelegate& delegate)
 
    auto cleanup2 = finally( [&] {
       if (exportResult == ExportResult::Cancelled || exportResult == ExportResult::Error) {
+         if (context.parallel) {
+            context.parallel.reset();
+            context.f.Close();
+            return;
+         }
 #ifndef LEGACY_FLAC
          context.f.Detach(); // libflac closes the file
 #endif
@@ -449,9 +484,10 @@ ExportResult FLACExportProcessor::Process(ExportProcessorDelegate& delegate)
             }
          }
       }
-      if (! context.encoder.process(
-            reinterpret_cast<FLAC__int32**>( tmpsmplbuf.get() ),
-            samplesThisRun) ) {
+      const auto buffers = reinterpret_cast<FLAC__int32**>( tmpsmplbuf.get() );
+      if (context.parallel)
+         context.parallel->Process(buffers, samplesThisRun);
+      else if (! context.encoder.process(buffers, samplesThisRun) ) {
          // TODO: more precise message
          throw ExportDiskFullError(context.fName);
       }
@@ -459,7 +495,16 @@ ExportResult FLACExportProcessor::Process(ExportProcessorDelegate& delegate)
          delegate, *context.mixer, context.t0, context.t1);
    }
 
-   if (exportResult != ExportResult::Cancelled && exportResult != ExportResult::Error) {
+   if (exportResult != ExportResult::Cancelled && exportResult != ExportResult::Error &&
+       context.parallel) {
+      context.parallel->Finish();
+      context.parallel.reset();
+      if (!context.f.Flush() || !context.f.Close())
+      {
+         return ExportResult::Error;
+      }
+   }
+   else if (exportResult != ExportResult::Cancelled && exportResult != ExportResult::Error) {
 #ifndef LEGACY_FLAC
       context.f.Detach(); // libflac closes the file
 #endif
@@ -139,8 +139,12 @@ public:
    void SetStreamUsage(wxInt32 WXUNUSED(StreamID), bool WXUNUSED(Use)) override
    {}
 
+   bool SupportsConcurrentImport() const override { return true; }
+
 private:
    sampleFormat          mFormat;
+   //! Chosen when opening, so that importing reads no preferences
+   sampleFormat          mTrackFormat;
    std::unique_ptr<MyFLACFile> mFile;
    wxFFile               mHandle;
    unsigned long         mSampleRate;
@@ -377,6 +381,7 @@ bool FLACImportFileHandle::Init()
       // This probably is not a FLAC file at all
       return false;
    }
+   mTrackFormat = ImportUtils::ChooseFormat(mFormat);
    return true;
 }
 
@@ -405,7 +410,7 @@ void FLACImportFileHandle::Import(
 
    wxASSERT(mStreamInfoDone);
 
-   mTrackList = ImportUtils::NewWaveTrack(*trackFactory, mNumChannels, mFormat, mSampleRate);
+   mTrackList = trackFactory->Create(mNumChannels, mTrackFormat, mSampleRate);
 
    mFile->mImportProgressListener = &progressListener;
 
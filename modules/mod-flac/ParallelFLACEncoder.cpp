@@ -0,0 +1,342 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file ParallelFLACEncoder.cpp
+
+**********************************************************************/
+#include "ParallelFLACEncoder.h"
+
+#include "ExportPlugin.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <utility>
+
+namespace {
+
+// Frames per chunk; with the usual block size of 4096, about three seconds
+// of audio at 44.1 kHz
+constexpr size_t FramesPerChunk = 32;
+
+// Size of the STREAMINFO block, after its own block header
+constexpr size_t StreamInfoBytes = 34;
+
+// CRC-8 (polynomial x^8 + x^2 + x + 1) that ends frame headers
+uint8_t Crc8(const FLAC__byte *data, size_t bytes)
+{
+   static const auto table = []{
+      std::array<uint8_t, 256> table;
+      for (unsigned ii = 0; ii < 256; ++ii) {
+         uint8_t crc = ii;
+         for (int bit = 0; bit < 8; ++bit)
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+         table[ii] = crc;
+      }
+      return table;
+   }();
+   uint8_t crc = 0;
+   while (bytes--)
+      crc = table[crc ^ *data++];
+   return crc;
+}
+
+// CRC-16 (polynomial x^16 + x^15 + x^2 + 1) that ends whole frames
+uint16_t Crc16(const FLAC__byte *data, size_t bytes)
+{
+   static const auto table = []{
+      std::array<uint16_t, 256> table;
+      for (unsigned ii = 0; ii < 256; ++ii) {
+         uint16_t crc = ii << 8;
+         for (int bit = 0; bit < 8; ++bit)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x8005 : crc << 1;
+         table[ii] = crc;
+      }
+      return table;
+   }();
+   uint16_t crc = 0;
+   while (bytes--)
+      crc = (crc << 8) ^ table[(crc >> 8) ^ *data++];
+   return crc;
+}
+
+// Frame numbers are coded like UTF-8, extended to 36 bits
+size_t CodedNumberLength(FLAC__byte first)
+{
+   size_t length = 0;
+   while (length < 8 && (first & (0x80 >> length)))
+      ++length;
+   return length == 0 ? 1 : length;
+}
+
+void AppendCodedNumber(std::vector<FLAC__byte> &out, uint64_t number)
+{
+   if (number < 0x80) {
+      out.push_back(number);
+      return;
+   }
+   // Count the continuation bytes, each holding six bits
+   size_t more = 1;
+   while (more < 6 && number >= (uint64_t{ 1 } << (6 * more + 6 - more)))
+      ++more;
+   const FLAC__byte lead = 0xFF00 >> (more + 1);
+   out.push_back(lead | (number >> (6 * more)));
+   while (more--)
+      out.push_back(0x80 | ((number >> (6 * more)) & 0x3F));
+}
+
+//! Append a copy of the frame, with a different frame number
+void AppendRenumbered(std::vector<FLAC__byte> &out,
+   const FLAC__byte *frame, size_t bytes, uint64_t number)
+{
+   // Sync code, block size, sample rate, channels and bit depth
+   constexpr size_t fixedBytes = 4;
+   // Fixed block size streams number frames, not samples
+   assert((frame[1] & 1) == 0);
+
+   const auto numberLength = CodedNumberLength(frame[fixedBytes]);
+   size_t optionalBytes = 0;
+   switch (frame[2] >> 4) {
+   case 6: optionalBytes += 1; break;
+   case 7: optionalBytes += 2; break;
+   default: break;
+   }
+   switch (frame[2] & 0x0F) {
+   case 12: optionalBytes += 1; break;
+   case 13: case 14: optionalBytes += 2; break;
+   default: break;
+   }
+   const auto headerCrcPosition = fixedBytes + numberLength + optionalBytes;
+   assert(bytes > headerCrcPosition + 2);
+
+   const auto start = out.size();
+   out.insert(out.end(), frame, frame + fixedBytes);
+   AppendCodedNumber(out, number);
+   out.insert(out.end(),
+      frame + fixedBytes + numberLength, frame + headerCrcPosition);
+   out.push_back(Crc8(out.data() + start, out.size() - start));
+   // Subframes are unchanged; the footer is the CRC of all that precedes it
+   out.insert(out.end(), frame + headerCrcPosition + 1, frame + bytes - 2);
+   const auto crc = Crc16(out.data() + start, out.size() - start);
+   out.push_back(crc >> 8);
+   out.push_back(crc & 0xFF);
+}
+
+void PutBigEndian(FLAC__byte *out, uint64_t value, size_t bytes)
+{
+   while (bytes--) {
+      out[bytes] = value & 0xFF;
+      value >>= 8;
+   }
+}
+}
+
+//! Collects the encoded frames of one chunk, renumbered for the whole stream
+class ParallelFLACEncoder::ChunkEncoder final : public FLAC::Encoder::Stream
+{
+public:
+   explicit ChunkEncoder(Chunk *pChunk = nullptr) : mpChunk{ pChunk } {}
+
+   //! Stream header and metadata blocks, if not encoding a chunk
+   std::vector<FLAC__byte> header;
+
+protected:
+   ::FLAC__StreamEncoderWriteStatus write_callback(const FLAC__byte buffer[],
+      size_t bytes, uint32_t samples, uint32_t current_frame) override
+   {
+      if (samples == 0) {
+         // Only the first encoder's stream header is wanted
+         if (!mpChunk)
+            header.insert(header.end(), buffer, buffer + bytes);
+      }
+      else if (mpChunk) {
+         auto &encoded = mpChunk->encoded;
+         const auto before = encoded.size();
+         AppendRenumbered(encoded, buffer, bytes,
+            mpChunk->firstFrame + current_frame);
+         const auto frameBytes = encoded.size() - before;
+         mpChunk->minFrameBytes = std::min(mpChunk->minFrameBytes, frameBytes);
+         mpChunk->maxFrameBytes = std::max(mpChunk->maxFrameBytes, frameBytes);
+      }
+      return FLAC__STREAM_ENCODER_WRITE_STATUS_OK;
+   }
+
+private:
+   Chunk *const mpChunk;
+};
+
+ParallelFLACEncoder::ParallelFLACEncoder(Configure configure,
+   FLAC__StreamMetadata **metadata, unsigned numMetadata,
+   unsigned channels, unsigned bitsPerSample,
+   wxFFile &file, const wxFileNameWrapper &fileName)
+   : mConfigure{ move(configure) }
+   , mChannels{ channels }
+   , mBytesPerSample{ (bitsPerSample + 7) / 8 }
+   , mFile{ file }
+   , mFileName{ fileName }
+{
+   // An encoder that only writes the stream header, with the metadata; the
+   // chunks' encoders write none
+   ChunkEncoder headerEncoder;
+   if (!(mConfigure(headerEncoder) &&
+         headerEncoder.set_metadata(metadata, numMetadata) &&
+         headerEncoder.init() == FLAC__STREAM_ENCODER_INIT_STATUS_OK))
+      throw ExportErrorException("FLAC:chunk-init");
+   mBlockSize = headerEncoder.get_blocksize();
+   headerEncoder.finish();
+
+   // "fLaC", then the STREAMINFO block header, then STREAMINFO
+   auto &header = headerEncoder.header;
+   if (header.size() < 8 + StreamInfoBytes)
+      throw ExportErrorException("FLAC:chunk-init");
+   mStreamInfoOffset = mFile.Tell() + 8;
+   Write(header.data(), header.size());
+
+   mChunkSize = mBlockSize * FramesPerChunk;
+   mBatchSize = Parallel::DefaultConcurrency();
+   mFilling = NewChunk(0);
+}
+
+ParallelFLACEncoder::~ParallelFLACEncoder()
+{
+   if (mEncodingThread.joinable())
+      mEncodingThread.join();
+}
+
+auto ParallelFLACEncoder::NewChunk(uint64_t firstFrame) const -> Chunk
+{
+   Chunk chunk;
+   chunk.samples.resize(mChannels);
+   for (auto &channel : chunk.samples)
+      channel.reserve(mChunkSize);
+   chunk.firstFrame = firstFrame;
+   chunk.minFrameBytes = SIZE_MAX;
+   return chunk;
+}
+
+void ParallelFLACEncoder::Process(
+   const FLAC__int32 *const buffers[], size_t samples)
+{
+   // The MD5 is of the interleaved samples, little-endian, in whole bytes
+   mMD5Buffer.resize(samples * mChannels * mBytesPerSample);
+   auto pByte = mMD5Buffer.data();
+   for (size_t ii = 0; ii < samples; ++ii)
+      for (unsigned channel = 0; channel < mChannels; ++channel) {
+         const auto sample = buffers[channel][ii];
+         for (unsigned byte = 0; byte < mBytesPerSample; ++byte)
+            *pByte++ = (sample >> (8 * byte)) & 0xFF;
+      }
+   mMD5.Update(mMD5Buffer.data(), mMD5Buffer.size());
+   mTotalSamples += samples;
+
+   for (size_t done = 0; done < samples;) {
+      const auto count = std::min(samples - done, mChunkSize - mFilling.length);
+      for (unsigned channel = 0; channel < mChannels; ++channel)
+         mFilling.samples[channel].insert(mFilling.samples[channel].end(),
+            buffers[channel] + done, buffers[channel] + done + count);
+      mFilling.length += count;
+      done += count;
+
+      if (mFilling.length == mChunkSize) {
+         const auto nextFrame = mFilling.firstFrame + FramesPerChunk;
+         mFull.push_back(std::move(mFilling));
+         mFilling = NewChunk(nextFrame);
+         if (mFull.size() == mBatchSize)
+            Dispatch();
+      }
+   }
+}
+
+void ParallelFLACEncoder::EncodeChunk(Chunk &chunk) const
+{
+   ChunkEncoder encoder{ &chunk };
+   if (!(mConfigure(encoder) &&
+         encoder.set_verify(true) &&
+         // The whole stream's MD5 is computed in Process()
+         encoder.set_do_md5(false) &&
+         encoder.init() == FLAC__STREAM_ENCODER_INIT_STATUS_OK))
+      throw ExportErrorException("FLAC:chunk-init");
+
+   std::vector<const FLAC__int32 *> buffers;
+   for (auto &channel : chunk.samples)
+      buffers.push_back(channel.data());
+   const auto ok = encoder.process(buffers.data(), chunk.length);
+   // Verification failures are reported by either of these
+   if (!(encoder.finish() && ok))
+      throw ExportErrorException("FLAC:chunk-encode");
+
+   // Release the input early; batches can be large
+   chunk.samples = {};
+}
+
+void ParallelFLACEncoder::Dispatch()
+{
+   WriteBatch();
+   mEncoding = std::move(mFull);
+   mFull.clear();
+   mEncodingThread = std::thread{ [this]{
+      try {
+         Parallel::For(mEncoding.size(), [this](size_t ii){
+            EncodeChunk(mEncoding[ii]);
+         });
+      }
+      catch (...) {
+         mEncodingException = std::current_exception();
+      }
+   } };
+}
+
+void ParallelFLACEncoder::WriteBatch()
+{
+   if (!mEncodingThread.joinable())
+      return;
+   mEncodingThread.join();
+   if (mEncodingException)
+      std::rethrow_exception(std::exchange(mEncodingException, nullptr));
+   for (auto &chunk : mEncoding) {
+      Write(chunk.encoded.data(), chunk.encoded.size());
+      mMinFrameBytes = std::min(mMinFrameBytes, chunk.minFrameBytes);
+      mMaxFrameBytes = std::max(mMaxFrameBytes, chunk.maxFrameBytes);
+   }
+   mEncoding.clear();
+}
+
+void ParallelFLACEncoder::Finish()
+{
+   if (mFilling.length > 0)
+      mFull.push_back(std::move(mFilling));
+   mFilling = NewChunk(0);
+   if (!mFull.empty())
+      Dispatch();
+   WriteBatch();
+
+   // Complete STREAMINFO: bytes 0-3 hold the block sizes, already correct
+   std::array<FLAC__byte, StreamInfoBytes> streamInfo;
+   if (!mFile.Seek(mStreamInfoOffset) ||
+       mFile.Read(streamInfo.data(), streamInfo.size()) != streamInfo.size())
+      throw ExportDiskFullError(mFileName);
+   if (mTotalSamples == 0)
+      mMinFrameBytes = 0;
+   PutBigEndian(&streamInfo[4], mMinFrameBytes, 3);
+   PutBigEndian(&streamInfo[7], mMaxFrameBytes, 3);
+   // Sample rate, channels and bit depth take the 28 bits before the 36 bit
+   // total sample count
+   streamInfo[13] = (streamInfo[13] & 0xF0) | ((mTotalSamples >> 32) & 0x0F);
+   PutBigEndian(&streamInfo[14], mTotalSamples & 0xFFFFFFFF, 4);
+   const auto digest = mMD5.FinalizeDigest();
+   std::copy(digest.begin(), digest.end(), &streamInfo[18]);
+
+   if (!mFile.Seek(mStreamInfoOffset))
+      throw ExportDiskFullError(mFileName);
+   Write(streamInfo.data(), streamInfo.size());
+   mFile.SeekEnd();
+}
+
+void ParallelFLACEncoder::Write(const void *buffer, size_t bytes)
+{
+   if (mFile.Write(buffer, bytes) != bytes)
+      throw ExportDiskFullError(mFileName);
+}
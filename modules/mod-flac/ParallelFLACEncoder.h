@@ -0,0 +1,107 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file ParallelFLACEncoder.h
+  @brief Encodes a FLAC stream as independent chunks on several threads
+
+**********************************************************************/
+#pragma once
+
+#include "FLAC++/encoder.h"
+#include "crypto/MD5.h"
+#include "wxFileNameWrapper.h"
+
+#include <wx/ffile.h>
+
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <thread>
+#include <vector>
+
+//! Splits the stream into chunks of whole frames, and encodes them in
+//! parallel with an encoder each, writing them to the file in order
+/*!
+ FLAC frames do not depend on each other, but each one records its frame
+ number, and each chunk's encoder counts from zero; so the frame headers are
+ renumbered, and their checksums recomputed, as the chunks are stitched
+ together.  STREAMINFO, which the encoders cannot know, is computed here and
+ written over the placeholder at the start of the file when finished.
+
+ Each encoder runs with libFLAC's verification, which decodes every frame it
+ produces and fails on any difference from the input, so the audio decodes
+ bit for bit as the samples passed to Process().
+ */
+class ParallelFLACEncoder final
+{
+public:
+   //! Applies the settings of the export to an encoder before initialization
+   using Configure = std::function<bool(FLAC::Encoder::Stream&)>;
+
+   //! Writes the stream header and metadata blocks to the file
+   /*!
+    @param metadata, numMetadata as for `FLAC::Encoder::Stream::set_metadata`;
+    needed only during construction
+    @pre `file` is open for writing and positioned at its start
+    */
+   ParallelFLACEncoder(Configure configure,
+      FLAC__StreamMetadata **metadata, unsigned numMetadata,
+      unsigned channels, unsigned bitsPerSample,
+      wxFFile &file, const wxFileNameWrapper &fileName);
+   //! Waits for encoding in progress, but does not complete the file
+   ~ParallelFLACEncoder();
+
+   //! Encoding happens as whole batches of chunks fill up
+   void Process(const FLAC__int32 *const buffers[], size_t samples);
+
+   //! Encode and write what remains, then complete the STREAMINFO block
+   void Finish();
+
+private:
+   struct Chunk
+   {
+      std::vector<std::vector<FLAC__int32>> samples;
+      size_t length{};
+      //! Number of the first frame in the whole stream
+      uint64_t firstFrame{};
+      std::vector<FLAC__byte> encoded;
+      size_t minFrameBytes{};
+      size_t maxFrameBytes{};
+   };
+   class ChunkEncoder;
+
+   Chunk NewChunk(uint64_t firstFrame) const;
+   void EncodeChunk(Chunk &chunk) const;
+   //! Start encoding the full chunks on another thread, after writing out
+   //! the previous batch
+   void Dispatch();
+   //! Wait for the batch being encoded and write it to the file
+   void WriteBatch();
+   void Write(const void *buffer, size_t bytes);
+
+   const Configure mConfigure;
+   const unsigned mChannels;
+   const unsigned mBytesPerSample;
+   wxFFile &mFile;
+   const wxFileNameWrapper mFileName;
+
+   unsigned mBlockSize{};
+   size_t mChunkSize{};
+   size_t mBatchSize{};
+
+   Chunk mFilling;
+   std::vector<Chunk> mFull;
+   std::vector<Chunk> mEncoding;
+   std::thread mEncodingThread;
+   std::exception_ptr mEncodingException;
+
+   crypto::MD5 mMD5;
+   std::vector<FLAC__byte> mMD5Buffer;
+   uint64_t mTotalSamples{};
+   size_t mMinFrameBytes{ SIZE_MAX };
+   size_t mMaxFrameBytes{};
+   //! Position of the STREAMINFO block in the file
+   wxFileOffset mStreamInfoOffset{};
+};
@@ -0,0 +1,194 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ParallelFLACEncoderTests.cpp
+
+**********************************************************************/
+#include "../ParallelFLACEncoder.h"
+
+#include "Parallel.h"
+#include "crypto/MD5.h"
+
+#include "FLAC++/decoder.h"
+#include <catch2/catch.hpp>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+constexpr unsigned sampleRate = 44100;
+// Small blocks, so that a stream of a few chunks per batch stays short
+constexpr unsigned blockSize = 1024;
+
+using Channels = std::vector<std::vector<FLAC__int32>>;
+
+Channels MakeSamples(unsigned channels, unsigned bitsPerSample, size_t length)
+{
+   std::mt19937 generator { 42 };
+   std::uniform_int_distribution<FLAC__int32> noise { -64, 64 };
+   const auto amplitude = (1 << (bitsPerSample - 2));
+   Channels result(channels, std::vector<FLAC__int32>(length));
+   for (unsigned channel = 0; channel < channels; ++channel)
+      for (size_t ii = 0; ii < length; ++ii)
+         result[channel][ii] =
+            static_cast<FLAC__int32>(
+               amplitude * std::sin(0.01 * (channel + 1) * ii)) +
+            noise(generator);
+   return result;
+}
+
+//! MD5 of the interleaved samples, little-endian in whole bytes, as FLAC
+//! defines it
+crypto::MD5::Digest
+ComputeMD5(const Channels& samples, unsigned bitsPerSample)
+{
+   const auto bytesPerSample = (bitsPerSample + 7) / 8;
+   crypto::MD5 md5;
+   std::vector<FLAC__byte> bytes;
+   for (size_t ii = 0; ii < samples[0].size(); ++ii)
+      for (const auto& channel : samples)
+         for (unsigned byte = 0; byte < bytesPerSample; ++byte)
+            bytes.push_back((channel[ii] >> (8 * byte)) & 0xFF);
+   md5.Update(bytes.data(), bytes.size());
+   return md5.FinalizeDigest();
+}
+
+void Encode(const wxString& path, const Channels& samples,
+   unsigned bitsPerSample, size_t bufferSize)
+{
+   const auto channels = static_cast<unsigned>(samples.size());
+   wxFFile file;
+   REQUIRE(file.Open(path, wxT("w+b")));
+   {
+      ParallelFLACEncoder encoder {
+         [&](FLAC::Encoder::Stream& stream) {
+            return stream.set_channels(channels) &&
+                   stream.set_sample_rate(sampleRate) &&
+                   stream.set_bits_per_sample(bitsPerSample) &&
+                   stream.set_blocksize(blockSize);
+         },
+         nullptr, 0, channels, bitsPerSample, file,
+         wxFileNameWrapper { path }
+      };
+      std::vector<const FLAC__int32*> buffers(channels);
+      const auto length = samples[0].size();
+      for (size_t done = 0; done < length; done += bufferSize)
+      {
+         for (unsigned channel = 0; channel < channels; ++channel)
+            buffers[channel] = samples[channel].data() + done;
+         encoder.Process(buffers.data(), std::min(bufferSize, length - done));
+      }
+      encoder.Finish();
+   }
+   file.Close();
+}
+
+//! Decodes a whole file with libFLAC, which checks the CRC of every frame
+//! and, when finishing, the MD5 in STREAMINFO
+class Decoder final : public FLAC::Decoder::File
+{
+public:
+   FLAC__StreamMetadata_StreamInfo streamInfo {};
+   Channels samples;
+   //! Whether each frame's number agreed with the samples decoded before it
+   bool numberedInOrder { true };
+   bool error { false };
+
+protected:
+   FLAC__StreamDecoderWriteStatus write_callback(
+      const FLAC__Frame* frame, const FLAC__int32* const buffer[]) override
+   {
+      const auto& header = frame->header;
+      samples.resize(header.channels);
+      if (header.number_type != FLAC__FRAME_NUMBER_TYPE_SAMPLE_NUMBER ||
+          header.number.sample_number != samples[0].size())
+         numberedInOrder = false;
+      for (unsigned channel = 0; channel < header.channels; ++channel)
+         samples[channel].insert(samples[channel].end(), buffer[channel],
+            buffer[channel] + header.blocksize);
+      return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+   }
+
+   void metadata_callback(const FLAC__StreamMetadata* metadata) override
+   {
+      if (metadata->type == FLAC__METADATA_TYPE_STREAMINFO)
+         streamInfo = metadata->data.stream_info;
+   }
+
+   void error_callback(FLAC__StreamDecoderErrorStatus) override
+   {
+      error = true;
+   }
+};
+} // namespace
+
+TEST_CASE("ParallelFLACEncoder stitches chunks into one valid stream")
+{
+   // Several batches of chunks, the last one partial, ending mid-block
+   constexpr auto batchSize = 3;
+   Parallel::SetMaxConcurrency(batchSize);
+   constexpr size_t chunkSize = 32 * blockSize;
+   constexpr size_t length = (3 * batchSize + 1) * chunkSize + 1000;
+   // Buffers of the export straddle the chunks and the blocks
+   constexpr size_t bufferSize = 4099;
+
+   const auto path = wxFileName::CreateTempFileName(wxT("flac"));
+   for (const auto bitsPerSample : { 16u, 24u })
+   {
+      for (const auto channels : { 1u, 2u })
+      {
+         const auto samples = MakeSamples(channels, bitsPerSample, length);
+         Encode(path, samples, bitsPerSample, bufferSize);
+
+         Decoder decoder;
+         REQUIRE(decoder.set_md5_checking(true));
+         REQUIRE(
+            decoder.init(path.ToStdString()) ==
+            FLAC__STREAM_DECODER_INIT_STATUS_OK);
+         REQUIRE(decoder.process_until_end_of_stream());
+         // False if the MD5 of the decoded samples differs from STREAMINFO
+         REQUIRE(decoder.finish());
+         REQUIRE(!decoder.error);
+
+         const auto& streamInfo = decoder.streamInfo;
+         REQUIRE(streamInfo.total_samples == length);
+         REQUIRE(streamInfo.channels == channels);
+         REQUIRE(streamInfo.bits_per_sample == bitsPerSample);
+         REQUIRE(streamInfo.min_blocksize == blockSize);
+         REQUIRE(streamInfo.max_blocksize == blockSize);
+         REQUIRE(streamInfo.min_framesize > 0);
+         REQUIRE(streamInfo.min_framesize <= streamInfo.max_framesize);
+         const auto md5 = ComputeMD5(samples, bitsPerSample);
+         REQUIRE(std::equal(md5.begin(), md5.end(), streamInfo.md5sum));
+
+         REQUIRE(decoder.numberedInOrder);
+         REQUIRE(decoder.samples == samples);
+      }
+   }
+   wxRemoveFile(path);
+   Parallel::SetMaxConcurrency(0);
+}
+
+TEST_CASE("ParallelFLACEncoder writes a valid stream of no samples")
+{
+   const auto path = wxFileName::CreateTempFileName(wxT("flac"));
+   Encode(path, Channels(2), 16, 4096);
+
+   Decoder decoder;
+   REQUIRE(decoder.set_md5_checking(true));
+   REQUIRE(
+      decoder.init(path.ToStdString()) == FLAC__STREAM_DECODER_INIT_STATUS_OK);
+   REQUIRE(decoder.process_until_end_of_stream());
+   REQUIRE(decoder.finish());
+   REQUIRE(!decoder.error);
+   REQUIRE(decoder.streamInfo.total_samples == 0);
+   REQUIRE(decoder.samples.empty());
+   wxRemoveFile(path);
+}
@@ -45,6 +45,7 @@
 #include "Track.h"
 
 #include "ExportPluginHelpers.h"
+#include "PipelinedMixer.h"
 #include "PlainExportOptionsEditor.h"
 
 #define LIBTWOLAME_STATIC
@@ -252,7 +253,7 @@ class MP2ExportProcessor final : public ExportProcessor
       double t0;
       double t1;
       wxFileNameWrapper fName;
-      std::unique_ptr<Mixer> mixer;
+      std::unique_ptr<PipelinedMixer> mixer;
       ArrayOf<char> id3buffer;
       int id3len;
       twolame_options* encodeOptions{};
@@ -96,6 +96,7 @@
 
 #include "ExportOptionsEditor.h"
 #include "ExportPluginHelpers.h"
+#include "PipelinedMixer.h"
 #include "ExportPluginRegistry.h"
 #include "SelectFile.h"
 #include "ShuttleGui.h"
@@ -1605,7 +1606,7 @@ class MP3ExportProcessor final : public ExportProcessor
       wxFileOffset infoTagPos;
       size_t bufferSize;
       int inSamples;
-      std::unique_ptr<Mixer> mixer;
+      std::unique_ptr<PipelinedMixer> mixer;
    } context;
 
 public:
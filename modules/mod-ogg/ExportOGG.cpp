@@ -20,6 +20,7 @@
 
 #include "wxFileNameWrapper.h"
 #include "ExportPluginHelpers.h"
+#include "PipelinedMixer.h"
 #include "ExportPluginRegistry.h"
 #include "FileIO.h"
 #include "Mix.h"
@@ -107,7 +108,7 @@ class OGGExportProcessor final : public ExportProcessor
       double t0;
       double t1;
       unsigned numChannels;
-      std::unique_ptr<Mixer> mixer;
+      std::unique_ptr<PipelinedMixer> mixer;
       std::unique_ptr<FileIO> outFile;
       wxFileNameWrapper fName;
 
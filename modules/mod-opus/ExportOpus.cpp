@@ -26,12 +26,14 @@
 #include "Tags.h"
 
 #include "ExportPluginHelpers.h"
+#include "PipelinedMixer.h"
 #include "ExportOptionsEditor.h"
 #include "ExportPluginRegistry.h"
 
 #include "PlainExportOptionsEditor.h"
 
 #include "CodeConversions.h"
+#include "Parallel.h"
 
 
 namespace
@@ -95,7 +97,8 @@ enum : int
    OPUSOptionIDFrameDuration,
    OPUSOptionIDVBRMode,
    OPUSOptionIDApplication,
-   OPUSOptionIDCutoff
+   OPUSOptionIDCutoff,
+   OPUSOptionIDParallel
 };
 
 namespace VBRMode
@@ -224,6 +227,12 @@ const std::initializer_list<PlainExportOptionsEditor::OptionDesc> OPUSOptions {
          }
       }, wxT("/FileFormats/OPUS/Cutoff")
    },
+   {
+      {
+         OPUSOptionIDParallel, XO("Encode on several threads"),
+         false
+      }, wxT("/FileFormats/OPUS/Parallel")
+   },
 };
 
 constexpr int supportedSampleRates[] = { 8000, 12000, 16000, 24000, 48000 };
@@ -235,6 +244,16 @@ bool IsValidSampleRate(int sampleRate) noexcept
          return true;
    return false;
 }
+
+struct OpusEncoderDeleter final
+{
+   void operator()(OpusMSEncoder* encoder) const noexcept
+   {
+      opus_multistream_encoder_destroy(encoder);
+   }
+};
+
+using OpusEncoderHandle = std::unique_ptr<OpusMSEncoder, OpusEncoderDeleter>;
 }
 
 class OpusExportProcessor final : public ExportProcessor
@@ -357,7 +376,7 @@ class OpusExportProcessor final : public ExportProcessor
       unsigned numChannels {};
       wxFileNameWrapper fName;
       wxFile outFile;
-      std::unique_ptr<Mixer> mixer;
+      std::unique_ptr<PipelinedMixer> mixer;
       std::unique_ptr<Tags> metadata;
 
       // Encoder properties
@@ -371,6 +390,13 @@ class OpusExportProcessor final : public ExportProcessor
 
          OpusMSEncoder* encoder {};
 
+         // Settings, to create more encoders alike
+         int application {};
+         int bitRate {};
+         int vbrMode {};
+         int complexity {};
+         int cutoff {};
+
          int32_t frameSize {};
          int32_t sampleRateFactor {};
          uint16_t preskip {};
@@ -437,11 +463,35 @@ class OpusExportProcessor final : public ExportProcessor
       } ogg;
 
       std::vector<float> encodeBuffer;
+
+      // Full frames are encoded in chunks, each by its own encoder, which
+      // first encodes some frames before the chunk and discards the packets,
+      // so that its state is near to that of one encoder for the whole stream.
+      // The stream is not exactly the same as that of one encoder, so this is
+      // optional.
+      struct ParallelState final
+      {
+         bool enabled {};
+         int32_t chunkFrames {};
+         int32_t warmupFrames {};
+         //! Interleaved full frames
+         std::vector<float> input;
+         //! How many frames at the start of input were encoded already
+         int32_t encodedFrames {};
+      } parallel;
    } context;
 
    void WriteOpusHeader();
    void WriteTags();
 
+   //! @param fillLayout whether to store the stream layout, which is the same
+   //! for every encoder
+   OpusEncoderHandle CreateEncoder(bool fillLayout = false);
+   //! Encode the full frames that are waiting, in parallel
+   std::vector<std::vector<unsigned char>> EncodePending();
+   //! Prepare the main encoder to continue after the last chunk
+   void FinishParallel();
+
    int32_t GetBestFrameSize(int32_t samplesCount) const noexcept
    {
       static const int32_t multipliers[] = {
@@ -614,6 +664,79 @@ void OpusExportProcessor::WriteTags()
    context.ogg.Flush(context.outFile);
 }
 
+OpusEncoderHandle OpusExportProcessor::CreateEncoder(bool fillLayout)
+{
+   const auto numChannels = context.numChannels;
+   int error;
+   OpusEncoderHandle encoder;
+
+   if (numChannels <= 2)
+   {
+      encoder.reset(opus_multistream_encoder_create(
+         context.sampleRate, numChannels, context.opus.nbStreams,
+         context.opus.nbCoupled, context.opus.streamMap,
+         context.opus.application, &error));
+   }
+   else
+   {
+      int nbStreams {}, nbCoupled {};
+      uint8_t streamMap[255] {};
+
+      encoder.reset(opus_multistream_surround_encoder_create(
+         context.sampleRate, numChannels, context.opus.channelMapping,
+         &nbStreams, &nbCoupled, streamMap, context.opus.application, &error));
+
+      // opus_multistream_surround_encoder_create is expected to fill
+      // stream count with values in [0, 255]
+      if (fillLayout)
+      {
+         context.opus.nbStreams = uint8_t(nbStreams);
+         context.opus.nbCoupled = uint8_t(nbCoupled);
+         std::copy(std::begin(streamMap), std::end(streamMap),
+            context.opus.streamMap);
+      }
+   }
+
+   if (error != OPUS_OK)
+      FailExport(XO("Unable to create Opus encoder"), error);
+
+   error = opus_multistream_encoder_ctl(
+      encoder.get(), OPUS_SET_BITRATE(context.opus.bitRate));
+
+   if (error != OPUS_OK)
+      FailExport(XO("Unable to set bitrate"), error);
+
+   error = opus_multistream_encoder_ctl(
+      encoder.get(), OPUS_SET_COMPLEXITY(context.opus.complexity));
+
+   if (error != OPUS_OK)
+      FailExport(XO("Unable to set complexity"), error);
+
+   error = opus_multistream_encoder_ctl(
+      encoder.get(), OPUS_SET_BANDWIDTH(context.opus.cutoff));
+
+   if (error != OPUS_OK)
+      FailExport(XO("Unable to set bandwidth"), error);
+
+   error = opus_multistream_encoder_ctl(
+      encoder.get(),
+      OPUS_SET_VBR(context.opus.vbrMode == VBRMode::CBR ? 0 : 1));
+
+   if (error != OPUS_OK)
+      FailExport(XO("Unable to set VBR mode"), error);
+
+   if (context.opus.vbrMode == VBRMode::CVBR)
+   {
+      error = opus_multistream_encoder_ctl(
+         encoder.get(), OPUS_SET_VBR_CONSTRAINT(1));
+
+      if (error != OPUS_OK)
+         FailExport(XO("Unable to set CVBR mode"), error);
+   }
+
+   return encoder;
+}
+
 OpusExportProcessor::~OpusExportProcessor()
 {
 
@@ -658,8 +781,11 @@ bool OpusExportProcessor::Initialize(
    context.status = selectionOnly ? XO("Exporting selected audio as Opus") :
                                     XO("Exporting the audio as Opus");
 
-   // Create opus encoder
-   int error;
+   context.opus.application = application;
+   context.opus.bitRate = bitRate;
+   context.opus.vbrMode = vbrMode;
+   context.opus.complexity = complexity;
+   context.opus.cutoff = cutoff;
 
    if (numChannels <= 2)
    {
@@ -668,63 +794,14 @@ bool OpusExportProcessor::Initialize(
       context.opus.nbCoupled = numChannels - 1;
       context.opus.streamMap[0] = 0;
       context.opus.streamMap[1] = 1;
-
-      context.opus.encoder = opus_multistream_encoder_create(
-         sampleRate, numChannels, context.opus.nbStreams,
-         context.opus.nbCoupled, context.opus.streamMap, application, &error);
    }
    else
-   {
       context.opus.channelMapping = numChannels <= 8 ? 1 : 255;
 
-      int nbStreams {}, nbCoupled {};
-
-      context.opus.encoder = opus_multistream_surround_encoder_create(
-         sampleRate, numChannels, context.opus.channelMapping,
-         &nbStreams, &nbCoupled,
-         context.opus.streamMap, application, &error);
-
-      // opus_multistream_surround_encoder_create is expected to fill
-      // stream count with values in [0, 255]
-      context.opus.nbStreams = uint8_t(nbStreams);
-      context.opus.nbCoupled = uint8_t(nbCoupled);
-   }
-
-   if (error != OPUS_OK)
-      FailExport(XO("Unable to create Opus encoder"), error);
-
-   error = opus_multistream_encoder_ctl(
-      context.opus.encoder, OPUS_SET_BITRATE(bitRate));
-
-   if (error != OPUS_OK)
-      FailExport(XO("Unable to set bitrate"), error);
-
-   error = opus_multistream_encoder_ctl(
-      context.opus.encoder, OPUS_SET_COMPLEXITY(complexity));
-
-   if (error != OPUS_OK)
-      FailExport(XO("Unable to set complexity"), error);
-
-   error = opus_multistream_encoder_ctl(
-      context.opus.encoder, OPUS_SET_BANDWIDTH(cutoff));
-
-   if (error != OPUS_OK)
-      FailExport(XO("Unable to set bandwidth"), error);
-
-   error = opus_multistream_encoder_ctl(
-      context.opus.encoder, OPUS_SET_VBR(vbrMode == VBRMode::CBR ? 0 : 1));
-
-   if (error != OPUS_OK)
-      FailExport(XO("Unable to set VBR mode"), error);
-
-   if (vbrMode == VBRMode::CVBR)
-   {
-      error = opus_multistream_encoder_ctl(
-         context.opus.encoder, OPUS_SET_VBR_CONSTRAINT(1));
+   // Create opus encoder
+   context.opus.encoder = CreateEncoder(true).release();
 
-      if (error != OPUS_OK)
-         FailExport(XO("Unable to set CVBR mode"), error);
-   }
+   int error;
 
    // Calculate the encoder latency. This value is needed in header
    // and to flush the encoder
@@ -766,6 +843,15 @@ bool OpusExportProcessor::Initialize(
 
    WriteTags();
 
+   context.parallel.enabled = ExportPluginHelpers::GetParameterValue<bool>(
+      parameters, OPUSOptionIDParallel, false);
+   // Chunks of about two seconds, each encoder warmed up with at least 100 ms
+   context.parallel.chunkFrames =
+      std::max(1, 2 * context.sampleRate / context.opus.frameSize);
+   context.parallel.warmupFrames = std::max(1,
+      (context.sampleRate / 10 + context.opus.frameSize - 1) /
+         context.opus.frameSize);
+
    const auto& tracks = TrackList::Get(project);
 
    context.mixer = ExportPluginHelpers::CreateMixer(
@@ -775,6 +861,85 @@ bool OpusExportProcessor::Initialize(
    return true;
 }
 
+std::vector<std::vector<unsigned char>> OpusExportProcessor::EncodePending()
+{
+   auto& parallel = context.parallel;
+   const auto frameSize = context.opus.frameSize;
+   const size_t frameLength = frameSize * context.numChannels;
+   const int32_t totalFrames = parallel.input.size() / frameLength;
+   const auto firstFrame = parallel.encodedFrames;
+   const auto nChunks =
+      (totalFrames - firstFrame + parallel.chunkFrames - 1) /
+      parallel.chunkFrames;
+
+   const auto chunks = Parallel::Transform<
+      std::vector<std::vector<unsigned char>>>(nChunks, [&](size_t ii)
+   {
+      const int32_t begin = firstFrame + ii * parallel.chunkFrames;
+      const int32_t end = std::min(begin + parallel.chunkFrames, totalFrames);
+      // The packets of frames before the chunk are discarded; the first
+      // chunk of the stream has none
+      const int32_t warmupBegin = std::max(0, begin - parallel.warmupFrames);
+
+      const auto encoder = CreateEncoder();
+      std::vector<unsigned char> buffer(
+         context.ogg.audioStreamPacket.GetBufferSize());
+      std::vector<std::vector<unsigned char>> packets;
+      packets.reserve(end - begin);
+
+      for (auto frame = warmupBegin; frame < end; ++frame)
+      {
+         auto result = opus_multistream_encode_float(
+            encoder.get(), parallel.input.data() + frame * frameLength,
+            frameSize, buffer.data(), buffer.size());
+
+         if (result < 0)
+            FailExport(XO("Failed to encode input buffer"), result);
+
+         if (frame >= begin)
+            packets.emplace_back(buffer.data(), buffer.data() + result);
+      }
+      return packets;
+   });
+
+   // Keep the last frames to warm up the next encoder
+   const auto kept = std::min(parallel.warmupFrames, totalFrames);
+   parallel.input.erase(parallel.input.begin(),
+      parallel.input.begin() + (totalFrames - kept) * frameLength);
+   parallel.encodedFrames = kept;
+
+   std::vector<std::vector<unsigned char>> packets;
+   for (auto& chunk : chunks)
+      for (auto& packet : chunk)
+         packets.push_back(std::move(packet));
+   return packets;
+}
+
+void OpusExportProcessor::FinishParallel()
+{
+   auto& parallel = context.parallel;
+   const auto frameSize = context.opus.frameSize;
+   const size_t frameLength = frameSize * context.numChannels;
+   const int32_t totalFrames = parallel.input.size() / frameLength;
+   // The main encoder has encoded nothing yet
+   assert(parallel.encodedFrames == totalFrames);
+
+   auto& buffer = context.ogg.audioStreamPacket;
+   for (int32_t frame = 0; frame < totalFrames; ++frame)
+   {
+      auto result = opus_multistream_encode_float(
+         context.opus.encoder, parallel.input.data() + frame * frameLength,
+         frameSize, buffer.GetBuffer(), buffer.GetBufferSize());
+
+      if (result < 0)
+         FailExport(XO("Failed to encode input buffer"), result);
+   }
+
+   parallel.enabled = false;
+   parallel.input = {};
+   parallel.encodedFrames = 0;
+}
+
 ExportResult OpusExportProcessor::Process(ExportProcessorDelegate& delegate)
 {
    delegate.SetStatusString(context.status);
@@ -785,6 +950,30 @@ ExportResult OpusExportProcessor::Process(ExportProcessorDelegate& delegate)
 
    int32_t latencyLeft = context.opus.preskip;
 
+   // Write packets of full frames, encoded in parallel
+   const auto writePackets =
+      [&](const std::vector<std::vector<unsigned char>>& packets)
+   {
+      auto& audioPacket = context.ogg.audioStreamPacket;
+      for (const auto& packet : packets)
+      {
+         std::copy(packet.begin(), packet.end(), audioPacket.GetBuffer());
+
+         granulePos += context.opus.frameSize * context.opus.sampleRateFactor;
+
+         audioPacket.packet.bytes = packet.size();
+         audioPacket.packet.granulepos = granulePos;
+
+         if (latencyLeft == 0)
+            audioPacket.MarkEOS();
+
+         context.ogg.PacketIn(audioPacket);
+         context.ogg.WriteOut(context.outFile);
+
+         audioPacket.packet.packetno++;
+      }
+   };
+
    while (exportResult == ExportResult::Success)
    {
       auto samplesThisRun = context.mixer->Process();
@@ -795,6 +984,32 @@ ExportResult OpusExportProcessor::Process(ExportProcessorDelegate& delegate)
       auto mixedAudioBuffer =
          reinterpret_cast<const float*>(context.mixer->GetBuffer());
 
+      if (context.parallel.enabled)
+      {
+         auto& parallel = context.parallel;
+         if (samplesThisRun == size_t(context.opus.frameSize))
+         {
+            parallel.input.insert(parallel.input.end(), mixedAudioBuffer,
+               mixedAudioBuffer + samplesThisRun * context.numChannels);
+
+            const auto pendingFrames =
+               parallel.input.size() /
+                  (context.opus.frameSize * context.numChannels) -
+               parallel.encodedFrames;
+            if (pendingFrames >=
+                parallel.chunkFrames * Parallel::DefaultConcurrency())
+               writePackets(EncodePending());
+
+            exportResult = ExportPluginHelpers::UpdateProgress(
+               delegate, *context.mixer, context.t0, context.t1);
+            continue;
+         }
+
+         // The last, short frame is encoded by the main encoder
+         writePackets(EncodePending());
+         FinishParallel();
+      }
+
       // bestFrameSize <= context.opus.frameSize by design
       auto bestFrameSize = GetBestFrameSize(samplesThisRun);
 
@@ -852,6 +1067,12 @@ ExportResult OpusExportProcessor::Process(ExportProcessorDelegate& delegate)
          delegate, *context.mixer, context.t0, context.t1);
    }
 
+   if (context.parallel.enabled)
+   {
+      writePackets(EncodePending());
+      FinishParallel();
+   }
+
    // Flush the encoder
 
    while (latencyLeft > 0)
@@ -28,6 +28,7 @@
 #include "ExportOptionsEditor.h"
 
 #include "ExportPluginHelpers.h"
+#include "PipelinedMixer.h"
 #include "ExportPluginRegistry.h"
 
 #ifdef USE_LIBID3TAG
@@ -384,7 +385,7 @@ class PCMExportProcessor final : public ExportProcessor
       int subformat;
       double t0;
       double t1;
-      std::unique_ptr<Mixer> mixer;
+      std::unique_ptr<PipelinedMixer> mixer;
       TranslatableString status;
       SF_INFO info;
       sampleFormat format;
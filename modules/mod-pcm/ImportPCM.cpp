@@ -38,9 +38,15 @@
 #include "ImportPlugin.h"
 #include "ImportProgressListener.h"
 #include "ImportUtils.h"
+#include "MappedPCM.h"
+#include "MemoryMappedFile.h"
+#include "Parallel.h"
 #include "WaveTrack.h"
 
 #include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 #ifdef USE_LIBID3TAG
    #include <id3tag.h>
@@ -97,7 +103,18 @@ public:
    void SetStreamUsage(wxInt32 WXUNUSED(StreamID), bool WXUNUSED(Use)) override
    {}
 
+   bool SupportsConcurrentImport() const override { return true; }
+
 private:
+   //! Read the sound data straight out of a mapping of the file, when it is
+   //! uncompressed and in a container that MappedPCM understands
+   /*!
+    @return whether the file was suitable; if not, nothing was appended and
+    the caller should read through libsndfile instead
+    */
+   bool ImportMapped(ImportProgressListener& progressListener,
+      TrackList &trackList, size_t maxBlockSize);
+
    SFFile                mFile;
    const SF_INFO         mInfo;
    sampleFormat          mEffectiveFormat;
@@ -271,6 +288,88 @@ auto PCMImportFileHandle::GetFileUncompressedBytes() -> ByteCount
    return mInfo.frames * mInfo.channels * SAMPLE_SIZE(mFormat);
 }
 
+bool PCMImportFileHandle::ImportMapped(
+   ImportProgressListener& progressListener,
+   TrackList &trackList, size_t maxBlockSize)
+{
+   if (mInfo.channels < 1 || mInfo.frames <= 0)
+      return false;
+
+   MemoryMappedFile file{ GetFilename() };
+   const auto region = MappedPCM::FindSoundData(file.Data(), file.Size(),
+      mInfo.format, mInfo.channels, mInfo.frames);
+   if (!region)
+      return false;
+
+   std::vector<WaveChannel*> channels;
+   ImportUtils::ForEachChannel(trackList, [&](auto& channel)
+   {
+      channels.push_back(&channel);
+   });
+
+   // Convert each channel a block at a time into its own buffer, so that
+   // appending copies whole blocks; channels proceed in parallel through the
+   // whole file
+   const auto format =
+      (mFormat == int16Sample && region->encoding == MappedPCM::Encoding::Int16)
+         ? int16Sample : floatSample;
+   std::vector<SampleBuffer> buffers;
+   for (size_t ii = 0; ii < channels.size(); ++ii)
+      if (!buffers.emplace_back(maxBlockSize, format).ptr())
+         return false;
+
+   // When the user stops, every channel ends where the furthest one got, so
+   // that the channels keep the same length
+   std::mutex mutex;
+   size_t limit = region->frames;
+   size_t furthest = 0;
+   std::atomic<size_t> framesCompleted{ 0 };
+   const auto totalFrames = region->frames * channels.size();
+
+   // Only the calling thread reports progress, every few blocks
+   constexpr size_t blocksPerReport = 16;
+   const auto callingThread = std::this_thread::get_id();
+
+   Parallel::For(channels.size(), [&](size_t iChannel) {
+      const auto buffer = buffers[iChannel].ptr();
+      const bool reporting = std::this_thread::get_id() == callingThread;
+      size_t blocksSinceReport = 0;
+      for (size_t done = 0;;) {
+         size_t end;
+         {
+            std::lock_guard<std::mutex> lock{ mutex };
+            if (done >= limit)
+               break;
+            end = std::min(done + maxBlockSize, region->frames);
+            furthest = std::max(furthest, end);
+         }
+         const auto block = end - done;
+         MappedPCM::Deinterleave(*region, iChannel, done, block, buffer,
+            format);
+         channels[iChannel]->AppendBuffer(
+            buffer, format, block, 1, mEffectiveFormat);
+         done = end;
+         framesCompleted.fetch_add(block, std::memory_order_relaxed);
+
+         if (reporting && ++blocksSinceReport == blocksPerReport) {
+            blocksSinceReport = 0;
+            progressListener.OnImportProgress(
+               static_cast<double>(
+                  framesCompleted.load(std::memory_order_relaxed)) /
+               totalFrames);
+            if (IsCancelled() || IsStopped()) {
+               std::lock_guard<std::mutex> lock{ mutex };
+               limit = furthest;
+            }
+         }
+      }
+   });
+   progressListener.OnImportProgress(
+      static_cast<double>(framesCompleted.load(std::memory_order_relaxed)) /
+      totalFrames);
+   return true;
+}
+
 #ifdef USE_LIBID3TAG
 struct id3_tag_deleter {
    void operator () (id3_tag *p) const { if (p) id3_tag_delete(p); }
@@ -289,16 +388,16 @@ void PCMImportFileHandle::Import(
 
    wxASSERT(mFile.get());
 
-   auto trackList = ImportUtils::NewWaveTrack(
-      *trackFactory,
-      mInfo.channels,
-      mFormat,
-      mInfo.samplerate);
+   // The format was chosen when opening, so that importing reads no
+   // preferences
+   auto trackList =
+      trackFactory->Create(mInfo.channels, mFormat, mInfo.samplerate);
 
    auto fileTotalFrames =
       (sampleCount)mInfo.frames; // convert from sf_count_t
    auto maxBlockSize = (*trackList->Any<WaveTrack>().begin())->GetMaxBlockSize();
 
+   if (!ImportMapped(progressListener, *trackList, maxBlockSize))
    {
       // Otherwise, we're in the "copy" mode, where we read in the actual
       // samples from the file and store our own local copy of the
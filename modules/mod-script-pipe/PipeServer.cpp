@@ -1,3 +1,92 @@
+// Besides text commands, one to a line, the pipe accepts batches of commands
+// in a binary framing: the byte BatchMarker, a count of commands, then each
+// command as a length and that many bytes of UTF-8.  Counts and lengths are
+// four bytes, little endian.  All commands of a batch go to Audacity in one
+// round trip, and the responses come back in the same framing, a length then
+// the bytes for each command in order, without the marker and count.
+
+#include <cstdint>
+#include <string>
+
+extern "C" int DoSrvBatch( char * pIn );
+extern "C" const char * DoSrvBatchResponse( size_t i, size_t * pLen );
+
+namespace {
+
+const int BatchMarker = 0x01;
+
+// Limits on the total size of the commands of one batch, counting the line
+// break after each, and on their number
+const uint32_t MaxBatchBytes = 64 << 20;
+const uint32_t MaxBatchCommands = 1 << 20;
+
+uint32_t ReadLength( const unsigned char * bytes )
+{
+   return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) |
+      (static_cast<uint32_t>(bytes[3]) << 24);
+}
+
+// Read the rest of a batch after its marker, with read(buffer, size), which
+// reads exactly size bytes or returns false.  The commands are returned one
+// to a line.  Returns the number of commands, or -1 for failure.
+template< typename Read > long ReadBatch( Read &&read, std::string &commands )
+{
+   unsigned char bytes[4];
+   if (!read(bytes, 4))
+      return -1;
+   const uint32_t count = ReadLength(bytes);
+   if (count > MaxBatchCommands)
+      return -1;
+   commands.clear();
+   for (uint32_t ii = 0; ii < count; ++ii)
+   {
+      if (!read(bytes, 4))
+         return -1;
+      const uint32_t length = ReadLength(bytes);
+      // In 64 bits, so that no sum of 32 bit lengths wraps
+      if (uint64_t{ commands.size() } + length + 1 > MaxBatchBytes)
+         return -1;
+      const size_t start = commands.size();
+      commands.resize(start + length);
+      if (length > 0 && !read(&commands[start], length))
+         return -1;
+      // A line break would split the command
+      for (size_t jj = start; jj < commands.size(); ++jj)
+         if (commands[jj] == '\r' || commands[jj] == '\n')
+            commands[jj] = ' ';
+      if (ii + 1 < count)
+         commands += '\n';
+   }
+   return static_cast<long>(count);
+}
+
+// Send the commands of a batch, and write the framed responses, each with
+// write(buffer, size), which returns false for failure
+template< typename Write >
+bool ServeBatch( std::string &commands, long count, Write &&write )
+{
+   if (count == 0)
+      return true;
+   DoSrvBatch(&commands[0]);
+   std::string frame;
+   for (long ii = 0; ii < count; ++ii)
+   {
+      // If Audacity gave fewer responses than commands, such as when there is
+      // no project, the rest are empty, so that the client does not hang
+      size_t length = 0;
+      const char *response = DoSrvBatchResponse(ii, &length);
+      frame.resize(4);
+      for (int jj = 0; jj < 4; ++jj)
+         frame[jj] = static_cast<char>((length >> (8 * jj)) & 0xff);
+      frame.append(response, length);
+      if (!write(frame.data(), frame.size()))
+         return false;
+   }
+   return true;
+}
+
+}
+
 #if defined(WIN32)
 
 #define WIN32_LEAN_AND_MEAN  // Exclude rarely-used stuff from Windows headers
@@ -70,12 +159,51 @@ void PipeServer()
          for(;;)
          {
             printf( "About to read\n" );
-            bSuccess = ReadFile( hPipeToSrv, chRequest, nBuff, &cbBytesRead, NULL);
+            bSuccess = ReadFile( hPipeToSrv, chRequest, nBuff - 1, &cbBytesRead, NULL);
+
+            // A batch may be longer than the buffer
+            if( (!bSuccess && GetLastError() != ERROR_MORE_DATA) || cbBytesRead==0 )
+               break;
 
             chRequest[ cbBytesRead] = '\0'; 
 
-            if( !bSuccess || cbBytesRead==0 )
-               break;
+            if( chRequest[0] == BatchMarker )
+            {
+               // Take what is left of the first read, then read on
+               DWORD consumed = 1;
+               auto read = [&]( void * buffer, size_t size )
+               {
+                  char *dest = static_cast<char*>( buffer );
+                  while( size > 0 && consumed < cbBytesRead )
+                  {
+                     *dest++ = chRequest[ consumed++ ];
+                     --size;
+                  }
+                  while( size > 0 )
+                  {
+                     DWORD cbRead = 0;
+                     if( !ReadFile( hPipeToSrv, dest, static_cast<DWORD>( size ), &cbRead, NULL) &&
+                         GetLastError() != ERROR_MORE_DATA )
+                        return false;
+                     if( cbRead == 0 )
+                        return false;
+                     dest += cbRead;
+                     size -= cbRead;
+                  }
+                  return true;
+               };
+               auto write = [&]( const char * buffer, size_t size )
+               {
+                  return WriteFile( hPipeFromSrv, buffer, static_cast<DWORD>( size ),
+                     &cbBytesWritten, NULL) != FALSE;
+               };
+               std::string commands;
+               const long count = ReadBatch( read, commands );
+               if( count < 0 || !ServeBatch( commands, count, write ) )
+                  break;
+               jj += count;
+               continue;
+            }
 
             printf( "Rxd %s\n", chRequest );
 
@@ -164,8 +292,27 @@ void PipeServer()
       return;
    }
 
-   while (fgets(buf, sizeof(buf), toFifo) != NULL)
+   int first;
+   std::string commands;
+   while ((first = fgetc(toFifo)) != EOF)
    {
+      if (first == BatchMarker)
+      {
+         auto read = [&](void *buffer, size_t size)
+            { return fread(buffer, 1, size, toFifo) == size; };
+         auto write = [&](const char *buffer, size_t size)
+            { return fwrite(buffer, 1, size, fromFifo) == size; };
+         const long count = ReadBatch(read, commands);
+         if (count < 0 || !ServeBatch(commands, count, write))
+            break;
+         fflush(fromFifo);
+         continue;
+      }
+
+      ungetc(first, toFifo);
+      if (fgets(buf, sizeof(buf), toFifo) == NULL)
+         break;
+
       int len = strlen(buf);
       if (len <= 1)
       {
@@ -24,6 +24,9 @@ See the example in this file.  It has several cases/options in it.
 
 #include "ModuleConstants.h"
 
+#include <string>
+#include <vector>
+
 extern void PipeServer();
 typedef DLL_IMPORT int (*tpExecScriptServerFunc)( wxString * pIn, wxString * pOut);
 static tpExecScriptServerFunc pScriptServerFn=NULL;
@@ -95,6 +98,62 @@ int DoSrv(char *pIn)
    return 1;
 }
 
+std::vector<std::string> batchResponses;
+
+// Send several commands, one to a line, to Audacity at once, and keep the
+// responses, which can be retrieved in order by calling DoSrvBatchResponse.
+// Returns the number of responses.
+int DoSrvBatch(char *pIn)
+{
+   wxString Str1(pIn, wxConvUTF8);
+   Str1.Replace( wxT("\r"), wxT(""));
+   wxString Str3;
+   (*pScriptServerFn)( &Str1 , &Str3);
+
+   batchResponses.clear();
+   auto addResponse = [](const wxString &response)
+   {
+      const wxCharBuffer utf8 = response.ToUTF8();
+      batchResponses.emplace_back(utf8.data(), utf8.length());
+   };
+   if (!Str1.Contains(wxT('\n')))
+   {
+      // One command, whose response is not framed
+      addResponse(Str3);
+      return 1;
+   }
+
+   // Each response is its length, SCRIPT_BATCH_LENGTH_END, and the response
+   size_t iStart = 0;
+   const size_t outputLength = Str3.length();
+   while (iStart < outputLength)
+   {
+      const size_t iEnd = Str3.find(SCRIPT_BATCH_LENGTH_END, iStart);
+      unsigned long long length = 0;
+      if (iEnd == wxString::npos ||
+          !Str3.Mid(iStart, iEnd - iStart).ToULongLong(&length) ||
+          length > outputLength - (iEnd + 1))
+         break;
+      addResponse(Str3.Mid(iEnd + 1, length));
+      iStart = iEnd + 1 + length;
+   }
+
+   return static_cast<int>(batchResponses.size());
+}
+
+// Get the UTF-8 bytes of one response prepared by DoSrvBatch; empty if there
+// is no such response.
+const char *DoSrvBatchResponse(size_t i, size_t *pLen)
+{
+   if (i >= batchResponses.size())
+   {
+      *pLen = 0;
+      return "";
+   }
+   *pLen = batchResponses[i].size();
+   return batchResponses[i].data();
+}
+
 size_t smin(size_t a, size_t b) { return a < b ? a : b; }
 
 // Write up to nMax characters of the prepared (by DoSrv) response lines.
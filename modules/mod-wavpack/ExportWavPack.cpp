@@ -26,6 +26,7 @@
 #include "Tags.h"
 
 #include "ExportPluginHelpers.h"
+#include "PipelinedMixer.h"
 #include "ExportOptionsEditor.h"
 #include "ExportPluginRegistry.h"
 
@@ -256,7 +257,7 @@ class WavPackExportProcessor final : public ExportProcessor
       sampleFormat format;
       WriteId outWvFile, outWvcFile;
       WavpackContext *wpc{};
-      std::unique_ptr<Mixer> mixer;
+      std::unique_ptr<PipelinedMixer> mixer;
       std::unique_ptr<Tags> metadata;
    } context;
 public:
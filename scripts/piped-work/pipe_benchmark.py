@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+"""Measures how many commands per second mod-script-pipe obeys.
+
+The same cheap command is sent many times, first one at a time as text,
+waiting for each response, then in batches in the binary framing:
+
+  request:  0x01, count, then for each command: length, UTF-8 bytes
+  response: for each command: length, UTF-8 bytes
+
+Counts and lengths are four bytes, little endian.
+
+Make sure Audacity is running first and that mod-script-pipe is enabled
+before running this script.
+
+Usage: python3 pipe_benchmark.py [commands] [batch size]
+"""
+
+import os
+import struct
+import sys
+import time
+
+
+if sys.platform == 'win32':
+    TONAME = '\\\\.\\pipe\\ToSrvPipe'
+    FROMNAME = '\\\\.\\pipe\\FromSrvPipe'
+    EOL = b'\r\n\0'
+else:
+    TONAME = '/tmp/audacity_script_pipe.to.' + str(os.getuid())
+    FROMNAME = '/tmp/audacity_script_pipe.from.' + str(os.getuid())
+    EOL = b'\n'
+
+COMMAND = 'Message: Text="benchmark"'
+BATCH_MARKER = b'\x01'
+
+for name in (TONAME, FROMNAME):
+    if not os.path.exists(name):
+        print(name + " does not exist.  "
+              "Ensure Audacity is running with mod-script-pipe.")
+        sys.exit(1)
+
+TOFILE = open(TONAME, 'wb', buffering=0)
+FROMFILE = open(FROMNAME, 'rb')
+
+
+def read_exactly(size):
+    """Read size bytes of the response."""
+    data = b''
+    while len(data) < size:
+        more = FROMFILE.read(size - len(data))
+        if not more:
+            raise EOFError('pipe closed')
+        data += more
+    return data
+
+
+def do_command(command):
+    """Send one text command, and return the response."""
+    TOFILE.write(command.encode('utf-8') + EOL)
+    result = b''
+    while True:
+        line = FROMFILE.readline()
+        if not line:
+            raise EOFError('pipe closed')
+        if line == b'\n' and result:
+            return result.decode('utf-8')
+        result += line
+
+
+def do_batch(commands):
+    """Send commands in one framed batch, and return their responses."""
+    frame = [BATCH_MARKER, struct.pack('<I', len(commands))]
+    for command in commands:
+        data = command.encode('utf-8')
+        frame += [struct.pack('<I', len(data)), data]
+    TOFILE.write(b''.join(frame))
+    responses = []
+    for _ in commands:
+        length, = struct.unpack('<I', read_exactly(4))
+        responses.append(read_exactly(length).decode('utf-8'))
+    return responses
+
+
+def main():
+    count = int(sys.argv[1]) if len(sys.argv) > 1 else 2000
+    batch_size = int(sys.argv[2]) if len(sys.argv) > 2 else 100
+
+    start = time.perf_counter()
+    for _ in range(count):
+        do_command(COMMAND)
+    text_rate = count / (time.perf_counter() - start)
+
+    start = time.perf_counter()
+    done = 0
+    while done < count:
+        size = min(batch_size, count - done)
+        responses = do_batch([COMMAND] * size)
+        if len(responses) != size:
+            print("Expected " + str(size) + " responses, got "
+                  + str(len(responses)))
+            sys.exit(1)
+        done += size
+    batch_rate = count / (time.perf_counter() - start)
+
+    print("One at a time:       %8.0f commands per second" % text_rate)
+    print("Batches of %-6d    %8.0f commands per second"
+          % (batch_size, batch_rate))
+    print("Last response: " + responses[-1].strip())
+
+
+main()
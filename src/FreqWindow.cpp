@@ -66,6 +66,7 @@ the mouse around.
 #include "CommonCommandFlags.h"
 #include "Decibels.h"
 #include "FFT.h"
+#include "MemoryX.h"
 #include "PitchName.h"
 #include "Prefs.h"
 #include "Project.h"
@@ -197,6 +198,7 @@ FrequencyPlotDialog::FrequencyPlotDialog(wxWindow * parent, wxWindowID id,
    mMouseX = 0;
    mMouseY = 0;
    mRate = 0;
+   mStart = 0;
    mDataLen = 0;
 
    gPrefs->Read(wxT("/FrequencyPlotDialog/DrawGrid"), &mDrawGrid, true);
@@ -559,11 +561,17 @@ bool FrequencyPlotDialog::Show(bool show)
    if (!show)
    {
       mFreqPlot->SetCursor(*mArrowCursor);
+      if (mCalculating)
+         // Closed during a calculation; stop it, without showing the results
+         mStopPending = true;
    }
 
    bool shown = IsShown();
 
-   if (show && !shown)
+   if (show && !shown && mCalculating)
+      // Hidden during a calculation; read the selection when it stops
+      mReplotPending = true;
+   else if (show && !shown)
    {
       dBRange = DecibelScaleCutoff.Read();
       if(dBRange < 90.)
@@ -583,85 +591,81 @@ bool FrequencyPlotDialog::Show(bool show)
 
 bool FrequencyPlotDialog::GetAudio()
 {
-   mData.reset();
+   mTracks.clear();
    mDataLen = 0;
 
-   int selcount = 0;
    bool warning = false;
    for (auto track :
       TrackList::Get(*mProject).Selected<const WaveTrack>()
    ) {
       auto &selectedRegion = ViewInfo::Get(*mProject).selectedRegion;
-      auto start = track->TimeToLongSamples(selectedRegion.t0());
-      if (selcount == 0) {
+      if (mTracks.empty()) {
          mRate = track->GetRate();
+         mStart = track->TimeToLongSamples(selectedRegion.t0());
          auto end = track->TimeToLongSamples(selectedRegion.t1());
-         auto dataLen = end - start;
-         // Permit approximately 46.60 minutes of selected samples at
-         // a sampling frequency of 48 kHz (11.65 minutes at 192 kHz).
-         auto maxDataLen = size_t(2) << 26;
+         auto dataLen = end - mStart;
+         // Permit approximately 24.8 hours of selected samples at
+         // a sampling frequency of 48 kHz (6.2 hours at 192 kHz).
+         // Samples are read as they are analyzed, not all at once.
+         const sampleCount maxDataLen{ 1LL << 32 };
          if (dataLen > maxDataLen) {
             warning = true;
             mDataLen = maxDataLen;
          }
          else
-            mDataLen = dataLen.as_size_t();
-         mData = Floats{ mDataLen };
+            mDataLen = dataLen;
       }
-      const auto nChannels = track->NChannels();
       if (track->GetRate() != mRate) {
          using namespace BasicUI;
          ShowMessageBox(
             XO("To plot the spectrum, all selected tracks must have the same sample rate."),
             MessageBoxOptions {}.Caption(XO("Error")).IconStyle(Icon::Error));
-         mData.reset();
+         mTracks.clear();
          mDataLen = 0;
          return false;
       }
-      Floats buffer1{ mDataLen };
-      Floats buffer2{ mDataLen };
-      float *const buffers[]{ buffer1.get(), buffer2.get() };
-      // Don't allow throw for bad reads
-      if (!track->GetFloats(
-             0, nChannels, buffers, start, mDataLen, false,
-             FillFormat::fillZero, false))
-      {
-         using namespace BasicUI;
-         ShowMessageBox(
-            XO("Audio could not be analyzed. This may be due to a stretched or pitch-shifted clip.\nTry resetting any stretched clips, or mixing and rendering the tracks before analyzing"),
-            MessageBoxOptions {}.Caption(XO("Error")).IconStyle(Icon::Error));
-         mData.reset();
-         mDataLen = 0;
-         return false;
-      }
-      size_t iChannel = 0;
-      if (selcount == 0) {
-         // First channel -- assign into mData
-         for (size_t i = 0; i < mDataLen; i++)
-            mData[i] = buffers[0][i];
-         ++iChannel;
-      }
-      // Later channels -- accumulate
-      for (; iChannel < nChannels; ++iChannel) {
-         const auto buffer = buffers[iChannel];
-         for (size_t i = 0; i < mDataLen; i++)
-            mData[i] += buffer[i];
-      }
-      ++selcount;
+      // Copy the track, sharing its sample blocks, so that later edits
+      // don't change what is analyzed
+      mTracks.push_back(track->Duplicate());
    }
 
-   if (selcount == 0)
+   if (mTracks.empty())
       return false;
 
    if (warning) {
       auto msg = XO(
 "Too much audio was selected. Only the first %.1f seconds of audio will be analyzed.")
-         .Format(mDataLen / mRate);
+         .Format(mDataLen.as_double() / mRate);
       AudacityMessageBox( msg );
    }
    return true;
 }
 
+bool FrequencyPlotDialog::ReadSamples(
+   float *buffer, sampleCount start, size_t len) const
+{
+   Floats buffer1{ len };
+   Floats buffer2{ len };
+   float *const buffers[]{ buffer1.get(), buffer2.get() };
+   std::fill(buffer, buffer + len, 0.0f);
+   for (const auto &pTracks : mTracks) {
+      const auto track = *pTracks->Any<const WaveTrack>().begin();
+      const auto nChannels = track->NChannels();
+      // Don't allow throw for bad reads
+      if (!track->GetFloats(
+             0, nChannels, buffers, mStart + start, len, false,
+             FillFormat::fillZero, false))
+         return false;
+      // Mix all channels
+      for (size_t iChannel = 0; iChannel < nChannels; ++iChannel) {
+         const auto channel = buffers[iChannel];
+         for (size_t i = 0; i < len; i++)
+            buffer[i] += channel[i];
+      }
+   }
+   return true;
+}
+
 void FrequencyPlotDialog::OnSize(wxSizeEvent & WXUNUSED(event))
 {
    Layout();
@@ -695,7 +699,8 @@ void FrequencyPlotDialog::DrawBackground(wxMemoryDC & dc)
 
 void FrequencyPlotDialog::DrawPlot()
 {
-   if (!mData || mDataLen < mWindowSize || mAnalyst->GetProcessedSize() == 0) {
+   if (mTracks.empty() || mDataLen < mWindowSize ||
+       mAnalyst->GetProcessedSize() == 0) {
       wxMemoryDC memDC;
 
       vRuler->ruler.SetUpdater(&LinearUpdater::Instance());
@@ -913,7 +918,7 @@ void FrequencyPlotDialog::PlotPaint(wxPaintEvent & event)
 
    dc.DrawBitmap( *mBitmap, 0, 0, true );
    // Fix for Bug 1226 "Plot Spectrum freezes... if insufficient samples selected"
-   if (!mData || mDataLen < mWindowSize)
+   if (mTracks.empty() || mDataLen < mWindowSize)
       return;
 
    dc.SetFont(mFreqFont);
@@ -1023,7 +1028,10 @@ void FrequencyPlotDialog::OnCloseButton(wxCommandEvent & WXUNUSED(event))
    gPrefs->Write(wxT("/FrequencyPlotDialog/FuncChoice"), mFuncChoice->GetSelection());
    gPrefs->Write(wxT("/FrequencyPlotDialog/AxisChoice"), mAxisChoice->GetSelection());
    gPrefs->Flush();
-   mData.reset();
+   // Stop any calculation before the data it reads are gone
+   if (mCalculating)
+      mStopPending = true;
+   mTracks.clear();
    Show(false);
 }
 
@@ -1035,7 +1043,13 @@ void FrequencyPlotDialog::SendRecalcEvent()
 
 void FrequencyPlotDialog::Recalc()
 {
-   if (!mData || mDataLen < mWindowSize) {
+   if (mCalculating) {
+      // Changed settings during the calculation; stop it, and start again
+      mRecalcPending = true;
+      return;
+   }
+
+   if (mTracks.empty() || mDataLen < mWindowSize) {
       DrawPlot();
       return;
    }
@@ -1044,6 +1058,26 @@ void FrequencyPlotDialog::Recalc()
       SpectrumAnalyst::Algorithm(mAlgChoice->GetSelection());
    int windowFunc = mFuncChoice->GetSelection();
 
+   const auto showResults = [&]{
+      if (alg == SpectrumAnalyst::Spectrum) {
+         if(mYMin < -dBRange)
+            mYMin = -dBRange;
+         if(mYMax <= -dBRange)
+            mYMax = -dBRange + 10.; // it's all out of range, but show a scale.
+         else
+            mYMax += .5;
+      }
+
+      // Prime the scrollbar
+      mPanScroller->SetScrollbar(0, (mYMax - mYMin) * 100, (mYMax - mYMin) * 100, 1);
+
+      DrawPlot();
+   };
+
+   // The gauge counts in integers
+   constexpr int ProgressRange = 1 << 20;
+   bool readError = false;
+
    wxWindow *hadFocus = FindFocus();
    // In wxMac, the skipped window MUST be a top level window.  I'd originally made it
    // just the mProgress window with the idea of preventing user interaction with the
@@ -1055,27 +1089,64 @@ void FrequencyPlotDialog::Recalc()
          blocker.emplace(this);
       wxYieldIfNeeded();
 
+      mProgress->SetRange(ProgressRange);
+      const auto source =
+      [&](float *buffer, sampleCount start, size_t len) {
+         readError = !ReadSamples(buffer, start, len);
+         return !readError;
+      };
+      // Plot the results so far after each pass over the selection
+      const auto report = [&](float yMin, float yMax, double fraction) {
+         mYMin = yMin;
+         mYMax = yMax;
+         showResults();
+         mProgress->SetValue(int(fraction * ProgressRange));
+         // This dialog's controls stay enabled, and may ask for another
+         // calculation or other data
+         wxYieldIfNeeded();
+         return !(mRecalcPending || mReplotPending || mStopPending);
+      };
+      mCalculating = true;
+      auto cleanup = finally([&]{ mCalculating = false; });
       mAnalyst->Calculate(alg, windowFunc, mWindowSize, mRate,
-         mData.get(), mDataLen,
-         &mYMin, &mYMax, mProgress);
+         source, mDataLen,
+         &mYMin, &mYMax, report);
+      mProgress->Reset();
    }
    if (hadFocus) {
       hadFocus->SetFocus();
    }
 
-   if (alg == SpectrumAnalyst::Spectrum) {
-      if(mYMin < -dBRange)
-         mYMin = -dBRange;
-      if(mYMax <= -dBRange)
-         mYMax = -dBRange + 10.; // it's all out of range, but show a scale.
-      else
-         mYMax += .5;
+   if (readError) {
+      using namespace BasicUI;
+      ShowMessageBox(
+         XO("Audio could not be analyzed. This may be due to a stretched or pitch-shifted clip.\nTry resetting any stretched clips, or mixing and rendering the tracks before analyzing"),
+         MessageBoxOptions {}.Caption(XO("Error")).IconStyle(Icon::Error));
+      mTracks.clear();
+      mDataLen = 0;
+      mReplotPending = mRecalcPending = false;
+      DrawPlot();
+      return;
    }
 
-   // Prime the scrollbar
-   mPanScroller->SetScrollbar(0, (mYMax - mYMin) * 100, (mYMax - mYMin) * 100, 1);
+   if (mStopPending) {
+      mStopPending = mRecalcPending = false;
+      // Unless shown again while stopping
+      if (!mReplotPending)
+         return;
+   }
+   if (mReplotPending) {
+      mReplotPending = mRecalcPending = false;
+      Replot();
+      return;
+   }
+   if (mRecalcPending) {
+      mRecalcPending = false;
+      SendRecalcEvent();
+      return;
+   }
 
-   DrawPlot();
+   showResults();
 }
 
 void FrequencyPlotDialog::OnExport(wxCommandEvent & WXUNUSED(event))
@@ -1124,6 +1195,16 @@ void FrequencyPlotDialog::OnExport(wxCommandEvent & WXUNUSED(event))
 
 void FrequencyPlotDialog::OnReplot(wxCommandEvent & WXUNUSED(event))
 {
+   Replot();
+}
+
+void FrequencyPlotDialog::Replot()
+{
+   if (mCalculating) {
+      // Don't replace the data that the calculation reads
+      mReplotPending = true;
+      return;
+   }
    dBRange = DecibelScaleCutoff.Read();
    if(dBRange < 90.)
       dBRange = 90.;
@@ -11,6 +11,7 @@
 #ifndef __AUDACITY_FREQ_WINDOW__
 #define __AUDACITY_FREQ_WINDOW__
 
+#include <memory>
 #include <vector>
 #include <wx/font.h> // member variable
 #include <wx/statusbr.h> // to inherit
@@ -28,6 +29,7 @@ class wxCheckBox;
 class wxChoice;
 
 class AudacityProject;
+class TrackList;
 class FrequencyPlotDialog;
 class FreqGauge;
 class RulerPanel;
@@ -68,6 +70,8 @@ private:
    void Populate();
 
    bool GetAudio();
+   //! Mix the selected channels; return false if they can't be read
+   bool ReadSamples(float *buffer, sampleCount start, size_t len) const;
 
    void PlotMouseEvent(wxMouseEvent & event);
    void PlotPaint(wxPaintEvent & event);
@@ -89,6 +93,8 @@ private:
 
    void SendRecalcEvent();
    void Recalc();
+   //! Read the selection again, then recalculate
+   void Replot();
    void DrawPlot();
    void DrawBackground(wxMemoryDC & dc);
 
@@ -137,8 +143,10 @@ private:
 
 
    double mRate;
-   size_t mDataLen;
-   Floats mData;
+   sampleCount mStart;
+   sampleCount mDataLen;
+   //! Copies of the selected tracks, sharing their sample blocks
+   std::vector<std::shared_ptr<TrackList>> mTracks;
    size_t mWindowSize;
 
    bool mLogAxis;
@@ -153,6 +161,14 @@ private:
 
    std::unique_ptr<SpectrumAnalyst> mAnalyst;
 
+   //! Recalc yields to events while it calculates; these defer what they ask
+   //! until the calculation stops
+   bool mCalculating{ false };
+   bool mRecalcPending{ false };
+   bool mReplotPending{ false };
+   //! Set when the dialog closes during the calculation
+   bool mStopPending{ false };
+
    DECLARE_EVENT_TABLE()
 
    friend class FreqPlot;
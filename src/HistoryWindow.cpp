@@ -41,6 +41,7 @@ undo memory so as to free up space.
 #include "ProjectHistory.h"
 #include "ProjectWindows.h"
 #include "ShuttleGui.h"
+#include "UndoStateSpiller.h"
 #include "AudacityMessageBox.h"
 #include "HelpSystem.h"
 
@@ -68,8 +69,10 @@ struct SpaceUsageCalculator {
    SpaceArray space;
    Type clipboardSpaceUsage;
 
-   void Calculate( UndoManager &manager )
+   void Calculate( AudacityProject &project )
    {
+      auto &manager = UndoManager::Get( project );
+      auto &spiller = UndoStateSpiller::Get( project );
       SampleBlockIDSet seen;
 
       // After copies and pastes, a block file may be used in more than
@@ -88,10 +91,13 @@ struct SpaceUsageCalculator {
       // state.
 
       manager.VisitStates(
-         [this, &seen](const UndoStackElem &elem) {
-            // Scan all tracks at current level
-            if (auto pTracks = TrackList::FindUndoTracks(elem))
-               space.push_back(CalculateUsage(*pTracks, seen));
+         [this, &spiller, &seen](const UndoStackElem &elem) {
+            // Scan all tracks at current level, including states spilled
+            // to disk, so that space lines up with the states
+            Type result = 0;
+            spiller.InspectBlocks(
+               elem, BlockSpaceUsageAccumulator( result ), &seen );
+            space.push_back(result);
          },
          true // newest state first
       );
@@ -187,6 +193,14 @@ void HistoryDialog::Populate(ShuttleGui & S)
             mTotal = S.Id(ID_TOTAL).Style(wxTE_READONLY).AddTextBox({}, wxT(""), 10);
             S.AddVariableText( {} )->Hide();
 
+            S.AddPrompt(XXO("Memor&y used by history"));
+            mMemory = S.Style(wxTE_READONLY).AddTextBox({}, wxT(""), 10);
+            S.AddVariableText( {} )->Hide();
+
+            S.AddPrompt(XXO("S&pilled to disk"));
+            mSpilled = S.Style(wxTE_READONLY).AddTextBox({}, wxT(""), 10);
+            S.AddVariableText( {} )->Hide();
+
 #if defined(ALLOW_DISCARD)
             S.AddPrompt(XXO("&Undo levels available"));
             mAvail = S.Id(ID_AVAIL).Style(wxTE_READONLY).AddTextBox({}, wxT(""), 10);
@@ -283,7 +297,7 @@ void HistoryDialog::DoUpdate()
    int i = 0;
 
    SpaceUsageCalculator calculator;
-   calculator.Calculate( *mManager );
+   calculator.Calculate( *mProject );
 
    // point to size for oldest state
    auto iter = calculator.space.rbegin();
@@ -307,6 +321,12 @@ void HistoryDialog::DoUpdate()
 
    mTotal->SetValue(Internat::FormatSize(total).Translation());
 
+   auto &spiller = UndoStateSpiller::Get(*mProject);
+   mMemory->SetValue(Internat::FormatSize(
+      static_cast<wxLongLong_t>(spiller.GetMemoryUsage())).Translation());
+   mSpilled->SetValue(Internat::FormatSize(
+      static_cast<wxLongLong_t>(spiller.GetSpilledUsage())).Translation());
+
    auto clipboardUsage = calculator.clipboardSpaceUsage;
    mClipboard->SetValue(Internat::FormatSize(clipboardUsage).Translation());
 #if defined(ALLOW_DISCARD)
@@ -67,6 +67,8 @@ class HistoryDialog final : public wxDialogWrapper,
    UndoManager       *mManager;
    wxListCtrl        *mList;
    wxTextCtrl        *mTotal;
+   wxTextCtrl        *mMemory;
+   wxTextCtrl        *mSpilled;
    wxTextCtrl        *mClipboard;
    wxTextCtrl        *mAvail;
    wxSpinCtrl        *mLevels;
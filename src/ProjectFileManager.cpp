@@ -29,6 +29,7 @@ Paul Licameli split from AudacityProject.cpp
 #include "ImportProgressListener.h"
 #include "Legacy.h"
 #include "MusicInformationRetrieval.h"
+#include "Parallel.h"
 #include "PlatformCompatibility.h"
 #include "Project.h"
 #include "ProjectFileIO.h"
@@ -65,7 +66,11 @@ Paul Licameli split from AudacityProject.cpp
 #include "wxFileNameWrapper.h"
 #include "wxPanelWrapper.h"
 
+#include <atomic>
+#include <chrono>
+#include <numeric>
 #include <optional>
+#include <thread>
 #include <wx/frame.h>
 #include <wx/log.h>
 
@@ -1134,10 +1139,17 @@ AudacityProject *ProjectFileManager::OpenProjectFile(
 void
 ProjectFileManager::AddImportedTracks(const FilePath &fileName,
    TrackHolders &&newTracks)
+{
+   const bool initiallyEmpty = TrackList::Get(mProject).empty();
+   AppendImportedTracks(fileName, std::move(newTracks));
+   FinishImport(fileName, initiallyEmpty,
+      XO("Imported '%s'").Format( fileName ));
+}
+
+void ProjectFileManager::AppendImportedTracks(const FilePath &fileName,
+   TrackHolders &&newTracks)
 {
    auto &project = mProject;
-   auto &history = ProjectHistory::Get( project );
-   auto &projectFileIO = ProjectFileIO::Get( project );
    auto &tracks = TrackList::Get( project );
 
    std::vector<Track*> results;
@@ -1146,7 +1158,6 @@ ProjectFileManager::AddImportedTracks(const FilePath &fileName,
 
    wxFileName fn(fileName);
 
-   bool initiallyEmpty = tracks.empty();
    double newRate = 0;
    wxString trackNameBase = fn.GetName();
    int i = -1;
@@ -1198,9 +1209,16 @@ ProjectFileManager::AddImportedTracks(const FilePath &fileName,
             interval->SetName(trackName);
       });
    }
+}
 
-   history.PushState(XO("Imported '%s'").Format( fileName ),
-       XO("Import"));
+void ProjectFileManager::FinishImport(const FilePath &fileName,
+   bool initiallyEmpty, const TranslatableString &description)
+{
+   auto &project = mProject;
+   auto &history = ProjectHistory::Get( project );
+   auto &projectFileIO = ProjectFileIO::Get( project );
+
+   history.PushState(description, XO("Import"));
 
 #if defined(__WXGTK__)
    // See bug #1224
@@ -1214,6 +1232,7 @@ ProjectFileManager::AddImportedTracks(const FilePath &fileName,
    // If the project was clean and temporary (not permanently saved), then set
    // the filename to the just imported path.
    if (initiallyEmpty && projectFileIO.IsTemporary()) {
+      wxFileName fn(fileName);
       project.SetProjectName(fn.GetName());
       project.SetInitialImportPath(fn.GetPath());
       projectFileIO.SetProjectTitle();
@@ -1241,6 +1260,82 @@ bool ImportProject(AudacityProject &dest, const FilePath &fileName)
    return true;
 }
 
+//! Run `work` in a worker thread, while this thread keeps polling `progress`
+//! with the fraction that `getProgress` computes, until the work is done
+/*!
+ @param onPoll is given each result of polling, and may signal the worker to
+ stop
+ Exceptions from `work` are rethrown in this thread
+ */
+void RunWhilePolling(
+   BasicUI::ProgressDialog& progress, const std::function<void()>& work,
+   const std::function<double()>& getProgress,
+   const std::function<void(BasicUI::ProgressResult)>& onPoll)
+{
+   std::atomic<bool> finished { false };
+   std::exception_ptr pException;
+   std::thread worker { [&] {
+      try
+      {
+         work();
+      }
+      catch (...)
+      {
+         pException = std::current_exception();
+      }
+      finished.store(true, std::memory_order_release);
+   } };
+
+   while (!finished.load(std::memory_order_acquire))
+   {
+      using namespace std::chrono_literals;
+      std::this_thread::sleep_for(50ms);
+      onPoll(progress.Poll(getProgress() * 1000, 1000));
+   }
+   worker.join();
+
+   if (pException)
+      std::rethrow_exception(pException);
+}
+
+std::shared_ptr<ClipMirAudioReader> PrepareImportedTracks(
+   AudacityProject& project, const FilePath& fileName,
+   const TrackHolders& newTracks,
+   std::optional<LibFileFormats::AcidizerTags> acidTags)
+{
+   const auto projectTempo = ProjectTimeSignature::Get(project).GetTempo();
+   for (auto trackList : newTracks)
+      for (auto track : *trackList)
+         track->OnProjectTempoChange(projectTempo);
+
+   if (!newTracks.empty() && newTracks[0])
+   {
+      const auto waveTracks = (*newTracks[0]).Any<WaveTrack>();
+      if (waveTracks.size() == 1)
+         return std::make_shared<ClipMirAudioReader>(
+            std::move(acidTags), fileName.ToStdString(),
+            **waveTracks.begin());
+   }
+   return nullptr;
+}
+
+//! @return false if the user cancelled
+bool ChooseStreams(ImportFileHandle& importFileHandle)
+{
+   // File has more than one stream - display stream selector
+   if (importFileHandle.GetStreamCount() > 1)
+   {
+      ImportStreamDialog ImportDlg(&importFileHandle, NULL, -1, XO("Select stream(s) to import"));
+
+      if (ImportDlg.ShowModal() == wxID_CANCEL)
+         return false;
+   }
+   // One stream - import it by default
+   else
+      importFileHandle.SetStreamUsage(0,TRUE);
+   return true;
+}
+
 class ImportProgress final
    : public ImportProgressListener
 {
@@ -1256,18 +1351,7 @@ public:
    bool OnImportFileOpened(ImportFileHandle& importFileHandle) override
    {
       mImportFileHandle = &importFileHandle;
-      // File has more than one stream - display stream selector
-      if (importFileHandle.GetStreamCount() > 1)
-      {
-         ImportStreamDialog ImportDlg(&importFileHandle, NULL, -1, XO("Select stream(s) to import"));
-
-         if (ImportDlg.ShowModal() == wxID_CANCEL)
-            return false;
-      }
-      // One stream - import it by default
-      else
-         importFileHandle.SetStreamUsage(0,TRUE);
-      return true;
+      return ChooseStreams(importFileHandle);
    }
 
    void OnImportProgress(double progress) override
@@ -1305,8 +1389,213 @@ private:
    ImportFileHandle* mImportFileHandle {nullptr};
    std::unique_ptr<BasicUI::ProgressDialog> mProgressDialog;
 };
+
+bool CanImportConcurrently(const std::vector<FilePath>& fileNames)
+{
+   if (fileNames.size() < 2 || !ConcurrentImport.Read())
+      return false;
+   // Projects and lists of files have their own semantics, and are left to
+   // the serial import
+   return std::none_of(
+      fileNames.begin(), fileNames.end(), [](const FilePath& fileName) {
+         const auto extension = fileName.AfterLast('.');
+         return extension.IsSameAs(wxT("aup3"), false) ||
+                extension.IsSameAs(wxT("aup"), false) ||
+                extension.IsSameAs(wxT("lof"), false);
+      });
+}
+
+//! One file of a concurrent import, opened in the main thread, then decoded
+//! in a worker thread into its own tracks and tags
+class ConcurrentImportJob final : public ImportProgressListener
+{
+public:
+   ConcurrentImportJob(FilePath fileName, std::shared_ptr<Tags> tags)
+       : fileName { std::move(fileName) }
+       , tags { std::move(tags) }
+   {
+   }
+
+   bool OnImportFileOpened(ImportFileHandle& importFileHandle) override
+   {
+      // Leave the file to the serial import, which will choose its streams
+      if (!importFileHandle.SupportsConcurrentImport())
+         return false;
+      declined = !ChooseStreams(importFileHandle);
+      return !declined;
+   }
+
+   void OnImportProgress(double progressFraction) override
+   {
+      progress.store(progressFraction, std::memory_order_relaxed);
+   }
+
+   void OnImportResult(ImportResult importResult) override
+   {
+      result = importResult;
+   }
+
+   bool Succeeded() const
+   {
+      return (result == ImportResult::Success ||
+              result == ImportResult::Stopped) &&
+             std::none_of(
+                tracks.begin(), tracks.end(),
+                [](const auto& pList) { return !pList || pList->empty(); }) &&
+             !tracks.empty();
+   }
+
+   const FilePath fileName;
+   const std::shared_ptr<Tags> tags;
+   std::unique_ptr<ImportFileHandle> handle;
+   TrackHolders tracks;
+   std::optional<LibFileFormats::AcidizerTags> acidTags;
+   std::atomic<double> progress { 0 };
+   ImportResult result { ImportResult::Error };
+   bool declined { false };
+};
 } // namespace
 
+bool ProjectFileManager::ImportConcurrently(
+   const std::vector<FilePath>& fileNames, bool addToHistory,
+   std::vector<std::shared_ptr<ClipMirAudioReader>>& resultingReaders)
+{
+   auto& project = mProject;
+   auto cleanup = valueRestorer(project.mbBusyImporting, true);
+   auto& trackFactory = WaveTrackFactory::Get(project);
+   const auto oldTags = Tags::Get(project).shared_from_this();
+   bool success = true;
+
+   // Open all files in this thread, because choosing among streams may
+   // require the user
+   std::vector<std::unique_ptr<ConcurrentImportJob>> jobs;
+   for (const auto& fileName : fileNames)
+   {
+      auto& job = *jobs.emplace_back(
+         std::make_unique<ConcurrentImportJob>(fileName, oldTags->Duplicate()));
+      job.handle = Importer::Get().Open(project, fileName, job);
+      if (job.declined)
+      {
+         // As in the serial import, stop at the first file declined, but
+         // keep the preceding ones
+         jobs.pop_back();
+         success = false;
+         break;
+      }
+   }
+
+   std::vector<ConcurrentImportJob*> opened;
+   for (const auto& pJob : jobs)
+      if (pJob->handle)
+         opened.push_back(pJob.get());
+
+   if (!opened.empty())
+   {
+      auto progress = BasicUI::MakeProgress(
+         XO("Import"),
+         XP("Importing %lld file", "Importing %lld files", 0)(
+            static_cast<long long>(opened.size())));
+      RunWhilePolling(
+         *progress,
+         [&] {
+            Parallel::For(opened.size(), [&](size_t i) {
+               auto& job = *opened[i];
+               job.handle->Import(
+                  job, &trackFactory, job.tracks, job.tags.get(),
+                  job.acidTags);
+            });
+         },
+         [&] {
+            return std::accumulate(
+                      opened.begin(), opened.end(), 0.,
+                      [](double sum, const ConcurrentImportJob* pJob) {
+                         return sum +
+                                pJob->progress.load(std::memory_order_relaxed);
+                      }) /
+                   opened.size();
+         },
+         [&](BasicUI::ProgressResult result) {
+            for (const auto pJob : opened)
+               if (result == BasicUI::ProgressResult::Cancelled)
+                  pJob->handle->Cancel();
+               else if (result == BasicUI::ProgressResult::Stopped)
+                  pJob->handle->Stop();
+         });
+   }
+
+   // Files that were not opened, not decoded, or whose importer does not
+   // support concurrency are imported serially, which tries all plugins and
+   // explains failures. Then everything is committed in the order of the file
+   // names.
+   const bool initiallyEmpty = TrackList::Get(project).empty();
+   auto newTags = oldTags->Duplicate();
+   std::vector<ConcurrentImportJob*> imported;
+   for (const auto& pJob : jobs)
+   {
+      auto& job = *pJob;
+      if (job.result == ImportProgressListener::ImportResult::Cancelled)
+      {
+         success = false;
+         break;
+      }
+      if (!job.Succeeded())
+      {
+         job.handle.reset();
+         job.tracks.clear();
+         *job.tags = *oldTags;
+         job.acidTags.reset();
+         ImportProgress importProgress(project);
+         TranslatableString errorMessage;
+         const auto importedSerially = Importer::Get().Import(
+            project, job.fileName, &importProgress, &trackFactory, job.tracks,
+            job.tags.get(), job.acidTags, errorMessage);
+         if (!errorMessage.empty())
+            BasicUI::ShowErrorDialog(
+               *ProjectFramePlacement(&project), XO("Error Importing"),
+               errorMessage, wxT("Importing_Audio"));
+         if (!importedSerially)
+         {
+            success = false;
+            break;
+         }
+      }
+      imported.push_back(&job);
+   }
+
+   for (const auto pJob : imported)
+   {
+      auto& job = *pJob;
+      // Tags set by later files override those of earlier files, as when
+      // importing one after the other
+      for (const auto& [name, value] : job.tags->GetRange())
+         if (oldTags->GetTag(name) != value)
+            newTags->SetTag(name, value);
+
+      if (
+         auto resultingReader = PrepareImportedTracks(
+            project, job.fileName, job.tracks, std::move(job.acidTags)))
+         resultingReaders.push_back(std::move(resultingReader));
+
+      if (addToHistory)
+         FileHistory::Global().Append(job.fileName);
+
+      AppendImportedTracks(job.fileName, std::move(job.tracks));
+   }
+
+   if (!imported.empty())
+   {
+      Tags::Set(project, newTags);
+      FinishImport(
+         imported.front()->fileName, initiallyEmpty,
+         imported.size() == 1 ?
+            XO("Imported '%s'").Format(imported.front()->fileName) :
+            XP("Imported %lld file", "Imported %lld files", 0)(
+               static_cast<long long>(imported.size())));
+   }
+
+   return success;
+}
+
 bool ProjectFileManager::Import(const FilePath& fileName, bool addToHistory)
 {
    return Import(std::vector<FilePath> { fileName }, addToHistory);
@@ -1325,27 +1614,51 @@ std::vector<std::shared_ptr<MIR::AnalyzedAudioClip>> RunTempoDetection(
    auto progress = MakeProgress(
       XO("Music Information Retrieval"), XO("Analyzing imported audio"),
       ProgressShowCancel);
-   auto count = 0;
-   const auto reportProgress = [&](double progressFraction) {
-      const auto result = progress->Poll(
-         (count + progressFraction) / readers.size() * 1000, 1000);
-      if (result != ProgressResult::Success)
-         throw UserException {};
-   };
 
-   std::vector<std::shared_ptr<MIR::AnalyzedAudioClip>> analyzedClips;
-   analyzedClips.reserve(readers.size());
-   std::transform(
-      readers.begin(), readers.end(), std::back_inserter(analyzedClips),
-      [&](const std::shared_ptr<ClipMirAudioReader>& reader) {
-         const MIR::ProjectSyncInfoInput input {
-            *reader,      reader->filename, reader->tags,       reportProgress,
-            projectTempo, projectWasEmpty,  isBeatsAndMeasures,
-         };
-         auto syncInfo = MIR::GetProjectSyncInfo(input);
-         ++count;
-         return std::make_shared<AnalyzedWaveClip>(reader, syncInfo);
+   // The clips are analyzed independently on worker threads, each reporting
+   // its own progress. The progress dialog may only be polled from this
+   // thread, which sums the progress up and signals cancellation.
+   std::vector<std::atomic<double>> progressFractions(readers.size());
+   std::atomic<bool> cancelled { false };
+   std::vector<std::shared_ptr<MIR::AnalyzedAudioClip>> analyzedClips(
+      readers.size());
+
+   RunWhilePolling(
+      *progress,
+      [&] {
+         Parallel::For(readers.size(), [&](size_t i) {
+            const auto& reader = readers[i];
+            const auto reportProgress = [&, i](double progressFraction) {
+               progressFractions[i].store(
+                  progressFraction, std::memory_order_relaxed);
+               if (cancelled.load(std::memory_order_relaxed))
+                  throw UserException {};
+            };
+            const MIR::ProjectSyncInfoInput input {
+               *reader,      reader->filename, reader->tags,       reportProgress,
+               projectTempo, projectWasEmpty,  isBeatsAndMeasures,
+            };
+            auto syncInfo = MIR::GetProjectSyncInfo(input);
+            analyzedClips[i] =
+               std::make_shared<AnalyzedWaveClip>(reader, syncInfo);
+            progressFractions[i].store(1., std::memory_order_relaxed);
+         });
+      },
+      [&] {
+         return std::accumulate(
+                   progressFractions.begin(), progressFractions.end(), 0.,
+                   [](double sum, const std::atomic<double>& fraction) {
+                      return sum + fraction.load(std::memory_order_relaxed);
+                   }) /
+                readers.size();
+      },
+      [&](ProgressResult result) {
+         if (result != ProgressResult::Success)
+            cancelled.store(true, std::memory_order_relaxed);
       });
+
+   if (cancelled.load(std::memory_order_relaxed))
+      throw UserException {};
    return analyzedClips;
 }
 } // namespace
@@ -1356,14 +1669,17 @@ bool ProjectFileManager::Import(
    const auto projectWasEmpty =
       TrackList::Get(mProject).Any<WaveTrack>().empty();
    std::vector<std::shared_ptr<ClipMirAudioReader>> resultingReaders;
-   const auto success = std::all_of(
-      fileNames.begin(), fileNames.end(), [&](const FilePath& fileName) {
-         std::shared_ptr<ClipMirAudioReader> resultingReader;
-         const auto success = Import(fileName, addToHistory, resultingReader);
-         if (success && resultingReader)
-            resultingReaders.push_back(std::move(resultingReader));
-         return success;
-      });
+   const auto success = CanImportConcurrently(fileNames) ?
+      ImportConcurrently(fileNames, addToHistory, resultingReaders) :
+      std::all_of(
+         fileNames.begin(), fileNames.end(), [&](const FilePath& fileName) {
+            std::shared_ptr<ClipMirAudioReader> resultingReader;
+            const auto success =
+               Import(fileName, addToHistory, resultingReader);
+            if (success && resultingReader)
+               resultingReaders.push_back(std::move(resultingReader));
+            return success;
+         });
    if (success && !resultingReaders.empty())
    {
       const auto pProj = mProject.shared_from_this();
@@ -1461,19 +1777,8 @@ bool ProjectFileManager::Import(
       if (!success)
          return false;
 
-      const auto projectTempo = ProjectTimeSignature::Get(project).GetTempo();
-      for (auto trackList : newTracks)
-         for (auto track : *trackList)
-            track->OnProjectTempoChange(projectTempo);
-
-      if (!newTracks.empty() && newTracks[0])
-      {
-         const auto waveTracks = (*newTracks[0]).Any<WaveTrack>();
-         if (waveTracks.size() == 1)
-            resultingReader.reset(new ClipMirAudioReader {
-               std::move(acidTags), fileName.ToStdString(),
-               **waveTracks.begin() });
-      }
+      resultingReader = PrepareImportedTracks(
+         project, fileName, newTracks, std::move(acidTags));
 
       if (addToHistory) {
          FileHistory::Global().Append(fileName);
@@ -122,6 +122,21 @@ private:
       const FilePath& fileName, bool addToHistory,
       std::shared_ptr<ClipMirAudioReader>& resultingReader);
 
+   //! Decode several files at once in worker threads, then add all their
+   //! tracks, in order, in one undo step
+   bool ImportConcurrently(
+      const std::vector<FilePath>& fileNames, bool addToHistory,
+      std::vector<std::shared_ptr<ClipMirAudioReader>>& resultingReaders);
+
+   //! Append and name the tracks imported from one file, without pushing undo
+   //! state
+   void AppendImportedTracks(const FilePath &fileName,
+                     TrackHolders &&newTracks);
+
+   //! Push undo state after import, and name the project if it was empty
+   void FinishImport(const FilePath &fileName, bool initiallyEmpty,
+      const TranslatableString &description);
+
    /*!
     @param fileName a path assumed to exist and contain an .aup3 project
     @param addtohistory whether to add the file to the MRU list
@@ -24,8 +24,10 @@ and in the spectrogram spectral selection.
 
 #include "SpectrumAnalyst.h"
 #include "FFT.h"
+#include "Parallel.h"
 
 #include "SampleFormat.h"
+#include <algorithm>
 #include <wx/dcclient.h>
 
 FreqGauge::FreqGauge(wxWindow * parent, wxWindowID winid)
@@ -88,118 +90,80 @@ SpectrumAnalyst::~SpectrumAnalyst()
 {
 }
 
-bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
-                                size_t windowSize, double rate,
-                                const float *data, size_t dataLen,
-                                float *pYMin, float *pYMax,
-                                FreqGauge *progress)
+namespace {
+//! Windows in each chunk of input that one work item analyzes
+size_t ChunkWindows(size_t half)
 {
-   // Wipe old data
-   mProcessed.resize(0);
-   mRate = 0.0;
-   mWindowSize = 0;
-
-   // Validate inputs
-   int f = NumWindowFuncs();
-
-   if (!(windowSize >= 32 && windowSize <= 131072 &&
-         alg >= SpectrumAnalyst::Spectrum &&
-         alg < SpectrumAnalyst::NumAlgorithms &&
-         windowFunc >= 0 && windowFunc < f)) {
-      return false;
-   }
-
-   if (dataLen < windowSize) {
-      return false;
-   }
-
-   // Now repopulate
-   mRate = rate;
-   mWindowSize = windowSize;
-   mAlg = alg;
-
-   auto half = mWindowSize / 2;
-   mProcessed.resize(mWindowSize);
+   // About a megabyte of samples
+   return std::max<size_t>(4, (1 << 18) / half);
+}
 
-   Floats in{ mWindowSize };
-   Floats out{ mWindowSize };
-   Floats out2{ mWindowSize };
-   Floats win{ mWindowSize };
+//! Chunks analyzed in each pass, between reports of results
+constexpr size_t PassChunks = 32;
 
-   for (size_t i = 0; i < mWindowSize; i++) {
-      mProcessed[i] = 0.0f;
-      win[i] = 1.0f;
-   }
+//! Sum the results of count windows, each starting half a window after the
+//! previous one
+std::vector<float> AnalyzeChunk(SpectrumAnalyst::Algorithm alg,
+   const float *win, size_t windowSize, const float *data, size_t count)
+{
+   const auto half = windowSize / 2;
+   std::vector<float> sums(half);
 
-   WindowFunc(windowFunc, mWindowSize, win.get());
+   Floats in{ windowSize };
+   Floats out{ windowSize };
+   Floats out2{ windowSize };
 
-   // Scale window such that an amplitude of 1.0 in the time domain
-   // shows an amplitude of 0dB in the frequency domain
-   double wss = 0;
-   for (size_t i = 0; i<mWindowSize; i++)
-      wss += win[i];
-   if(wss > 0)
-      wss = 4.0 / (wss*wss);
-   else
-      wss = 1.0;
-
-   if (progress) {
-      progress->SetRange(dataLen);
-   }
-
-   size_t start = 0;
-   int windows = 0;
-   while (start + mWindowSize <= dataLen) {
-      for (size_t i = 0; i < mWindowSize; i++)
+   for (size_t start = 0; count > 0; --count, start += half) {
+      for (size_t i = 0; i < windowSize; i++)
          in[i] = win[i] * data[start + i];
 
       switch (alg) {
-         case Spectrum:
-            PowerSpectrum(mWindowSize, in.get(), out.get());
+         case SpectrumAnalyst::Spectrum:
+            PowerSpectrum(windowSize, in.get(), out.get());
 
             for (size_t i = 0; i < half; i++)
-               mProcessed[i] += out[i];
+               sums[i] += out[i];
             break;
 
-         case Autocorrelation:
-         case CubeRootAutocorrelation:
-         case EnhancedAutocorrelation:
+         case SpectrumAnalyst::Autocorrelation:
+         case SpectrumAnalyst::CubeRootAutocorrelation:
+         case SpectrumAnalyst::EnhancedAutocorrelation:
 
             // Take FFT
-            RealFFT(mWindowSize, in.get(), out.get(), out2.get());
+            RealFFT(windowSize, in.get(), out.get(), out2.get());
             // Compute power
-            for (size_t i = 0; i < mWindowSize; i++)
+            for (size_t i = 0; i < windowSize; i++)
                in[i] = (out[i] * out[i]) + (out2[i] * out2[i]);
 
-            if (alg == Autocorrelation) {
-               for (size_t i = 0; i < mWindowSize; i++)
+            if (alg == SpectrumAnalyst::Autocorrelation) {
+               for (size_t i = 0; i < windowSize; i++)
                   in[i] = sqrt(in[i]);
             }
-            if (alg == CubeRootAutocorrelation ||
-                alg == EnhancedAutocorrelation) {
+            if (alg == SpectrumAnalyst::CubeRootAutocorrelation ||
+                alg == SpectrumAnalyst::EnhancedAutocorrelation) {
                // Tolonen and Karjalainen recommend taking the cube root
                // of the power, instead of the square root
 
-               for (size_t i = 0; i < mWindowSize; i++)
+               for (size_t i = 0; i < windowSize; i++)
                   in[i] = pow(in[i], 1.0f / 3.0f);
             }
             // Take FFT
-            RealFFT(mWindowSize, in.get(), out.get(), out2.get());
+            RealFFT(windowSize, in.get(), out.get(), out2.get());
 
             // Take real part of result
             for (size_t i = 0; i < half; i++)
-               mProcessed[i] += out[i];
+               sums[i] += out[i];
             break;
 
-         case Cepstrum:
-            RealFFT(mWindowSize, in.get(), out.get(), out2.get());
+         case SpectrumAnalyst::Cepstrum:
+            RealFFT(windowSize, in.get(), out.get(), out2.get());
 
             // Compute log power
             // Set a sane lower limit assuming maximum time amplitude of 1.0
             {
                float power;
-               float minpower = 1e-20*mWindowSize*mWindowSize;
-               for (size_t i = 0; i < mWindowSize; i++)
+               float minpower = 1e-20*windowSize*windowSize;
+               for (size_t i = 0; i < windowSize; i++)
                {
                   power = (out[i] * out[i]) + (out2[i] * out2[i]);
                   if(power < minpower)
@@ -208,11 +172,11 @@ bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
                      in[i] = log(power);
                }
                // Take IFFT
-               InverseRealFFT(mWindowSize, in.get(), NULL, out.get());
+               InverseRealFFT(windowSize, in.get(), NULL, out.get());
 
                // Take real part of result
                for (size_t i = 0; i < half; i++)
-                  mProcessed[i] += out[i];
+                  sums[i] += out[i];
             }
 
             break;
@@ -221,21 +185,160 @@ bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
             wxASSERT(false);
             break;
       }                         //switch
+   }
 
-      // Update the progress bar
-      if (progress) {
-         progress->SetValue(start);
-      }
+   return sums;
+}
+}
 
-      start += half;
-      windows++;
-   }
+bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
+                                size_t windowSize, double rate,
+                                const float *data, size_t dataLen,
+                                float *pYMin, float *pYMax,
+                                FreqGauge *progress)
+{
+   // The gauge counts in integers
+   constexpr int ProgressRange = 1 << 20;
+   if (progress)
+      progress->SetRange(ProgressRange);
+
+   const auto source = [data](float *buffer, sampleCount start, size_t len) {
+      const auto begin = data + start.as_size_t();
+      std::copy(begin, begin + len, buffer);
+      return true;
+   };
+   const auto report = [progress](float, float, double fraction) {
+      // Update the progress bar
+      if (progress)
+         progress->SetValue(int(fraction * ProgressRange));
+      return true;
+   };
+   const auto result = Calculate(alg, windowFunc, windowSize, rate,
+      source, dataLen, pYMin, pYMax, report);
 
    if (progress) {
       // Reset for next time
       progress->Reset();
    }
 
+   return result;
+}
+
+bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
+                                size_t windowSize, double rate,
+                                const SampleSource &source,
+                                sampleCount dataLen,
+                                float *pYMin, float *pYMax,
+                                const ResultsReporter &report)
+{
+   // Wipe old data
+   mProcessed.resize(0);
+   mRate = 0.0;
+   mWindowSize = 0;
+
+   // Validate inputs
+   int f = NumWindowFuncs();
+
+   if (!(windowSize >= 32 && windowSize <= 131072 &&
+         alg >= SpectrumAnalyst::Spectrum &&
+         alg < SpectrumAnalyst::NumAlgorithms &&
+         windowFunc >= 0 && windowFunc < f)) {
+      return false;
+   }
+
+   if (dataLen < windowSize) {
+      return false;
+   }
+
+   // Now repopulate
+   mRate = rate;
+   mWindowSize = windowSize;
+   mAlg = alg;
+
+   auto half = windowSize / 2;
+
+   Floats win{ windowSize };
+   for (size_t i = 0; i < windowSize; i++)
+      win[i] = 1.0f;
+
+   WindowFunc(windowFunc, windowSize, win.get());
+
+   // Scale window such that an amplitude of 1.0 in the time domain
+   // shows an amplitude of 0dB in the frequency domain
+   double wss = 0;
+   for (size_t i = 0; i<windowSize; i++)
+      wss += win[i];
+   if(wss > 0)
+      wss = 4.0 / (wss*wss);
+   else
+      wss = 1.0;
+
+   // Divide the windows into chunks, and the chunks into passes.  The chunks
+   // of each pass are spread over the whole input, so that the results after
+   // any pass represent all of it.
+   const auto totalWindows =
+      size_t((dataLen.as_long_long() - windowSize) / half + 1);
+   const auto chunkWindows = ChunkWindows(half);
+   const auto nChunks = (totalWindows + chunkWindows - 1) / chunkWindows;
+   const auto nPasses = (nChunks + PassChunks - 1) / PassChunks;
+
+   std::vector<double> sums(half);
+   size_t windows = 0;
+   std::vector<std::vector<float>> buffers;
+   std::vector<size_t> counts;
+   for (size_t pass = 0; pass < nPasses; ++pass) {
+      // Read the input of the pass on this thread
+      buffers.clear();
+      counts.clear();
+      for (auto chunk = pass; chunk < nChunks; chunk += nPasses) {
+         const auto first = chunk * chunkWindows;
+         const auto count = std::min(chunkWindows, totalWindows - first);
+         auto &buffer = buffers.emplace_back((count + 1) * half);
+         if (!source(buffer.data(),
+            sampleCount{ first } * sampleCount{ half }, buffer.size()))
+            return false;
+         counts.push_back(count);
+      }
+
+      // Analyze the chunks on worker threads, and sum their results in
+      // order, so that they don't depend on the number of threads
+      const auto partials = Parallel::Transform<std::vector<float>>(
+         buffers.size(), [&](size_t ii) {
+            return AnalyzeChunk(
+               alg, win.get(), windowSize, buffers[ii].data(), counts[ii]);
+         });
+      for (size_t ii = 0; ii < partials.size(); ++ii) {
+         const auto &partial = partials[ii];
+         for (size_t i = 0; i < half; i++)
+            sums[i] += partial[i];
+         windows += counts[ii];
+      }
+
+      // report may have let another Calculate replace the members; this
+      // pass depends only on the arguments, and restores them for its results
+      mRate = rate;
+      mWindowSize = windowSize;
+      mAlg = alg;
+      float yMin, yMax;
+      Finish(alg, windowSize, sums, windows, wss, &yMin, &yMax);
+      if (pYMin)
+         *pYMin = yMin;
+      if (pYMax)
+         *pYMax = yMax;
+      if (report && !report(yMin, yMax, double(windows) / totalWindows))
+         return false;
+   }
+
+   return true;
+}
+
+void SpectrumAnalyst::Finish(Algorithm alg, size_t windowSize,
+   const std::vector<double> &sums, size_t windows,
+   double wss, float *pYMin, float *pYMax)
+{
+   const auto half = sums.size();
+   mProcessed.assign(windowSize, 0.0f);
+
    float mYMin = 1000000, mYMax = -1000000;
    double scale;
    switch (alg) {
@@ -246,7 +349,7 @@ bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
       scale = wss / (double)windows;
       for (size_t i = 0; i < half; i++)
       {
-         mProcessed[i] = 10 * log10(mProcessed[i] * scale);
+         mProcessed[i] = 10 * log10(sums[i] * scale);
          if(mProcessed[i] > mYMax)
             mYMax = mProcessed[i];
          else if(mProcessed[i] < mYMin)
@@ -257,7 +360,7 @@ bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
    case Autocorrelation:
    case CubeRootAutocorrelation:
       for (size_t i = 0; i < half; i++)
-         mProcessed[i] = mProcessed[i] / windows;
+         mProcessed[i] = sums[i] / windows;
 
       // Find min/max
       mYMin = mProcessed[0];
@@ -270,12 +373,14 @@ bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
       break;
 
    case EnhancedAutocorrelation:
+   {
       for (size_t i = 0; i < half; i++)
-         mProcessed[i] = mProcessed[i] / windows;
+         mProcessed[i] = sums[i] / windows;
 
       // Peak Pruning as described by Tolonen and Karjalainen, 2000
 
       // Clip at zero, copy to temp array
+      std::vector<float> out(half);
       for (size_t i = 0; i < half; i++) {
          if (mProcessed[i] < 0.0)
             mProcessed[i] = float(0.0);
@@ -304,10 +409,11 @@ bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
          else if (mProcessed[i] < mYMin)
             mYMin = mProcessed[i];
       break;
+   }
 
    case Cepstrum:
       for (size_t i = 0; i < half; i++)
-         mProcessed[i] = mProcessed[i] / windows;
+         mProcessed[i] = sums[i] / windows;
 
       // Find min/max, ignoring first and last few values
       {
@@ -331,8 +437,6 @@ bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
       *pYMin = mYMin;
    if (pYMax)
       *pYMax = mYMax;
-
-   return true;
 }
 
 const float *SpectrumAnalyst::GetProcessed() const
@@ -12,8 +12,10 @@
 #ifndef __AUDACITY_SPECTRUM_ANALYST__
 #define __AUDACITY_SPECTRUM_ANALYST__
 
+#include <functional>
 #include <vector>
 #include <wx/statusbr.h>
+#include "SampleCount.h"
 
 class FreqGauge;
 
@@ -31,6 +33,16 @@ public:
       NumAlgorithms
    };
 
+   //! Fills buffer with len samples of the input, beginning at start
+   /*! Called only on the thread that called Calculate; return false if the
+    samples can't be read */
+   using SampleSource =
+      std::function<bool(float *buffer, sampleCount start, size_t len)>;
+   //! Receives the range of the results so far, and the fraction of the
+   //! input that they cover; return false to stop
+   using ResultsReporter =
+      std::function<bool(float yMin, float yMax, double fraction)>;
+
    SpectrumAnalyst();
    ~SpectrumAnalyst();
 
@@ -42,6 +54,24 @@ public:
       float *pYMin = NULL, float *pYMax = NULL, // outputs
       FreqGauge *progress = NULL);
 
+   //! Like the other overload, but reading the input as needed, so that it
+   //! need not all be in memory at once
+   /*!
+    Windows are analyzed on worker threads, in passes that each spread over
+    the whole input.  After each pass, the results are averaged over the
+    windows done so far, and report is called, so that a plot can show them
+    while the rest are computed.  If report or source returns false, the
+    partial results remain.
+
+    Return true iff successful and not stopped
+    */
+   bool Calculate(Algorithm alg,
+      int windowFunc, // see FFT.h for values
+      size_t windowSize, double rate,
+      const SampleSource &source, sampleCount dataLen,
+      float *pYMin = NULL, float *pYMax = NULL, // outputs
+      const ResultsReporter &report = {});
+
    const float *GetProcessed() const;
    int GetProcessedSize() const;
 
@@ -49,6 +79,12 @@ public:
    float FindPeak(float xPos, float *pY) const;
 
 private:
+   //! Average the sums over the windows, then finish for the algorithm
+   /*! Reads no members, which a reentrant Calculate may have replaced */
+   void Finish(Algorithm alg, size_t windowSize,
+      const std::vector<double> &sums, size_t windows,
+      double wss, float *pYMin, float *pYMax);
+
    float CubicInterpolate(float y0, float y1, float y2, float y3, float x) const;
    float CubicMaximize(float y0, float y1, float y2, float y3, float * max) const;
 
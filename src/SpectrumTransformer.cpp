@@ -12,6 +12,7 @@ Edward Hui
 
 #include <algorithm>
 #include "FFT.h"
+#include "Parallel.h"
 #include "WaveTrack.h"
 
 SpectrumTransformer::SpectrumTransformer( bool needsOutput,
@@ -103,7 +104,15 @@ bool SpectrumTransformer::DoFinish()
 void
 TrackSpectrumTransformer::DoOutput(const float *outBuffer, size_t mStepSize)
 {
-   mOutputTrack->Append((constSamplePtr)outBuffer, floatSample, mStepSize);
+   if (mpSegmentOutput) {
+      if (mSegmentSkip > 0)
+         --mSegmentSkip;
+      else
+         mpSegmentOutput->insert(
+            mpSegmentOutput->end(), outBuffer, outBuffer + mStepSize);
+   }
+   else
+      mOutputTrack->Append((constSamplePtr)outBuffer, floatSample, mStepSize);
 }
 
 bool SpectrumTransformer::Start(size_t queueLength)
@@ -342,6 +351,7 @@ bool TrackSpectrumTransformer::Process(const WindowProcessor &processor,
    const WaveChannel &channel, size_t queueLength, sampleCount start,
    sampleCount len)
 {
+   assert(!NeedsOutput() || mOutputTrack != nullptr);
    mpChannel = &channel;
 
    if (!Start(queueLength))
@@ -375,6 +385,102 @@ bool TrackSpectrumTransformer::DoFinish()
    return SpectrumTransformer::DoFinish();
 }
 
+bool TrackSpectrumTransformer::ProcessParallel(const Factory &factory,
+   const WindowProcessor &processor, const WaveChannel &channel,
+   size_t queueLength, size_t warmUpWindows,
+   sampleCount start, sampleCount len, const ProgressReporter &progress)
+{
+   assert(!NeedsOutput() || mOutputTrack != nullptr);
+   assert(NeedsOutput() || (warmUpWindows == 0 && queueLength == 1));
+   mpChannel = &channel;
+
+   // Indices of windows count from the first window of Process(), which may
+   // be padded; window w begins at sample (w - padSteps) * mStepSize.
+   // Segments are ranges of steps of output, or else of windows.
+   const long long stepSize = mStepSize;
+   const long long stepsPerWindow = mStepsPerWindow;
+   const long long padSteps = mLeadingPadding ? stepsPerWindow - 1 : 0;
+   const long long history = queueLength - 1;
+   const long long warmUp = warmUpWindows;
+   const long long total = len.as_long_long();
+   const long long segmentLength =
+      std::max<long long>(512, 8 * (warmUp + history + stepsPerWindow));
+   const auto nSegmentsInBatch = 2 * Parallel::DefaultConcurrency();
+
+   struct Segment {
+      std::unique_ptr<TrackSpectrumTransformer> pTransformer;
+      long long begin, end; //!< samples to read, relative to start
+      size_t skip;
+      FloatVector output;
+      bool success = false;
+   };
+
+   FloatVector buffer;
+   long long first = 0;
+   bool last = false;
+   while (!last) {
+      // Lay out the next batch of segments
+      std::vector<Segment> segments;
+      while (!last && segments.size() < nSegmentsInBatch) {
+         const auto next = first + segmentLength;
+         long long firstWindow = first, endWindow = next;
+         if (NeedsOutput()) {
+            // Output steps need the windows that overlap them, and the
+            // windows that must be in the queue with those
+            firstWindow += padSteps - (stepsPerWindow - 1) - warmUp;
+            endWindow += padSteps + history;
+         }
+         // Start as Process() does, if warm-up would reach the padding
+         const bool padded = firstWindow < padSteps;
+         const auto skipped = padded ? 0 : firstWindow - padSteps;
+         const auto begin = skipped * stepSize;
+         const auto end = (endWindow - padSteps + stepsPerWindow - 1) * stepSize;
+         last = end > total;
+         segments.push_back({
+            factory(padded && mLeadingPadding, last && mTrailingPadding),
+            begin, std::min(end, total),
+            NeedsOutput() ? size_t(first - skipped) : 0
+         });
+         first = next;
+      }
+
+      // Read all input of the batch on this thread
+      const auto batchBegin = segments.front().begin;
+      const auto batchLen = segments.back().end - batchBegin;
+      buffer.resize(batchLen);
+      channel.GetFloats(buffer.data(), start + batchBegin, batchLen);
+
+      Parallel::For(segments.size(), [&](size_t ii){
+         auto &segment = segments[ii];
+         auto &transformer = *segment.pTransformer;
+         transformer.mpSegmentOutput = &segment.output;
+         transformer.mSegmentSkip = segment.skip;
+         segment.success = transformer.Start(queueLength) &&
+            transformer.ProcessSamples(processor,
+               buffer.data() + (segment.begin - batchBegin),
+               segment.end - segment.begin) &&
+            transformer.Finish(processor);
+      });
+
+      for (auto &segment : segments) {
+         if (!segment.success)
+            return false;
+         DoMergeSegment(*segment.pTransformer);
+         if (!segment.output.empty())
+            DoOutput(segment.output.data(), segment.output.size());
+      }
+      if (!progress(std::min(1.0,
+         static_cast<double>(segments.back().end) / total)))
+         return false;
+   }
+
+   return DoFinish();
+}
+
+void TrackSpectrumTransformer::DoMergeSegment(TrackSpectrumTransformer &)
+{
+}
+
 bool TrackSpectrumTransformer::PostProcess(
    WaveTrack &outputTrack, sampleCount len)
 {
@@ -188,7 +188,8 @@ public:
    /*!
     @copydoc SpectrumTransformer::SpectrumTransformer(bool,
        eWindowFunctions, eWindowFunctions, size_t, unsigned, bool, bool)
-    @pre `!needsOutput || pOutputTrack != nullptr`
+    @pre `!needsOutput || pOutputTrack != nullptr`, except for transformers
+    made by a Factory for ProcessParallel()
     */
    TrackSpectrumTransformer(WaveChannel *pOutputTrack,
       bool needsOutput, eWindowFunctions inWindowType,
@@ -199,14 +200,44 @@ public:
       }
       , mOutputTrack{ pOutputTrack }
    {
-      assert(!needsOutput || pOutputTrack != nullptr);
    }
    ~TrackSpectrumTransformer() override;
 
+   //! Makes a transformer like this one, but with the given paddings, and no
+   //! output track, to transform one segment for ProcessParallel()
+   using Factory = std::function< std::unique_ptr<TrackSpectrumTransformer>(
+      bool leadingPadding, bool trailingPadding) >;
+
+   //! Type of function that is given the fraction of samples done
+   /*! @return false to abort processing */
+   using ProgressReporter = std::function< bool(double) >;
+
    //! Invokes Start(), ProcessSamples(), and Finish()
    bool Process(const WindowProcessor &processor, const WaveChannel &channel,
       size_t queueLength, sampleCount start, sampleCount len);
 
+   //! Like Process(), but cutting the channel into segments that are
+   //! transformed concurrently, each by a new transformer from factory
+   /*!
+    Each segment transformer also takes the warmUpWindows windows before its
+    segment, and the windows after it that the queue needs, so the output is
+    the same as from Process(), if the processor's changes to a window depend
+    on no more windows before it.  The output of segments, and the calls to
+    DoMergeSegment() and progress, are on the calling thread, in order.
+
+    Without output, segments share no windows, so the processor may not look
+    at any but the newest.
+
+    Segments have a fixed length, so even without output, results do not
+    depend on the number of threads.
+
+    @pre `NeedsOutput() || (warmUpWindows == 0 && queueLength == 1)`
+    */
+   bool ProcessParallel(const Factory &factory,
+      const WindowProcessor &processor, const WaveChannel &channel,
+      size_t queueLength, size_t warmUpWindows,
+      sampleCount start, sampleCount len, const ProgressReporter &progress);
+
    //! Final flush and trimming of tail samples
    /*!
     @pre `outputTrack.IsLeader()`
@@ -218,9 +249,19 @@ protected:
    void DoOutput(const float *outBuffer, size_t mStepSize) override;
    bool DoFinish() override;
 
+   //! Called by ProcessParallel() after each segment is transformed, to
+   //! gather information from the segment transformer
+   /*! Default implementation does nothing */
+   virtual void DoMergeSegment(TrackSpectrumTransformer &segment);
+
 private:
    WaveChannel *const mOutputTrack;
    const WaveChannel *mpChannel = nullptr;
+
+   //! When transforming a segment, output goes here, after skipping the
+   //! output steps for the warm-up windows
+   FloatVector *mpSegmentOutput = nullptr;
+   size_t mSegmentSkip = 0;
 };
 
 #endif
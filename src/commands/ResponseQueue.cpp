@@ -36,10 +36,9 @@ void ResponseQueue::AddResponse(Response response)
 Response ResponseQueue::WaitAndGetResponse()
 {
    wxMutexLocker locker(mMutex);
-   if (mResponses.empty())
-   {
+   // Guard against spurious wake-ups
+   while (mResponses.empty())
       mCondition.Wait();
-   }
    wxASSERT(!mResponses.empty());
    Response msg = mResponses.front();
    mResponses.pop();
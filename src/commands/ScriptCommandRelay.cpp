@@ -25,40 +25,70 @@ code out of ModuleManager.
 #include "CommandBuilder.h"
 #include "ActiveProject.h"
 #include "AppCommandEvent.h"
+#include "BasicUI.h"
 #include "Project.h"
 #include <wx/app.h>
+#include <wx/arrstr.h>
+#include <future>
 #include <thread>
 
-/// This is the function which actually obeys one command.
-static int ExecCommand(wxString *pIn, wxString *pOut, bool fromMain)
+/// Obeys commands in order, in the main thread, and returns their responses.
+/// Each command applies to the project that is active when it starts, which
+/// an earlier command may have changed.
+static wxArrayString ObeyCommands(const wxArrayString &commands)
 {
-   if (auto pProject = ::GetActiveProject().lock()) {
-      CommandBuilder builder(*pProject, *pIn);
+   wxArrayString responses;
+   for (const auto &command : commands) {
+      const auto pProject = ::GetActiveProject().lock();
+      if (!pProject) {
+         responses.push_back({});
+         continue;
+      }
+      CommandBuilder builder(*pProject, command);
       if (builder.WasValid())
       {
-         OldStyleCommandPointer cmd = builder.GetCommand();
-
          AppCommandEvent ev;
-         ev.SetCommand(cmd);
-
-         if (fromMain)
-         {
-            // Use SafelyProcessEvent, which stops exceptions, because this is
-            // expected to be reached from within the XLisp runtime
-            wxTheApp->SafelyProcessEvent(ev);
-         }
-         else
-         {
-            // Send the event to the main thread
-            wxTheApp->AddPendingEvent(ev);
-         }
+         ev.SetCommand(builder.GetCommand());
+
+         // Use SafelyProcessEvent, which stops exceptions, because this is
+         // also reached from within the XLisp runtime
+         wxTheApp->SafelyProcessEvent(ev);
       }
+      responses.push_back(builder.GetResponse());
+   }
+   return responses;
+}
 
-      // Wait for and retrieve the response
-      *pOut = builder.GetResponse();
+/// This is the function which actually obeys commands.  From the worker
+/// thread, several commands, one to a line, make a batch, which costs only
+/// one trip to the main thread.
+static int ExecCommand(wxString *pIn, wxString *pOut, bool fromMain)
+{
+   pOut->clear();
+   const bool batch = !fromMain && pIn->Contains(wxT('\n'));
+   wxArrayString commands;
+   if (batch)
+      commands = wxSplit(*pIn, wxT('\n'), wxT('\0'));
+   else
+      commands.push_back(*pIn);
+
+   wxArrayString responses;
+   if (fromMain)
+      responses = ObeyCommands(commands);
+   else {
+      // Send all the commands to the main thread in one action, and wait here
+      // for the responses
+      std::promise<wxArrayString> promise;
+      auto future = promise.get_future();
+      BasicUI::CallAfter([&]{ promise.set_value(ObeyCommands(commands)); });
+      responses = future.get();
    }
+
+   if (!batch)
+      *pOut = responses[0];
    else
-      *pOut = wxString{};
+      for (const auto &response : responses)
+         *pOut << response.length() << SCRIPT_BATCH_LENGTH_END << response;
 
    return 0;
 }
@@ -22,6 +22,13 @@
 
 class wxString;
 
+//! Several commands may be passed in one call of the script server function,
+//! one to a line; they are sent to the main thread together, and their
+//! responses come back in order, each as its length in characters, in decimal
+//! digits, then this character, then the response, which may contain any
+//! characters; a single command, with no line break, gets its response alone
+#define SCRIPT_BATCH_LENGTH_END wxT(':')
+
 typedef int(*tpExecScriptServerFunc)(wxString * pIn, wxString * pOut);
 typedef int(*tpRegScriptServerFunc)(tpExecScriptServerFunc pFn);
 
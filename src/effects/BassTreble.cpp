@@ -144,8 +144,6 @@ struct EffectBassTreble::Instance
    static void Coefficients(double hz, double slope, double gain, double samplerate, int type,
       double& a0, double& a1, double& a2, double& b0, double& b1, double& b2);
 
-   static float DoFilter(EffectBassTrebleState& data, float in);
-
    EffectBassTrebleState mState;
    std::vector<EffectBassTreble::Instance> mSlaves;
 };
@@ -404,15 +402,7 @@ void EffectBassTreble::Instance::InstanceInit(EffectSettings& settings, EffectBa
    data.b1Treble = 0;
    data.b2Treble = 0;
 
-   data.xn1Bass = 0;
-   data.xn2Bass = 0;
-   data.yn1Bass = 0;
-   data.yn2Bass = 0;
-
-   data.xn1Treble = 0;
-   data.xn2Treble = 0;
-   data.yn1Treble = 0;
-   data.yn2Treble = 0;
+   data.filter.Reset();
 
    data.bass = -1;
    data.treble = -1;
@@ -435,20 +425,40 @@ size_t EffectBassTreble::Instance::InstanceProcess(EffectSettings &settings,
 
    data.gain = DB_TO_LINEAR(ms.mGain);
 
+   const bool changed = data.bass != oldBass || data.treble != oldTreble;
+
    // Compute coefficients of the low shelf biquand IIR filter
-   if (data.bass != oldBass)
+   if (data.bass != oldBass) {
       Coefficients(data.hzBass, data.slope, ms.mBass, data.samplerate, kBass,
                   data.a0Bass, data.a1Bass, data.a2Bass,
                   data.b0Bass, data.b1Bass, data.b2Bass);
+      data.bass = oldBass;
+   }
 
    // Compute coefficients of the high shelf biquand IIR filter
-   if (data.treble != oldTreble)
+   if (data.treble != oldTreble) {
       Coefficients(data.hzTreble, data.slope, ms.mTreble, data.samplerate, kTreble,
                   data.a0Treble, data.a1Treble, data.a2Treble,
                   data.b0Treble, data.b1Treble, data.b2Treble);
+      data.treble = oldTreble;
+   }
+
+   // The filter keeps its histories when only coefficients change
+   if (changed) {
+      const BiquadCascade::Section sections[] {
+         { data.b0Bass / data.a0Bass, data.b1Bass / data.a0Bass,
+           data.b2Bass / data.a0Bass,
+           data.a1Bass / data.a0Bass, data.a2Bass / data.a0Bass },
+         { data.b0Treble / data.a0Treble, data.b1Treble / data.a0Treble,
+           data.b2Treble / data.a0Treble,
+           data.a1Treble / data.a0Treble, data.a2Treble / data.a0Treble },
+      };
+      data.filter.SetSections(sections, 2);
+   }
 
+   data.filter.Process(&ibuf, &obuf, blockLen);
    for (decltype(blockLen) i = 0; i < blockLen; i++) {
-      obuf[i] = DoFilter(data, ibuf[i]) * data.gain;
+      obuf[i] *= data.gain;
    }
 
    return blockLen;
@@ -487,29 +497,6 @@ void EffectBassTreble::Instance::Coefficients(double hz, double slope, double ga
    }
 }
 
-float EffectBassTreble::Instance::DoFilter(EffectBassTrebleState & data, float in)
-{
-   // Bass filter
-   float out = (data.b0Bass * in + data.b1Bass * data.xn1Bass + data.b2Bass * data.xn2Bass -
-         data.a1Bass * data.yn1Bass - data.a2Bass * data.yn2Bass) / data.a0Bass;
-   data.xn2Bass = data.xn1Bass;
-   data.xn1Bass = in;
-   data.yn2Bass = data.yn1Bass;
-   data.yn1Bass = out;
-
-   // Treble filter
-   in = out;
-   out = (data.b0Treble * in + data.b1Treble * data.xn1Treble + data.b2Treble * data.xn2Treble -
-         data.a1Treble * data.yn1Treble - data.a2Treble * data.yn2Treble) / data.a0Treble;
-   data.xn2Treble = data.xn1Treble;
-   data.xn1Treble = in;
-   data.yn2Treble = data.yn1Treble;
-   data.yn1Treble = out;
-
-   return out;
-}
-
-
 void EffectBassTreble::Editor::OnBassText(wxCommandEvent & WXUNUSED(evt))
 {
    auto& ms = mSettings;
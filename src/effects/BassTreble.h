@@ -12,6 +12,7 @@
 #ifndef __AUDACITY_EFFECT_BASS_TREBLE__
 #define __AUDACITY_EFFECT_BASS_TREBLE__
 
+#include "BiquadCascade.h"
 #include "StatelessPerTrackEffect.h"
 #include "ShuttleAutomation.h"
 
@@ -27,8 +28,8 @@ public:
    double slope, hzBass, hzTreble;
    double a0Bass, a1Bass, a2Bass, b0Bass, b1Bass, b2Bass;
    double a0Treble, a1Treble, a2Treble, b0Treble, b1Treble, b2Treble;
-   double xn1Bass, xn2Bass, yn1Bass, yn2Bass;
-   double xn1Treble, xn2Treble, yn1Treble, yn2Treble;
+   //! The low shelf, then the high shelf
+   BiquadCascade filter;
 };
 
 
@@ -42,6 +42,8 @@
 #include "WaveClip.h"
 #include "WaveTrack.h"
 
+#include "SegmentedOverlapAdd.h"
+
 const EffectParameterMethods& EffectEqualization::Parameters() const
 {
    static CapturedParameters<EffectEqualization,
@@ -363,14 +365,36 @@ bool EffectEqualization::Init()
    return(true);
 }
 
+//! Convolves one channel with the filter, and appends the result
+/*!
+ The filtering is done by SegmentedOverlapAdd, on several threads.
+ */
 struct EffectEqualization::Task {
-   Task(size_t M, size_t idealBlockLen, WaveChannel &channel)
-      : buffer{ idealBlockLen }
-      , idealBlockLen{ idealBlockLen }
-      , output{ channel }
-      , leftTailRemaining{ (M - 1) / 2 }
+   static constexpr auto windowSize = EqualizationFilter::windowSize;
+
+   Task(const EqualizationFilter &filter, WaveChannel &channel)
+      : overlapAdd{ windowSize, filter.mM,
+         [&filter](float *window, float *scratch){
+            filter.Filter(windowSize, window, scratch);
+         } }
+      , idealBlockLen{ overlapAdd.BlockLen() }
+      , outputChannel{ channel }
+      , leftTailRemaining{ (filter.mM - 1) / 2 }
+   {
+   }
+
+   //! Filter len samples from the buffer, which are not more than
+   //! idealBlockLen, and append them to the output, except for the last M - 1
+   void FilterBlock(size_t len)
    {
-      memset(lastWindow, 0, windowSize * sizeof(float));
+      AccumulateSamples((constSamplePtr)overlapAdd.FilterBlock(len), len);
+   }
+
+   //! Append the last M - 1 samples, after all input
+   void Finish()
+   {
+      AccumulateSamples((constSamplePtr)overlapAdd.Finish(),
+         overlapAdd.TailLen());
    }
 
    void AccumulateSamples(constSamplePtr buffer, size_t len)
@@ -379,23 +403,15 @@ struct EffectEqualization::Task {
       leftTailRemaining -= leftTail;
       len -= leftTail;
       buffer += leftTail * sizeof(float);
-      output.Append(buffer, floatSample, len);
+      outputChannel.Append(buffer, floatSample, len);
    }
 
-   static constexpr auto windowSize = EqualizationFilter::windowSize;
-   Floats window1{ windowSize };
-   Floats window2{ windowSize };
-
-   Floats buffer;
+   SegmentedOverlapAdd overlapAdd;
    const size_t idealBlockLen;
 
-   // These pointers are swapped after each FFT window
-   float *thisWindow{ window1.get() };
-   float *lastWindow{ window2.get() };
-
    // a new WaveChannel to hold all of the output,
    // including 'tails' each end
-   WaveChannel &output;
+   WaveChannel &outputChannel;
 
    size_t leftTailRemaining;
 };
@@ -424,17 +440,9 @@ bool EffectEqualization::Process(EffectInstance &, EffectSettings &)
          auto iter0 = pTempTrack->Channels().begin();
 
          for (const auto pChannel : track->Channels()) {
-            constexpr auto windowSize = EqualizationFilter::windowSize;
-            const auto &M = mParameters.mM;
-
-            wxASSERT(M - 1 < windowSize);
-            size_t L = windowSize - (M - 1);   //Process L samples at a go
-            auto s = start;
-            auto idealBlockLen = pChannel->GetMaxBlockSize() * 4;
-            if (idealBlockLen % L != 0)
-               idealBlockLen += (L - (idealBlockLen % L));
+            wxASSERT(mParameters.mM - 1 < EqualizationFilter::windowSize);
             auto pNewChannel = *iter0++;
-            Task task{ M, idealBlockLen, *pNewChannel };
+            Task task{ mParameters, *pNewChannel };
             bGoodResult = ProcessOne(task, count, *pChannel, start, len);
             if (!bGoodResult)
                goto done;
@@ -476,82 +484,26 @@ bool EffectEqualization::TransferDataToWindow(const EffectSettings &settings)
 bool EffectEqualization::ProcessOne(Task &task,
    int count, const WaveChannel &t, sampleCount start, sampleCount len)
 {
-   constexpr auto windowSize = EqualizationFilter::windowSize;
-
-   const auto &M = mParameters.mM;
-
-   wxASSERT(M - 1 < windowSize);
-   size_t L = windowSize - (M - 1);   //Process L samples at a go
    auto s = start;
-
-   auto &buffer = task.buffer;
-   auto &window1 = task.window1;
-   auto &window2 = task.window2;
-   auto &thisWindow = task.thisWindow;
-   auto &lastWindow = task.lastWindow;
-
    auto originalLen = len;
 
-   auto &output = task.output;
-
    TrackProgress(count, 0.);
-   bool bLoopSuccess = true;
-   size_t wcopy = 0;
 
    while (len != 0)
    {
       auto block = limitSampleBufferSize( task.idealBlockLen, len );
 
-      t.GetFloats(buffer.get(), s, block);
-
-      for(size_t i = 0; i < block; i += L)   //go through block in lumps of length L
-      {
-         wcopy = std::min <size_t> (L, block - i);
-         for(size_t j = 0; j < wcopy; j++)
-            thisWindow[j] = buffer[i+j];   //copy the L (or remaining) samples
-         for(auto j = wcopy; j < windowSize; j++)
-            thisWindow[j] = 0;   //this includes the padding
-
-         mParameters.Filter(windowSize, thisWindow);
-
-         // Overlap - Add
-         for(size_t j = 0; (j < M - 1) && (j < wcopy); j++)
-            buffer[i+j] = thisWindow[j] + lastWindow[L + j];
-         for(size_t j = M - 1; j < wcopy; j++)
-            buffer[i+j] = thisWindow[j];
-
-         std::swap( thisWindow, lastWindow );
-      }  //next i, lump of this block
-
-      task.AccumulateSamples((samplePtr)buffer.get(), block);
+      t.GetFloats(task.overlapAdd.Buffer(), s, block);
+      task.FilterBlock(block);
       len -= block;
       s += block;
 
       if (TrackProgress(count, ( s - start ).as_double() /
                         originalLen.as_double()))
-      {
-         bLoopSuccess = false;
-         break;
-      }
+         return false;
    }
 
-   if (bLoopSuccess) {
-      // M-1 samples of 'tail' left in lastWindow, get them now
-      if(wcopy < (M - 1)) {
-         // Still have some overlap left to process
-         // (note that lastWindow and thisWindow have been exchanged at this point
-         //  so that 'thisWindow' is really the window prior to 'lastWindow')
-         size_t j = 0;
-         for(; j < M - 1 - wcopy; j++)
-            buffer[j] = lastWindow[wcopy + j] + thisWindow[L + wcopy + j];
-         // And fill in the remainder after the overlap
-         for( ; j < M - 1; j++)
-            buffer[j] = lastWindow[wcopy + j];
-      } else {
-         for(size_t j = 0; j < M - 1; j++)
-            buffer[j] = lastWindow[wcopy + j];
-      }
-      task.AccumulateSamples((samplePtr)buffer.get(), M - 1);
-   }
-   return bLoopSuccess;
+   // M-1 samples of 'tail' are left over; get them now
+   task.Finish();
+   return true;
 }
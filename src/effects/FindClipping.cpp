@@ -155,6 +155,28 @@ bool EffectFindClipping::ProcessOne(LabelTrack &lt,
    decltype(len) s = 0, startrun = 0, stoprun = 0, samps = 0;
    decltype(blockSize) block = 0;
    double startTime = -1.0;
+   // Samples before this were already checked against block statistics
+   decltype(len) checked = 0;
+
+   // Label the run of clipping that ends mStop samples before sample s
+   const auto addLabel = [&]{
+      lt.AddLabel(
+         SelectedRegion(startTime,
+            wt.LongSamplesToTime(start + s - mStop)),
+         /*!
+          i18n-hint: Two numbers are substituted; the second is the
+          size of a set, the first is the size of a subset, and not
+          understood as an ordinal (i.e., not meaning "first", or
+          "second", etc.)
+          */
+         XC("%lld of %lld", "find clipping")
+            .Format(startrun.as_long_long(),
+               (samps - mStop).as_long_long())
+            .Translation());
+      startrun = 0;
+      stoprun = 0;
+      samps = 0;
+   };
 
    while (s < len) {
       if (block == 0) {
@@ -162,7 +184,38 @@ bool EffectFindClipping::ProcessOne(LabelTrack &lt,
             bGoodResult = false;
             break;
          }
-         block = limitSampleBufferSize( blockSize, len - s );
+
+         if (s >= checked) {
+            // Skip the samples of sample blocks that statistics show to be
+            // without clipping, doing what the loop below would do for them
+            const auto best =
+               limitSampleBufferSize(wt.GetBestBlockSize(start + s), len - s);
+            const auto stats = wt.GetStats(start + s, best);
+            if (stats && stats->clipped == 0) {
+               if (startrun >= mStart) {
+                  const auto needed = mStop - stoprun;
+                  if (best >= needed) {
+                     s += needed - 1;
+                     samps += needed;
+                     addLabel();
+                     s += best - needed + 1;
+                  }
+                  else {
+                     stoprun += best;
+                     samps += best;
+                     s += best;
+                  }
+               }
+               else {
+                  startrun = 0;
+                  s += best;
+               }
+               continue;
+            }
+            checked = s + best;
+         }
+
+         block = limitSampleBufferSize( blockSize, checked - s );
          wt.GetFloats(buffer.get(), start + s, block);
          ptr = buffer.get();
       }
@@ -182,24 +235,8 @@ bool EffectFindClipping::ProcessOne(LabelTrack &lt,
          if (startrun >= mStart) {
             stoprun++;
             samps++;
-            if (stoprun >= mStop) {
-               lt.AddLabel(
-                  SelectedRegion(startTime,
-                     wt.LongSamplesToTime(start + s - mStop)),
-                  /*!
-                   i18n-hint: Two numbers are substituted; the second is the
-                   size of a set, the first is the size of a subset, and not
-                   understood as an ordinal (i.e., not meaning "first", or
-                   "second", etc.)
-                   */
-                  XC("%lld of %lld", "find clipping")
-                     .Format(startrun.as_long_long(),
-                        (samps - mStop).as_long_long())
-                     .Translation());
-               startrun = 0;
-               stoprun = 0;
-               samps = 0;
-            }
+            if (stoprun >= mStop)
+               addLabel();
          }
          else
             startrun = 0;
@@ -447,19 +447,14 @@ bool EffectLoudness::ProcessOne(WaveChannel &track, size_t nChannels,
 void EffectLoudness::LoadBufferBlock(WaveChannel &track, size_t nChannels,
    sampleCount pos, size_t len)
 {
-   size_t idx = 0;
-   const auto getOne = [&](WaveChannel &channel) {
-      // Get the samples from the track and put them in the buffer
-      channel.GetFloats(mTrackBuffer[idx].get(), pos, len);
-   };
-
+   // Get the samples from the track and put them in the buffer
    if (nChannels == 1)
-      getOne(track);
-   else
-      for (const auto channel : track.GetTrack().Channels()) {
-         getOne(*channel);
-         ++idx;
-      }
+      track.GetFloats(mTrackBuffer[0].get(), pos, len);
+   else {
+      // Read all channels in one pass
+      float *const buffers[]{ mTrackBuffer[0].get(), mTrackBuffer[1].get() };
+      track.GetTrack().GetFloats(0, nChannels, buffers, pos, len);
+   }
    mTrackBufferLen = len;
 }
 
@@ -467,13 +462,9 @@ void EffectLoudness::LoadBufferBlock(WaveChannel &track, size_t nChannels,
 /// (for loudness).
 bool EffectLoudness::AnalyseBufferBlock(EBUR128 &loudnessProcessor)
 {
-   for(size_t i = 0; i < mTrackBufferLen; i++)
-   {
-      loudnessProcessor.ProcessSampleFromChannel(mTrackBuffer[0][i], 0);
-      if (mProcStereo)
-         loudnessProcessor.ProcessSampleFromChannel(mTrackBuffer[1][i], 1);
-      loudnessProcessor.NextSample();
-   }
+   const float *const channels[] { mTrackBuffer[0].get(),
+      mProcStereo ? mTrackBuffer[1].get() : nullptr };
+   loudnessProcessor.ProcessSamples(channels, mTrackBufferLen);
 
    if (!UpdateProgress())
       return false;
@@ -262,6 +262,8 @@ struct MyTransformer : TrackSpectrumTransformer {
          windowSize, stepsPerWindow, leadingPadding, trailingPadding
       }
       , mWorker{ worker }
+      , mSums( windowSize / 2 + 1 )
+      , mFreqSmoothingScratch( windowSize / 2 + 1 )
    {
    }
    struct MyWindow : public Window
@@ -280,9 +282,15 @@ struct MyTransformer : TrackSpectrumTransformer {
    MyWindow &NthWindow(int nn) { return static_cast<MyWindow&>(Nth(nn)); }
    std::unique_ptr<Window> NewWindow(size_t windowSize) override;
    bool DoStart() override;
-   bool DoFinish() override;
+   void DoMergeSegment(TrackSpectrumTransformer &segment) override;
 
    EffectNoiseReduction::Worker &mWorker;
+
+   // Statistics of the windows of one segment
+   unsigned mWindows = 0;
+   FloatVector mSums;
+
+   FloatVector mFreqSmoothingScratch;
 };
 
 //----------------------------------------------------------------------------
@@ -309,7 +317,7 @@ public:
 
    static bool Processor(SpectrumTransformer &transformer);
 
-   void ApplyFreqSmoothing(FloatVector &gains);
+   void ApplyFreqSmoothing(FloatVector &gains, FloatVector &scratch);
    void GatherStatistics(MyTransformer &transformer);
    inline bool Classify(
       MyTransformer &transformer, unsigned nWindows, int band);
@@ -322,7 +330,6 @@ public:
    const Settings &mSettings;
    Statistics &mStatistics;
 
-   FloatVector mFreqSmoothingScratch;
    const size_t mFreqSmoothingBins;
    // When spectral selection limits the affected band:
    size_t mBinLow;  // inclusive lower bound
@@ -340,11 +347,11 @@ public:
    unsigned  mNWindowsToExamine;
    unsigned  mCenter;
    unsigned  mHistoryLen;
+   // Windows to process before a segment, for the same gains as in serial
+   unsigned  mWarmUpWindows;
 
    // Following are for progress indicator only:
    unsigned  mProgressTrackCount = 0;
-   sampleCount mLen = 0;
-   sampleCount mProgressWindowCount = 0;
 };
 
 /****************************************************************//**
@@ -724,7 +731,6 @@ bool EffectNoiseReduction::Worker::Process(
 {
    mProgressTrackCount = 0;
    for (auto track : tracks.Selected<WaveTrack>()) {
-      mProgressWindowCount = 0;
       if (track->GetRate() != mStatistics.mRate) {
          if (mDoProfile)
             EffectUIServices::DoMessageBox(mEffect,
@@ -745,16 +751,6 @@ bool EffectNoiseReduction::Worker::Process(
          auto start = track->TimeToLongSamples(t0);
          auto end = track->TimeToLongSamples(t1);
          const auto len = end - start;
-         mLen = len;
-         const auto extra =
-            (mSettings.StepsPerWindow() - 1) * mSettings.SpectrumSize();
-         // Adjust denominator for presence or absence of padding,
-         // which makes the number of windows visited either more or less
-         // than the number of window steps in the data.
-         if (mDoProfile)
-            mLen -= extra;
-         else
-            mLen += extra;
 
          auto t0 = track->LongSamplesToTime(start);
          auto tLen = track->LongSamplesToTime(len);
@@ -766,6 +762,16 @@ bool EffectNoiseReduction::Worker::Process(
             pFirstTrack = *(*ppTempList)->Any<WaveTrack>().begin();
             pIter.emplace(pFirstTrack->Channels().begin());
          }
+         const auto factory = [&](bool leadingPadding, bool trailingPadding){
+            return std::make_unique<MyTransformer>(*this, nullptr,
+               !mSettings.mDoProfile, inWindowType, outWindowType,
+               mSettings.WindowSize(), mSettings.StepsPerWindow(),
+               leadingPadding, trailingPadding);
+         };
+         const auto progress = [&](double fraction){
+            // Let user cancel
+            return !mEffect.TrackProgress(mProgressTrackCount, fraction);
+         };
          for (const auto pChannel : track->Channels()) {
             auto pOutputTrack = pIter ? *(*pIter)++ : nullptr;
             MyTransformer transformer{ *this, pOutputTrack.get(),
@@ -773,9 +779,12 @@ bool EffectNoiseReduction::Worker::Process(
                mSettings.WindowSize(), mSettings.StepsPerWindow(),
                !mSettings.mDoProfile, !mSettings.mDoProfile
             };
-            if (!transformer
-               .Process(Processor, *pChannel, mHistoryLen, start, len))
+            if (!transformer.ProcessParallel(factory, Processor, *pChannel,
+               mHistoryLen, mDoProfile ? 0 : mWarmUpWindows, start, len,
+               progress))
                return false;
+            if (mDoProfile)
+               FinishTrackStatistics();
             ++mProgressTrackCount;
          }
          if (ppTempList) {
@@ -799,7 +808,8 @@ bool EffectNoiseReduction::Worker::Process(
    return true;
 }
 
-void EffectNoiseReduction::Worker::ApplyFreqSmoothing(FloatVector &gains)
+void EffectNoiseReduction::Worker::ApplyFreqSmoothing(
+   FloatVector &gains, FloatVector &scratch)
 {
    // Given an array of gain mutipliers, average them
    // GEOMETRICALLY.  Don't multiply and take nth root --
@@ -811,7 +821,7 @@ void EffectNoiseReduction::Worker::ApplyFreqSmoothing(FloatVector &gains)
    const auto spectrumSize = mSettings.SpectrumSize();
 
    {
-      auto pScratch = mFreqSmoothingScratch.data();
+      auto pScratch = scratch.data();
       std::fill(pScratch, pScratch + spectrumSize, 0.0f);
    }
 
@@ -823,13 +833,13 @@ void EffectNoiseReduction::Worker::ApplyFreqSmoothing(FloatVector &gains)
       const int j0 = std::max(0, ii - (int)mFreqSmoothingBins);
       const int j1 = std::min(spectrumSize - 1, ii + mFreqSmoothingBins);
       for(int jj = j0; jj <= j1; ++jj) {
-         mFreqSmoothingScratch[ii] += gains[jj];
+         scratch[ii] += gains[jj];
       }
-      mFreqSmoothingScratch[ii] /= (j1 - j0 + 1);
+      scratch[ii] /= (j1 - j0 + 1);
    }
 
    for (size_t ii = 0; ii < spectrumSize; ++ii)
-      gains[ii] = exp(mFreqSmoothingScratch[ii]);
+      gains[ii] = exp(scratch[ii]);
 }
 
 EffectNoiseReduction::Worker::Worker(EffectNoiseReduction &effect,
@@ -844,7 +854,6 @@ EffectNoiseReduction::Worker::Worker(EffectNoiseReduction &effect,
 , mSettings{ settings }
 , mStatistics{ statistics }
 
-, mFreqSmoothingScratch(mSettings.SpectrumSize())
 , mFreqSmoothingBins{ size_t(std::max(0.0, settings.mFreqSmoothingBands)) }
 , mBinLow{ 0 }
 , mBinHigh{ mSettings.SpectrumSize() }
@@ -902,6 +911,20 @@ EffectNoiseReduction::Worker::Worker(EffectNoiseReduction &effect,
       // See ReduceNoise()
       mHistoryLen = std::max(mNWindowsToExamine, mCenter + nAttackBlocks);
    }
+
+   // Each window's gains are raised by the release of the previous window,
+   // in a decay that stops mattering when it falls to mNoiseAttenFactor;
+   // count the steps of the slowest decay, from a gain of one, in the same
+   // arithmetic.  Then allow for the queue, in which windows affect others.
+   unsigned releaseWindows = 0;
+   for (float gain = 1.0; gain > mNoiseAttenFactor; ++releaseWindows) {
+      const float next = gain * mOneBlockRelease;
+      // A release too slow for float to express cannot decay
+      if (!(next < gain))
+         break;
+      gain = next;
+   }
+   mWarmUpWindows = releaseWindows + mHistoryLen + mSettings.StepsPerWindow();
 }
 
 bool MyTransformer::DoStart()
@@ -939,11 +962,16 @@ bool EffectNoiseReduction::Worker::Processor(SpectrumTransformer &trans)
    else
       worker.ReduceNoise(transformer);
 
-   // Update the Progress meter, let user cancel
-   return !worker.mEffect.TrackProgress(worker.mProgressTrackCount,
-      std::min(1.0,
-         ((++worker.mProgressWindowCount).as_double() *
-          worker.mSettings.StepSize()) / worker.mLen.as_double()));
+   return true;
+}
+
+void MyTransformer::DoMergeSegment(TrackSpectrumTransformer &segment)
+{
+   auto &mySegment = static_cast<MyTransformer &>(segment);
+   auto &statistics = mWorker.mStatistics;
+   statistics.mTrackWindows += mySegment.mWindows;
+   for (size_t ii = 0, nn = mySegment.mSums.size(); ii < nn; ++ii)
+      statistics.mSums[ii] += mySegment.mSums[ii];
 }
 
 void EffectNoiseReduction::Worker::FinishTrackStatistics()
@@ -969,12 +997,13 @@ void EffectNoiseReduction::Worker::FinishTrackStatistics()
 
 void EffectNoiseReduction::Worker::GatherStatistics(MyTransformer &transformer)
 {
-   ++mStatistics.mTrackWindows;
+   // Sum in the transformer of one segment, to be merged in order
+   ++transformer.mWindows;
 
    {
       // NEW statistics
       auto pPower = transformer.NthWindow(0).mSpectrums.data();
-      auto pSum = mStatistics.mSums.data();
+      auto pSum = transformer.mSums.data();
       for (size_t jj = 0; jj < mSettings.SpectrumSize(); ++jj) {
          *pSum++ += *pPower++;
       }
@@ -1169,7 +1198,7 @@ void EffectNoiseReduction::Worker::ReduceNoise(MyTransformer &transformer)
       if (mNoiseReductionChoice != NRC_ISOLATE_NOISE)
          // Apply frequency smoothing to output gain
          // Gains are not less than mNoiseAttenFactor
-         ApplyFreqSmoothing(record.mGains);
+         ApplyFreqSmoothing(record.mGains, transformer.mFreqSmoothingScratch);
 
       // Apply gain to FFT
       {
@@ -1203,13 +1232,6 @@ void EffectNoiseReduction::Worker::ReduceNoise(MyTransformer &transformer)
    }
 }
 
-bool MyTransformer::DoFinish()
-{
-   if (mWorker.mDoProfile)
-      mWorker.FinishTrackStatistics();
-   return TrackSpectrumTransformer::DoFinish();
-}
-
 //----------------------------------------------------------------------------
 // EffectNoiseReduction::Dialog
 //----------------------------------------------------------------------------
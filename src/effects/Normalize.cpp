@@ -171,41 +171,25 @@ bool EffectNormalize::Process(EffectInstance &, EffectSettings &)
                      .Format(trackName);
          }
 
-         if (oneChannel) {
-            if (TrackList::NChannels(*track) == 1)
-               // really mono
-               msg = topMsg +
-                  XO("Processing: %s").Format(trackName);
-            else
-               //'stereo tracks independently'
-               // TODO: more-than-two-channels-message
-               msg = topMsg +
-                  XO("Processing stereo channels independently: %s")
-                     .Format(trackName);
-         }
-         else
-            msg = topMsg +
-               // TODO: more-than-two-channels-message
-               XO("Processing first track of stereo pair: %s")
-                  .Format(trackName);
-
-         // Use multiplier in the second, processing loop over channels
-         auto pOffset = offsets.begin();
-         auto pExtent = extents.begin();
-         for (const auto channel : channels) {
-            const auto extent = oneChannel ? *pExtent++: maxExtent;
-            if ((extent > 0) && mGain)
-               mMult = ratio / extent;
-            else
-               mMult = 1.0;
-            if (false ==
-                (bGoodResult = ProcessOne(*channel, msg, progress, *pOffset++)))
-               goto break2;
+         if (oneChannel && channels.size() > 1)
+            //'stereo tracks independently'
             // TODO: more-than-two-channels-message
             msg = topMsg +
-               XO("Processing second track of stereo pair: %s")
+               XO("Processing stereo channels independently: %s")
                   .Format(trackName);
+         else
+            msg = topMsg +
+               XO("Processing: %s").Format(trackName);
+
+         // Use multipliers in the second, processing pass over all channels
+         std::vector<float> mults;
+         for (const auto extent : extents) {
+            const auto used = oneChannel ? extent : maxExtent;
+            mults.push_back(((used > 0) && mGain) ? ratio / used : 1.0);
          }
+         if (false ==
+             (bGoodResult = ProcessOne(*track, msg, progress, offsets, mults)))
+            goto break2;
       }
    }
 
@@ -366,14 +350,20 @@ bool EffectNormalize::AnalyseTrackData(const WaveChannel &track,
          end - s
       );
 
-      //Get the samples from the track and put them in the buffer
-      track.GetFloats(
-         buffer.get(), s, block, FillFormat::fillZero, true, &blockSamples);
+      //Use the sum of the samples, found from statistics of whole sample
+      //blocks where possible
+      if (const auto stats = track.GetStats(s, block, true, &blockSamples))
+         sum += stats->sum;
+      else {
+         //Get the samples from the track and put them in the buffer
+         track.GetFloats(
+            buffer.get(), s, block, FillFormat::fillZero, true, &blockSamples);
+
+         //Process the buffer.
+         sum = AnalyseDataDC(buffer.get(), block, sum);
+      }
       totalSamples += blockSamples;
 
-      //Process the buffer.
-      sum = AnalyseDataDC(buffer.get(), block, sum);
-
       //Increment s one blockfull of samples
       s += block;
 
@@ -395,10 +385,10 @@ bool EffectNormalize::AnalyseTrackData(const WaveChannel &track,
 
 //ProcessOne() takes a track, transforms it to bunch of buffer-blocks,
 //and executes ProcessData, on it...
-// uses mMult and offset to normalize a track.
-// mMult must be set before this is called
-bool EffectNormalize::ProcessOne(WaveChannel &track,
-   const TranslatableString &msg, double &progress, float offset)
+// uses the offset and multiplier of each channel to normalize a track.
+bool EffectNormalize::ProcessOne(WaveTrack &track,
+   const TranslatableString &msg, double &progress,
+   const std::vector<float> &offsets, const std::vector<float> &mults)
 {
    bool rc = true;
 
@@ -411,9 +401,16 @@ bool EffectNormalize::ProcessOne(WaveChannel &track,
    //to make it a double now than it is to do it later
    auto len = (end - start).as_double();
 
-   //Initiate a processing buffer.  This buffer will (most likely)
-   //be shorter than the length of the track being processed.
-   Floats buffer{ track.GetMaxBlockSize() };
+   //Initiate a processing buffer for each channel.  These buffers will
+   //(most likely) be shorter than the length of the track being processed.
+   const auto channels = track.Channels();
+   const auto nChannels = channels.size();
+   std::vector<Floats> buffers(nChannels);
+   std::vector<float *> pointers;
+   for (auto &buffer : buffers) {
+      buffer.reinit(track.GetMaxBlockSize());
+      pointers.push_back(buffer.get());
+   }
 
    //Go through the track one buffer at a time. s counts which
    //sample the current buffer starts at.
@@ -426,29 +423,37 @@ bool EffectNormalize::ProcessOne(WaveChannel &track,
          end - s
       );
 
-      //Get the samples from the track and put them in the buffer
-      track.GetFloats(buffer.get(), s, block);
+      //Get the samples of all channels in one pass, and put them in the
+      //buffers
+      track.GetFloats(0, nChannels, pointers.data(), s, block);
 
-      //Process the buffer.
-      ProcessData(buffer.get(), block, offset);
+      size_t iChannel = 0;
+      for (const auto channel : channels) {
+         //Process the buffer.
+         ProcessData(pointers[iChannel], block,
+            offsets[iChannel], mults[iChannel]);
 
-      //Copy the newly-changed samples back onto the track.
-      if (!track.Set((samplePtr) buffer.get(), floatSample, s, block)) {
-         rc = false;
-         break;
+         //Copy the newly-changed samples back onto the track.
+         if (!channel->Set((samplePtr) pointers[iChannel], floatSample, s, block)) {
+            rc = false;
+            break;
+         }
+         ++iChannel;
       }
+      if (!rc)
+         break;
 
       //Increment s one blockfull of samples
       s += block;
 
       //Update the Progress meter
       if (TotalProgress(progress +
-                        ((s - start).as_double() / len)/double(2*GetNumWaveTracks()), msg)) {
+                        nChannels * ((s - start).as_double() / len)/double(2*GetNumWaveTracks()), msg)) {
          rc = false; //lda .. break, not return, so that buffer is deleted
          break;
       }
    }
-   progress += 1.0/double(2*GetNumWaveTracks());
+   progress += nChannels/double(2*GetNumWaveTracks());
 
    //Return true because the effect processing succeeded ... unless cancelled
    return rc;
@@ -462,10 +467,11 @@ double EffectNormalize::AnalyseDataDC(float *buffer, size_t len, double sum)
    return sum;
 }
 
-void EffectNormalize::ProcessData(float *buffer, size_t len, float offset)
+void EffectNormalize::ProcessData(
+   float *buffer, size_t len, float offset, float mult)
 {
    for(decltype(len) i = 0; i < len; i++) {
-      float adjFrame = (buffer[i] + offset) * mMult;
+      float adjFrame = (buffer[i] + offset) * mult;
       buffer[i] = adjFrame;
    }
 }
@@ -17,12 +17,14 @@
 #include "ShuttleAutomation.h"
 #include <wx/weakref.h>
 #include <functional>
+#include <vector>
 
 class wxCheckBox;
 class wxStaticText;
 class wxTextCtrl;
 class ShuttleGui;
 class WaveChannel;
+class WaveTrack;
 
 class EffectNormalize final : public StatefulEffect
 {
@@ -57,8 +59,9 @@ public:
 private:
    // EffectNormalize implementation
 
-   bool ProcessOne(WaveChannel &track,
-      const TranslatableString &msg, double& progress, float offset);
+   bool ProcessOne(WaveTrack &track,
+      const TranslatableString &msg, double& progress,
+      const std::vector<float> &offsets, const std::vector<float> &mults);
    using ProgressReport = std::function<bool(double fraction)>;
    static bool AnalyseTrack(const WaveChannel &track,
       const ProgressReport &report,
@@ -68,7 +71,8 @@ private:
       const ProgressReport &report, double curT0, double curT1,
       float &offset);
    static double AnalyseDataDC(float *buffer, size_t len, double sum);
-   void ProcessData(float *buffer, size_t len, float offset);
+   static void ProcessData(
+      float *buffer, size_t len, float offset, float mult);
 
    void OnUpdateUI(wxCommandEvent & evt);
    void UpdateUI();
@@ -83,7 +87,6 @@ private:
 
    double mCurT0;
    double mCurT1;
-   float  mMult;
 
    wxCheckBox *mGainCheckBox;
    wxCheckBox *mDCCheckBox;
@@ -0,0 +1,140 @@
+/**********************************************************************
+
+   Audacity: A Digital Audio Editor
+   PaulStretchEngine.cpp
+
+   Nasca Octavian Paul (Paul Nasca)
+
+ **********************************************************************/
+#include "PaulStretchEngine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "FFT.h"
+
+PaulStretch::PaulStretch(float rap_, size_t in_bufsize_, float samplerate_ )
+   : samplerate { samplerate_ }
+   , rap { std::max(1.0f, rap_) }
+   , in_bufsize { in_bufsize_ }
+   , out_bufsize { std::max(size_t{ 8 }, in_bufsize) }
+   , out_buf { out_bufsize }
+   , old_out_smp_buf { out_bufsize * 2, true }
+   , poolsize { in_bufsize_ * 2 }
+   , in_pool { poolsize, true }
+   , remained_samples { 0.0 }
+   , hFFT { GetFFT(poolsize) }
+   , window { poolsize }
+   , out_fade { out_bufsize }
+   , out_shape { out_bufsize }
+   , fft_smps { poolsize, true }
+   , fft_freq { poolsize / 2, true }
+   , fft_tmp { out_bufsize * 2, true }
+{
+   std::fill(window.get(), window.get() + poolsize, 1.0f);
+   WindowFunc(eWinFuncHann, poolsize, window.get());
+
+   float tmp = 1.0 / (float) out_bufsize * M_PI;
+   float hinv_sqrt2 = 0.853553390593f;//(1.0+1.0/sqrt(2))*0.5;
+
+   float ampfactor = 1.0;
+   if (rap < 1.0)
+      ampfactor = rap * 0.707;
+   else
+      ampfactor = (out_bufsize / (float)poolsize) * 4.0;
+
+   for (size_t i = 0; i < out_bufsize; i++) {
+      out_fade[i] = 0.5 + 0.5 * cos(i * tmp);
+      out_shape[i] =
+         (hinv_sqrt2 - (1.0 - hinv_sqrt2) * cos(i * 2.0 * tmp)) * ampfactor;
+   }
+}
+
+PaulStretch::~PaulStretch()
+{
+}
+
+void PaulStretch::process(float *smps, size_t nsmps)
+{
+   //add NEW samples to the pool
+   if ((smps != NULL) && (nsmps != 0)) {
+      if (nsmps > poolsize) {
+         nsmps = poolsize;
+      }
+      auto nleft = poolsize - nsmps;
+
+      //move left the samples from the pool to make room for NEW samples
+      std::copy(in_pool.get() + nsmps, in_pool.get() + poolsize, in_pool.get());
+
+      //add NEW samples to the pool
+      std::copy(smps, smps + nsmps, in_pool.get() + nleft);
+   }
+
+   //get the windowed samples from the pool
+   for (size_t i = 0; i < poolsize; i++)
+      fft_smps[i] = in_pool[i] * window[i];
+
+   // After the FFT in place, bins other than DC and Nyquist are pairs of
+   // real and imaginary parts, at bit-reversed positions
+   RealFFTf(fft_smps.get(), hFFT.get());
+   const auto bitReversed = hFFT->BitReversed.get();
+
+   fft_freq[0] = fabs(fft_smps[0]);
+   for (size_t i = 1; i < poolsize / 2; i++) {
+      const auto bin = fft_smps.get() + bitReversed[i];
+      fft_freq[i] = sqrt(bin[0] * bin[0] + bin[1] * bin[1]);
+   }
+   process_spectrum(fft_freq.get());
+
+
+   //put randomize phases to frequencies and do a IFFT
+   //the inverse takes the bins in their natural order
+   float inv_2p15_2pi = 1.0 / 16384.0 * (float)M_PI;
+   for (size_t i = 1; i < poolsize / 2; i++) {
+      unsigned int random = (rand()) & 0x7fff;
+      float phase = random * inv_2p15_2pi;
+      fft_smps[2 * i] = fft_freq[i] * cos(phase);
+      fft_smps[2 * i + 1] = fft_freq[i] * sin(phase);
+   }
+   // No DC, and no Nyquist frequency, which goes in the place of the
+   // imaginary part of DC
+   fft_smps[0] = fft_smps[1] = 0.0;
+
+   InverseRealFFTf(fft_smps.get(), hFFT.get());
+   ReorderToTime(hFFT.get(), fft_smps.get(), fft_tmp.get());
+
+   //make the output buffer
+   for (size_t i = 0; i < out_bufsize; i++) {
+      float a = out_fade[i];
+      float out = fft_tmp[i + out_bufsize] * (1.0 - a) + old_out_smp_buf[i] * a;
+      out_buf[i] = out * out_shape[i];
+   }
+
+   //the current output becomes the old
+   std::swap(old_out_smp_buf, fft_tmp);
+}
+
+size_t PaulStretch::get_nsamples()
+{
+   double r = out_bufsize / rap;
+   auto ri = (size_t)floor(r);
+   double rf = r - floor(r);
+
+   remained_samples += rf;
+   if (remained_samples >= 1.0){
+      ri += (size_t)floor(remained_samples);
+      remained_samples = remained_samples - floor(remained_samples);
+   }
+
+   if (ri > poolsize) {
+      ri = poolsize;
+   }
+
+   return ri;
+}
+
+size_t PaulStretch::get_nsamples_for_fill()
+{
+   return poolsize;
+}
@@ -0,0 +1,67 @@
+/**********************************************************************
+
+   Audacity: A Digital Audio Editor
+   PaulStretchEngine.h
+
+   Nasca Octavian Paul (Paul Nasca)
+
+ **********************************************************************/
+
+#ifndef __AUDACITY_PAUL_STRETCH_ENGINE__
+#define __AUDACITY_PAUL_STRETCH_ENGINE__
+
+#include "RealFFTf.h"
+#include "SampleFormat.h"
+
+/// \brief Class that helps EffectPaulStretch.  It does the FFTs and inner loop
+/// of the effect.
+/*!
+ All buffers and tables are allocated at construction; each call of process
+ does one real FFT and one inverse real FFT in place, with the FFT tables
+ shared through GetFFT.
+ */
+class PaulStretch
+{
+public:
+   PaulStretch(float rap_, size_t in_bufsize_, float samplerate_);
+   //in_bufsize is also a half of a FFT buffer (in samples)
+   virtual ~PaulStretch();
+
+   void process(float *smps, size_t nsmps);
+
+   size_t get_nsamples();//how many samples are required to be added in the pool next time
+   size_t get_nsamples_for_fill();//how many samples are required to be added for a complete buffer refill (at start of the song or after seek)
+
+private:
+   void process_spectrum(float *) {}
+
+   const float samplerate;
+   const float rap;
+   const size_t in_bufsize;
+
+public:
+   const size_t out_bufsize;
+   const Floats out_buf;
+
+private:
+   Floats old_out_smp_buf;
+
+public:
+   const size_t poolsize;//how many samples are inside the input_pool size (need to know how many samples to fill when seeking)
+
+private:
+   const Floats in_pool;//de marimea in_bufsize
+
+   double remained_samples;//how many fraction of samples has remained (0..1)
+
+   const HFFT hFFT;
+   //! Hann window of the input pool; cross-fade and shaping of the output,
+   //! the latter with the amplification
+   const Floats window, out_fade, out_shape;
+
+   const Floats fft_smps, fft_freq;
+   //! Output of the inverse FFT, exchanged with old_out_smp_buf after use
+   Floats fft_tmp;
+};
+
+#endif
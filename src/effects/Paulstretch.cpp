@@ -14,6 +14,7 @@
 
 *//*******************************************************************/
 #include "Paulstretch.h"
+#include "PaulStretchEngine.h"
 #include "EffectEditor.h"
 #include "EffectOutputTracks.h"
 #include "LoadEffects.h"
@@ -25,7 +26,6 @@
 #include <wx/valgen.h>
 
 #include "ShuttleGui.h"
-#include "FFT.h"
 #include "../widgets/valnum.h"
 #include "AudacityMessageBox.h"
 #include "Prefs.h"
@@ -42,45 +42,6 @@ const EffectParameterMethods& EffectPaulstretch::Parameters() const
    return parameters;
 }
 
-/// \brief Class that helps EffectPaulStretch.  It does the FFTs and inner loop
-/// of the effect.
-class PaulStretch
-{
-public:
-   PaulStretch(float rap_, size_t in_bufsize_, float samplerate_);
-   //in_bufsize is also a half of a FFT buffer (in samples)
-   virtual ~PaulStretch();
-
-   void process(float *smps, size_t nsmps);
-
-   size_t get_nsamples();//how many samples are required to be added in the pool next time
-   size_t get_nsamples_for_fill();//how many samples are required to be added for a complete buffer refill (at start of the song or after seek)
-
-private:
-   void process_spectrum(float *WXUNUSED(freq)) {};
-
-   const float samplerate;
-   const float rap;
-   const size_t in_bufsize;
-
-public:
-   const size_t out_bufsize;
-   const Floats out_buf;
-
-private:
-   const Floats old_out_smp_buf;
-
-public:
-   const size_t poolsize;//how many samples are inside the input_pool size (need to know how many samples to fill when seeking)
-
-private:
-   const Floats in_pool;//de marimea in_bufsize
-
-   double remained_samples;//how many fraction of samples has remained (0..1)
-
-   const Floats fft_smps, fft_c, fft_s, fft_freq, fft_tmp;
-};
-
 //
 // EffectPaulstretch
 //
@@ -414,129 +375,3 @@ bool EffectPaulstretch::ProcessOne(const WaveChannel &track,
    }
    return false;
 };
-
-/*************************************************************/
-
-
-PaulStretch::PaulStretch(float rap_, size_t in_bufsize_, float samplerate_ )
-   : samplerate { samplerate_ }
-   , rap { std::max(1.0f, rap_) }
-   , in_bufsize { in_bufsize_ }
-   , out_bufsize { std::max(size_t{ 8 }, in_bufsize) }
-   , out_buf { out_bufsize }
-   , old_out_smp_buf { out_bufsize * 2, true }
-   , poolsize { in_bufsize_ * 2 }
-   , in_pool { poolsize, true }
-   , remained_samples { 0.0 }
-   , fft_smps { poolsize, true }
-   , fft_c { poolsize, true }
-   , fft_s { poolsize, true }
-   , fft_freq { poolsize, true }
-   , fft_tmp { poolsize }
-{
-}
-
-PaulStretch::~PaulStretch()
-{
-}
-
-void PaulStretch::process(float *smps, size_t nsmps)
-{
-   //add NEW samples to the pool
-   if ((smps != NULL) && (nsmps != 0)) {
-      if (nsmps > poolsize) {
-         nsmps = poolsize;
-      }
-      int nleft = poolsize - nsmps;
-
-      //move left the samples from the pool to make room for NEW samples
-      for (int i = 0; i < nleft; i++)
-         in_pool[i] = in_pool[i + nsmps];
-
-      //add NEW samples to the pool
-      for (size_t i = 0; i < nsmps; i++)
-         in_pool[i + nleft] = smps[i];
-   }
-
-   //get the samples from the pool
-   for (size_t i = 0; i < poolsize; i++)
-      fft_smps[i] = in_pool[i];
-   WindowFunc(eWinFuncHann, poolsize, fft_smps.get());
-
-   RealFFT(poolsize, fft_smps.get(), fft_c.get(), fft_s.get());
-
-   for (size_t i = 0; i < poolsize / 2; i++)
-      fft_freq[i] = sqrt(fft_c[i] * fft_c[i] + fft_s[i] * fft_s[i]);
-   process_spectrum(fft_freq.get());
-
-
-   //put randomize phases to frequencies and do a IFFT
-   float inv_2p15_2pi = 1.0 / 16384.0 * (float)M_PI;
-   for (size_t i = 1; i < poolsize / 2; i++) {
-      unsigned int random = (rand()) & 0x7fff;
-      float phase = random * inv_2p15_2pi;
-      float s = fft_freq[i] * sin(phase);
-      float c = fft_freq[i] * cos(phase);
-
-      fft_c[i] = fft_c[poolsize - i] = c;
-
-      fft_s[i] = s; fft_s[poolsize - i] = -s;
-   }
-   fft_c[0] = fft_s[0] = 0.0;
-   fft_c[poolsize / 2] = fft_s[poolsize / 2] = 0.0;
-
-   FFT(poolsize, true, fft_c.get(), fft_s.get(), fft_smps.get(), fft_tmp.get());
-
-   float max = 0.0, max2 = 0.0;
-   for (size_t i = 0; i < poolsize; i++) {
-      max = std::max(max, fabsf(fft_tmp[i]));
-      max2 = std::max(max2, fabsf(fft_smps[i]));
-   }
-
-
-   //make the output buffer
-   float tmp = 1.0 / (float) out_bufsize * M_PI;
-   float hinv_sqrt2 = 0.853553390593f;//(1.0+1.0/sqrt(2))*0.5;
-
-   float ampfactor = 1.0;
-   if (rap < 1.0)
-      ampfactor = rap * 0.707;
-   else
-      ampfactor = (out_bufsize / (float)poolsize) * 4.0;
-
-   for (size_t i = 0; i < out_bufsize; i++) {
-      float a = (0.5 + 0.5 * cos(i * tmp));
-      float out = fft_smps[i + out_bufsize] * (1.0 - a) + old_out_smp_buf[i] * a;
-      out_buf[i] =
-         out * (hinv_sqrt2 - (1.0 - hinv_sqrt2) * cos(i * 2.0 * tmp)) *
-         ampfactor;
-   }
-
-   //copy the current output buffer to old buffer
-   for (size_t i = 0; i < out_bufsize * 2; i++)
-      old_out_smp_buf[i] = fft_smps[i];
-}
-
-size_t PaulStretch::get_nsamples()
-{
-   double r = out_bufsize / rap;
-   auto ri = (size_t)floor(r);
-   double rf = r - floor(r);
-
-   remained_samples += rf;
-   if (remained_samples >= 1.0){
-      ri += (size_t)floor(remained_samples);
-      remained_samples = remained_samples - floor(remained_samples);
-   }
-
-   if (ri > poolsize) {
-      ri = poolsize;
-   }
-
-   return ri;
-}
-
-size_t PaulStretch::get_nsamples_for_fill()
-{
-   return poolsize;
-}
@@ -401,6 +401,7 @@ bool EffectReverb::Instance::InstanceInit(EffectSettings& settings,
                     rs.mToneLow,
                     rs.mToneHigh,
                     BLOCK,
+                    PreDelay.max,
                     state.mP[i].wet);
    }
 
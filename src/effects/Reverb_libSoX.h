@@ -12,6 +12,7 @@
 
 **********************************************************************/
 
+#include <cstddef>
 #include <cstring>
 #include <cstdlib>
 #ifdef __WXMSW__
@@ -23,6 +24,11 @@
 using std::min;
 using std::max;
 
+#if defined(__SSE__) || defined(_M_AMD64) || defined(_M_X64)
+   #include <xmmintrin.h>
+   #define REVERB_SSE
+#endif
+
 #define array_length(a) (sizeof(a)/sizeof(a[0]))
 #define dB_to_linear(x) exp((x) * M_LN10 * 0.05)
 #define midi_to_freq(n) (440 * pow(2,((n)-69)/12.))
@@ -103,10 +109,12 @@ static void fifo_delete(fifo_t * f)
    free(f->data);
 }
 
-static void fifo_create(fifo_t * f, FIFO_SIZE_T item_size)
+/* Allocate enough that writes never reallocate, while the queue holds no
+   more than max_items */
+static void fifo_create(fifo_t * f, FIFO_SIZE_T item_size, size_t max_items)
 {
    f->item_size = item_size;
-   f->allocation = FIFO_MIN;
+   f->allocation = FIFO_MIN + 2 * max_items * item_size;
    f->data = (char *)malloc(f->allocation);
    fifo_clear(f);
 }
@@ -117,25 +125,6 @@ typedef struct {
    float   store;
 } filter_t;
 
-static float comb_process(filter_t * p,  /* gcc -O2 will inline this */
-      float const * input, float const * feedback, float const * hf_damping)
-{
-   float output = *p->ptr;
-   p->store = output + (p->store - output) * *hf_damping;
-   *p->ptr = *input + p->store * *feedback;
-   filter_advance(p);
-   return output;
-}
-
-static float allpass_process(filter_t * p,  /* gcc -O2 will inline this */
-      float const * input)
-{
-   float output = *p->ptr;
-   *p->ptr = *input + output * .5;
-   filter_advance(p);
-   return output - *input;
-}
-
 typedef struct {double b0, b1, a1, i1, o1;} one_pole_t;
 
 static float one_pole_process(one_pole_t * p, float i0)
@@ -235,24 +224,128 @@ static void filter_array_create(filter_array_t * p, double rate,
    }
 }
 
-static void filter_array_process(filter_array_t * p,
-      size_t length, float const * input, float * output,
-      float const * feedback, float const * hf_damping, float const * gain)
+/* How many samples a filter can take before its pointer wraps */
+static size_t filter_room(filter_t const * p)
+{
+   return p->ptr - p->buffer + 1;
+}
+
+/* Advance the pointer by n, no more than filter_room */
+static void filter_skip(filter_t * p, size_t n)
+{
+   p->ptr -= n;
+   if (p->ptr < p->buffer)
+      p->ptr += p->size;
+}
+
+#define COMB_COUNT array_length(comb_lengths)
+#define ALLPASS_COUNT array_length(allpass_lengths)
+
+/* Filter n samples, which no filter may wrap, so that the filters need no
+   checks of their pointers, and keep their state in registers.  Where SSE is
+   available, the damping recurrences of all combs go through the lanes of
+   two vectors at once.  The results are the same as from filtering one
+   sample at a time */
+static void filter_array_process_piece(filter_array_t * p, size_t n,
+      float const * input, float * output,
+      float feedback, float hf_damping, float gain)
 {
-   while (length--) {
-      float out = 0, in = *input++;
+   float * combs[COMB_COUNT], * allpasses[ALLPASS_COUNT];
+   size_t i, j;
+   for (i = 0; i < COMB_COUNT; ++i)
+      combs[i] = p->comb[i].ptr;
+   for (i = 0; i < ALLPASS_COUNT; ++i)
+      allpasses[i] = p->allpass[i].ptr;
+   one_pole_t one_poles[2] = { p->one_pole[0], p->one_pole[1] };
+
+#ifdef REVERB_SSE
+   static_assert(COMB_COUNT == 8, "combs fill two vectors");
+   const __m128 damping = _mm_set1_ps(hf_damping), fb = _mm_set1_ps(feedback);
+   __m128 store0 = _mm_setr_ps(p->comb[0].store, p->comb[1].store,
+      p->comb[2].store, p->comb[3].store);
+   __m128 store1 = _mm_setr_ps(p->comb[4].store, p->comb[5].store,
+      p->comb[6].store, p->comb[7].store);
+#else
+   float stores[COMB_COUNT];
+   for (i = 0; i < COMB_COUNT; ++i)
+      stores[i] = p->comb[i].store;
+#endif
 
-      size_t i = array_length(comb_lengths) - 1;
-      do out += comb_process(p->comb + i, &in, feedback, hf_damping);
-      while (i--);
+   for (j = 0; j < n; ++j) {
+      /* All pointers move backwards together */
+      const ptrdiff_t k = -(ptrdiff_t)j;
+      float in = input[j], out = 0;
+      float outs[COMB_COUNT], writes[COMB_COUNT];
+#ifdef REVERB_SSE
+      const __m128 in4 = _mm_set1_ps(in),
+         out0 = _mm_setr_ps(
+            combs[0][k], combs[1][k], combs[2][k], combs[3][k]),
+         out1 = _mm_setr_ps(
+            combs[4][k], combs[5][k], combs[6][k], combs[7][k]);
+      store0 = _mm_add_ps(out0, _mm_mul_ps(_mm_sub_ps(store0, out0), damping));
+      store1 = _mm_add_ps(out1, _mm_mul_ps(_mm_sub_ps(store1, out1), damping));
+      _mm_storeu_ps(outs, out0);
+      _mm_storeu_ps(outs + 4, out1);
+      _mm_storeu_ps(writes, _mm_add_ps(in4, _mm_mul_ps(store0, fb)));
+      _mm_storeu_ps(writes + 4, _mm_add_ps(in4, _mm_mul_ps(store1, fb)));
+#else
+      for (i = 0; i < COMB_COUNT; ++i) {
+         outs[i] = combs[i][k];
+         stores[i] = outs[i] + (stores[i] - outs[i]) * hf_damping;
+         writes[i] = in + stores[i] * feedback;
+      }
+#endif
+      i = COMB_COUNT - 1;
+      do {
+         out += outs[i];
+         combs[i][k] = writes[i];
+      } while (i--);
+
+      i = ALLPASS_COUNT - 1;
+      do {
+         float allpass_out = allpasses[i][k];
+         allpasses[i][k] = out + allpass_out * .5;
+         out = allpass_out - out;
+      } while (i--);
+
+      out = one_pole_process(&one_poles[0], out);
+      out = one_pole_process(&one_poles[1], out);
+      output[j] = out * gain;
+   }
 
-      i = array_length(allpass_lengths) - 1;
-      do out = allpass_process(p->allpass + i, &out);
-      while (i--);
+#ifdef REVERB_SSE
+   float stores[COMB_COUNT];
+   _mm_storeu_ps(stores, store0);
+   _mm_storeu_ps(stores + 4, store1);
+#endif
+   for (i = 0; i < COMB_COUNT; ++i) {
+      filter_t * comb = p->comb + i;
+      comb->store = stores[i];
+      filter_skip(comb, n);
+   }
+   for (i = 0; i < ALLPASS_COUNT; ++i) {
+      filter_t * allpass = p->allpass + i;
+      filter_skip(allpass, n);
+   }
+   p->one_pole[0] = one_poles[0];
+   p->one_pole[1] = one_poles[1];
+}
 
-      out = one_pole_process(&p->one_pole[0], out);
-      out = one_pole_process(&p->one_pole[1], out);
-      *output++ = out * *gain;
+static void filter_array_process(filter_array_t * p,
+      size_t length, float const * input, float * output,
+      float const * feedback, float const * hf_damping, float const * gain)
+{
+   while (length) {
+      /* Take no more than any filter can before it wraps */
+      size_t n = length, i;
+      for (i = 0; i < COMB_COUNT; ++i)
+         n = min(n, filter_room(p->comb + i));
+      for (i = 0; i < ALLPASS_COUNT; ++i)
+         n = min(n, filter_room(p->allpass + i));
+
+      filter_array_process_piece(p, n, input, output,
+         *feedback, *hf_damping, *gain);
+      input += n, output += n, length -= n;
    }
 }
 
@@ -385,12 +478,15 @@ static void filter_t_resize(filter_t* p, size_t newSize)
 }
 
 
-static void reverb_allocate(reverb_t* p, double sample_rate_Hz, size_t buffer_size, float** out)
+static void reverb_allocate(reverb_t* p, double sample_rate_Hz,
+   size_t buffer_size, double max_pre_delay_ms, float** out)
 {
    memset(p, 0, sizeof(*p));
 
-   // Input queue
-   fifo_create(&p->input_fifo, sizeof(float));
+   // Input queue, big enough for the longest pre-delay, so that neither
+   // processing nor a change of settings during play reallocates it
+   size_t max_delay = max_pre_delay_ms / 1000 * sample_rate_Hz + .5;
+   fifo_create(&p->input_fifo, sizeof(float), buffer_size + max_delay);
 
    // Outputs
    out[0] = lsx_zalloc(p->out[0], buffer_size);
@@ -479,9 +575,10 @@ static void reverb_create(reverb_t * p, double sample_rate_Hz,
       double tone_low,       /* % */
       double tone_high,      /* % */
       size_t buffer_size,
+      double max_pre_delay_ms,
       float * * out)
 {
-   reverb_allocate(p, sample_rate_Hz, buffer_size, out);
+   reverb_allocate(p, sample_rate_Hz, buffer_size, max_pre_delay_ms, out);
 
    reverb_init(p, sample_rate_Hz, wet_gain_dB, room_scale, reverberance, hf_damping, pre_delay_ms, stereo_depth, tone_low, tone_high);
 }
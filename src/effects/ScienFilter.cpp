@@ -36,6 +36,7 @@ a graph for EffectScienFilter.
 #include "LoadEffects.h"
 
 #include <math.h>
+#include <vector>
 
 #include <wx/setup.h> // for wxUSE_* macros
 
@@ -200,21 +201,19 @@ unsigned EffectScienFilter::GetAudioOutCount() const
 bool EffectScienFilter::ProcessInitialize(
    EffectSettings &, double, ChannelNames chanMap)
 {
+   std::vector<BiquadCascade::Section> sections;
    for (int iPair = 0; iPair < (mOrder + 1) / 2; iPair++)
-      mpBiquad[iPair].Reset();
+      sections.push_back(mpBiquad[iPair].GetSection());
+   mCascade.SetSections(sections.data(), sections.size());
+   mCascade.Reset();
    return true;
 }
 
 size_t EffectScienFilter::ProcessBlock(EffectSettings &,
    const float *const *inBlock, float *const *outBlock, size_t blockLen)
 {
-   const float *ibuf = inBlock[0];
-   for (int iPair = 0; iPair < (mOrder + 1) / 2; iPair++)
-   {
-      mpBiquad[iPair].Process(ibuf, outBlock[0], blockLen);
-      ibuf = outBlock[0];
-   }
-
+   // All sections in one pass
+   mCascade.Process(inBlock, outBlock, blockLen);
    return blockLen;
 }
 
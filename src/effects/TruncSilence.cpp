@@ -24,6 +24,8 @@
 #include <list>
 #include <limits>
 #include <math.h>
+#include <optional>
+#include <vector>
 
 #include <wx/checkbox.h>
 #include <wx/choice.h>
@@ -515,6 +517,80 @@ bool EffectTruncSilence::DoRemoval(const RegionList &silences,
    return true;
 }
 
+// Find runs of silence in all channels of a range of frames, from the
+// statistics of sample blocks, as the frame-by-frame loop in Analyze does
+// when not previewing.  The statistics list only those runs in each channel
+// that are long or touch an end of the range, but that includes all runs
+// long enough to matter, if minSilenceFrames is at least
+// SampleStats::MinInteriorRun.
+// Returns false if the statistics are not available.
+static bool AnalyzeFromStats(const WaveTrack &wt, size_t gridIndex,
+   sampleCount index, size_t count, sampleCount minSilenceFrames,
+   RegionList &trackSilences, sampleCount &silentFrame)
+{
+   // Starts and ends of the runs, relative to index
+   using Runs = std::vector<std::pair<sampleCount, sampleCount>>;
+   std::optional<Runs> silent;
+   for (const auto pChannel : wt.Channels()) {
+      const auto stats = pChannel->GetStats(index, count);
+      if (!stats)
+         return false;
+      const auto &runs = stats->silence[gridIndex];
+      Runs channelRuns;
+      if (runs.leading == count)
+         channelRuns.emplace_back(0, count);
+      else {
+         if (runs.leading > 0)
+            channelRuns.emplace_back(0, runs.leading);
+         for (const auto &[start, length] : runs.interior)
+            channelRuns.emplace_back(start, start + length);
+         if (runs.trailing > 0)
+            channelRuns.emplace_back(count - runs.trailing, count);
+      }
+
+      if (!silent)
+         silent = std::move(channelRuns);
+      else {
+         // A frame is silent only if all channels are
+         Runs both;
+         auto iter = silent->begin(), end = silent->end();
+         auto channelIter = channelRuns.begin(),
+            channelEnd = channelRuns.end();
+         while (iter != end && channelIter != channelEnd) {
+            const auto start = std::max(iter->first, channelIter->first);
+            const auto stop = std::min(iter->second, channelIter->second);
+            if (start < stop)
+               both.emplace_back(start, stop);
+            if (iter->second < channelIter->second)
+               ++iter;
+            else
+               ++channelIter;
+         }
+         silent = std::move(both);
+      }
+   }
+
+   // The first frame not known to be silent ends the silence before it
+   sampleCount position = 0;
+   const auto endSilence = [&]{
+      if (silentFrame >= minSilenceFrames)
+         trackSilences.push_back(Region(
+            wt.LongSamplesToTime(index + position - silentFrame),
+            wt.LongSamplesToTime(index + position)
+         ));
+      silentFrame = 0;
+   };
+   for (const auto &[start, stop] : *silent) {
+      if (start > position)
+         endSilence();
+      silentFrame += stop - start;
+      position = stop;
+   }
+   if (position < count)
+      endSilence();
+   return true;
+}
+
 bool EffectTruncSilence::Analyze(RegionList& silenceList,
    RegionList& trackSilences, const WaveTrack &wt, sampleCount* silentFrame,
    sampleCount* index, int whichTrack, double* inputLength,
@@ -528,6 +604,10 @@ bool EffectTruncSilence::Analyze(RegionList& silenceList,
       sampleCount(std::max(mInitialAllowedSilence, DEF_MinTruncMs) * rate);
 
    double truncDbSilenceThreshold = DB_TO_LINEAR(mThresholdDB);
+   // Statistics of sample blocks can find the silences at some thresholds
+   const auto gridIndex = minSilenceFrames >= SampleStats::MinInteriorRun
+      ? SampleStats::SilenceGridIndex(mThresholdDB)
+      : std::nullopt;
    auto blockLen = wt.GetMaxBlockSize();
    auto start = wt.TimeToLongSamples(mT0);
    auto end = wt.TimeToLongSamples(mT1);
@@ -619,6 +699,18 @@ bool EffectTruncSilence::Analyze(RegionList& silenceList,
       // Limit size of current block if we've reached the end
       auto count = limitSampleBufferSize( blockLen, end - *index );
 
+      // Without a preview, which needs counts of samples, try statistics of
+      // whole sample blocks first
+      if (!inputLength && gridIndex) {
+         for (const auto pChannel : wt.Channels())
+            count = std::min(count, pChannel->GetBestBlockSize(*index));
+         if (AnalyzeFromStats(wt, *gridIndex, *index, count,
+            minSilenceFrames, trackSilences, *silentFrame)) {
+            *index += count;
+            continue;
+         }
+      }
+
       // Fill buffers
       size_t iChannel = 0;
       for (const auto pChannel : wt.Channels())
@@ -30,7 +30,12 @@ effects from this one class.
 
 #include <algorithm>
 #include <cmath>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
 
 #include <locale.h>
 
@@ -662,6 +667,141 @@ bool NyquistEffect::Init()
 
 static void RegisterFunctions();
 
+namespace {
+//! Reads one channel in a worker thread, ahead of the Nyquist interpreter,
+//! so that the interpreter seldom waits for the database
+/*! Nyquist fetches each channel in order; a fetch anywhere else restarts the
+ reading there */
+class ChannelReadAhead final
+{
+public:
+   ChannelReadAhead(const WaveChannel &channel, sampleCount start,
+      sampleCount end)
+      : mChannel{ channel }
+      , mEnd{ end }
+      , mNext{ start }
+      , mThread{ [this]{ Run(); } }
+   {}
+
+   ~ChannelReadAhead()
+   {
+      {
+         std::lock_guard<std::mutex> lock{ mMutex };
+         mStop = true;
+      }
+      mRoom.notify_one();
+      mThread.join();
+   }
+
+   //! Copy `len` samples starting at `start`; rethrows what reading threw
+   void Get(float *buffer, sampleCount start, size_t len)
+   {
+      while (len > 0) {
+         if (start >= mEnd) {
+            // Not read ahead; let the channel supply the padding
+            mChannel.GetFloats(buffer, start, len);
+            return;
+         }
+         if (!mCurrent.samples || start < mCurrent.start ||
+             start >= mCurrent.start + mCurrent.len)
+            mCurrent = Take(start);
+         if (mCurrent.pException)
+            std::rethrow_exception(mCurrent.pException);
+         const auto offset = (start - mCurrent.start).as_size_t();
+         const auto count = std::min(len, mCurrent.len - offset);
+         std::copy_n(&mCurrent.samples[offset], count, buffer);
+         buffer += count;
+         start += count;
+         len -= count;
+      }
+   }
+
+private:
+   struct Chunk {
+      sampleCount start{};
+      size_t len{};
+      std::unique_ptr<float[]> samples;
+      std::exception_ptr pException;
+   };
+
+   //! Chunks waiting to be taken, at most
+   static constexpr size_t MaxChunks = 4;
+
+   //! The chunk containing `start`, which is before mEnd
+   Chunk Take(sampleCount start)
+   {
+      std::unique_lock<std::mutex> lock{ mMutex };
+      while (true) {
+         const auto first = mChunks.empty() ? mNext : mChunks.front().start;
+         if (start < first || start > mNext) {
+            // Not in the stream ahead; read from there instead
+            mChunks.clear();
+            mNext = start;
+            ++mGeneration;
+            mRoom.notify_one();
+         }
+         mReady.wait(lock, [this]{ return !mChunks.empty(); });
+         auto chunk = std::move(mChunks.front());
+         mChunks.pop_front();
+         mRoom.notify_one();
+         if (start < chunk.start + chunk.len || chunk.pException)
+            return chunk;
+      }
+   }
+
+   void Run()
+   {
+      std::unique_lock<std::mutex> lock{ mMutex };
+      while (true) {
+         mRoom.wait(lock, [this]{
+            return mStop || (mChunks.size() < MaxChunks && mNext < mEnd); });
+         if (mStop)
+            return;
+
+         Chunk chunk;
+         chunk.start = mNext;
+         chunk.len = limitSampleBufferSize(
+            mChannel.GetBestBlockSize(chunk.start), mEnd - chunk.start);
+         const auto generation = mGeneration;
+         lock.unlock();
+
+         chunk.samples = std::make_unique<float[]>(chunk.len);
+         try {
+            mChannel.GetFloats(chunk.samples.get(), chunk.start, chunk.len);
+         }
+         catch (...) {
+            chunk.pException = std::current_exception();
+         }
+
+         lock.lock();
+         if (generation != mGeneration)
+            // The consumer moved elsewhere meanwhile
+            continue;
+         mNext = chunk.start + chunk.len;
+         mChunks.push_back(std::move(chunk));
+         mReady.notify_one();
+      }
+   }
+
+   const WaveChannel &mChannel;
+   const sampleCount mEnd;
+
+   std::mutex mMutex;
+   std::condition_variable mRoom, mReady;
+   std::deque<Chunk> mChunks;
+   //! Where the worker reads next
+   sampleCount mNext;
+   //! Incremented when the reading restarts elsewhere
+   size_t mGeneration{ 0 };
+   bool mStop{ false };
+
+   //! Used only by the consumer
+   Chunk mCurrent;
+
+   std::thread mThread;
+};
+}
+
 //! Reads and writes Audacity's track objects, interchanging with Nyquist
 //! sound objects (implemented in the library layer written in C)
 struct NyquistEffect::NyxContext {
@@ -688,10 +828,10 @@ struct NyquistEffect::NyxContext {
 
    unsigned          mCurNumChannels{}; //!< Not used in the callbacks
 
-   using Buffer = std::unique_ptr<float[]>;
-   Buffer            mCurBuffer[2]; //!< used only in GetCallback
-   sampleCount       mCurBufferStart[2]{};
-   size_t            mCurBufferLen[2]{};
+   //! Join the threads reading ahead; call before changing any track
+   void StopReading();
+   //! Started by the first GetCallback for each channel
+   std::optional<ChannelReadAhead> mReadAhead[2];
    sampleCount       mCurLen{};
 
    std::shared_ptr<TrackList> mOutputTracks;
@@ -1038,6 +1178,10 @@ bool NyquistEffect::Process(EffectInstance &, EffectSettings &settings)
                Internat::ToString(t1));
          }
 
+         // Tracks are processed one after another, never in parallel:
+         // libnyquist keeps the interpreter's state in globals of this
+         // process.  Only the reading of input runs in other threads (see
+         // ChannelReadAhead).
          success = ProcessOne(nyxContext, oOutputs ? &*oOutputs : nullptr);
 
          // Reset previous locale
@@ -1547,6 +1691,9 @@ bool NyquistEffect::ProcessOne(
    // Evaluate the expression, which may invoke the get callback, but often does
    // not, leaving that to delayed evaluation of the output sound
    rval = nyx_eval_expression(cmd.mb_str(wxConvUTF8));
+   // The plug-in may have read only part of its input; don't leave threads
+   // reading what later steps may change
+   nyxContext.StopReading();
 
    // If we're not showing debug window, log errors and warnings:
    const auto output = mDebugOutput.Translation();
@@ -1714,6 +1861,8 @@ bool NyquistEffect::ProcessOne(
 
    // Now fully evaluate the sound
    int success = nyx_get_audio(NyxContext::StaticPutCallback, &nyxContext);
+   // Delayed evaluation may have restarted reading; stop before pasting
+   nyxContext.StopReading();
 
    // See if GetCallback found read errors
    if (auto pException = nyxContext.mpException)
@@ -2562,47 +2711,27 @@ int NyquistEffect::NyxContext::StaticGetCallback(float *buffer, int channel,
    return This->GetCallback(buffer, channel, start, len, totlen);
 }
 
+void NyquistEffect::NyxContext::StopReading()
+{
+   for (auto &readAhead : mReadAhead)
+      readAhead.reset();
+}
+
 int NyquistEffect::NyxContext::GetCallback(float *buffer, int ch,
    int64_t start, int64_t len, int64_t)
 {
-   if (mCurBuffer[ch]) {
-      if ((mCurStart + start) < mCurBufferStart[ch] ||
-          (mCurStart + start) + len >
-          mCurBufferStart[ch] + mCurBufferLen[ch]) {
-         mCurBuffer[ch].reset();
-      }
+   try {
+      if (!mReadAhead[ch])
+         mReadAhead[ch].emplace(
+            *mCurTrack[ch], mCurStart, mCurStart + mCurLen);
+      mReadAhead[ch]->Get(buffer, mCurStart + start, len);
    }
-
-   if (!mCurBuffer[ch]) {
-      mCurBufferStart[ch] = (mCurStart + start);
-      mCurBufferLen[ch] = mCurTrack[ch]->GetBestBlockSize(mCurBufferStart[ch]);
-
-      if (mCurBufferLen[ch] < (size_t) len)
-         mCurBufferLen[ch] = mCurTrack[ch]->GetIdealBlockSize();
-
-      mCurBufferLen[ch] = limitSampleBufferSize(mCurBufferLen[ch],
-         mCurStart + mCurLen - mCurBufferStart[ch]);
-
-      // C++20
-      // mCurBuffer[ch] = std::make_unique_for_overwrite(mCurBufferLen[ch]);
-      mCurBuffer[ch] = Buffer{ safenew float[ mCurBufferLen[ch] ] };
-      try {
-         mCurTrack[ch]->GetFloats( mCurBuffer[ch].get(),
-            mCurBufferStart[ch], mCurBufferLen[ch]);
-      }
-      catch ( ... ) {
-         // Save the exception object for re-throw when out of the library
-         mpException = std::current_exception();
-         return -1;
-      }
+   catch ( ... ) {
+      // Save the exception object for re-throw when out of the library
+      mpException = std::current_exception();
+      return -1;
    }
 
-   // We have guaranteed above that this is nonnegative and bounded by
-   // mCurBufferLen[ch]:
-   auto offset = (mCurStart + start - mCurBufferStart[ch]).as_size_t();
-   const void *src = &mCurBuffer[ch][offset];
-   std::memcpy(buffer, src, len * sizeof(float));
-
    if (ch == 0) {
       double progress = mScale * ((start + len) / mCurLen.as_double());
       if (progress > mProgressIn)
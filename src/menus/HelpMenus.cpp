@@ -3,10 +3,14 @@
 #include <wx/bmpbuttn.h>
 #include <wx/textctrl.h>
 #include <wx/frame.h>
+#include <wx/wfstream.h>
+
+#include <sstream>
 
 #include "../AboutDialog.h"
 #include "AllThemeResources.h"
 #include "AudioIO.h"
+#include "AudioTrace.h"
 #include "../CommonCommandFlags.h"
 #include "../CrashReport.h" // for HAS_CRASH_REPORT
 #include "FileNames.h"
@@ -276,6 +280,14 @@ void OnAudioDeviceInfo(const CommandContext &context)
       XO("Audio Device Info"), wxT("deviceinfo.txt") );
 }
 
+void OnAudioThreadStatistics(const CommandContext &context)
+{
+   auto &project = context.project;
+   const auto info = AudioIO::Get()->GetAudioThreadStatistics().Report();
+   ShowDiagnostics( project, info,
+      XO("Audio Thread Statistics"), wxT("audiothreadstatistics.txt") );
+}
+
 void OnShowLog( const CommandContext &context )
 {
    LogWindow::Show();
@@ -369,6 +381,37 @@ void OnFrameStatistics(const CommandContext&)
    FrameStatisticsDialog::Show(true);
 }
 
+void OnStartAudioTrace(const CommandContext&)
+{
+   AudioTrace::Start();
+}
+
+void OnSaveAudioTrace(const CommandContext &context)
+{
+   auto &project = context.project;
+   AudioTrace::Stop();
+
+   const auto fName = SelectFile(FileNames::Operation::Export,
+      Verbatim("Save Audio Trace"),
+      wxEmptyString,
+      wxT("audiotrace.json"),
+      wxT("json"),
+      { { Verbatim("Trace Event Format"), { wxT("json") }, true },
+        FileNames::AllFiles },
+      wxFD_SAVE | wxFD_OVERWRITE_PROMPT | wxRESIZE_BORDER,
+      &GetProjectFrame(project));
+   if (fName.empty())
+      return;
+
+   std::ostringstream stream;
+   AudioTrace::WriteChromeTrace(stream);
+   const auto trace = stream.str();
+   wxFFileOutputStream file{ fName };
+   if (!file.IsOk() || !file.WriteAll(trace.data(), trace.size()))
+      AudacityMessageBox(
+         Verbatim("Couldn't write to file: %s").Format(fName));
+}
+
 #if defined(HAVE_UPDATES_CHECK)
 void OnCheckForUpdates(const CommandContext &WXUNUSED(context))
 {
@@ -436,6 +479,9 @@ auto HelpMenu()
             Command( wxT("DeviceInfo"), XXO("Au&dio Device Info..."),
                OnAudioDeviceInfo,
                AudioIONotBusyFlag() ),
+            Command( wxT("AudioThreadStatistics"),
+               XXO("Audio &Thread Statistics..."), OnAudioThreadStatistics,
+               AlwaysEnabledFlag ),
             Command( wxT("Log"), XXO("Show &Log..."), OnShowLog,
                AlwaysEnabledFlag ),
       #if defined(HAS_CRASH_REPORT)
@@ -465,7 +511,14 @@ auto HelpMenu()
             Command(
                  wxT("FrameStatistics"), Verbatim("Frame Statistics..."),
                  OnFrameStatistics,
-                 AlwaysEnabledFlag)
+                 AlwaysEnabledFlag),
+
+            // Load saved traces in chrome://tracing or Perfetto
+            Command( wxT("StartAudioTrace"), Verbatim("Start Audio Trace"),
+               OnStartAudioTrace, AlwaysEnabledFlag ),
+
+            Command( wxT("SaveAudioTrace"), Verbatim("Save Audio Trace..."),
+               OnSaveAudioTrace, AlwaysEnabledFlag )
       #endif
          )
       ),
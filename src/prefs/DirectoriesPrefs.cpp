@@ -34,6 +34,7 @@
 #include "AudacityMessageBox.h"
 #include "ReadOnlyText.h"
 #include "FileNames.h"
+#include "UndoStateSpiller.h"
 
 using namespace FileNames;
 using namespace TempDirectory;
@@ -260,6 +261,18 @@ void DirectoriesPrefs::PopulateOrExchange(ShuttleGui &S)
    }
    S.EndStatic();
 
+   S.StartStatic(XO("Undo history"));
+   {
+      S.StartThreeColumn();
+      {
+         S.TieIntegerTextBox(XXO("Memor&y limit:"), UndoMemoryBudget, 9);
+         S.AddUnits(XO("MB; older states are moved to the temporary files "
+            "directory beyond it, 0 for no limit"));
+      }
+      S.EndThreeColumn();
+   }
+   S.EndStatic();
+
    S.EndScroller();
 }
 
@@ -112,6 +112,8 @@ void ExtImportPrefs::PopulateOrExchange(ShuttleGui & S)
    S.TieCheckBox(XXO("A&ttempt to use filter in OpenFile dialog first"),
          {wxT("/ExtendedImport/OverrideExtendedImportByOpenFileDialogChoice"),
           true});
+   S.TieCheckBox(XXO("&Decode several files at once when importing them together"),
+         ConcurrentImport);
    S.StartStatic(XO("Rules to choose import filters"), 1);
    {
       S.SetSizerProportion(1);
@@ -57,6 +57,7 @@
 
 #include "AudioIO.h"
 #include "AColor.h"
+#include "EBUR128.h"
 #include "../widgets/BasicMenu.h"
 #include "ImageManipulation.h"
 #include "Decibels.h"
@@ -402,6 +403,8 @@ MeterPanel::MeterPanel(AudacityProject *project,
    Reset(44100.0, true);
 }
 
+MeterPanel::~MeterPanel() = default;
+
 void MeterPanel::Clear()
 {
    mQueue.Clear();
@@ -415,7 +418,9 @@ void MeterPanel::UpdatePrefs()
       std::max(MIN_REFRESH_RATE, std::min(MAX_REFRESH_RATE,
          gPrefs->Read(Key(wxT("RefreshRate")), 30L)));
    mGradient = gPrefs->Read(Key(wxT("Bars")), wxT("Gradient")) == wxT("Gradient");
-   mDB = gPrefs->Read(Key(wxT("Type")), wxT("dB")) == wxT("dB");
+   const auto type = gPrefs->Read(Key(wxT("Type")), wxT("dB"));
+   mLUFS = type == wxT("LUFS");
+   mDB = mLUFS || type == wxT("dB");
    mMeterDisabled = gPrefs->Read(Key(wxT("Disabled")), 0L);
 
    if (mDesiredStyle != MixerTrackCluster)
@@ -912,6 +917,16 @@ void MeterPanel::Reset(double sampleRate, bool resetClipping)
    // While it's stopped, empty the queue
    mQueue.Clear();
 
+   // Replace the loudness measurement only while audio I/O can't be using it;
+   // a change of meter type during play takes effect when play starts again
+   if (!mActive) {
+      if (mLUFS && sampleRate > 0)
+         mLoudness = std::make_unique<EBUR128>(sampleRate, kMaxMeterBars);
+      else
+         mLoudness.reset();
+      mIntegratedLoudness = 0;
+   }
+
    mLayoutValid = false;
 
    mTimer.Start(1000 / mMeterRefreshRate);
@@ -990,6 +1005,28 @@ void MeterPanel::UpdateDisplay(
    for(unsigned int j=0; j<mNumBars; j++)
       msg.rms[j] = sqrt(msg.rms[j]/numFrames);
 
+   if (mLoudness) {
+      // Deinterleave in pieces small enough for the stack; channels that are
+      // missing are silent
+      constexpr size_t pieceSize = 256;
+      float buffers[kMaxMeterBars][pieceSize];
+      const float *channels[kMaxMeterBars];
+      for (unsigned int j = 0; j < kMaxMeterBars; j++)
+         channels[j] = buffers[j];
+      for (int i = 0; i < numFrames; i += pieceSize) {
+         const auto count = std::min<size_t>(pieceSize, numFrames - i);
+         for (unsigned int j = 0; j < kMaxMeterBars; j++)
+            for (size_t k = 0; k < count; k++)
+               buffers[j][k] = j < numChannels
+                  ? sampleData[(i + k) * numChannels + j] : 0.0f;
+         mLoudness->ProcessSamples(channels, count);
+      }
+      msg.loudness = true;
+      msg.momentary = mLoudness->MomentaryLoudness();
+      msg.shortTerm = mLoudness->ShortTermLoudness();
+      msg.integrated = mLoudness->IntegrativeLoudness();
+   }
+
    mQueue.Put(msg);
 }
 
@@ -1064,6 +1101,23 @@ void MeterPanel::OnMeterUpdate(wxTimerEvent & WXUNUSED(event))
       double deltaT = msg.numFrames / mRate;
 
       mT += deltaT;
+
+      const bool loudness = mLUFS && msg.loudness;
+      if (loudness) {
+         // The first bar shows momentary loudness, the second short-term;
+         // loudness is a mean square, so its root is the level to show.
+         // Clipping in any channel shows in both.
+         msg.peak[0] = msg.rms[0] = sqrt(msg.momentary);
+         msg.peak[1] = msg.rms[1] = sqrt(msg.shortTerm);
+         msg.clipping[0] = msg.clipping[1] =
+            msg.clipping[0] || msg.clipping[1];
+         msg.headPeakCount[0] = msg.headPeakCount[1] =
+            std::max(msg.headPeakCount[0], msg.headPeakCount[1]);
+         msg.tailPeakCount[0] = msg.tailPeakCount[1] =
+            std::max(msg.tailPeakCount[0], msg.tailPeakCount[1]);
+         mIntegratedLoudness = msg.integrated;
+      }
+
       for(unsigned int j=0; j<mNumBars; j++) {
          mBar[j].isclipping = false;
 
@@ -1073,7 +1127,8 @@ void MeterPanel::OnMeterUpdate(wxTimerEvent & WXUNUSED(event))
             msg.rms[j] = ToDB(msg.rms[j], mDBRange);
          }
 
-         if (mDecay) {
+         // Loudness is already averaged over time
+         if (mDecay && !loudness) {
             if (mDB) {
                float decayAmount = mDecayRate * deltaT / mDBRange;
                mBar[j].peak = floatMax(msg.peak[j],
@@ -1090,7 +1145,7 @@ void MeterPanel::OnMeterUpdate(wxTimerEvent & WXUNUSED(event))
             mBar[j].peak = msg.peak[j];
 
          // This smooths out the RMS signal
-         float smooth = pow(0.9, (double)msg.numFrames/1024.0);
+         float smooth = loudness ? 0 : pow(0.9, (double)msg.numFrames/1024.0);
          mBar[j].rms = mBar[j].rms * smooth + msg.rms[j] * (1.0 - smooth);
 
          if (mT - mBar[j].peakHoldTime > mPeakHoldDuration ||
@@ -1290,10 +1345,18 @@ void MeterPanel::SetBarAndClip(int iBar, bool vert)
 void MeterPanel::HandleLayout(wxDC &dc)
 {
    // Refresh to reflect any language changes
-   /* i18n-hint: One-letter abbreviation for Left, in VU Meter */
-   mLeftText = _("L");
-   /* i18n-hint: One-letter abbreviation for Right, in VU Meter */
-   mRightText = _("R");
+   if (mLUFS) {
+      /* i18n-hint: One-letter abbreviation for Momentary loudness, in VU Meter */
+      mLeftText = _("M");
+      /* i18n-hint: One-letter abbreviation for Short-term loudness, in VU Meter */
+      mRightText = _("S");
+   }
+   else {
+      /* i18n-hint: One-letter abbreviation for Left, in VU Meter */
+      mLeftText = _("L");
+      /* i18n-hint: One-letter abbreviation for Right, in VU Meter */
+      mRightText = _("R");
+   }
 
    dc.SetFont(GetFont());
    int width = mWidth;
@@ -1954,6 +2017,14 @@ void MeterPanel::ShowMenu(const wxPoint & pos)
       mi->Enable(!mActive || mMonitoring);
    }
 
+   if (mLUFS && mIntegratedLoudness > 0) {
+      auto mi = menu.Append(wxID_ANY,
+         /* i18n-hint: LUFS is Loudness Units relative to Full Scale */
+         wxString::Format(_("Integrated Loudness: %.1f LUFS"),
+            10 * log10(mIntegratedLoudness)));
+      mi->Enable(false);
+   }
+
    menu.Append(OnPreferencesID, _("Options..."));
 
    BasicMenu::Handle{ &menu }.Popup(
@@ -1982,6 +2053,7 @@ void MeterPanel::OnPreferences(wxCommandEvent & WXUNUSED(event))
    wxRadioButton *rms;
    wxRadioButton *db;
    wxRadioButton *linear;
+   wxRadioButton *lufs;
    wxRadioButton *automatic;
    wxRadioButton *horizontal;
    wxRadioButton *vertical;
@@ -2032,8 +2104,11 @@ void MeterPanel::OnPreferences(wxCommandEvent & WXUNUSED(event))
         {
            S.StartVerticalLay();
            {
-              db = S.AddRadioButton(XXO("dB"), true, mDB);
-              linear = S.AddRadioButtonToGroup(XXO("Linear"), false, mDB);
+              const int type = mLUFS ? 2 : mDB ? 0 : 1;
+              db = S.AddRadioButton(XXO("dB"), 0, type);
+              linear = S.AddRadioButtonToGroup(XXO("Linear"), 1, type);
+              /* i18n-hint: LUFS is Loudness Units relative to Full Scale */
+              lufs = S.AddRadioButtonToGroup(XXO("Loudness (LUFS)"), 2, type);
            }
            S.EndVerticalLay();
         }
@@ -2078,7 +2153,8 @@ void MeterPanel::OnPreferences(wxCommandEvent & WXUNUSED(event))
 
       gPrefs->Write(Key(wxT("Style")), style[s]);
       gPrefs->Write(Key(wxT("Bars")), gradient->GetValue() ? wxT("Gradient") : wxT("RMS"));
-      gPrefs->Write(Key(wxT("Type")), db->GetValue() ? wxT("dB") : wxT("Linear"));
+      gPrefs->Write(Key(wxT("Type")), db->GetValue() ? wxT("dB")
+         : lufs->GetValue() ? wxT("LUFS") : wxT("Linear"));
       gPrefs->Write(Key(wxT("RefreshRate")), rate->GetValue());
 
       gPrefs->Flush();
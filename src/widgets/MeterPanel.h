@@ -17,6 +17,7 @@
 #define __AUDACITY_METER_PANEL__
 
 #include <atomic>
+#include <memory>
 #include <wx/setup.h> // for wxUSE_* macros
 #include <wx/brush.h> // member variable
 #include <wx/defs.h>
@@ -31,6 +32,7 @@
 
 class AudacityProject;
 struct AudioIOEvent;
+class EBUR128;
 
 // Increase this when we add support for multichannel meters
 // (most of the code is already there)
@@ -60,6 +62,12 @@ class MeterUpdateMsg
    bool clipping[kMaxMeterBars];
    int headPeakCount[kMaxMeterBars];
    int tailPeakCount[kMaxMeterBars];
+   //! Whether the loudness values are given, for the LUFS meter type
+   bool loudness;
+   //! Momentary, short-term and integrated loudness, as EBUR128 gives them
+   float momentary;
+   float shortTerm;
+   float integrated;
 
    /* neither constructor nor destructor do anything */
    MeterUpdateMsg() { }
@@ -124,6 +132,7 @@ class AUDACITY_DLL_API MeterPanel final
          const wxSize& size = wxDefaultSize,
          Style style = HorizontalStereo,
          float fDecayRate = 60.0f);
+   ~MeterPanel() override;
 
    void SetFocusFromKbd() override;
 
@@ -267,6 +276,8 @@ class AUDACITY_DLL_API MeterPanel final
    Style     mDesiredStyle;
    bool      mGradient;
    bool      mDB;
+   //! Show loudness, on the decibel scale, instead of levels of channels
+   bool      mLUFS{};
    int       mDBRange;
    bool      mDecay;
    float     mDecayRate{}; // dB/sec
@@ -285,6 +296,10 @@ class AUDACITY_DLL_API MeterPanel final
    unsigned  mNumBars;
    MeterBar  mBar[kMaxMeterBars]{};
 
+   //! Measures loudness in UpdateDisplay, for the LUFS meter type
+   std::unique_ptr<EBUR128> mLoudness;
+   float     mIntegratedLoudness{};
+
    bool      mLayoutValid;
 
    std::unique_ptr<wxBitmap> mBitmap;
@@ -9,6 +9,7 @@
 
 **********************************************************************/
 #include "MockSampleBlock.h"
+#include "XMLWriter.h"
 
 namespace
 {
@@ -61,8 +62,9 @@ size_t MockSampleBlock::GetSpaceUsage() const
    return data.size();
 }
 
-void MockSampleBlock::SaveXML(XMLWriter&)
+void MockSampleBlock::SaveXML(XMLWriter& xmlFile)
 {
+   xmlFile.WriteAttr(wxT("blockid"), id);
 }
 
 size_t MockSampleBlock::DoGetSamples(
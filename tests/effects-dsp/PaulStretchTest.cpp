@@ -0,0 +1,50 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  PaulStretchTest.cpp
+
+**********************************************************************/
+#include "PaulStretchEngine.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Hidden; run with the [benchmark] tag
+TEST_CASE("Paulstretch CPU time per second of output", "[.][benchmark]")
+{
+   using namespace std::chrono;
+   constexpr float rate = 44100, amount = 10;
+   constexpr double seconds = 30;
+   std::mt19937 engine { 13 };
+   std::uniform_real_distribution<float> distribution { -1.f, 1.f };
+   for (const size_t bufferSize : { 1024, 16384 })
+   {
+      PaulStretch stretch { amount, bufferSize, rate };
+      std::vector<float> input(stretch.poolsize);
+      for (auto& sample : input)
+         sample = distribution(engine);
+
+      srand(0);
+      stretch.process(input.data(), stretch.get_nsamples_for_fill());
+      size_t produced = 0;
+      const auto start = steady_clock::now();
+      while (produced < seconds * rate)
+      {
+         stretch.process(input.data(), stretch.get_nsamples());
+         produced += stretch.out_bufsize;
+      }
+      const auto elapsed =
+         duration<double, std::milli>(steady_clock::now() - start).count();
+      REQUIRE(std::isfinite(stretch.out_buf[0]));
+      std::cout << "Paulstretch, buffer of " << bufferSize << ": "
+                << elapsed * rate / produced
+                << " ms per second of output\n";
+   }
+}
@@ -0,0 +1,152 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ReverbTest.cpp
+
+**********************************************************************/
+// Reverb_libSoX.h relies on what its includer has already included
+#include <cassert>
+#include <cmath>
+#include <wx/defs.h>
+
+#include "Reverb_libSoX.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+//! The filters as they were run before they were run in pieces: a check of
+//! the pointer of each filter after each sample
+void OldFilterArrayProcess(filter_array_t* p, size_t length,
+   const float* input, float* output, float feedback, float hf_damping,
+   float gain)
+{
+   const auto comb = [&](filter_t* f, float in) {
+      float out = *f->ptr;
+      f->store = out + (f->store - out) * hf_damping;
+      *f->ptr = in + f->store * feedback;
+      filter_advance(f);
+      return out;
+   };
+   const auto allpass = [](filter_t* f, float in) {
+      float out = *f->ptr;
+      *f->ptr = in + out * .5;
+      filter_advance(f);
+      return out - in;
+   };
+   while (length--)
+   {
+      float out = 0, in = *input++;
+      size_t i = array_length(comb_lengths) - 1;
+      do
+         out += comb(p->comb + i, in);
+      while (i--);
+      i = array_length(allpass_lengths) - 1;
+      do
+         out = allpass(p->allpass + i, out);
+      while (i--);
+      out = one_pole_process(&p->one_pole[0], out);
+      out = one_pole_process(&p->one_pole[1], out);
+      *output++ = out * gain;
+   }
+}
+
+//! Filters of the same sizes, contents and positions as another's
+struct FilterArrayCopy
+{
+   explicit FilterArrayCopy(const filter_array_t& other)
+       : filters { other }
+   {
+      const auto copy = [](filter_t& f) {
+         const auto buffer = static_cast<float*>(malloc(f.size * sizeof(float)));
+         std::copy(f.buffer, f.buffer + f.size, buffer);
+         f.ptr = buffer + (f.ptr - f.buffer);
+         f.buffer = buffer;
+      };
+      for (auto& f : filters.comb)
+         copy(f);
+      for (auto& f : filters.allpass)
+         copy(f);
+   }
+   ~FilterArrayCopy()
+   {
+      filter_array_delete(&filters);
+   }
+   filter_array_t filters;
+};
+
+std::vector<float> Noise(size_t len)
+{
+   std::mt19937 engine { 11 };
+   std::uniform_real_distribution<float> distribution { -1.f, 1.f };
+   std::vector<float> result(len);
+   for (auto& sample : result)
+      sample = distribution(engine);
+   return result;
+}
+} // namespace
+
+TEST_CASE("Reverb filters give what they gave one sample at a time")
+{
+   for (const double rate : { 8000., 44100., 192000. })
+      for (const double offset : { 0., 1. })
+         for (const double scale : { .1, .55, 1. })
+         {
+            filter_array_t filters {};
+            filter_array_create(&filters, rate, scale, offset);
+            one_pole_init(&filters, rate, 50, 15000);
+            FilterArrayCopy old { filters };
+
+            // Long enough for every filter to wrap several times, in blocks
+            // of lengths that do not divide any filter
+            const auto input = Noise(rate / 2);
+            std::vector<float> expected(input.size()), actual(input.size());
+            const float feedback = .8f, damping = .35f, gain = .015f;
+            for (size_t pos = 0, len = 1; pos < input.size();
+                 len = len * 5 % 3001 + 1)
+            {
+               const auto count = std::min(len, input.size() - pos);
+               OldFilterArrayProcess(&old.filters, count, &input[pos],
+                  &expected[pos], feedback, damping, gain);
+               filter_array_process(&filters, count, &input[pos],
+                  &actual[pos], &feedback, &damping, &gain);
+               pos += count;
+            }
+            filter_array_delete(&filters);
+            REQUIRE(actual == expected);
+         }
+}
+
+// Hidden; run with the [benchmark] tag
+TEST_CASE("Reverb CPU time per second of audio", "[.][benchmark]")
+{
+   using namespace std::chrono;
+   constexpr double rate = 44100;
+   constexpr size_t blockSize = 512, seconds = 60;
+   const auto input = Noise(blockSize);
+   for (const double depth : { 0., 100. })
+   {
+      reverb_t reverb;
+      float* out[2];
+      reverb_create(&reverb, rate, -1, 75, 50, 50, 10, depth, 100, 100,
+         blockSize, 200, out);
+      const auto start = steady_clock::now();
+      for (size_t ii = 0; ii < seconds * rate / blockSize; ++ii)
+      {
+         fifo_write(&reverb.input_fifo, blockSize, input.data());
+         reverb_process(&reverb, blockSize);
+      }
+      const auto elapsed =
+         duration<double, std::milli>(steady_clock::now() - start).count();
+      reverb_delete(&reverb);
+      std::cout << "Reverb, stereo depth " << depth << ": "
+                << elapsed / seconds << " ms per second of audio\n";
+   }
+}
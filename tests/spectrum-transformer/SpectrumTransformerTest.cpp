@@ -0,0 +1,217 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SpectrumTransformerTest.cpp
+
+**********************************************************************/
+#include "SpectrumTransformer.h"
+
+#include "FFT.h"
+#include "MockSampleBlockFactory.h"
+#include "MockedPrefs.h"
+#include "Parallel.h"
+#include "Project.h"
+#include "WaveTrack.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+namespace
+{
+MockedPrefs prefs;
+
+constexpr auto rate = 44100;
+constexpr size_t windowSize = 2048;
+constexpr unsigned stepsPerWindow = 4;
+// The newest window decides the gains of the oldest, as in Noise Reduction
+constexpr size_t queueLength = 3;
+
+//! A noise gate with release, like Noise Reduction's: each bin opens fully
+//! when loud, else its gain decays to a floor
+/*!
+ The gains depend on the windows before, but no more than the decay takes to
+ reach the floor; that many warm-up windows make parallel output the same as
+ serial
+ */
+class GateTransformer final : public TrackSpectrumTransformer
+{
+public:
+   static constexpr float threshold = 1.0f;
+   static constexpr float decay = 0.9f;
+   static constexpr float floor = 0.05f;
+
+   static size_t WarmUpWindows()
+   {
+      size_t result = 0;
+      for (auto gain = 1.0f; gain > floor; gain *= decay)
+         ++result;
+      return result;
+   }
+
+   GateTransformer(
+      WaveChannel* pOutput, bool leadingPadding, bool trailingPadding)
+       : TrackSpectrumTransformer { pOutput,        true,
+                                    eWinFuncHann,   eWinFuncHann,
+                                    windowSize,     stepsPerWindow,
+                                    leadingPadding, trailingPadding }
+   {
+   }
+
+   static bool Processor(SpectrumTransformer& transformer)
+   {
+      auto& gate = static_cast<GateTransformer&>(transformer);
+      const auto& newest = gate.Newest();
+      for (size_t ii = 0; ii < gate.mGains.size(); ++ii)
+      {
+         const auto re = newest.mRealFFTs[ii], im = newest.mImagFFTs[ii];
+         auto& gain = gate.mGains[ii];
+         gain = re * re + im * im > threshold ?
+                   1.0f :
+                   std::max(floor, gain * decay);
+      }
+      if (gate.QueueIsFull())
+      {
+         auto& latest = gate.Latest();
+         for (size_t ii = 0; ii < gate.mGains.size(); ++ii)
+         {
+            latest.mRealFFTs[ii] *= gate.mGains[ii];
+            latest.mImagFFTs[ii] *= gate.mGains[ii];
+         }
+      }
+      return true;
+   }
+
+protected:
+   bool DoStart() override
+   {
+      mGains.assign(windowSize / 2, 1.0f);
+      return TrackSpectrumTransformer::DoStart();
+   }
+
+private:
+   std::vector<float> mGains;
+};
+
+//! Bursts of tone in noise, so that the gates open and close
+std::vector<float> MakeSignal(size_t length)
+{
+   std::mt19937 generator { 5 };
+   std::normal_distribution<float> noise { 0, 0.05f };
+   std::vector<float> result(length);
+   for (size_t ii = 0; ii < length; ++ii)
+   {
+      const bool on = (ii / 7000) % 3 == 0;
+      result[ii] = noise(generator) + (on ? 0.5f * std::sin(ii * 0.05f) : 0);
+   }
+   return result;
+}
+
+struct Tracks
+{
+   explicit Tracks(const std::vector<float>& samples)
+   {
+      input = MakeTrack();
+      input->GetChannel(0)->Append(
+         reinterpret_cast<constSamplePtr>(samples.data()), floatSample,
+         samples.size());
+      input->Flush();
+   }
+
+   std::shared_ptr<WaveTrack> MakeTrack()
+   {
+      const auto track =
+         std::make_shared<WaveTrack>(factory, floatSample, rate);
+      TrackList::Get(*project).Add(track);
+      return track;
+   }
+
+   //! Transform the whole input into a new track, either serially or in
+   //! parallel
+   std::vector<float> Transform(bool parallel)
+   {
+      const auto output = MakeTrack();
+      const auto pOutput = output->GetChannel(0);
+      const auto pChannel = input->GetChannel(0);
+      const auto len = input->GetVisibleSampleCount();
+      GateTransformer transformer { pOutput.get(), true, true };
+      if (parallel)
+      {
+         const auto factory = [](bool leadingPadding, bool trailingPadding) {
+            return std::make_unique<GateTransformer>(
+               nullptr, leadingPadding, trailingPadding);
+         };
+         REQUIRE(transformer.ProcessParallel(
+            factory, GateTransformer::Processor, *pChannel, queueLength,
+            GateTransformer::WarmUpWindows(), 0, len,
+            [](double) { return true; }));
+      }
+      else
+         REQUIRE(transformer.Process(
+            GateTransformer::Processor, *pChannel, queueLength, 0, len));
+      output->Flush();
+
+      std::vector<float> result(output->GetVisibleSampleCount().as_size_t());
+      REQUIRE(pOutput->GetFloats(result.data(), 0, result.size()));
+      return result;
+   }
+
+   const std::shared_ptr<AudacityProject> project {
+      AudacityProject::Create()
+   };
+   const std::shared_ptr<MockSampleBlockFactory> factory {
+      std::make_shared<MockSampleBlockFactory>()
+   };
+   std::shared_ptr<WaveTrack> input;
+};
+
+//! Transform serially, then in parallel on each number of threads, and
+//! require the same output; returns the times taken, serial first
+std::vector<double> CompareTransforms(
+   const std::vector<float>& samples, std::initializer_list<size_t> threads)
+{
+   Tracks tracks { samples };
+   std::vector<double> times;
+   const auto transform = [&](bool parallel) {
+      const auto start = std::chrono::steady_clock::now();
+      auto result = tracks.Transform(parallel);
+      times.push_back(std::chrono::duration<double, std::milli>(
+                         std::chrono::steady_clock::now() - start)
+                         .count());
+      return result;
+   };
+   const auto serial = transform(false);
+   REQUIRE(serial.size() >= samples.size());
+   for (const auto nThreads : threads)
+   {
+      Parallel::SetMaxConcurrency(nThreads);
+      // Bit for bit
+      REQUIRE(transform(true) == serial);
+   }
+   Parallel::SetMaxConcurrency(0);
+   return times;
+}
+} // namespace
+
+TEST_CASE("Parallel spectrum transformation is the same as serial")
+{
+   // Shorter than one segment, and long enough for more than one batch
+   for (const auto length : { 3000, 60 * rate })
+      CompareTransforms(MakeSignal(length), { 1, 3 });
+}
+
+// Hidden; run with the [benchmark] tag
+TEST_CASE("Parallel spectrum transformation speed", "[.][benchmark]")
+{
+   const auto threads = Parallel::DefaultConcurrency();
+   const auto times = CompareTransforms(MakeSignal(120 * rate), { threads });
+   std::cout << "two minutes of audio: serial " << times[0]
+             << " ms, parallel " << times[1] << " ms on " << threads
+             << " threads\n";
+}